@@ -0,0 +1,80 @@
+/*
+ * INGRES ChatBot - Pipelined Query Benchmark
+ * Compares issuing N independent lookups one after another against sending
+ * them as a single pipelined batch on one pooled connection.
+ *
+ * Usage: db_pipeline_bench [conninfo] [iterations]
+ */
+
+#include "database.h"
+#include "db_async.h"
+#include "db_pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static const char* bench_states[] = {
+    "Punjab", "Haryana", "Rajasthan", "Gujarat",
+    "Maharashtra", "Karnataka", "Tamil Nadu", "Uttar Pradesh"
+};
+#define BENCH_STATE_COUNT (int)(sizeof(bench_states) / sizeof(bench_states[0]))
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static double run_sequential(void) {
+    double start = now_ms();
+    for (int i = 0; i < BENCH_STATE_COUNT; i++) {
+        free_query_result(query_by_state(bench_states[i]));
+    }
+    return now_ms() - start;
+}
+
+static double run_pipelined(void) {
+    double start = now_ms();
+    DbBatch* batch = db_batch_create();
+    for (int i = 0; i < BENCH_STATE_COUNT; i++) {
+        db_batch_add_state(batch, bench_states[i]);
+    }
+    db_batch_submit(batch);
+    db_batch_wait(batch, 0);
+    db_batch_free(batch);
+    return now_ms() - start;
+}
+
+int main(int argc, char* argv[]) {
+    const char* conninfo = argc > 1 ? argv[1] : NULL;
+    int iterations = argc > 2 ? atoi(argv[2]) : 200;
+    if (iterations <= 0) iterations = 200;
+
+    if (!db_pool_init(conninfo, 2)) {
+        fprintf(stderr, "❌ Could not connect; pass a conninfo string or set INGRES_DB_CONNINFO\n");
+        return 1;
+    }
+
+    // Warm up both paths so statement preparation is not measured
+    run_sequential();
+    run_pipelined();
+
+    double sequential_total = 0.0, pipelined_total = 0.0;
+    for (int i = 0; i < iterations; i++) {
+        sequential_total += run_sequential();
+        pipelined_total += run_pipelined();
+    }
+
+    double sequential_avg = sequential_total / iterations;
+    double pipelined_avg = pipelined_total / iterations;
+
+    printf("📊 %d lookups per request, %d iterations\n", BENCH_STATE_COUNT, iterations);
+    printf("   • Sequential: %.3f ms/request\n", sequential_avg);
+    printf("   • Pipelined:  %.3f ms/request\n", pipelined_avg);
+    if (pipelined_avg > 0.0) {
+        printf("   • Speedup:    %.2fx\n", sequential_avg / pipelined_avg);
+    }
+
+    db_pool_shutdown();
+    return 0;
+}
@@ -0,0 +1,658 @@
+/*
+ * INGRES ChatBot - Load Generator
+ * Drives the query pipeline (in process, or the HTTP API over loopback)
+ * from N threads with a query mix, and reports throughput, tail latency and
+ * allocations per request as one JSON object for regression tracking.
+ *
+ * Usage: loadgen [--threads N] [--requests N | --duration SEC] [--warmup N]
+ *                [--queries FILE]... [--session]
+ *                [--http HOST:PORT [--close] [--gzip] [--ws]] [--output FILE]
+ *
+ * In HTTP mode each thread keeps one keep-alive connection and reopens it
+ * only when the server closes it; --close opens one per request instead.
+ * --gzip sends Accept-Encoding: gzip; compare body_bytes_per_response
+ * with and without it for the egress saved by compression. --ws sends each
+ * query as one frame over a /ws/chat WebSocket per thread instead.
+ *
+ * Defaults: 4 threads, 20000 requests, 200 warmup requests per thread, the
+ * queries in test_queries.txt and test_enhanced_queries.txt.
+ */
+
+#define _GNU_SOURCE             // Sockets, barriers and dup2 under -std=c11
+#include "chatbot.h"
+#include "logger.h"
+#include "metrics.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <errno.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+
+#define LOADGEN_MAX_QUERIES 256
+#define LOADGEN_MAX_FILES 8
+#define LOADGEN_HTTP_TIMEOUT_S 5
+
+// ============================================================================
+// ALLOCATION COUNTING
+// ============================================================================
+
+// Interposing malloc catches allocations made inside libc (strdup etc.) too.
+// Only glibc exposes the underlying allocator under a second name.
+#if defined(__GLIBC__)
+#define LOADGEN_COUNT_ALLOCS 1
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t count, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+
+static atomic_ulong allocation_count;
+
+void* malloc(size_t size) {
+    atomic_fetch_add_explicit(&allocation_count, 1, memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    atomic_fetch_add_explicit(&allocation_count, 1, memory_order_relaxed);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    atomic_fetch_add_explicit(&allocation_count, 1, memory_order_relaxed);
+    return __libc_realloc(ptr, size);
+}
+
+static unsigned long allocations(void) {
+    return atomic_load(&allocation_count);
+}
+#else
+#define LOADGEN_COUNT_ALLOCS 0
+static unsigned long allocations(void) {
+    return 0;
+}
+#endif
+
+// ============================================================================
+// CONFIGURATION
+// ============================================================================
+
+typedef struct {
+    int threads;
+    long requests;              // Total measured requests (when duration_s == 0)
+    double duration_s;          // Run for this long instead
+    int warmup;                 // Unmeasured requests per thread
+    const char* query_files[LOADGEN_MAX_FILES];
+    int query_file_count;
+    bool use_session;           // Pass a session id so the response cache is exercised
+    const char* http_host;      // NULL: call the pipeline in process
+    const char* http_port;
+    bool close_each;            // Connection: close on every HTTP request
+    bool accept_gzip;           // Ask for compressed responses
+    bool websocket;             // One /ws/chat socket per thread, a frame per request
+    const char* output;         // NULL: stdout
+} LoadgenConfig;
+
+static char* queries[LOADGEN_MAX_QUERIES];
+static int query_count = 0;
+
+static LoadgenConfig config = {
+    .threads = 4,
+    .requests = 20000,
+    .warmup = 200,
+};
+
+static void usage(const char* program) {
+    fprintf(stderr,
+            "Usage: %s [--threads N] [--requests N | --duration SEC] [--warmup N]\n"
+            "          [--queries FILE]... [--session]\n"
+            "          [--http HOST:PORT [--close] [--gzip] [--ws]] [--output FILE]\n",
+            program);
+}
+
+static bool parse_args(int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+
+        if (strcmp(arg, "--session") == 0) {
+            config.use_session = true;
+            continue;
+        }
+        if (strcmp(arg, "--close") == 0) {
+            config.close_each = true;
+            continue;
+        }
+        if (strcmp(arg, "--gzip") == 0) {
+            config.accept_gzip = true;
+            continue;
+        }
+        if (strcmp(arg, "--ws") == 0) {
+            config.websocket = true;
+            continue;
+        }
+        if (!value) return false;
+        i++;
+
+        if (strcmp(arg, "--threads") == 0) {
+            config.threads = atoi(value);
+        } else if (strcmp(arg, "--requests") == 0) {
+            config.requests = atol(value);
+        } else if (strcmp(arg, "--duration") == 0) {
+            config.duration_s = atof(value);
+        } else if (strcmp(arg, "--warmup") == 0) {
+            config.warmup = atoi(value);
+        } else if (strcmp(arg, "--queries") == 0 && config.query_file_count < LOADGEN_MAX_FILES) {
+            config.query_files[config.query_file_count++] = value;
+        } else if (strcmp(arg, "--http") == 0) {
+            static char host[256];
+            const char* colon = strrchr(value, ':');
+            if (!colon || colon == value || (size_t)(colon - value) >= sizeof(host)) return false;
+            memcpy(host, value, (size_t)(colon - value));
+            host[colon - value] = '\0';
+            config.http_host = host;
+            config.http_port = colon + 1;
+        } else if (strcmp(arg, "--output") == 0) {
+            config.output = value;
+        } else {
+            return false;
+        }
+    }
+
+    if (config.query_file_count == 0) {
+        config.query_files[config.query_file_count++] = "test_queries.txt";
+        config.query_files[config.query_file_count++] = "test_enhanced_queries.txt";
+    }
+    return config.threads > 0 && config.warmup >= 0 && (!config.websocket || config.http_host) &&
+           (config.duration_s > 0.0 || config.requests > 0);
+}
+
+// One query per line; blank lines and the interactive "quit" are skipped
+static void load_queries(const char* path) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "⚠️  Cannot read %s\n", path);
+        return;
+    }
+
+    char line[MAX_INPUT_LENGTH];
+    while (query_count < LOADGEN_MAX_QUERIES && fgets(line, sizeof(line), file)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '\0' || strcmp(line, "quit") == 0) continue;
+        queries[query_count] = strdup(line);
+        if (queries[query_count]) query_count++;
+    }
+    fclose(file);
+}
+
+// ============================================================================
+// CLIENTS
+// ============================================================================
+
+static uint64_t now_ns(void) {
+    return metrics_now_ns();
+}
+
+static bool run_in_process(const char* query, const char* session_id) {
+    BotResponse* response = process_user_query_enhanced(query, session_id);
+    if (!response) return false;
+    free_bot_response(response);
+    return true;
+}
+
+static void json_escape_into(char* out, size_t capacity, const char* text) {
+    size_t used = 0;
+    for (; *text && used + 7 < capacity; text++) {
+        unsigned char c = (unsigned char)*text;
+        if (c == '"' || c == '\\') {
+            out[used++] = '\\';
+            out[used++] = (char)c;
+        } else if (c < 0x20) {
+            used += (size_t)snprintf(out + used, capacity - used, "\\u%04x", c);
+        } else {
+            out[used++] = (char)c;
+        }
+    }
+    out[used] = '\0';
+}
+
+// Each worker thread's connection; -1 until opened or after it was closed
+static _Thread_local int http_fd = -1;
+static _Thread_local unsigned long long http_body_bytes;    // Response bodies as sent
+static atomic_ulong http_connections;
+
+static int http_connect(void) {
+    struct addrinfo hints = { .ai_family = AF_UNSPEC, .ai_socktype = SOCK_STREAM };
+    struct addrinfo* address = NULL;
+    if (getaddrinfo(config.http_host, config.http_port, &hints, &address) != 0) return -1;
+
+    int fd = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+    bool connected = fd >= 0 && connect(fd, address->ai_addr, address->ai_addrlen) == 0;
+    freeaddrinfo(address);
+    if (!connected) {
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+
+    struct timeval timeout = { .tv_sec = LOADGEN_HTTP_TIMEOUT_S };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    atomic_fetch_add_explicit(&http_connections, 1, memory_order_relaxed);
+    return fd;
+}
+
+static void http_disconnect(void) {
+    if (http_fd >= 0) close(http_fd);
+    http_fd = -1;
+}
+
+// Value of header name (lowercase) within the header block, or NULL
+static const char* find_header(char* headers, const char* name) {
+    size_t name_length = strlen(name);
+    for (char* line = strstr(headers, "\r\n"); line; line = strstr(line + 2, "\r\n")) {
+        if (strncasecmp(line + 2, name, name_length) == 0 && line[2 + name_length] == ':') {
+            return line + 3 + name_length;
+        }
+    }
+    return NULL;
+}
+
+// Read one response off the connection: the whole header block, then
+// exactly Content-Length body bytes. Returns the status, or -1.
+static int read_http_response(bool* server_closes) {
+    char buffer[16384];
+    size_t received = 0;
+    char* headers_end = NULL;
+
+    while (!headers_end) {
+        if (received == sizeof(buffer) - 1) return -1;
+        ssize_t n = recv(http_fd, buffer + received, sizeof(buffer) - 1 - received, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        received += (size_t)n;
+        buffer[received] = '\0';
+        headers_end = strstr(buffer, "\r\n\r\n");
+    }
+    if (strncmp(buffer, "HTTP/1.", 7) != 0 || received < 12) return -1;
+    int status = atoi(buffer + 9);
+
+    *headers_end = '\0';
+    const char* length = find_header(buffer, "content-length");
+    const char* connection = find_header(buffer, "connection");
+    *server_closes = strncmp(buffer, "HTTP/1.0", 8) == 0 ||
+                     (connection && strstr(connection, "close") != NULL);
+    if (!length) return -1;     // The server always frames its responses
+
+    // Skip the body without keeping it
+    size_t body_left = (size_t)atol(length);
+    http_body_bytes += body_left;
+    size_t body_seen = received - (size_t)(headers_end + 4 - buffer);
+    body_left = body_seen >= body_left ? 0 : body_left - body_seen;
+    while (body_left > 0) {
+        ssize_t n = recv(http_fd, buffer, body_left < sizeof(buffer) ? body_left : sizeof(buffer), 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        body_left -= (size_t)n;
+    }
+    return status;
+}
+
+// Success means a 2xx status line and the full body
+static bool run_http(const char* query, const char* session_id) {
+    char escaped[MAX_INPUT_LENGTH * 2];
+    json_escape_into(escaped, sizeof(escaped), query);
+    char body[MAX_INPUT_LENGTH * 2 + 128];
+    int body_length = session_id
+        ? snprintf(body, sizeof(body), "{\"message\":\"%s\",\"session_id\":\"%s\"}", escaped, session_id)
+        : snprintf(body, sizeof(body), "{\"message\":\"%s\"}", escaped);
+
+    char request[sizeof(body) + 256];
+    int request_length = snprintf(request, sizeof(request),
+                                  "POST /api/chat HTTP/1.1\r\n"
+                                  "Host: %s\r\n"
+                                  "Content-Type: application/json\r\n"
+                                  "Content-Length: %d\r\n"
+                                  "%s"
+                                  "Connection: %s\r\n\r\n%s",
+                                  config.http_host, body_length,
+                                  config.accept_gzip ? "Accept-Encoding: gzip\r\n" : "",
+                                  config.close_each ? "close" : "keep-alive", body);
+
+    // A reused connection may have been closed by the server while idle;
+    // that costs one retry on a fresh connection, not an error
+    for (int attempt = 0; attempt < 2; attempt++) {
+        bool reused = http_fd >= 0;
+        if (!reused && (http_fd = http_connect()) < 0) return false;
+
+        bool server_closes = false;
+        int status = -1;
+        if (send(http_fd, request, (size_t)request_length, MSG_NOSIGNAL) == request_length) {
+            status = read_http_response(&server_closes);
+        }
+        if (status < 0 || server_closes || config.close_each) http_disconnect();
+        if (status >= 0) return status >= 200 && status < 300;
+        if (!reused) return false;
+    }
+    return false;
+}
+
+// Exactly length bytes off the connection
+static bool recv_exact(void* buffer, size_t length) {
+    char* out = buffer;
+    while (length > 0) {
+        ssize_t n = recv(http_fd, out, length, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        out += n;
+        length -= (size_t)n;
+    }
+    return true;
+}
+
+// Upgrade a fresh connection to a /ws/chat WebSocket
+static bool ws_handshake(void) {
+    char request[512];
+    int request_length = snprintf(request, sizeof(request),
+                                  "GET /ws/chat HTTP/1.1\r\n"
+                                  "Host: %s\r\n"
+                                  "Upgrade: websocket\r\n"
+                                  "Connection: Upgrade\r\n"
+                                  "Sec-WebSocket-Key: bG9hZGdlbi1zZXNzaW9uIQ==\r\n"
+                                  "Sec-WebSocket-Version: 13\r\n\r\n",
+                                  config.http_host);
+    if (send(http_fd, request, (size_t)request_length, MSG_NOSIGNAL) != request_length) return false;
+
+    // The server says nothing more until the first frame, so the handshake
+    // response is all there is to read
+    char response[1024];
+    size_t received = 0;
+    while (received < sizeof(response) - 1) {
+        ssize_t n = recv(http_fd, response + received, sizeof(response) - 1 - received, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        received += (size_t)n;
+        response[received] = '\0';
+        if (strstr(response, "\r\n\r\n")) return strncmp(response, "HTTP/1.1 101", 12) == 0;
+    }
+    return false;
+}
+
+// One masked text frame out, one frame back. Success means an answer
+// rather than an {"error": ...} frame.
+static bool run_ws(const char* query) {
+    if (http_fd < 0) {
+        if ((http_fd = http_connect()) < 0) return false;
+        if (!ws_handshake()) {
+            http_disconnect();
+            return false;
+        }
+    }
+
+    char escaped[MAX_INPUT_LENGTH * 2];
+    json_escape_into(escaped, sizeof(escaped), query);
+    unsigned char frame[MAX_INPUT_LENGTH * 2 + 64];
+    size_t payload_length = (size_t)snprintf((char*)frame + 8, sizeof(frame) - 8, "{\"message\":\"%s\"}", escaped);
+
+    // Header: FIN + text, masked 16-bit length, then the mask key
+    static const unsigned char mask[4] = { 0x5a, 0xc3, 0x17, 0x8e };
+    size_t header_length = 8;
+    frame[0] = 0x81;
+    frame[1] = 0x80 | 126;
+    frame[2] = (unsigned char)(payload_length >> 8);
+    frame[3] = (unsigned char)payload_length;
+    memcpy(frame + 4, mask, 4);
+    for (size_t i = 0; i < payload_length; i++) frame[header_length + i] ^= mask[i % 4];
+    size_t frame_length = header_length + payload_length;
+    if (send(http_fd, frame, frame_length, MSG_NOSIGNAL) != (ssize_t)frame_length) {
+        http_disconnect();
+        return false;
+    }
+
+    unsigned char header[10];
+    if (!recv_exact(header, 2)) {
+        http_disconnect();
+        return false;
+    }
+    uint64_t length = header[1] & 0x7f;
+    if (length == 126 || length == 127) {
+        size_t extended = length == 126 ? 2 : 8;
+        if (!recv_exact(header + 2, extended)) {
+            http_disconnect();
+            return false;
+        }
+        length = 0;
+        for (size_t i = 0; i < extended; i++) length = (length << 8) | header[2 + i];
+    }
+    http_body_bytes += length;
+
+    char body[16384];
+    bool answered = true;
+    for (uint64_t left = length; left > 0;) {
+        size_t chunk = left < sizeof(body) ? (size_t)left : sizeof(body);
+        if (!recv_exact(body, chunk)) {
+            http_disconnect();
+            return false;
+        }
+        if (left == length) answered = strncmp(body, "{\"error\"", 9) != 0;
+        left -= chunk;
+    }
+    return (header[0] & 0x0f) == 0x1 && answered;
+}
+
+// ============================================================================
+// WORKERS
+// ============================================================================
+
+typedef struct {
+    int index;
+    LatencyHistogram latencies;
+    unsigned long errors;
+    unsigned long long body_bytes;
+} Worker;
+
+static atomic_long requests_left;
+static atomic_bool stop_requested;
+static pthread_barrier_t start_barrier;
+static pthread_barrier_t measure_barrier;
+static pthread_barrier_t go_barrier;
+static unsigned long allocs_before;
+static uint64_t measure_start;
+
+// All workers plus main meet here after warmup. One of them starts the clock
+// and the allocation count before anyone issues a measured request.
+static void wait_for_measurement(void) {
+    if (pthread_barrier_wait(&measure_barrier) == PTHREAD_BARRIER_SERIAL_THREAD) {
+        allocs_before = allocations();
+        measure_start = now_ns();
+    }
+    pthread_barrier_wait(&go_barrier);
+}
+
+static bool issue(unsigned* next, const char* session_id) {
+    const char* query = queries[*next % (unsigned)query_count];
+    *next += 1;
+    if (config.websocket) return run_ws(query);
+    return config.http_host ? run_http(query, session_id) : run_in_process(query, session_id);
+}
+
+static void* worker_main(void* arg) {
+    Worker* worker = arg;
+    char session_id[32];
+    snprintf(session_id, sizeof(session_id), "loadgen-%d", worker->index);
+    const char* session = config.use_session ? session_id : NULL;
+
+    // Threads start at different points in the mix so they don't run in lockstep
+    unsigned next = (unsigned)worker->index * 7u;
+
+    pthread_barrier_wait(&start_barrier);
+    for (int i = 0; i < config.warmup; i++) issue(&next, session);
+
+    wait_for_measurement();
+    http_body_bytes = 0;
+
+    for (;;) {
+        if (config.duration_s > 0.0) {
+            if (atomic_load_explicit(&stop_requested, memory_order_relaxed)) break;
+        } else if (atomic_fetch_sub_explicit(&requests_left, 1, memory_order_relaxed) <= 0) {
+            break;
+        }
+
+        uint64_t start = now_ns();
+        bool ok = issue(&next, session);
+        metrics_histogram_record(&worker->latencies, now_ns() - start);
+        if (!ok) worker->errors++;
+    }
+    worker->body_bytes = http_body_bytes;
+    http_disconnect();
+    return NULL;
+}
+
+// ============================================================================
+// REPORT
+// ============================================================================
+
+static void write_report(FILE* out, const LatencyHistogram* latencies, unsigned long errors,
+                         double elapsed_s, unsigned long allocs, unsigned long long body_bytes) {
+    double requests = (double)latencies->total_count;
+    double us = 1000.0;
+
+    fprintf(out, "{\"mode\":\"%s\",\"threads\":%d,\"warmup_per_thread\":%d,\"queries\":%d,"
+                 "\"session\":%s,\"requests\":%llu,\"errors\":%lu,\"duration_s\":%.3f,\"qps\":%.1f,",
+            config.websocket ? "websocket" : config.http_host ? "http" : "in_process", config.threads, config.warmup, query_count,
+            config.use_session ? "true" : "false", (unsigned long long)latencies->total_count,
+            errors, elapsed_s, elapsed_s > 0.0 ? requests / elapsed_s : 0.0);
+    fprintf(out, "\"latency_us\":{\"mean\":%.2f,\"p50\":%.2f,\"p90\":%.2f,\"p99\":%.2f,"
+                 "\"p999\":%.2f,\"max\":%.2f},",
+            requests > 0 ? (double)latencies->total_ns / requests / us : 0.0,
+            (double)metrics_value_at_quantile(latencies, 0.5) / us,
+            (double)metrics_value_at_quantile(latencies, 0.9) / us,
+            (double)metrics_value_at_quantile(latencies, 0.99) / us,
+            (double)metrics_value_at_quantile(latencies, 0.999) / us,
+            (double)latencies->max_ns / us);
+
+    if (config.http_host) {
+        fprintf(out, "\"keep_alive\":%s,\"connections\":%lu,\"gzip\":%s,\"body_bytes_per_response\":%.1f,",
+                config.close_each ? "false" : "true", atomic_load(&http_connections),
+                config.accept_gzip ? "true" : "false", requests > 0 ? (double)body_bytes / requests : 0.0);
+    }
+
+    // Client-side allocations are included in HTTP mode; the server's are not
+    if (LOADGEN_COUNT_ALLOCS && requests > 0) {
+        fprintf(out, "\"allocs_per_request\":%.2f}\n", (double)allocs / requests);
+    } else {
+        fprintf(out, "\"allocs_per_request\":null}\n");
+    }
+}
+
+// The pipeline prints start-up and shutdown banners; send them to stderr so
+// stdout carries only the report
+static int hide_stdout(void) {
+    fflush(stdout);
+    int saved = dup(STDOUT_FILENO);
+    dup2(STDERR_FILENO, STDOUT_FILENO);
+    return saved;
+}
+
+static void restore_stdout(int saved) {
+    fflush(stdout);
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+}
+
+int main(int argc, char* argv[]) {
+    if (!parse_args(argc, argv)) {
+        usage(argv[0]);
+        return 2;
+    }
+    for (int i = 0; i < config.query_file_count; i++) load_queries(config.query_files[i]);
+    if (query_count == 0) {
+        fprintf(stderr, "❌ No queries loaded\n");
+        return 1;
+    }
+
+    if (!config.http_host) {
+        // Log lines go to the log file only, never to stdout
+        LoggerConfig log_config;
+        logger_default_config(&log_config);
+        log_config.console = false;
+        logger_init(&log_config);
+
+        int saved_stdout = hide_stdout();
+        bool ready = chatbot_init();
+        restore_stdout(saved_stdout);
+        if (!ready) {
+            fprintf(stderr, "❌ Chatbot initialization failed\n");
+            return 1;
+        }
+    }
+
+    Worker* workers = calloc((size_t)config.threads, sizeof(Worker));
+    pthread_t* threads = calloc((size_t)config.threads, sizeof(pthread_t));
+    if (!workers || !threads) return 1;
+
+    atomic_store(&requests_left, config.requests);
+    pthread_barrier_init(&start_barrier, NULL, (unsigned)config.threads);
+    pthread_barrier_init(&measure_barrier, NULL, (unsigned)config.threads + 1);
+    pthread_barrier_init(&go_barrier, NULL, (unsigned)config.threads + 1);
+
+    for (int i = 0; i < config.threads; i++) {
+        workers[i].index = i;
+        if (pthread_create(&threads[i], NULL, worker_main, &workers[i]) != 0) {
+            fprintf(stderr, "❌ Could not start worker %d\n", i);
+            return 1;
+        }
+    }
+
+    // Measurement starts once every worker has finished its warmup
+    wait_for_measurement();
+
+    if (config.duration_s > 0.0) {
+        struct timespec wait = {
+            .tv_sec = (time_t)config.duration_s,
+            .tv_nsec = (long)((config.duration_s - (double)(time_t)config.duration_s) * 1e9),
+        };
+        while (nanosleep(&wait, &wait) != 0 && errno == EINTR) {}
+        atomic_store(&stop_requested, true);
+    }
+    for (int i = 0; i < config.threads; i++) pthread_join(threads[i], NULL);
+
+    double elapsed_s = (double)(now_ns() - measure_start) / 1e9;
+    unsigned long allocs = allocations() - allocs_before;
+
+    LatencyHistogram* total = calloc(1, sizeof(LatencyHistogram));
+    if (!total) return 1;
+    unsigned long errors = 0;
+    unsigned long long body_bytes = 0;
+    for (int i = 0; i < config.threads; i++) {
+        metrics_histogram_add(total, &workers[i].latencies);
+        errors += workers[i].errors;
+        body_bytes += workers[i].body_bytes;
+    }
+
+    if (!config.http_host) {
+        int saved_stdout = hide_stdout();
+        chatbot_cleanup();
+        restore_stdout(saved_stdout);
+    }
+
+    FILE* out = config.output ? fopen(config.output, "w") : stdout;
+    if (!out) {
+        fprintf(stderr, "❌ Cannot write %s\n", config.output);
+        return 1;
+    }
+    write_report(out, total, errors, elapsed_s, allocs, body_bytes);
+    if (out != stdout) fclose(out);
+
+    pthread_barrier_destroy(&start_barrier);
+    pthread_barrier_destroy(&measure_barrier);
+    pthread_barrier_destroy(&go_barrier);
+    free(total);
+    free(workers);
+    free(threads);
+    for (int i = 0; i < query_count; i++) free(queries[i]);
+    return errors == 0 ? 0 : 1;
+}
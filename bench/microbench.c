@@ -0,0 +1,544 @@
+/*
+ * INGRES ChatBot - Kernel Micro-Benchmarks
+ * Times individual hot functions in isolation: fuzzy matching, intent
+ * classification, location extraction, the in-memory store scan and hash
+ * lookups, over short/long/misspelled inputs and datasets scaled x1..x1000.
+ *
+ * Each case runs in batches sized to about --batch-us microseconds; a batch
+ * is timed with the cycle counter (TSC on x86, CNTVCT on arm64, the
+ * monotonic clock elsewhere). --reps batches per case are collected, samples
+ * outside median +/- 3 scaled MADs are dropped, and the median of the rest
+ * is reported per operation.
+ *
+ * Usage: microbench [--filter SUBSTR] [--reps N] [--batch-us N]
+ *                   [--scales 1,10,100,1000] [--save FILE]
+ *                   [--baseline FILE [--threshold PCT]]
+ *
+ * --save writes one JSON object per case; --baseline compares against such a
+ * file and exits 1 if any case is slower by more than --threshold percent
+ * (default 5).
+ */
+
+#define _GNU_SOURCE             // mkstemp/unlink/dup2 under -std=c11
+#include "chatbot.h"
+#include "database.h"
+#include "snapshot.h"
+#include "query_cache.h"
+#include "metrics.h"
+#include "logger.h"
+#include "utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CYCLE_COUNTER "tsc"
+static inline uint64_t cycles_now(void) {
+    _mm_lfence();
+    return __rdtsc();
+}
+#elif defined(__aarch64__)
+#define CYCLE_COUNTER "cntvct"
+static inline uint64_t cycles_now(void) {
+    uint64_t value;
+    __asm__ volatile("isb; mrs %0, cntvct_el0" : "=r"(value));
+    return value;
+}
+#else
+#define CYCLE_COUNTER "ns"
+static inline uint64_t cycles_now(void) {
+    return metrics_now_ns();
+}
+#endif
+
+#define MICROBENCH_MAX_REPS 1000
+#define MICROBENCH_MAX_SCALES 8
+#define MICROBENCH_MAX_BASELINE 512
+#define MICROBENCH_OUTLIER_MADS 3.0
+
+// Keeps results alive so the compiler cannot drop the calls
+static volatile uintptr_t sink;
+
+// ============================================================================
+// INPUTS
+// ============================================================================
+
+typedef struct {
+    const char* label;
+    const char* a;
+    const char* b;
+} StringPair;
+
+static const StringPair similarity_pairs[] = {
+    { "short", "punjab", "panjab" },
+    { "long", "groundwater extraction sustainability assessment",
+              "ground water extractoin sustainibility asessment" },
+    { "mismatch", "maharashtra", "rainfall" },
+};
+
+typedef struct {
+    const char* label;
+    const char* text;
+} QueryInput;
+
+static const QueryInput query_inputs[] = {
+    { "short", "Punjab status" },
+    { "long", "Could you please show me the detailed groundwater extraction and recharge "
+              "situation for Ludhiana district in Punjab, and compare it with the over-exploited "
+              "blocks in Haryana over the last few assessment years?" },
+    { "misspelled", "shwo me grondwater levl in Panjab near Ludhyana" },
+};
+
+#define COUNT_OF(array) (sizeof(array) / sizeof((array)[0]))
+
+// ============================================================================
+// KERNELS (each runs `iterations` operations)
+// ============================================================================
+
+static void bench_levenshtein(const void* arg, long iterations) {
+    const StringPair* pair = arg;
+    for (long i = 0; i < iterations; i++) sink += (uintptr_t)levenshtein_distance(pair->a, pair->b);
+}
+
+static void bench_advanced_similarity(const void* arg, long iterations) {
+    const StringPair* pair = arg;
+    for (long i = 0; i < iterations; i++) {
+        sink += (uintptr_t)(calculate_advanced_similarity(pair->a, pair->b) * 1000.0f);
+    }
+}
+
+static void bench_classify(const void* arg, long iterations) {
+    const QueryInput* query = arg;
+    float confidence;
+    for (long i = 0; i < iterations; i++) {
+        sink += (uintptr_t)classify_intent_advanced(query->text, NULL, &confidence);
+    }
+}
+
+static void bench_extract_locations(const void* arg, long iterations) {
+    const QueryInput* query = arg;
+    Arena arena;
+    arena_init(&arena);
+    for (long i = 0; i < iterations; i++) {
+        const char* state = NULL;
+        const char* district = NULL;
+        const char* block = NULL;
+        sink += (uintptr_t)extract_locations(&arena, query->text, &state, &district, &block);
+        arena_reset(&arena);
+    }
+    arena_destroy(&arena);
+}
+
+// create_enhanced_result is reached through query_by_*; the query cache is
+// shut down while these run so every call scans the store
+static void bench_state_scan(const void* arg, long iterations) {
+    (void)arg;
+    for (long i = 0; i < iterations; i++) {
+        QueryResult* result = query_by_state("Punjab");
+        sink += result ? (uintptr_t)result->count : 0;
+        free_query_result(result);
+    }
+}
+
+static void bench_district_scan(const void* arg, long iterations) {
+    (void)arg;
+    for (long i = 0; i < iterations; i++) {
+        QueryResult* result = query_by_location(NULL, "Ludhiana", NULL);
+        sink += result ? (uintptr_t)result->count : 0;
+        free_query_result(result);
+    }
+}
+
+typedef struct {
+    HashTable* table;
+    char** keys;
+    int key_count;
+} HashInput;
+
+static void bench_hash_get(const void* arg, long iterations) {
+    const HashInput* input = arg;
+    for (long i = 0; i < iterations; i++) {
+        sink += (uintptr_t)hash_get(input->table, input->keys[i % input->key_count]);
+    }
+}
+
+// ============================================================================
+// HARNESS
+// ============================================================================
+
+typedef struct {
+    int reps;
+    double batch_us;
+    const char* filter;
+    int scales[MICROBENCH_MAX_SCALES];
+    int scale_count;
+    const char* save_path;
+    const char* baseline_path;
+    double threshold_pct;
+} BenchConfig;
+
+static BenchConfig config = {
+    .reps = 25,
+    .batch_us = 1000.0,
+    .scales = { 1, 10, 100, 1000 },
+    .scale_count = 4,
+    .threshold_pct = 5.0,
+};
+
+typedef struct {
+    char name[128];
+    double median;          // Counter ticks per operation
+    double mean;
+    double stddev;
+    double min;
+    int kept;
+    int samples;
+} BenchResult;
+
+typedef struct {
+    char name[128];
+    double median;
+} BaselineEntry;
+
+static BaselineEntry baseline[MICROBENCH_MAX_BASELINE];
+static int baseline_count = 0;
+static double ticks_per_ns = 1.0;
+static FILE* save_file = NULL;
+static int regressions = 0;
+
+static int compare_doubles(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static double median_of(double* sorted, int count) {
+    return count % 2 ? sorted[count / 2] : (sorted[count / 2 - 1] + sorted[count / 2]) / 2.0;
+}
+
+// Counter ticks per nanosecond, measured against the monotonic clock
+static void calibrate_counter(void) {
+    uint64_t start_ns = metrics_now_ns();
+    uint64_t start_ticks = cycles_now();
+    while (metrics_now_ns() - start_ns < 50000000ULL) {}
+    uint64_t elapsed_ns = metrics_now_ns() - start_ns;
+    ticks_per_ns = (double)(cycles_now() - start_ticks) / (double)elapsed_ns;
+    if (ticks_per_ns <= 0.0) ticks_per_ns = 1.0;
+}
+
+// Grow the batch until it takes at least batch_us
+static long calibrate_batch(void (*kernel)(const void*, long), const void* arg) {
+    long iterations = 1;
+    for (;;) {
+        uint64_t start = metrics_now_ns();
+        kernel(arg, iterations);
+        double elapsed_us = (double)(metrics_now_ns() - start) / 1000.0;
+        if (elapsed_us >= config.batch_us || iterations >= (1L << 30)) return iterations;
+        iterations *= elapsed_us > 0.0 && config.batch_us / elapsed_us < 10.0 ? 2 : 10;
+    }
+}
+
+static const BaselineEntry* find_baseline(const char* name) {
+    for (int i = 0; i < baseline_count; i++) {
+        if (strcmp(baseline[i].name, name) == 0) return &baseline[i];
+    }
+    return NULL;
+}
+
+static void report(const BenchResult* result) {
+    printf("%-52s %12.1f %10.1f %8.1f%% %5d/%-3d", result->name, result->median,
+           result->median / ticks_per_ns, result->median > 0.0 ? 100.0 * result->stddev / result->median : 0.0,
+           result->kept, result->samples);
+
+    const BaselineEntry* before = find_baseline(result->name);
+    if (before && before->median > 0.0) {
+        double delta = 100.0 * (result->median - before->median) / before->median;
+        bool slower = delta > config.threshold_pct;
+        regressions += slower;
+        printf(" %+7.1f%%%s", delta, slower ? " ⚠️  slower" : delta < -config.threshold_pct ? " ✅ faster" : "");
+    }
+    printf("\n");
+
+    if (save_file) {
+        fprintf(save_file, "{\"name\":\"%s\",\"median_ticks\":%.3f,\"median_ns\":%.3f,"
+                           "\"mean_ticks\":%.3f,\"stddev_ticks\":%.3f,\"min_ticks\":%.3f,"
+                           "\"kept\":%d,\"samples\":%d,\"counter\":\"%s\"}\n",
+                result->name, result->median, result->median / ticks_per_ns, result->mean,
+                result->stddev, result->min, result->kept, result->samples, CYCLE_COUNTER);
+    }
+}
+
+static bool selected(const char* name) {
+    return !config.filter || strstr(name, config.filter);
+}
+
+static void run_case(const char* name, void (*kernel)(const void*, long), const void* arg) {
+    if (!selected(name)) return;
+
+    static double samples[MICROBENCH_MAX_REPS];
+    long iterations = calibrate_batch(kernel, arg);
+
+    for (int rep = 0; rep < config.reps; rep++) {
+        uint64_t start = cycles_now();
+        kernel(arg, iterations);
+        samples[rep] = (double)(cycles_now() - start) / (double)iterations;
+    }
+
+    // Outlier rejection: keep samples within a few scaled MADs of the median
+    qsort(samples, (size_t)config.reps, sizeof(double), compare_doubles);
+    double median = median_of(samples, config.reps);
+    double deviations[MICROBENCH_MAX_REPS];
+    for (int i = 0; i < config.reps; i++) deviations[i] = fabs(samples[i] - median);
+    qsort(deviations, (size_t)config.reps, sizeof(double), compare_doubles);
+    double limit = MICROBENCH_OUTLIER_MADS * 1.4826 * median_of(deviations, config.reps);
+
+    BenchResult result = { .samples = config.reps, .min = samples[0] };
+    snprintf(result.name, sizeof(result.name), "%s", name);
+    double kept[MICROBENCH_MAX_REPS];
+    double sum = 0.0;
+    for (int i = 0; i < config.reps; i++) {
+        if (fabs(samples[i] - median) <= limit) {
+            kept[result.kept++] = samples[i];
+            sum += samples[i];
+        }
+    }
+    result.median = median_of(kept, result.kept);
+    result.mean = sum / result.kept;
+    double squares = 0.0;
+    for (int i = 0; i < result.kept; i++) squares += (kept[i] - result.mean) * (kept[i] - result.mean);
+    result.stddev = result.kept > 1 ? sqrt(squares / (result.kept - 1)) : 0.0;
+
+    report(&result);
+}
+
+// ============================================================================
+// SCALED DATASETS
+// ============================================================================
+
+// Replace the store with the current rows repeated `scale` times (each copy
+// gets distinct block names, so indexes grow like a bigger country would)
+static bool load_scaled_dataset(const GroundwaterData* rows, uint32_t row_count, int scale,
+                                const char* path) {
+    SnapshotBuilder* builder = snapshot_builder_create();
+    if (!builder) return false;
+
+    bool ok = true;
+    for (int copy = 0; copy < scale && ok; copy++) {
+        for (uint32_t i = 0; i < row_count && ok; i++) {
+            GroundwaterData row = rows[i];
+            if (copy > 0) {
+                char block[sizeof(row.block)];
+                snprintf(block, sizeof(block), "%.36s %d", rows[i].block, copy);
+                memcpy(row.block, block, sizeof(row.block));
+            }
+            ok = snapshot_builder_add(builder, &row);
+        }
+    }
+
+    size_t size = 0;
+    uint8_t* image = ok ? snapshot_builder_finish(builder, &size) : NULL;
+    snapshot_builder_free(builder);
+    if (!image) return false;
+
+    ok = snapshot_write_file(image, size, path);
+    free(image);
+    return ok && db_reload_snapshot(path);
+}
+
+static GroundwaterData* copy_base_rows(uint32_t* count) {
+    const Snapshot* snapshot = db_snapshot_acquire();
+    GroundwaterData* rows = snapshot ? malloc(sizeof(GroundwaterData) * (snapshot->row_count + 1)) : NULL;
+    *count = 0;
+    if (rows) {
+        for (uint32_t i = 0; i < snapshot->row_count; i++) snapshot_get_row(snapshot, i, &rows[i]);
+        *count = snapshot->row_count;
+    }
+    db_snapshot_release();
+    return rows;
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+// Start-up and reload banners go to stderr so stdout carries only the table
+static int hide_stdout(void) {
+    fflush(stdout);
+    int saved = dup(STDOUT_FILENO);
+    dup2(STDERR_FILENO, STDOUT_FILENO);
+    return saved;
+}
+
+static void restore_stdout(int saved) {
+    fflush(stdout);
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+}
+
+static bool parse_scales(const char* list) {
+    config.scale_count = 0;
+    for (const char* p = list; *p && config.scale_count < MICROBENCH_MAX_SCALES;) {
+        int scale = atoi(p);
+        if (scale <= 0) return false;
+        config.scales[config.scale_count++] = scale;
+        p = strchr(p, ',');
+        if (!p) break;
+        p++;
+    }
+    return config.scale_count > 0;
+}
+
+static bool parse_args(int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[++i] : NULL;
+        if (!value) return false;
+
+        if (strcmp(arg, "--filter") == 0) config.filter = value;
+        else if (strcmp(arg, "--reps") == 0) config.reps = atoi(value);
+        else if (strcmp(arg, "--batch-us") == 0) config.batch_us = atof(value);
+        else if (strcmp(arg, "--scales") == 0) { if (!parse_scales(value)) return false; }
+        else if (strcmp(arg, "--save") == 0) config.save_path = value;
+        else if (strcmp(arg, "--baseline") == 0) config.baseline_path = value;
+        else if (strcmp(arg, "--threshold") == 0) config.threshold_pct = atof(value);
+        else return false;
+    }
+    return config.reps >= 3 && config.reps <= MICROBENCH_MAX_REPS && config.batch_us > 0.0;
+}
+
+static bool load_baseline(const char* path) {
+    FILE* file = fopen(path, "r");
+    if (!file) return false;
+
+    char line[1024];
+    while (baseline_count < MICROBENCH_MAX_BASELINE && fgets(line, sizeof(line), file)) {
+        BaselineEntry* entry = &baseline[baseline_count];
+        const char* name = strstr(line, "\"name\":\"");
+        const char* median = strstr(line, "\"median_ticks\":");
+        if (!name || !median) continue;
+        name += 8;
+        const char* end = strchr(name, '"');
+        if (!end || (size_t)(end - name) >= sizeof(entry->name)) continue;
+        memcpy(entry->name, name, (size_t)(end - name));
+        entry->name[end - name] = '\0';
+        entry->median = atof(median + 15);
+        baseline_count++;
+    }
+    fclose(file);
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    if (!parse_args(argc, argv)) {
+        fprintf(stderr,
+                "Usage: %s [--filter SUBSTR] [--reps N] [--batch-us N] [--scales 1,10,100,1000]\n"
+                "          [--save FILE] [--baseline FILE [--threshold PCT]]\n", argv[0]);
+        return 2;
+    }
+    if (config.baseline_path && !load_baseline(config.baseline_path)) {
+        fprintf(stderr, "❌ Cannot read baseline %s\n", config.baseline_path);
+        return 2;
+    }
+    if (config.save_path && !(save_file = fopen(config.save_path, "w"))) {
+        fprintf(stderr, "❌ Cannot write %s\n", config.save_path);
+        return 2;
+    }
+
+    LoggerConfig log_config;
+    logger_default_config(&log_config);
+    log_config.console = false;
+    logger_init(&log_config);
+
+    int saved_stdout = hide_stdout();
+    bool ready = chatbot_init();
+
+    calibrate_counter();
+    char dataset_path[] = "/tmp/ingres_microbench_XXXXXX";
+    int dataset_fd = mkstemp(dataset_path);
+    if (dataset_fd >= 0) close(dataset_fd);
+    uint32_t base_count = 0;
+    GroundwaterData* base_rows = ready ? copy_base_rows(&base_count) : NULL;
+    query_cache_shutdown();
+    restore_stdout(saved_stdout);
+    if (!ready || !base_rows) {
+        fprintf(stderr, "❌ Chatbot initialization failed\n");
+        return 1;
+    }
+
+    printf("⏱️  Counter: %s (%.3f ticks/ns), %d reps x ~%.0f us batches\n\n",
+           CYCLE_COUNTER, ticks_per_ns, config.reps, config.batch_us);
+    printf("%-52s %12s %10s %9s %9s %s\n", "case", "ticks/op", "ns/op", "stddev", "kept",
+           config.baseline_path ? "vs baseline" : "");
+
+    char name[128];
+    for (size_t i = 0; i < COUNT_OF(similarity_pairs); i++) {
+        snprintf(name, sizeof(name), "levenshtein_distance/%s", similarity_pairs[i].label);
+        run_case(name, bench_levenshtein, &similarity_pairs[i]);
+    }
+    for (size_t i = 0; i < COUNT_OF(similarity_pairs); i++) {
+        snprintf(name, sizeof(name), "calculate_advanced_similarity/%s", similarity_pairs[i].label);
+        run_case(name, bench_advanced_similarity, &similarity_pairs[i]);
+    }
+    for (size_t i = 0; i < COUNT_OF(query_inputs); i++) {
+        snprintf(name, sizeof(name), "classify_intent_advanced/%s", query_inputs[i].label);
+        run_case(name, bench_classify, &query_inputs[i]);
+    }
+    for (size_t i = 0; i < COUNT_OF(query_inputs); i++) {
+        snprintf(name, sizeof(name), "extract_locations/%s", query_inputs[i].label);
+        run_case(name, bench_extract_locations, &query_inputs[i]);
+    }
+
+    for (int s = 0; s < config.scale_count; s++) {
+        int scale = config.scales[s];
+
+        // Store kernels over the dataset repeated `scale` times
+        char state_case[128];
+        char district_case[128];
+        snprintf(state_case, sizeof(state_case), "create_enhanced_result/state/x%d", scale);
+        snprintf(district_case, sizeof(district_case), "create_enhanced_result/district/x%d", scale);
+        if (selected(state_case) || selected(district_case)) {
+            saved_stdout = hide_stdout();
+            bool loaded = load_scaled_dataset(base_rows, base_count, scale, dataset_path);
+            restore_stdout(saved_stdout);
+
+            if (loaded) {
+                run_case(state_case, bench_state_scan, NULL);
+                run_case(district_case, bench_district_scan, NULL);
+            } else {
+                fprintf(stderr, "⚠️  Could not build the x%d dataset\n", scale);
+            }
+        }
+
+        // Hash lookups over a table of 64 x scale keys
+        snprintf(name, sizeof(name), "hash_get/x%d", scale);
+        if (!selected(name)) continue;
+        int key_count = 64 * scale;
+        HashInput input = { hash_create(), malloc(sizeof(char*) * (size_t)key_count), key_count };
+        if (input.table && input.keys) {
+            for (int k = 0; k < key_count; k++) {
+                char key[32];
+                snprintf(key, sizeof(key), "district-%d", k);
+                input.keys[k] = strdup(key);
+                hash_set(input.table, input.keys[k], input.keys[k]);
+            }
+            run_case(name, bench_hash_get, &input);
+            for (int k = 0; k < key_count; k++) free(input.keys[k]);
+        }
+        free(input.keys);
+        hash_free(input.table);
+    }
+
+    unlink(dataset_path);
+    free(base_rows);
+    saved_stdout = hide_stdout();
+    chatbot_cleanup();
+    restore_stdout(saved_stdout);
+    if (save_file) fclose(save_file);
+    if (config.baseline_path) {
+        printf("\n%s %d case(s) slower than baseline by more than %.1f%%\n",
+               regressions ? "⚠️ " : "✅", regressions, config.threshold_pct);
+    }
+    return regressions ? 1 : 0;
+}
@@ -0,0 +1,83 @@
+#ifndef ADMISSION_H
+#define ADMISSION_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Bounded admission control in front of the chat pipeline. A fixed set of
+// worker threads (at most MAX_CONCURRENT_REQUESTS by default) runs admitted
+// jobs; everything else waits in a bounded queue, highest priority first and
+// FIFO within a priority. A job that cannot be queued, or that waits longer
+// than max_wait_ms, is shed: its shed callback runs instead so the caller can
+// answer 503 straight away rather than slowing every request down.
+//
+// Configuration comes from the environment unless admission_init is given one:
+//   INGRES_MAX_CONCURRENT   worker threads                  (default MAX_CONCURRENT_REQUESTS)
+//   INGRES_MAX_QUEUED       waiting jobs, all priorities     (default 256)
+//   INGRES_QUEUE_WAIT_MS    longest wait before shedding     (default 200)
+
+#define ADMISSION_DEFAULT_MAX_QUEUED 256
+#define ADMISSION_DEFAULT_WAIT_MS 200
+#define ADMISSION_MAX_RETRY_AFTER 30        // Seconds
+
+typedef enum {
+    ADMISSION_PRIORITY_HIGH,        // Interactive turns the client marked urgent
+    ADMISSION_PRIORITY_NORMAL,
+    ADMISSION_PRIORITY_LOW,         // Bulk and background work
+    ADMISSION_PRIORITY_COUNT
+} AdmissionPriority;
+
+typedef enum {
+    ADMISSION_SHED_QUEUE_FULL,
+    ADMISSION_SHED_TIMEOUT,
+    ADMISSION_SHED_SHUTDOWN,
+    ADMISSION_SHED_REASON_COUNT
+} AdmissionShedReason;
+
+// Both callbacks run on a worker thread or on the caller of admission_submit /
+// admission_expire / admission_shutdown; exactly one of them runs per job
+typedef void (*AdmissionRun)(void* job);
+typedef void (*AdmissionShed)(void* job, AdmissionShedReason reason);
+
+typedef struct {
+    int max_concurrent;
+    int max_queued;
+    uint32_t max_wait_ms;
+} AdmissionConfig;
+
+typedef struct {
+    int workers;
+    int in_flight;
+    int queued;
+    int queued_by_priority[ADMISSION_PRIORITY_COUNT];
+    uint64_t admitted_total;
+    uint64_t shed_total[ADMISSION_SHED_REASON_COUNT];
+    uint64_t avg_service_ns;        // Moving average of run time
+} AdmissionStats;
+
+// Settings from the environment (see above)
+void admission_default_config(AdmissionConfig* config);
+
+// Start the workers. NULL uses admission_default_config. Returns false when
+// already running or the workers cannot be started.
+bool admission_init(const AdmissionConfig* config);
+
+// Shed everything still queued, wait for in-flight jobs and stop the workers
+void admission_shutdown(void);
+
+// Queue a job. When the queue is full (or admission is not running) the shed
+// callback runs before this returns and false is returned.
+bool admission_submit(AdmissionPriority priority, AdmissionRun run, AdmissionShed shed, void* job);
+
+// Shed queued jobs that have waited longer than max_wait_ms; call this
+// periodically (the event loop does). Returns the number shed.
+int admission_expire(void);
+
+// Seconds a shed client should wait, from queue depth and recent service time
+uint32_t admission_retry_after(void);
+
+void admission_stats(AdmissionStats* stats);
+
+const char* admission_shed_reason_name(AdmissionShedReason reason);
+
+#endif // ADMISSION_H
@@ -0,0 +1,66 @@
+#ifndef API_H
+#define API_H
+
+#include "chatbot.h"
+
+// HTTP API on mongoose. Probes (/api/health, /api/status, /api/capabilities,
+// /api/metrics) are answered on the event loop; chat requests go through
+// admission control (admission.h) to the worker pool and are answered when
+// their worker finishes, or with 503 + Retry-After when they are shed.
+// Bodies of COMPRESS_MIN_BYTES and up go out gzip- or deflate-encoded when
+// Accept-Encoding allows (compress.h).
+//
+// /api/chat/stream answers as server-sent events over chunked encoding:
+// "intent" once the query is classified, one "section" per paragraph of the
+// message, then "done" with the remaining response fields (or "error").
+//
+// /ws/chat carries many chat turns over one WebSocket. Each connection has
+// its own conversation context; its turns run in order, one at a time, and
+// each is answered with the /api/chat JSON in a frame of the same type.
+//
+// /api/chat/batch takes a JSON array of messages and answers each one with
+// the /api/chat JSON, in request order: as one array, or as NDJSON lines
+// streamed while they finish. Items run on the worker pool in parallel at
+// low priority, and repeated queries in a batch run once.
+//
+// Every other path is a web UI file from the static cache (static_cache.h),
+// loaded from the roots below when the server starts.
+//
+// INGRES_EVENT_LOOPS > 1 (0 for one per core) runs that many event loops,
+// each on its own thread with its own mongoose manager and SO_REUSEPORT
+// listener on the port; the kernel spreads connections across them, and a
+// connection stays on the loop that accepted it. Loops share only read-only
+// state (dataset, static cache, prebuilt payloads) and the worker pool.
+//
+// stop_api_server drains: listeners close, idle connections are closed
+// (WebSockets with 1001 Going Away), and every request already received,
+// streams, batches and WebSocket turns included, is answered before its
+// connection closes. Whatever is still open after INGRES_DRAIN_TIMEOUT_MS is
+// cut off; then the workers stop and start_api_server returns.
+
+#define API_DEFAULT_PORT "8080"
+#define API_POLL_INTERVAL_MS 50     // Also how often queued requests are checked for expiry
+#define API_STREAM_HIGH_WATER (64 * 1024)   // Unsent bytes past which stream events wait
+#define API_STREAM_STALL_MS 10000           // A stream reader this slow is disconnected
+#define API_WS_MAX_PENDING 8                // WebSocket turns queued behind the running one
+#define API_BATCH_MAX_ITEMS 1000            // Messages in one /api/chat/batch request
+#define API_BATCH_PARALLEL 8                // Items of one batch in flight, capped at the core count
+#define API_WEB_BUILD_ROOT "./web/build"    // React build output, preferred
+#define API_WEB_PUBLIC_ROOT "./web/public"
+#define API_DRAIN_TIMEOUT_MS 20000          // In-flight work gets this long after a stop
+#define API_DEFAULT_EVENT_LOOPS 1
+#define API_MAX_EVENT_LOOPS 64
+
+// Serve on 0.0.0.0:port until stopped; returns 1 if it cannot listen
+int start_api_server(const char* port);
+
+// Begin draining; start_api_server returns 0 once done. Async-signal-safe.
+void stop_api_server(void);
+
+// Response as a JSON object; caller frees
+char* bot_response_to_json(BotResponse* response);
+
+// Legacy entry point: plain-text answer for message; caller frees *response
+void handle_chat_request(const char* message, char** response);
+
+#endif // API_H
@@ -0,0 +1,41 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Per-request bump allocator. Scratch a request needs only while it is being
+// processed (lowercased input, token copies, context snapshots) is carved
+// from one arena and given back by a single reset at the end. Each thread
+// keeps a few arenas cached, so in steady state request scratch costs no
+// malloc/free and threads never meet in the allocator for it.
+
+#define ARENA_BLOCK_SIZE (16 * 1024)
+#define ARENA_MAX_RETAINED (256 * 1024)     // Larger arenas shrink back on reset
+#define ARENA_THREAD_CACHE 4
+
+typedef struct ArenaBlock ArenaBlock;
+
+typedef struct {
+    ArenaBlock* head;           // Block being carved; older blocks follow
+    size_t used;                // Bytes used in head
+} Arena;
+
+void arena_init(Arena* arena);
+void arena_destroy(Arena* arena);
+
+// Drop everything at once. If the request overflowed into several blocks,
+// they are replaced by one block big enough for next time.
+void arena_reset(Arena* arena);
+
+// Max-aligned; NULL only when a new block cannot be allocated
+void* arena_alloc(Arena* arena, size_t size);
+char* arena_strdup(Arena* arena, const char* str);
+char* arena_strndup(Arena* arena, const char* str, size_t length);
+char* arena_lower(Arena* arena, const char* str);   // Lowercased copy
+
+// Per-thread cache. Nested acquires get distinct arenas; release resets.
+Arena* arena_acquire(void);
+void arena_release(Arena* arena);
+
+#endif // ARENA_H
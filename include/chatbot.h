@@ -5,6 +5,7 @@
 #include <stdatomic.h>
 #include "utils.h"
 #include "database.h"
+#include "arena.h"
 
 // Thread safety for concurrent requests
 typedef struct {
@@ -46,19 +47,6 @@ typedef struct {
     bool enable_cors;
 } WebEndpoint;
 
-typedef struct {
-    char key[128];
-    BotResponse value;
-    time_t timestamp;
-    int access_count;
-} CacheEntry;
-
-typedef struct {
-    CacheEntry entries[CACHE_SIZE];
-    int size;
-    ThreadSafeCounter counter;
-} ResponseCache;
-
 /**
  * @brief Defines the type of user intent identified by the chatbot.
  *
@@ -184,7 +172,9 @@ typedef enum {
     INTENT_FOLLOW_UP_QUESTION,      // "tell me more about that"
     INTENT_CLARIFICATION_REQUEST,   // "what do you mean by that"
     INTENT_PREVIOUS_CONTEXT,        // "go back to previous topic"
-    INTENT_CONVERSATION_SUMMARY     // "summarize our conversation"
+    INTENT_CONVERSATION_SUMMARY,    // "summarize our conversation"
+
+    INTENT_COUNT                    // Number of intents; sizes intent-indexed tables
 } IntentType;
 
 /**
@@ -222,8 +212,38 @@ typedef struct {
     int source_count;           // Number of data sources
     bool is_multilingual;       // Whether response supports multiple languages
     char* language_code;        // Language of the response (en, hi, etc.)
+    unsigned owned;             // ResponseOwnership bits; other fields are borrowed
+    atomic_int ref_count;       // 0 = prebuilt and shared, never freed
 } BotResponse;
 
+/**
+ * @brief Which BotResponse fields a response frees.
+ *
+ * A field without its bit is borrowed from storage that outlives every
+ * response (string literals, compiled templates), so it may be shared freely.
+ */
+typedef enum {
+    RESPONSE_OWNS_MESSAGE       = 1 << 0,
+    RESPONSE_OWNS_QUERY_RESULT  = 1 << 1,
+    RESPONSE_OWNS_SUGGESTIONS   = 1 << 2,
+    RESPONSE_OWNS_CLARIFICATION = 1 << 3,
+    RESPONSE_OWNS_SOURCES       = 1 << 4,
+    RESPONSE_OWNS_LANGUAGE      = 1 << 5
+} ResponseOwnership;
+
+typedef struct {
+    char key[128];
+    BotResponse* value;         // Counted reference; hits hand out another
+    time_t timestamp;
+    int access_count;
+} CacheEntry;
+
+typedef struct {
+    CacheEntry entries[CACHE_SIZE];
+    int size;
+    ThreadSafeCounter counter;
+} ResponseCache;
+
 /**
  * @brief Initializes the chatbot.
  *
@@ -265,6 +285,47 @@ BotResponse* process_user_query(const char* user_input);
  */
 void free_bot_response(BotResponse* response);
 
+/**
+ * @brief Releases a response reference (same as free_bot_response).
+ *
+ * Owned fields are freed with the last reference; prebuilt shared responses
+ * are never freed.
+ */
+void free_enhanced_bot_response(BotResponse* response);
+
+/**
+ * @brief Allocates an empty response with one reference and no fields set.
+ *
+ * Freed responses are kept in a per-thread pool (pool.h) and handed out
+ * again fully cleared, so steady-state requests do not allocate one.
+ */
+BotResponse* bot_response_new(IntentType intent);
+
+/**
+ * @brief Adds a reference; responses shared this way must not be modified.
+ */
+BotResponse* bot_response_retain(BotResponse* response);
+
+/**
+ * @brief True for prebuilt responses shared by every request.
+ */
+bool bot_response_is_static(const BotResponse* response);
+
+/**
+ * @brief Private copy of a prebuilt response for per-request changes.
+ *
+ * Every string is borrowed from the prebuilt response, so only the struct
+ * itself is allocated. Returns NULL if response is not prebuilt.
+ */
+BotResponse* bot_response_borrow(const BotResponse* response);
+
+/**
+ * @brief The prebuilt response every request for intent shares.
+ *
+ * NULL for intents whose text is rendered per request.
+ */
+const BotResponse* bot_response_prebuilt(IntentType intent);
+
 /**
  * @brief Advanced intent classification with context awareness
  *
@@ -275,6 +336,12 @@ void free_bot_response(BotResponse* response);
  */
 IntentType classify_intent_advanced(const char* user_input, ConversationContext* context, float* confidence);
 
+/**
+ * @brief classify_intent_advanced with scratch taken from a request arena
+ */
+IntentType classify_intent_arena(Arena* arena, const char* user_input, ConversationContext* context,
+                                 float* confidence);
+
 /**
  * @brief Legacy simple intent classification (for backward compatibility)
  *
@@ -310,13 +377,15 @@ char* generate_response(IntentType intent, const char* location, const char* que
 /**
  * @brief Extract location entities from user input
  *
+ * @param arena Request arena for scratch copies.
  * @param user_input The raw string input from the user.
- * @param state Pointer to store extracted state (allocated by function).
- * @param district Pointer to store extracted district (allocated by function).
- * @param block Pointer to store extracted block (allocated by function).
+ * @param state Pointer to store extracted state (points into the static name tables).
+ * @param district Pointer to store extracted district (points into the static name tables).
+ * @param block Pointer to store extracted block (points into the static name tables).
  * @return Number of locations extracted.
  */
-int extract_locations(const char* user_input, char** state, char** district, char** block);
+int extract_locations(Arena* arena, const char* user_input, const char** state, const char** district,
+                      const char** block);
 
 /**
  * @brief Calculate fuzzy string similarity (Levenshtein distance based)
@@ -327,6 +396,16 @@ int extract_locations(const char* user_input, char** state, char** district, cha
  */
 float calculate_similarity(const char* str1, const char* str2);
 
+/**
+ * @brief Edit distance between two strings (insert/delete/substitute, cost 1)
+ */
+int levenshtein_distance(const char* s1, const char* s2);
+
+/**
+ * @brief Weighted blend of Levenshtein, Jaccard and length similarity (0-1)
+ */
+float calculate_advanced_similarity(const char* str1, const char* str2);
+
 /**
  * @brief Initialize conversation context
  *
@@ -381,6 +460,28 @@ const char* chatbot_get_last_error(ChatbotError* error_code);
  */
 BotResponse* process_user_query_enhanced(const char* user_input, const char* session_id);
 
+/**
+ * @brief Called once the intent is known, before the response is generated.
+ */
+typedef void (*IntentCallback)(void* context, IntentType intent, float confidence);
+
+/**
+ * @brief process_user_query_enhanced that reports the classified intent
+ * through on_intent as soon as it is known, so a caller can start answering
+ * before data lookup and rendering finish. on_intent runs on the calling
+ * thread and is not called for empty input or a session cache hit.
+ */
+BotResponse* process_user_query_streaming(const char* user_input, const char* session_id,
+                                          IntentCallback on_intent, void* context);
+
+/**
+ * @brief process_user_query against a caller-owned conversation context
+ * (from init_conversation_context) instead of the global one, so follow-up
+ * questions resolve within that conversation. The context is read and
+ * updated without locking: do not use it from two threads at once.
+ */
+BotResponse* process_user_query_in_session(const char* user_input, ConversationContext* session);
+
 /**
  * @brief Initialize response cache for performance optimization
  *
@@ -392,7 +493,8 @@ bool init_response_cache(void);
  * @brief Get cached response if available
  *
  * @param cache_key Cache key to lookup
- * @return Cached BotResponse or NULL if not found
+ * @return A new reference to the cached BotResponse (read-only; release it
+ *         with free_enhanced_bot_response) or NULL if not found
  */
 BotResponse* get_cached_response(const char* cache_key);
 
@@ -400,10 +502,11 @@ BotResponse* get_cached_response(const char* cache_key);
  * @brief Store response in cache
  *
  * @param cache_key Cache key
- * @param response Response to cache
+ * @param response Response to cache; the cache takes its own reference, so
+ *        the response must not be modified afterwards
  * @return true if caching successful
  */
-bool cache_response(const char* cache_key, const BotResponse* response);
+bool cache_response(const char* cache_key, BotResponse* response);
 
 /**
  * @brief Clear expired cache entries
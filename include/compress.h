@@ -0,0 +1,69 @@
+#ifndef COMPRESS_H
+#define COMPRESS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "utils.h"
+
+// HTTP response compression on zlib. Bodies are produced as raw deflate and
+// framed as gzip or deflate (zlib) only when sent, so one compressed body
+// serves both encodings. Text that never changes is compressed once into a
+// segment that ends on a byte boundary; a streaming Deflater can splice such
+// segments between dynamically compressed spans without recompressing them.
+// Each thread reuses one deflate state, so steady-state compression does not
+// set up zlib per response.
+
+#define COMPRESS_MIN_BYTES 512          // Smaller bodies go out uncompressed
+#define COMPRESS_LEVEL 6                // Per-response compression
+#define COMPRESS_HEADER_MAX 10
+#define COMPRESS_TRAILER_MAX 8
+
+typedef enum {
+    CONTENT_ENCODING_IDENTITY,
+    CONTENT_ENCODING_GZIP,
+    CONTENT_ENCODING_DEFLATE
+} ContentEncoding;
+
+// Best encoding an Accept-Encoding value allows (gzip over deflate on a tie,
+// q=0 excludes); identity when header is NULL or accepts neither
+ContentEncoding compress_negotiate(const char* header, size_t length);
+const char* content_encoding_name(ContentEncoding encoding);
+
+// Raw deflate of a fixed text at the best compression level, flushed so it
+// can be spliced into any Deflater output
+typedef struct {
+    char* data;
+    size_t length;
+    size_t source_length;               // Bytes of text it decompresses to
+} DeflateSegment;
+
+bool deflate_segment_init(DeflateSegment* segment, const char* text, size_t length);
+void deflate_segment_free(DeflateSegment* segment);
+
+// Streaming raw deflate onto a StrBuf using this thread's deflate state.
+// After a failed call the rest are no-ops and deflater_finish returns false.
+typedef struct {
+    void* stream;
+    StrBuf* out;
+    bool failed;
+} Deflater;
+
+bool deflater_begin(Deflater* deflater, StrBuf* out);
+void deflater_write(Deflater* deflater, const char* data, size_t length);
+void deflater_splice(Deflater* deflater, const DeflateSegment* segment);
+bool deflater_finish(Deflater* deflater);
+
+// Raw deflate of data in one call; false on failure
+bool deflate_buffer(const char* data, size_t length, StrBuf* out);
+
+// Complete gzip member of data at the best compression level, for bodies
+// compressed once and served many times; false on failure
+bool gzip_buffer_best(const char* data, size_t length, StrBuf* out);
+
+// Framing that turns a raw deflate body of source into a gzip or deflate
+// body. Both return the byte count written (0 for identity).
+size_t compress_frame_header(ContentEncoding encoding, unsigned char header[COMPRESS_HEADER_MAX]);
+size_t compress_frame_trailer(ContentEncoding encoding, const char* source, size_t length,
+                              unsigned char trailer[COMPRESS_TRAILER_MAX]);
+
+#endif // COMPRESS_H
@@ -0,0 +1,34 @@
+#ifndef CSV_READER_H
+#define CSV_READER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+// Streaming RFC 4180 CSV reader. Records are parsed in place inside a large
+// read buffer: each field is returned as a NUL-terminated pointer into that
+// buffer (quoted fields are unescaped in place), so no per-field allocation
+// happens. Field pointers stay valid until the next csv_reader_next call.
+
+#define CSV_READER_BUFFER_SIZE (1024 * 1024)
+#define CSV_MAX_FIELDS 64
+
+typedef struct CsvReader CsvReader;
+
+CsvReader* csv_reader_open(const char* path);
+CsvReader* csv_reader_from_file(FILE* file);    // Caller keeps ownership of file
+void csv_reader_close(CsvReader* reader);
+
+// Parse the next record into fields. Returns the number of fields (extra
+// fields beyond max_fields are dropped), 0 at end of input, -1 on error.
+// Blank lines are skipped.
+int csv_reader_next(CsvReader* reader, char** fields, int max_fields);
+
+// 1-based line number where the last returned record started
+long csv_reader_line(const CsvReader* reader);
+
+// Parse one complete record held in buf[0..len) in place. Returns the
+// field count or -1 if the record has an unterminated quote.
+int csv_parse_record(char* buf, size_t len, char** fields, int max_fields);
+
+#endif // CSV_READER_H
@@ -26,6 +26,7 @@ typedef struct {
     int count;                   // Number of records
     char query_type[50];         // Type of query executed
     float execution_time_ms;     // Query execution time
+    int capacity;                // Rows data has room for (pooled results keep their buffer)
 } QueryResult;
 
 // Database initialization and cleanup
@@ -39,16 +40,54 @@ QueryResult* query_by_category(const char* category);
 QueryResult* query_critical_areas(void);
 QueryResult* query_historical_trend(const char* state, const char* district, const char* block);
 
+// Locations whose extractable resource fell the most (relative) between
+// their first assessment since since_year and the latest; one row per
+// location (its latest assessment), steepest decline first
+QueryResult* query_fastest_declining(int since_year, int limit);
+
 // Utility functions
 GroundwaterData* get_location_data(const char* state, const char* district, const char* block);
 GroundwaterData* get_state_data(const char* state, int* count);
 GroundwaterData* get_critical_areas(int* count);
 
-// Memory management
+// Dataset version, bumped whenever the underlying data changes; results
+// cached against an older version are discarded
+unsigned long db_dataset_version(void);
+void db_mark_dataset_changed(void);
+
+// Current in-memory dataset (see snapshot.h). Every acquire must be paired
+// with a release on the same thread; the snapshot stays valid in between
+// even if a reload publishes a new one.
+struct Snapshot;
+const struct Snapshot* db_snapshot_acquire(void);
+void db_snapshot_release(void);
+
+// Multi-year history (see timeseries.h), swapped with the snapshot on
+// reload; same pairing rules as db_snapshot_acquire
+struct TimeSeriesStore;
+const struct TimeSeriesStore* db_history_acquire(void);
+void db_history_release(void);
+
+// Hot reload: load path (NULL = the configured INGRES_SNAPSHOT, or the
+// built-in sample data) and swap it in without blocking readers. Returns
+// false and keeps the current dataset if the new one fails validation.
+bool db_reload_snapshot(const char* path);
+
+// Async-signal-safe request for the background reloader (e.g. on SIGHUP)
+void db_request_reload(void);
+
+// Memory management. Results are pooled per thread with their row buffers:
+// query_result_new returns one reset to count 0, zero timing and the given
+// query_type, with room for capacity rows; free_query_result returns it.
+#define QUERY_RESULT_POOL_MAX_ROWS 512      // Larger row buffers are not kept
+QueryResult* query_result_new(int capacity, const char* query_type);
+bool query_result_reserve(QueryResult* result, int capacity);
 void free_query_result(QueryResult* result);
 
 // Sample data access
 extern GroundwaterData sample_data[];
 extern int sample_data_count;
+extern GroundwaterData sample_history[];
+extern int sample_history_count;
 
 #endif // DATABASE_H
\ No newline at end of file
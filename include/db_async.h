@@ -0,0 +1,52 @@
+#ifndef DB_ASYNC_H
+#define DB_ASYNC_H
+
+#include <stdbool.h>
+#include "database.h"
+
+// Batches of independent queries issued together. With the PostgreSQL pool
+// the whole batch goes out on one connection in libpq pipeline mode (a single
+// round trip); without it the batch is answered from the in-memory store at
+// submit time, so callers use the same API in every build.
+
+#define DB_BATCH_MAX_QUERIES 16
+#define DB_BATCH_DEFAULT_TIMEOUT_MS 5000
+
+typedef enum {
+    DB_BATCH_PENDING,   // Results still in flight
+    DB_BATCH_DONE,      // Every query has a result (possibly empty)
+    DB_BATCH_FAILED     // Batch could not be submitted
+} DbBatchStatus;
+
+typedef struct DbBatch DbBatch;
+
+DbBatch* db_batch_create(void);
+void db_batch_free(DbBatch* batch);
+
+// Queue a query; returns its index in the batch or -1 when the batch is full
+// or already submitted. Parameters are copied.
+int db_batch_add_location(DbBatch* batch, const char* state, const char* district, const char* block);
+int db_batch_add_state(DbBatch* batch, const char* state);
+int db_batch_add_category(DbBatch* batch, const char* category);
+int db_batch_count(const DbBatch* batch);
+
+// Send every queued query without waiting for results
+bool db_batch_submit(DbBatch* batch);
+
+// Non-blocking use: the socket to watch for readability (or writability
+// while db_batch_wants_write is true), and a step that consumes whatever
+// input is available. Socket is -1 when the batch needs no I/O. The API
+// server does not register batches with its event loop; response rendering
+// runs on admission workers and uses db_batch_wait.
+int db_batch_socket(const DbBatch* batch);
+bool db_batch_wants_write(const DbBatch* batch);
+DbBatchStatus db_batch_poll(DbBatch* batch);
+
+// Blocking wait for synchronous callers (worker threads); timeout_ms <= 0
+// waits up to DB_BATCH_DEFAULT_TIMEOUT_MS.
+DbBatchStatus db_batch_wait(DbBatch* batch, int timeout_ms);
+
+// Transfer ownership of one result to the caller (NULL if unavailable)
+QueryResult* db_batch_take_result(DbBatch* batch, int index);
+
+#endif // DB_ASYNC_H
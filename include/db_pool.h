@@ -0,0 +1,68 @@
+#ifndef DB_POOL_H
+#define DB_POOL_H
+
+#include <stdbool.h>
+#include "database.h"
+
+// The pool only exists in builds linked against libpq. Sample-data builds
+// never see these declarations.
+#ifdef USE_POSTGRESQL
+#include <libpq-fe.h>
+
+// Pool sizing and health-check tuning (overridable through the environment,
+// see db_pool_init)
+#define DB_POOL_DEFAULT_SIZE 8
+#define DB_POOL_MAX_SIZE 64
+#define DB_POOL_ACQUIRE_TIMEOUT_MS 2000
+#define DB_POOL_IDLE_PING_SECONDS 30     // Ping connections idle longer than this
+#define DB_POOL_BACKOFF_INITIAL_MS 100   // First reconnect delay
+#define DB_POOL_BACKOFF_MAX_MS 30000     // Reconnect delay ceiling
+
+// Statements prepared once on every pooled connection
+typedef enum {
+    DB_STMT_BY_LOCATION,
+    DB_STMT_BY_STATE,
+    DB_STMT_BY_CATEGORY,
+    DB_STMT_COUNT
+} DbStatement;
+
+typedef struct PooledConnection PooledConnection;
+
+// Pool statistics for health reporting
+typedef struct {
+    int size;                    // Configured number of connections
+    int healthy;                 // Connections currently usable
+    int in_use;                  // Connections checked out
+    long acquire_timeouts;       // Acquires that gave up waiting
+    long reconnects;             // Successful reconnects after a failure
+} DbPoolStats;
+
+// Pool lifecycle. conninfo may be NULL to use INGRES_DB_CONNINFO /
+// DATABASE_URL or the compiled-in defaults; size <= 0 uses
+// INGRES_DB_POOL_SIZE or DB_POOL_DEFAULT_SIZE.
+bool db_pool_init(const char* conninfo, int size);
+void db_pool_shutdown(void);
+bool db_pool_is_ready(void);
+void db_pool_get_stats(DbPoolStats* stats);
+
+// Check a connection out of the pool, waiting up to timeout_ms. The returned
+// connection is healthy and has every DbStatement prepared. Pass healthy=false
+// on release if the caller saw a connection-level error so it gets reset.
+PooledConnection* db_pool_acquire(int timeout_ms);
+void db_pool_release(PooledConnection* pc, bool healthy);
+PGconn* db_pool_conn(PooledConnection* pc);
+const char* db_pool_statement_name(DbStatement stmt);
+
+// Run a prepared statement on a pooled connection and decode the binary
+// result straight into a QueryResult. Returns NULL on failure so callers can
+// fall back to the in-memory store.
+QueryResult* db_pool_query(DbStatement stmt, const char* const* params, int nparams,
+                           const char* query_type);
+
+// Decode a binary-format result with the standard assessment column layout.
+// out's row buffer is grown as needed (see query_result_reserve).
+bool db_pool_decode_result(const PGresult* res, QueryResult* out);
+
+#endif // USE_POSTGRESQL
+
+#endif // DB_POOL_H
@@ -0,0 +1,29 @@
+#ifndef EPOCH_H
+#define EPOCH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Epoch-based reclamation for read-mostly shared objects (RCU style).
+// Readers bracket every access with epoch_enter/epoch_exit: no locks, no
+// shared writes beyond their own slot. A writer publishes a replacement with
+// an atomic store and hands the old object to epoch_retire; it is destroyed
+// by epoch_reclaim once every reader that could have seen it has exited.
+
+#define EPOCH_MAX_READERS 256   // Threads with a dedicated slot; extra threads share a counter
+
+// Reader side. Nesting is allowed; only the outermost pair publishes.
+void epoch_enter(void);
+void epoch_exit(void);
+
+// Writer side. Call after the replacement has been published.
+bool epoch_retire(void* object, void (*destroy)(void*));
+
+// Destroy retired objects no reader can still hold; returns how many remain
+int epoch_reclaim(void);
+
+// Wait (polling) until every retired object is destroyed, up to timeout_ms.
+// Returns true when nothing is left.
+bool epoch_drain(int timeout_ms);
+
+#endif // EPOCH_H
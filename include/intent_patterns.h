@@ -28,7 +28,8 @@ extern int template_count;
 
 // Pattern matching functions
 IntentType match_patterns(const char* user_input);
-char* get_response_template(IntentType intent);
+// Shared immutable text (never free it); length (optional) excludes the terminator
+const char* get_response_template(IntentType intent, size_t* length);
 void init_patterns(void);
 
 #endif // INTENT_PATTERNS_H
\ No newline at end of file
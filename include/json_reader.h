@@ -0,0 +1,67 @@
+#ifndef JSON_READER_H
+#define JSON_READER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Pull parser over a JSON text, the reading counterpart of json_writer.h.
+// Callers walk the document in order and skip what they do not need;
+// nothing is built up front. Strings come back unescaped as UTF-8.
+//
+//   JsonReader json;
+//   json_reader_init(&json, body, length);
+//   json_enter_array(&json);
+//   while (json_next_element(&json)) {
+//       char* text = json_read_string(&json);   // or json_skip(&json)
+//       ...
+//   }
+//   if (!json_reader_done(&json)) ...           // malformed or trailing data
+//
+// After any error the reader stays failed and every call returns false/NULL.
+
+#define JSON_READER_MAX_DEPTH 16
+
+typedef enum {
+    JSON_VALUE_INVALID,         // End of input, or not the start of a value
+    JSON_VALUE_STRING,
+    JSON_VALUE_NUMBER,
+    JSON_VALUE_OBJECT,
+    JSON_VALUE_ARRAY,
+    JSON_VALUE_BOOL,
+    JSON_VALUE_NULL
+} JsonValueType;
+
+typedef struct {
+    const char* at;
+    const char* end;
+    int depth;
+    char closers[JSON_READER_MAX_DEPTH];    // Per level: ']' or '}'
+    bool has_items[JSON_READER_MAX_DEPTH];  // Per level: a comma comes before the next item
+    bool failed;
+} JsonReader;
+
+void json_reader_init(JsonReader* json, const char* data, size_t length);
+
+// Type of the next value, without consuming it
+JsonValueType json_peek(JsonReader* json);
+
+// Open the next value as a container; false when it is something else
+bool json_enter_array(JsonReader* json);
+bool json_enter_object(JsonReader* json);
+
+// Step to the next item of the innermost container: true with the reader at
+// its value, false once the container has been closed (or on error). Member
+// names longer than key_size are returned empty.
+bool json_next_element(JsonReader* json);
+bool json_next_member(JsonReader* json, char* key, size_t key_size);
+
+// The next value as a string; caller frees. NULL when it is not a string.
+char* json_read_string(JsonReader* json);
+
+// Pass over the next value, containers included
+bool json_skip(JsonReader* json);
+
+// The whole text was one well-formed value
+bool json_reader_done(JsonReader* json);
+
+#endif // JSON_READER_H
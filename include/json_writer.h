@@ -0,0 +1,57 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "utils.h"
+
+// Streaming JSON writer over a StrBuf. It tracks nesting so callers never
+// place commas themselves, and escapes every string, so a response is valid
+// JSON whatever its text contains (quotes, newlines, markdown). Non-ASCII
+// UTF-8 passes through unchanged.
+//
+//   JsonWriter json;
+//   json_writer_init(&json, &buf);
+//   json_begin_object(&json);
+//   json_key(&json, "message");
+//   json_string(&json, text);
+//   json_end_object(&json);
+//   if (!json_writer_ok(&json)) ...   // out of memory or unbalanced
+
+#define JSON_WRITER_MAX_DEPTH 16
+
+typedef struct {
+    StrBuf* out;
+    int depth;
+    bool has_items[JSON_WRITER_MAX_DEPTH];  // Per level: a comma goes before the next value
+    bool after_key;
+    bool failed;
+} JsonWriter;
+
+void json_writer_init(JsonWriter* json, StrBuf* out);
+
+void json_begin_object(JsonWriter* json);
+void json_end_object(JsonWriter* json);
+void json_begin_array(JsonWriter* json);
+void json_end_array(JsonWriter* json);
+
+// Object member name; the next value call supplies its value
+void json_key(JsonWriter* json, const char* key);
+
+void json_string(JsonWriter* json, const char* value);      // NULL writes null
+void json_string_n(JsonWriter* json, const char* value, size_t length);
+void json_int(JsonWriter* json, long value);
+void json_double(JsonWriter* json, double value, int decimals);
+void json_bool(JsonWriter* json, bool value);
+void json_null(JsonWriter* json);
+
+// Append pre-serialized JSON as one value (e.g. a cached object)
+void json_raw(JsonWriter* json, const char* value, size_t length);
+
+// Every write succeeded and all containers are closed
+bool json_writer_ok(const JsonWriter* json);
+
+// Escape value as the body of a JSON string (no quotes) onto out
+bool json_escape_append(StrBuf* out, const char* value, size_t length);
+
+#endif // JSON_WRITER_H
@@ -0,0 +1,78 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+// Asynchronous logger. log_message formats into a slot of a lock-free ring
+// (any number of producer threads, no locks, no I/O) and returns; a single
+// flusher thread drains the ring and writes whole batches with writev.
+// Levels below the runtime threshold return before any formatting. When the
+// ring is full the line is dropped and counted rather than blocking the
+// caller.
+//
+// Configuration comes from the environment unless logger_init is given one:
+//   INGRES_LOG_LEVEL    debug | info | warn | error     (default info)
+//   INGRES_LOG_FORMAT   text | json                     (default text)
+//   INGRES_LOG_FILE     path, empty to disable           (default ingres_chatbot.log)
+//   INGRES_LOG_CONSOLE  0 to stop echoing to stdout      (default 1)
+
+#define LOG_RING_SIZE 1024          // Slots; power of two
+#define LOG_MESSAGE_MAX 512         // Longer messages are truncated
+#define LOG_BATCH_MAX 64            // Lines per writev
+#define LOG_IDLE_WAIT_MS 10         // Flusher poll interval when the ring is empty
+
+// Ordered by severity
+typedef enum {
+    LOG_DEBUG,
+    LOG_INFO,
+    LOG_WARNING,
+    LOG_ERROR
+} LogLevel;
+
+typedef enum {
+    LOG_FORMAT_TEXT,                // [2025-01-31 12:00:00] [INFO] message
+    LOG_FORMAT_JSON                 // {"ts":"2025-01-31T06:30:00.123Z","level":"info","thread":1,"msg":"message"}
+} LogFormat;
+
+typedef struct {
+    const char* path;               // NULL or "" for no log file
+    LogLevel level;
+    LogFormat format;
+    bool console;                   // Echo to stdout
+} LoggerConfig;
+
+// Settings from the environment (see above)
+void logger_default_config(LoggerConfig* config);
+
+// Start the flusher. NULL uses logger_default_config. The first log_message
+// starts it with defaults when this was never called. Returns false when
+// already started or the log file cannot be opened.
+bool logger_init(const LoggerConfig* config);
+
+// Write out everything logged so far and stop the flusher (also run at exit).
+// Later messages are discarded.
+void logger_shutdown(void);
+
+// Block until every line logged before the call has been written
+void logger_flush(void);
+
+void logger_set_level(LogLevel level);
+void logger_set_format(LogFormat format);
+const char* logger_path(void);      // NULL when not writing a file
+unsigned long logger_dropped(void); // Lines lost to a full ring
+
+extern atomic_int logger_min_level;
+
+// Cheap check for callers that build expensive arguments
+static inline bool log_enabled(LogLevel level) {
+    return (int)level >= atomic_load_explicit(&logger_min_level, memory_order_relaxed);
+}
+
+#if defined(__GNUC__)
+__attribute__((format(printf, 2, 3)))
+#endif
+void log_message(LogLevel level, const char* format, ...);
+
+#endif // LOGGER_H
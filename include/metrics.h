@@ -0,0 +1,63 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+// Per-stage latency histograms (HDR style: log-linear buckets, ~3% relative
+// error). Each thread records into its own histograms with plain relaxed
+// stores, so the request path never shares a cache line; readers walk every
+// thread's histograms and merge. Threads that exit fold their counts into a
+// shared total first.
+
+#define METRICS_SUB_BUCKET_BITS 5                           // 32 sub-buckets per power of two
+#define METRICS_MAX_VALUE_BITS 40                           // ~18 minutes in nanoseconds
+#define METRICS_BUCKET_COUNT ((METRICS_MAX_VALUE_BITS - METRICS_SUB_BUCKET_BITS + 1) << METRICS_SUB_BUCKET_BITS)
+
+typedef enum {
+    METRIC_PARSE,           // Request body parsing
+    METRIC_LOCATION,        // Location extraction
+    METRIC_CLASSIFY,        // Intent classification
+    METRIC_DB_QUERY,        // Query execution and aggregation
+    METRIC_RENDER,          // Template rendering
+    METRIC_SERIALIZE,       // Response JSON
+    METRIC_REQUEST,         // Whole pipeline, wall time
+    METRIC_STAGE_COUNT
+} MetricStage;
+
+typedef struct {
+    uint64_t counts[METRICS_BUCKET_COUNT];
+    uint64_t total_count;
+    uint64_t total_ns;
+    uint64_t max_ns;
+} LatencyHistogram;
+
+// CLOCK_MONOTONIC in nanoseconds
+uint64_t metrics_now_ns(void);
+
+void metrics_record(MetricStage stage, uint64_t elapsed_ns);
+
+// Record the time since start_ns; returns now so stages can be chained
+uint64_t metrics_record_since(MetricStage stage, uint64_t start_ns);
+
+// Merged view across all threads (a consistent-enough snapshot, not atomic)
+void metrics_snapshot(MetricStage stage, LatencyHistogram* out);
+
+// Add one value to a private (single-threaded) histogram, e.g. a load
+// generator's client-side latencies; merge with metrics_histogram_add
+void metrics_histogram_record(LatencyHistogram* histogram, uint64_t value_ns);
+void metrics_histogram_add(LatencyHistogram* into, const LatencyHistogram* from);
+
+// Value at quantile q (0..1) as the bucket's highest equivalent value
+uint64_t metrics_value_at_quantile(const LatencyHistogram* histogram, double q);
+
+const char* metrics_stage_name(MetricStage stage);
+
+// Prometheus text exposition (summary per stage); caller frees
+char* metrics_render_prometheus(void);
+
+// Drop every recorded value (tests, or after a warm-up)
+void metrics_reset(void);
+
+#endif // METRICS_H
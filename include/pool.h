@@ -0,0 +1,28 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <stdbool.h>
+
+// Per-thread free lists for objects created on every request (BotResponse,
+// QueryResult). An object goes back on the list of the thread that frees
+// it, so no list is ever shared. Each list keeps at most POOL_MAX_CACHED
+// objects; the rest are destroyed, as are a thread's cached objects when it
+// exits. Pooled objects come back exactly as they were put: the owning
+// module resets them.
+
+#define POOL_MAX_CACHED 32
+
+typedef enum {
+    POOL_BOT_RESPONSE,
+    POOL_QUERY_RESULT,
+    POOL_KIND_COUNT
+} PoolKind;
+
+// NULL when this thread has none cached
+void* pool_get(PoolKind kind);
+
+// Cache object for reuse, or destroy it when the list is full. destroy
+// frees the object and anything it keeps across reuse.
+void pool_put(PoolKind kind, void* object, void (*destroy)(void*));
+
+#endif // POOL_H
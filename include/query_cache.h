@@ -0,0 +1,55 @@
+#ifndef QUERY_CACHE_H
+#define QUERY_CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "database.h"
+
+// Read-through cache for query_by_* results. Entries are keyed by query kind
+// plus case- and whitespace-normalized parameters, bounded by both entry count
+// and bytes (LRU eviction), expire after a TTL, and are dropped when the
+// dataset version they were computed against changes.
+
+#define QUERY_CACHE_DEFAULT_ENTRIES 1024
+#define QUERY_CACHE_DEFAULT_BYTES (4 * 1024 * 1024)
+#define QUERY_CACHE_DEFAULT_TTL_SECONDS 300
+// Normalized keys longer than this are not cached at all
+#define QUERY_CACHE_KEY_MAX 192
+
+typedef enum {
+    QUERY_KIND_LOCATION,
+    QUERY_KIND_STATE,
+    QUERY_KIND_CATEGORY,
+    QUERY_KIND_TREND,
+    QUERY_KIND_COUNT
+} QueryKind;
+
+typedef struct {
+    long hits;
+    long misses;
+    long evictions;              // Dropped to stay within bounds
+    long expirations;            // Dropped for TTL or dataset version
+    size_t entries;
+    size_t bytes;
+} QueryCacheStats;
+
+// Zero arguments use INGRES_QUERY_CACHE_ENTRIES / INGRES_QUERY_CACHE_BYTES /
+// INGRES_QUERY_CACHE_TTL or the defaults above. Calling init again resizes
+// the cache and drops its contents.
+bool query_cache_init(size_t max_entries, size_t max_bytes, int ttl_seconds);
+void query_cache_shutdown(void);
+
+// Returns a private copy of the cached result (free with free_query_result),
+// or NULL on a miss
+QueryResult* query_cache_get(QueryKind kind, const char* a, const char* b, const char* c);
+
+// Stores a copy of result; the caller keeps ownership. dataset_version is
+// db_dataset_version() as read before the query ran; results computed
+// against a since-replaced dataset are not stored.
+void query_cache_put(QueryKind kind, const char* a, const char* b, const char* c,
+                     const QueryResult* result, unsigned long dataset_version);
+
+void query_cache_invalidate_all(void);
+void query_cache_get_stats(QueryCacheStats* stats);
+
+#endif // QUERY_CACHE_H
@@ -0,0 +1,76 @@
+#ifndef RESPONSE_RENDER_H
+#define RESPONSE_RENDER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "database.h"
+#include "utils.h"
+
+// Data-bound response rendering. Templates name their values with {slot}
+// placeholders ("{{" is a literal brace); {other_slot} reads the secondary
+// aggregate, e.g. the other side of a comparison. A template is compiled
+// once into literal segments and typed slots. Rendering resolves every slot
+// first, so the output length is exact before anything is written; a
+// template without slots is its own immutable output.
+
+#define RENDER_MAX_YEARS 16
+#define RENDER_MAX_LIST_ROWS 8      // List slots show the worst rows, then "...and N more"
+#define TEMPLATE_MAX_SLOTS 64
+
+typedef struct {
+    int year;
+    float extractable;
+    float extraction;
+} RenderYear;
+
+// Aggregate over the rows for one location (or category)
+typedef struct {
+    char location[64];
+    const QueryResult* rows;        // Borrowed; used by list slots
+    int block_count;
+    int over_exploited;
+    int critical;
+    int semi_critical;
+    int safe;
+
+    int year;                       // Latest assessment year
+    char category[20];              // Most common category (ties go to the worse)
+    float recharge;
+    float extractable;
+    float extraction;
+
+    RenderYear years[RENDER_MAX_YEARS];  // From history, oldest first
+    int year_count;
+    char first_category[20];
+    float trend_rate;               // Net availability CAGR, percent per year
+} RenderAggregate;
+
+typedef struct {
+    RenderAggregate primary;
+    RenderAggregate secondary;
+} RenderData;
+
+typedef struct TemplateProgram TemplateProgram;
+
+// Returns NULL for unknown slot names, an unterminated placeholder or more
+// than TEMPLATE_MAX_SLOTS slots
+TemplateProgram* template_compile(const char* text);
+void template_free(TemplateProgram* program);
+bool template_has_slots(const TemplateProgram* program);
+
+// Slot-less templates: the program's own text (shared, valid until
+// template_free), else NULL. The static length is the literal byte count.
+const char* template_static_text(const TemplateProgram* program);
+size_t template_static_length(const TemplateProgram* program);
+
+// Appends with a single exact reservation
+bool template_render(const TemplateProgram* program, const RenderData* data, StrBuf* out);
+// Exact-size malloc'd result; length (optional) excludes the terminator
+char* template_render_alloc(const TemplateProgram* program, const RenderData* data, size_t* length);
+
+// Building aggregates from query results
+void render_aggregate_init(RenderAggregate* aggregate, const char* location);
+void render_aggregate_rows(RenderAggregate* aggregate, const QueryResult* rows);
+void render_aggregate_history(RenderAggregate* aggregate, const QueryResult* history);
+
+#endif // RESPONSE_RENDER_H
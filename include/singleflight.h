@@ -0,0 +1,62 @@
+#ifndef SINGLEFLIGHT_H
+#define SINGLEFLIGHT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+// In-flight coalescing of identical chat queries. The first request for a
+// normalized query becomes the leader and computes the answer; requests for
+// the same query that arrive before it finishes join its flight instead of
+// running the pipeline again. When the leader completes, every member of the
+// flight (leader included) is handed the same reference-counted response
+// bytes. Finished flights are forgotten at once; caching stays the response
+// cache's job.
+
+#define SINGLEFLIGHT_STRIPES 64         // Independently locked slices of the table
+#define SINGLEFLIGHT_KEY_MAX 512        // Normalized queries longer than this never coalesce
+
+// An immutable response body and the HTTP status it goes out with
+typedef struct SharedBytes {
+    atomic_int refs;
+    int status;
+    size_t length;
+    struct SharedBytes* deflated;       // The body as raw deflate (compress.h), or NULL; owned
+    char data[];                        // NUL-terminated
+} SharedBytes;
+
+// Copy of data with one reference; NULL on allocation failure
+SharedBytes* shared_bytes_new(int status, const char* data, size_t length);
+SharedBytes* shared_bytes_retain(SharedBytes* bytes);
+void shared_bytes_release(SharedBytes* bytes);
+
+// Called once per member when its flight completes. result is borrowed:
+// retain it to keep it past the call.
+typedef void (*SingleFlightCallback)(void* member, SharedBytes* result);
+
+typedef struct SingleFlight SingleFlight;
+
+// Lowercase, trim and collapse whitespace, drop trailing ?!. - the form two
+// queries must share to coalesce. Returns the length, or 0 when out is too
+// small or nothing is left.
+size_t singleflight_normalize(const char* query, char* out, size_t out_size);
+
+// Join the flight for query, or start one. Returns the new flight when the
+// caller is the leader (it must call singleflight_complete), NULL when it
+// joined an existing flight. on_done runs for member either way.
+SingleFlight* singleflight_begin(const char* query, SingleFlightCallback on_done, void* member);
+
+// Hand result to every member and retire the flight. Takes over the
+// caller's reference to result, which may be NULL.
+void singleflight_complete(SingleFlight* flight, SharedBytes* result);
+
+typedef struct {
+    uint64_t leaders;                   // Flights started (pipeline runs)
+    uint64_t coalesced;                 // Requests that joined a running flight
+    int in_flight;
+} SingleFlightStats;
+
+void singleflight_stats(SingleFlightStats* stats);
+
+#endif // SINGLEFLIGHT_H
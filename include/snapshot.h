@@ -0,0 +1,82 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "database.h"
+
+// Binary dataset snapshot: a versioned, checksummed, column-oriented image of
+// the assessment rows. Strings are dictionary-encoded (rows hold uint32 ids),
+// rows are sorted by state/district/block/year, and the file carries prebuilt
+// state ranges and a category index. Images are produced offline by
+// tools/csv_to_snapshot and mapped read-only at startup, so every worker
+// process shares the same page-cache pages.
+
+#define SNAPSHOT_MAGIC "INGRSNAP"
+#define SNAPSHOT_FORMAT_VERSION 1
+
+// Contiguous rows sharing one key (name_id is a dictionary string id)
+typedef struct {
+    uint32_t name_id;
+    uint32_t first;
+    uint32_t count;
+    uint32_t reserved;
+} SnapshotRange;
+
+// Read-only view over a loaded image; all pointers point into it
+typedef struct Snapshot {
+    uint32_t row_count;
+    uint32_t string_count;
+    uint32_t state_count;
+    uint32_t category_count;
+    uint64_t checksum;
+
+    const uint32_t* state;              // Columns, one entry per row
+    const uint32_t* district;
+    const uint32_t* block;
+    const uint32_t* category;
+    const float* annual_recharge;
+    const float* extractable_resource;
+    const float* annual_extraction;
+    const int32_t* assessment_year;
+
+    const SnapshotRange* states;        // Sorted case-insensitively by name
+    const SnapshotRange* categories;    // first/count index into category_rows
+    const uint32_t* category_rows;
+
+    // Backing storage
+    const uint8_t* image;
+    size_t image_size;
+    const uint32_t* string_offsets;
+    const char* string_blob;
+    bool mapped;
+} Snapshot;
+
+typedef struct SnapshotBuilder SnapshotBuilder;
+
+// Building images (offline converter and sample-data startup)
+SnapshotBuilder* snapshot_builder_create(void);
+bool snapshot_builder_add(SnapshotBuilder* builder, const GroundwaterData* row);
+uint8_t* snapshot_builder_finish(SnapshotBuilder* builder, size_t* size);  // malloc'd image
+void snapshot_builder_free(SnapshotBuilder* builder);
+
+// Write an image next to path and rename it into place, so a reader never
+// maps a half-written file
+bool snapshot_write_file(const uint8_t* image, size_t size, const char* path);
+
+// Loading. snapshot_open maps the file; snapshot_from_image takes ownership
+// of a malloc'd image. Both validate the header, checksum and indexes and
+// return NULL on any mismatch.
+Snapshot* snapshot_open(const char* path);
+Snapshot* snapshot_from_image(uint8_t* image, size_t size);
+Snapshot* snapshot_from_rows(const GroundwaterData* rows, int count);
+void snapshot_close(Snapshot* snapshot);
+
+// Lookups
+const char* snapshot_string(const Snapshot* snapshot, uint32_t id);
+void snapshot_get_row(const Snapshot* snapshot, uint32_t row, GroundwaterData* out);
+const SnapshotRange* snapshot_find_state(const Snapshot* snapshot, const char* state);
+const SnapshotRange* snapshot_find_category(const Snapshot* snapshot, const char* category);
+
+#endif // SNAPSHOT_H
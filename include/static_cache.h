@@ -0,0 +1,62 @@
+#ifndef STATIC_CACHE_H
+#define STATIC_CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// In-memory cache of the web UI's static files. Each root is walked once at
+// startup; every file is held in memory with a strong ETag over its content
+// and, when it pays, a gzip body compressed at the best level. After loading,
+// the cache is read-only, so lookups take no locks and serving an asset costs
+// no filesystem calls. Files that change on disk are picked up on restart,
+// which is when a new UI build is deployed anyway.
+//
+// Build output names carrying a content hash (main.1a2b3c4d.js) never change
+// content under the same name, so those are marked cacheable for a year;
+// everything else is revalidated with If-None-Match on each use.
+
+#define STATIC_CACHE_BUCKETS 256
+#define STATIC_CACHE_MAX_FILE_BYTES (8 * 1024 * 1024)   // Larger files stay on disk
+#define STATIC_CACHE_MAX_BYTES (64 * 1024 * 1024)       // Across all held files
+#define STATIC_CACHE_GZIP_MAX_RATIO 0.9                 // Keep gzip only when it saves 10%
+
+#define STATIC_CACHE_IMMUTABLE "public, max-age=31536000, immutable"
+#define STATIC_CACHE_REVALIDATE "no-cache"
+
+typedef struct StaticAsset {
+    char* path;                 // Request path, e.g. "/static/js/main.1a2b3c4d.js"
+    char* file;                 // File it was read from
+    char* data;                 // NULL when over the size limits: serve file instead
+    size_t length;
+    char* gzip;                 // Complete gzip body, or NULL
+    size_t gzip_length;
+    const char* content_type;
+    const char* cache_control;
+    char etag[24];              // Quoted, e.g. "\"0123456789abcdef\""
+    char gzip_etag[28];         // The gzip body is a different representation
+    struct StaticAsset* next;   // Bucket chain
+} StaticAsset;
+
+typedef struct {
+    size_t assets;
+    size_t bytes;               // Held identity bodies
+    size_t gzip_bytes;          // Held gzip bodies
+    size_t on_disk;             // Assets left on disk for size
+} StaticCacheStats;
+
+// Add every file under root (dotfiles skipped). A path already loaded from
+// an earlier root keeps that file, so roots are given in priority order.
+// False when root cannot be read.
+bool static_cache_load(const char* root);
+
+// Asset for a decoded request path; "/" and "/dir/" map to index.html.
+// NULL when no root has such a file.
+const StaticAsset* static_cache_find(const char* path);
+
+// If-None-Match value names either representation of asset (or is "*")
+bool static_cache_not_modified(const StaticAsset* asset, const char* header, size_t length);
+
+void static_cache_get_stats(StaticCacheStats* stats);
+void static_cache_clear(void);
+
+#endif // STATIC_CACHE_H
@@ -0,0 +1,70 @@
+#ifndef TIMESERIES_H
+#define TIMESERIES_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "database.h"
+
+// Multi-year assessment history keyed by location (state/district/block).
+// Each location's series is stored as one compressed block: years and
+// measures (fixed-point, hundredths of MCM) are delta + zigzag + varint
+// encoded, so a range query decodes a few dozen bytes. Per-location
+// slope/CAGR is computed once at build time, and a dense year-major copy
+// of every measure backs whole-dataset scans such as "fastest declining
+// since 2013".
+
+typedef enum {
+    TS_MEASURE_RECHARGE,            // annual_recharge
+    TS_MEASURE_EXTRACTABLE,         // extractable_resource
+    TS_MEASURE_EXTRACTION,          // annual_extraction
+    TS_MEASURE_COUNT
+} TsMeasure;
+
+typedef struct {
+    int first_year;
+    int last_year;
+    int year_count;
+    float slope[TS_MEASURE_COUNT];  // Least-squares MCM per year
+    float cagr[TS_MEASURE_COUNT];   // Compound annual growth, first to last year
+} TimeSeriesStats;
+
+typedef struct {
+    uint32_t location;
+    int from_year;                  // Earliest assessment at or after since_year
+    int to_year;                    // Latest assessment
+    float from_value;
+    float to_value;
+    float change;                   // Relative change, e.g. -0.18 for -18%
+} TimeSeriesDecline;
+
+typedef struct TimeSeriesStore TimeSeriesStore;
+
+// Build from rows in any order; a later row for the same location and year
+// replaces an earlier one. Returns NULL on allocation failure.
+TimeSeriesStore* timeseries_build(const GroundwaterData* rows, size_t count);
+void timeseries_free(TimeSeriesStore* store);
+
+size_t timeseries_location_count(const TimeSeriesStore* store);
+void timeseries_location_names(const TimeSeriesStore* store, uint32_t location,
+                               const char** state, const char** district, const char** block);
+
+// Locations matching state/district/block (NULL matches anything), in key
+// order. Returns the number found; at most max ids are written.
+size_t timeseries_find(const TimeSeriesStore* store, const char* state, const char* district,
+                       const char* block, uint32_t* out, size_t max);
+
+// Decode one location's assessments with from_year <= year <= to_year
+// (0 = unbounded), oldest first. Returns the number of rows written.
+size_t timeseries_range(const TimeSeriesStore* store, uint32_t location, int from_year, int to_year,
+                        GroundwaterData* out, size_t max);
+
+const TimeSeriesStats* timeseries_stats(const TimeSeriesStore* store, uint32_t location);
+
+// Largest relative decreases of measure between each location's first
+// assessment at or after since_year and its latest one, most negative first.
+// One pass over the year-major columns; returns the number written.
+size_t timeseries_fastest_declining(const TimeSeriesStore* store, TsMeasure measure, int since_year,
+                                    TimeSeriesDecline* out, size_t max);
+
+#endif // TIMESERIES_H
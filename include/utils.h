@@ -76,6 +76,29 @@ string string_array_get(StringArray* arr, int index);
 void string_array_free(StringArray* arr);
 StringArray* string_split(const string str, const char delimiter);
 
+// ============================================================================
+// STRING BUFFERS
+// ============================================================================
+
+// Growable, reusable output buffer: clear keeps the allocation, so a buffer
+// reused across calls stops allocating once it has reached its working size
+typedef struct {
+    char* data;                 // NUL-terminated once anything is appended
+    size_t length;
+    size_t capacity;
+} StrBuf;
+
+void strbuf_init(StrBuf* buf);
+void strbuf_free(StrBuf* buf);
+void strbuf_clear(StrBuf* buf);
+bool strbuf_reserve(StrBuf* buf, size_t extra);
+bool strbuf_append(StrBuf* buf, const char* data, size_t length);
+bool strbuf_append_str(StrBuf* buf, const char* str);
+bool strbuf_append_int(StrBuf* buf, long value);
+bool strbuf_append_fixed(StrBuf* buf, double value, int decimals, bool show_sign);
+bool strbuf_appendf(StrBuf* buf, const char* format, ...);
+string strbuf_copy(const StrBuf* buf);     // Exact-size malloc'd copy
+
 // ============================================================================
 // HASH TABLE
 // ============================================================================
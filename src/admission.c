@@ -0,0 +1,303 @@
+/*
+ * INGRES ChatBot - Admission Control
+ * Fixed worker pool behind a bounded, priority-ordered wait queue.
+ */
+
+#include "admission.h"
+#include "chatbot.h"
+#include "metrics.h"
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#define EXPIRE_BATCH 64
+
+typedef struct {
+    AdmissionRun run;
+    AdmissionShed shed;
+    void* job;
+    uint64_t enqueued_ns;
+} QueuedJob;
+
+// One FIFO ring per priority, each sized for the whole queue bound
+typedef struct {
+    QueuedJob* jobs;
+    int head;
+    int count;
+} JobRing;
+
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t work_ready;
+    bool running;
+    AdmissionConfig config;
+    JobRing rings[ADMISSION_PRIORITY_COUNT];
+    int queued;
+    int in_flight;
+    pthread_t* threads;
+    int thread_count;
+    uint64_t admitted_total;
+    uint64_t shed_total[ADMISSION_SHED_REASON_COUNT];
+    uint64_t avg_service_ns;
+} admission = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .work_ready = PTHREAD_COND_INITIALIZER,
+};
+
+static const char* shed_reason_names[ADMISSION_SHED_REASON_COUNT] = {
+    "queue_full", "timeout", "shutdown"
+};
+
+static int env_int(const char* name, int fallback) {
+    const char* value = getenv(name);
+    if (!value || !*value) return fallback;
+    char* end;
+    long parsed = strtol(value, &end, 10);
+    return *end == '\0' && parsed > 0 && parsed <= 1000000 ? (int)parsed : fallback;
+}
+
+void admission_default_config(AdmissionConfig* config) {
+    config->max_concurrent = env_int("INGRES_MAX_CONCURRENT", MAX_CONCURRENT_REQUESTS);
+    config->max_queued = env_int("INGRES_MAX_QUEUED", ADMISSION_DEFAULT_MAX_QUEUED);
+    config->max_wait_ms = (uint32_t)env_int("INGRES_QUEUE_WAIT_MS", ADMISSION_DEFAULT_WAIT_MS);
+}
+
+// ============================================================================
+// QUEUE (caller holds the lock)
+// ============================================================================
+
+static void ring_push(JobRing* ring, const QueuedJob* job) {
+    ring->jobs[(ring->head + ring->count) % admission.config.max_queued] = *job;
+    ring->count++;
+}
+
+static QueuedJob ring_pop(JobRing* ring) {
+    QueuedJob job = ring->jobs[ring->head];
+    ring->head = (ring->head + 1) % admission.config.max_queued;
+    ring->count--;
+    return job;
+}
+
+static bool pop_next(QueuedJob* out) {
+    for (int priority = 0; priority < ADMISSION_PRIORITY_COUNT; priority++) {
+        JobRing* ring = &admission.rings[priority];
+        if (ring->count > 0) {
+            *out = ring_pop(ring);
+            admission.queued--;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool is_expired(const QueuedJob* job, uint64_t now_ns) {
+    return now_ns - job->enqueued_ns > (uint64_t)admission.config.max_wait_ms * 1000000ULL;
+}
+
+// ============================================================================
+// WORKERS
+// ============================================================================
+
+static void* worker_main(void* arg) {
+    (void)arg;
+    pthread_mutex_lock(&admission.lock);
+    for (;;) {
+        while (admission.running && admission.queued == 0) {
+            pthread_cond_wait(&admission.work_ready, &admission.lock);
+        }
+        if (!admission.running) break;
+
+        QueuedJob job;
+        pop_next(&job);
+        uint64_t start_ns = metrics_now_ns();
+
+        // Nobody called admission_expire in time; still honour the bound
+        if (is_expired(&job, start_ns)) {
+            admission.shed_total[ADMISSION_SHED_TIMEOUT]++;
+            pthread_mutex_unlock(&admission.lock);
+            job.shed(job.job, ADMISSION_SHED_TIMEOUT);
+            pthread_mutex_lock(&admission.lock);
+            continue;
+        }
+
+        admission.in_flight++;
+        admission.admitted_total++;
+        pthread_mutex_unlock(&admission.lock);
+
+        job.run(job.job);
+        uint64_t service_ns = metrics_now_ns() - start_ns;
+
+        pthread_mutex_lock(&admission.lock);
+        admission.in_flight--;
+        admission.avg_service_ns = admission.avg_service_ns
+            ? (admission.avg_service_ns * 7 + service_ns) / 8
+            : service_ns;
+    }
+    pthread_mutex_unlock(&admission.lock);
+    return NULL;
+}
+
+bool admission_init(const AdmissionConfig* config) {
+    AdmissionConfig settings;
+    if (config) settings = *config;
+    else admission_default_config(&settings);
+    if (settings.max_concurrent <= 0 || settings.max_queued <= 0) return false;
+
+    pthread_mutex_lock(&admission.lock);
+    if (admission.running || admission.threads) {
+        pthread_mutex_unlock(&admission.lock);
+        return false;
+    }
+
+    admission.config = settings;
+    for (int priority = 0; priority < ADMISSION_PRIORITY_COUNT; priority++) {
+        JobRing* ring = &admission.rings[priority];
+        ring->jobs = calloc((size_t)settings.max_queued, sizeof(QueuedJob));
+        ring->head = 0;
+        ring->count = 0;
+    }
+    admission.threads = calloc((size_t)settings.max_concurrent, sizeof(pthread_t));
+    admission.queued = 0;
+    admission.in_flight = 0;
+    admission.admitted_total = 0;
+    memset(admission.shed_total, 0, sizeof(admission.shed_total));
+    admission.avg_service_ns = 0;
+    admission.running = true;
+
+    bool ok = admission.threads != NULL;
+    for (int priority = 0; priority < ADMISSION_PRIORITY_COUNT; priority++) {
+        ok = ok && admission.rings[priority].jobs != NULL;
+    }
+    admission.thread_count = 0;
+    while (ok && admission.thread_count < settings.max_concurrent) {
+        ok = pthread_create(&admission.threads[admission.thread_count], NULL, worker_main, NULL) == 0;
+        if (ok) admission.thread_count++;
+    }
+    pthread_mutex_unlock(&admission.lock);
+
+    if (!ok) {
+        admission_shutdown();
+        return false;
+    }
+    return true;
+}
+
+void admission_shutdown(void) {
+    pthread_mutex_lock(&admission.lock);
+    admission.running = false;
+
+    // Collect the waiting jobs; their shed callbacks run without the lock
+    int pending_count = admission.queued;
+    QueuedJob* pending = pending_count > 0 ? malloc((size_t)pending_count * sizeof(QueuedJob)) : NULL;
+    int collected = 0;
+    QueuedJob job;
+    while (pop_next(&job)) {
+        if (pending) pending[collected++] = job;
+    }
+    admission.shed_total[ADMISSION_SHED_SHUTDOWN] += (uint64_t)pending_count;
+
+    pthread_t* threads = admission.threads;
+    int thread_count = admission.thread_count;
+    pthread_cond_broadcast(&admission.work_ready);
+    pthread_mutex_unlock(&admission.lock);
+
+    for (int i = 0; i < collected; i++) pending[i].shed(pending[i].job, ADMISSION_SHED_SHUTDOWN);
+    free(pending);
+
+    for (int i = 0; i < thread_count; i++) pthread_join(threads[i], NULL);
+
+    pthread_mutex_lock(&admission.lock);
+    free(admission.threads);
+    admission.threads = NULL;
+    admission.thread_count = 0;
+    for (int priority = 0; priority < ADMISSION_PRIORITY_COUNT; priority++) {
+        free(admission.rings[priority].jobs);
+        admission.rings[priority].jobs = NULL;
+    }
+    pthread_mutex_unlock(&admission.lock);
+}
+
+// ============================================================================
+// SUBMISSION
+// ============================================================================
+
+bool admission_submit(AdmissionPriority priority, AdmissionRun run, AdmissionShed shed, void* job) {
+    if ((unsigned)priority >= ADMISSION_PRIORITY_COUNT) priority = ADMISSION_PRIORITY_NORMAL;
+
+    pthread_mutex_lock(&admission.lock);
+    if (!admission.running || admission.queued >= admission.config.max_queued) {
+        AdmissionShedReason reason = admission.running ? ADMISSION_SHED_QUEUE_FULL : ADMISSION_SHED_SHUTDOWN;
+        admission.shed_total[reason]++;
+        pthread_mutex_unlock(&admission.lock);
+        shed(job, reason);
+        return false;
+    }
+
+    QueuedJob entry = { run, shed, job, metrics_now_ns() };
+    ring_push(&admission.rings[priority], &entry);
+    admission.queued++;
+    pthread_cond_signal(&admission.work_ready);
+    pthread_mutex_unlock(&admission.lock);
+    return true;
+}
+
+int admission_expire(void) {
+    int total = 0;
+    for (;;) {
+        QueuedJob expired[EXPIRE_BATCH];
+        int count = 0;
+
+        // Rings are FIFO, so only their heads can be the oldest. The clock is
+        // read under the lock: a job submitted by another thread in between
+        // would otherwise look older than now and be shed at once.
+        pthread_mutex_lock(&admission.lock);
+        uint64_t now_ns = metrics_now_ns();
+        for (int priority = 0; priority < ADMISSION_PRIORITY_COUNT && admission.running; priority++) {
+            JobRing* ring = &admission.rings[priority];
+            while (count < EXPIRE_BATCH && ring->count > 0 && is_expired(&ring->jobs[ring->head], now_ns)) {
+                expired[count++] = ring_pop(ring);
+                admission.queued--;
+            }
+        }
+        admission.shed_total[ADMISSION_SHED_TIMEOUT] += (uint64_t)count;
+        pthread_mutex_unlock(&admission.lock);
+
+        for (int i = 0; i < count; i++) expired[i].shed(expired[i].job, ADMISSION_SHED_TIMEOUT);
+        total += count;
+        if (count < EXPIRE_BATCH) return total;
+    }
+}
+
+// ============================================================================
+// STATISTICS
+// ============================================================================
+
+uint32_t admission_retry_after(void) {
+    pthread_mutex_lock(&admission.lock);
+    uint64_t workers = admission.thread_count > 0 ? (uint64_t)admission.thread_count : 1;
+    uint64_t wait_ns = (uint64_t)(admission.queued + 1) * admission.avg_service_ns / workers;
+    pthread_mutex_unlock(&admission.lock);
+
+    uint64_t seconds = (wait_ns + 999999999ULL) / 1000000000ULL;
+    if (seconds < 1) seconds = 1;
+    if (seconds > ADMISSION_MAX_RETRY_AFTER) seconds = ADMISSION_MAX_RETRY_AFTER;
+    return (uint32_t)seconds;
+}
+
+void admission_stats(AdmissionStats* stats) {
+    pthread_mutex_lock(&admission.lock);
+    stats->workers = admission.thread_count;
+    stats->in_flight = admission.in_flight;
+    stats->queued = admission.queued;
+    for (int priority = 0; priority < ADMISSION_PRIORITY_COUNT; priority++) {
+        stats->queued_by_priority[priority] = admission.rings[priority].count;
+    }
+    stats->admitted_total = admission.admitted_total;
+    memcpy(stats->shed_total, admission.shed_total, sizeof(stats->shed_total));
+    stats->avg_service_ns = admission.avg_service_ns;
+    pthread_mutex_unlock(&admission.lock);
+}
+
+const char* admission_shed_reason_name(AdmissionShedReason reason) {
+    return (unsigned)reason < ADMISSION_SHED_REASON_COUNT ? shed_reason_names[reason] : "unknown";
+}
@@ -1,202 +1,1801 @@
-#include "chatbot.h"
+#include "api.h"
+#include "admission.h"
+#include "singleflight.h"
+#include "json_writer.h"
+#include "json_reader.h"
+#include "compress.h"
+#include "static_cache.h"
+#include "metrics.h"
+#include "logger.h"
 #include "../lib/mongoose.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
 
 // Conditional JSON support
 #ifdef USE_JSON_C
 #include <json-c/json.h>
 #endif
 
+#define CORS_HEADERS "Access-Control-Allow-Origin: *\r\n" \
+                     "Access-Control-Allow-Methods: GET, POST, OPTIONS\r\n" \
+                     "Access-Control-Allow-Headers: Content-Type, X-Request-Priority\r\n"
+#define JSON_HEADERS CORS_HEADERS "Content-Type: application/json\r\n"
+
+// c->data[0]: close once the deferred reply has been sent
+#define CONN_CLOSE_AFTER_REPLY 'C'
+// c->data[1]: ContentEncoding the current request accepts
+#define CONN_ENCODING_SLOT 1
+// c->data[2]: the stream's headers have gone out
+#define CONN_STREAM_SLOT 2
+// c->data[3]: stream events for this connection are held this pass
+#define CONN_HELD_SLOT 3
+// c->data[4]: the stream being answered is NDJSON rather than SSE
+#define CONN_NDJSON_SLOT 4
+
+#define STREAM_HEADERS CORS_HEADERS "Content-Type: text/event-stream\r\n" \
+                       "Cache-Control: no-cache\r\n" \
+                       "Transfer-Encoding: chunked\r\n"
+#define NDJSON_HEADERS CORS_HEADERS "Content-Type: application/x-ndjson\r\n" \
+                       "Transfer-Encoding: chunked\r\n"
+
+// Chat JSON starts with the message (see bot_response_to_json), so the
+// precompressed segment of a prebuilt message splices in right after this
+#define CHAT_JSON_PREFIX "{\"message\":\""
+
 // API endpoint handlers
 static void handle_chat_endpoint(struct mg_connection *c, struct mg_http_message *hm);
+static void handle_chat_stream_endpoint(struct mg_connection *c, struct mg_http_message *hm);
+static void handle_chat_batch_endpoint(struct mg_connection *c, struct mg_http_message *hm);
 static void handle_status_endpoint(struct mg_connection *c, struct mg_http_message *hm);
 static void handle_health_endpoint(struct mg_connection *c, struct mg_http_message *hm);
 static void handle_capabilities_endpoint(struct mg_connection *c, struct mg_http_message *hm);
+static void handle_metrics_endpoint(struct mg_connection *c, struct mg_http_message *hm);
+static void handle_static_request(struct mg_connection *c, struct mg_http_message *hm);
+static void handle_ws_upgrade(struct mg_connection *c, struct mg_http_message *hm);
+static void handle_ws_message(struct mg_connection *c, struct mg_ws_message *wm);
+static void close_ws_session(struct mg_connection *c);
 
-// Convert BotResponse to simple JSON-like format
-char* bot_response_to_json(BotResponse* response) {
-    if (!response) return NULL;
+// A chat flight's leader on its way to a worker
+typedef struct {
+    SingleFlight* flight;
+    char* message;
+    bool compress;              // The leader accepts a compressed reply
+} ChatJob;
+
+// A streamed chat request on its way to a worker; streams do not coalesce
+typedef struct {
+    unsigned long conn_id;
+    char* message;
+} StreamJob;
+
+struct ChatBatch;
+
+// One query of a batch. Later items with the same query (and session) are
+// not run; they share the first one's answer through same_next.
+typedef struct {
+    struct ChatBatch* batch;
+    char* message;
+    char* session_id;
+    bool duplicate;
+    int same_next;              // Next item sharing this answer, or -1
+    SharedBytes* result;        // Set once answered
+} BatchItem;
+
+// A /api/chat/batch request. Its unique items run on the worker pool, at
+// most window at a time so one batch neither fills the admission queue nor
+// ages its own items past the queue wait limit; each answer starts the next
+// item from the worker that finished.
+typedef struct ChatBatch {
+    unsigned long conn_id;
+    AdmissionPriority priority;
+    bool ndjson;                // Stream lines as items finish, in order
+    bool compress;
+    BatchItem* items;
+    int count;
+    int window;
+    pthread_mutex_t lock;
+    int next_run;               // First item not yet submitted
+    int running;
+    int answered;
+    int next_line;              // NDJSON: first item not yet posted
+    bool pumping;               // A thread is submitting items
+} ChatBatch;
+
+// One queued or running chat turn of a WebSocket session
+typedef struct WsTurn {
+    char* message;
+    const char* error;          // Rejected frame: answered with this, in turn order
+    int opcode;                 // Answered in kind: text or binary frame
+    struct WsTurn* next;
+} WsTurn;
+
+// A /ws/chat connection's conversation. Its turns run one at a time, so the
+// context is only touched by the worker running the current turn; everything
+// else belongs to the event loop.
+typedef struct {
+    unsigned long conn_id;
+    ConversationContext* context;
+    AdmissionPriority priority;
+    WsTurn* pending;
+    WsTurn** pending_tail;
+    int pending_count;
+    WsTurn* running;            // NULL when idle
+    bool closed;                // Connection gone; freed once the running turn is back
+} WsSession;
+
+static void finish_ws_turn(WsSession* session, struct mg_connection *c, SharedBytes* answer);
+
+typedef enum {
+    REPLY_RESPONSE,             // A whole response (status and body)
+    REPLY_STREAM_EVENT,         // One server-sent event of a stream
+    REPLY_STREAM_END,           // The stream's last event
+    REPLY_WS_TURN               // The answer to a WebSocket session's running turn
+} ReplyKind;
+
+// A finished (or shed) chat request, or a piece of a stream, waiting for the
+// event loop to send it; response bytes are shared with every other request
+// in the same flight
+typedef struct ChatReply {
+    unsigned long conn_id;
+    ReplyKind kind;
+    SharedBytes* bytes;
+    WsSession* session;         // REPLY_WS_TURN only
+    uint64_t held_since_ms;     // First held for a slow reader, or 0
+    struct ChatReply* next;
+} ChatReply;
+
+// One event loop: a mongoose manager with its own listener and connections.
+// Workers hand replies to the loop that owns the connection through its list
+// and poke it with mg_wakeup; only that loop's thread touches its connections.
+typedef struct {
+    struct mg_mgr mgr;
+    int index;
+    pthread_t thread;
+    bool threaded;              // Runs on thread; the first loop runs on the caller's
+    unsigned long wakeup_conn_id;
+    pthread_mutex_t reply_lock;
+    ChatReply* reply_head;
+    ChatReply* reply_tail;
+
+    // Stream events whose connection still has API_STREAM_HIGH_WATER bytes
+    // unsent; retried every poll, in order. Loop thread only.
+    ChatReply* held_head;
+    ChatReply* held_tail;
+
+    // Written by the loop thread only; atomic so /api/metrics on any loop
+    // can add them up
+    atomic_int ws_sessions_open;
+    atomic_uint_fast64_t ws_turns_total;
+    atomic_uint_fast64_t batch_requests_total;
+    atomic_uint_fast64_t batch_items_total;
+    atomic_uint_fast64_t static_responses_total;
+    atomic_uint_fast64_t static_not_modified_total;
+} ApiLoop;
+
+// Connection ids carry their loop's index in the top byte (each manager
+// counts up from index << LOOP_ID_SHIFT), so a worker holding a conn_id
+// knows which loop to hand its reply to
+#define LOOP_ID_SHIFT (sizeof(unsigned long) * 8 - 8)
+
+static ApiLoop* api_loops[API_MAX_EVENT_LOOPS];
+static int api_loop_count = 0;
+
+// Set by stop_api_server, possibly from a signal handler
+static atomic_bool stop_requested;
+static uint32_t drain_timeout_ms = API_DRAIN_TIMEOUT_MS;
+
+static ApiLoop* loop_of(unsigned long conn_id) {
+    return api_loops[conn_id >> LOOP_ID_SHIFT];
+}
+
+// Compressed once at startup: the messages of intents that always answer
+// with the same text, and the fixed capabilities document
+static DeflateSegment prebuilt_segments[INTENT_COUNT];
+static const char* prebuilt_messages[INTENT_COUNT];
+static const char capabilities_json[] = "{\"capabilities\":[\"Location-based groundwater queries\",\"Historical trend analysis\",\"Multi-location comparisons\",\"Policy recommendations\",\"Conservation method suggestions\",\"Crisis area identification\",\"Technical explanations\",\"Context-aware conversations\",\"Fuzzy string matching\",\"Multi-language support framework\",\"Real-time confidence scoring\",\"Follow-up suggestions\",\"Data source attribution\"],\"total_intents\":70,\"supported_languages\":\"English, Hindi (framework)\"}\n";
+static StrBuf capabilities_deflated;
 
-    char* result = malloc(4096); // Large buffer for response
-    if (!result) return NULL;
+static atomic_uint_fast64_t compressed_responses;
+static atomic_uint_fast64_t compression_saved_bytes;
 
-    // Build simple JSON-like response
-    snprintf(result, 4096,
-        "{\"message\":\"%s\",\"intent\":%d,\"confidence\":%.2f,\"processing_time_ms\":%.2f,\"has_data\":%s,\"requires_clarification\":%s",
-        response->message ? response->message : "",
-        response->intent,
-        response->confidence_score,
-        response->processing_time_ms,
-        response->has_data ? "true" : "false",
-        response->requires_clarification ? "true" : "false");
+// Every response field except the message, into an open object
+static void write_response_fields(JsonWriter* json, const BotResponse* response) {
+    json_key(json, "intent");
+    json_int(json, response->intent);
+    json_key(json, "confidence");
+    json_double(json, response->confidence_score, 2);
+    json_key(json, "processing_time_ms");
+    json_double(json, response->processing_time_ms, 2);
+    json_key(json, "has_data");
+    json_bool(json, response->has_data);
+    json_key(json, "requires_clarification");
+    json_bool(json, response->requires_clarification);
 
     // Add suggestions if available
     if (response->suggestion_count > 0) {
-        strcat(result, ",\"suggestions\":[");
+        json_key(json, "suggestions");
+        json_begin_array(json);
         for (int i = 0; i < response->suggestion_count; i++) {
-            if (i > 0) strcat(result, ",");
-            char suggestion[256];
-            snprintf(suggestion, sizeof(suggestion), "\"%s\"",
-                    response->suggested_actions[i] ? response->suggested_actions[i] : "");
-            strcat(result, suggestion);
+            json_string(json, response->suggested_actions[i] ? response->suggested_actions[i] : "");
         }
-        strcat(result, "]");
+        json_end_array(json);
     }
 
     // Add clarification if needed
     if (response->clarification_question) {
-        char clarification[512];
-        snprintf(clarification, sizeof(clarification), ",\"clarification_question\":\"%s\"",
-                response->clarification_question);
-        strcat(result, clarification);
+        json_key(json, "clarification_question");
+        json_string(json, response->clarification_question);
     }
 
     // Add data sources
     if (response->source_count > 0) {
-        strcat(result, ",\"data_sources\":[");
+        json_key(json, "data_sources");
+        json_begin_array(json);
         for (int i = 0; i < response->source_count; i++) {
-            if (i > 0) strcat(result, ",");
-            char source[256];
-            snprintf(source, sizeof(source), "\"%s\"",
-                    response->data_sources[i] ? response->data_sources[i] : "");
-            strcat(result, source);
-        }
-        strcat(result, "]");
-    }
-
-    strcat(result, "}");
-    return result;
-}
-
-// Main HTTP event handler
-static void http_handler(struct mg_connection *c, int ev, void *ev_data, void *fn_data) {
-    if (ev == MG_EV_HTTP_MSG) {
-        struct mg_http_message *hm = (struct mg_http_message *) ev_data;
-        
-        // Enable CORS
-        mg_printf(c, "HTTP/1.1 200 OK\r\n"
-                     "Access-Control-Allow-Origin: *\r\n"
-                     "Access-Control-Allow-Methods: GET, POST, OPTIONS\r\n"
-                     "Access-Control-Allow-Headers: Content-Type\r\n"
-                     "Content-Type: application/json\r\n\r\n");
-        
-        // Route requests
-        if (mg_http_match_uri(hm, "/api/chat")) {
-            handle_chat_endpoint(c, hm);
-        } else if (mg_http_match_uri(hm, "/api/status")) {
-            handle_status_endpoint(c, hm);
-        } else if (mg_http_match_uri(hm, "/api/health")) {
-            handle_health_endpoint(c, hm);
-        } else if (mg_http_match_uri(hm, "/api/capabilities")) {
-            handle_capabilities_endpoint(c, hm);
-        } else {
-            // Serve static files or 404
-            struct mg_http_serve_opts opts = {.root_dir = "./web"};
-            mg_http_serve_dir(c, hm, &opts);
+            json_string(json, response->data_sources[i] ? response->data_sources[i] : "");
+        }
+        json_end_array(json);
+    }
+}
+
+// Convert BotResponse to a JSON object
+char* bot_response_to_json(BotResponse* response) {
+    if (!response) return NULL;
+
+    uint64_t serialize_ns = metrics_now_ns();
+    StrBuf out;
+    strbuf_init(&out);
+    strbuf_reserve(&out, 4096);
+
+    JsonWriter json;
+    json_writer_init(&json, &out);
+    json_begin_object(&json);
+    json_key(&json, "message");
+    json_string(&json, response->message ? response->message : "");
+    write_response_fields(&json, response);
+    json_end_object(&json);
+
+    if (!json_writer_ok(&json)) {
+        strbuf_free(&out);
+        return NULL;
+    }
+    metrics_record_since(METRIC_SERIALIZE, serialize_ns);
+    return out.data;
+}
+
+static bool uri_is(struct mg_http_message *hm, const char* uri) {
+    return mg_match(hm->uri, mg_str(uri), NULL);
+}
+
+static bool method_is(struct mg_http_message *hm, const char* method) {
+    return mg_strcmp(hm->method, mg_str(method)) == 0;
+}
+
+// "Connection: close", or HTTP/1.0 without "Connection: keep-alive"
+static bool wants_close(struct mg_http_message *hm) {
+    struct mg_str *connection = mg_http_get_header(hm, "Connection");
+    if (connection && mg_strcasecmp(*connection, mg_str("close")) == 0) return true;
+    bool keep_alive = connection && mg_strcasecmp(*connection, mg_str("keep-alive")) == 0;
+    return mg_strcmp(hm->proto, mg_str("HTTP/1.0")) == 0 && !keep_alive;
+}
+
+// ============================================================================
+// COMPRESSED RESPONSES
+// ============================================================================
+
+static ContentEncoding request_encoding(struct mg_http_message *hm) {
+    struct mg_str *accept = mg_http_get_header(hm, "Accept-Encoding");
+    return accept ? compress_negotiate(accept->buf, accept->len) : CONTENT_ENCODING_IDENTITY;
+}
+
+static const char* status_text(int status) {
+    switch (status) {
+        case 200: return "OK";
+        case 304: return "Not Modified";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 500: return "Internal Server Error";
+        case 503: return "Service Unavailable";
+        default:  return "";
+    }
+}
+
+// Send body with its Content-Length. When a raw deflate form of body is
+// given and the client accepts an encoding, that goes out framed instead.
+static void send_response(struct mg_connection *c, int status, const char* headers,
+                          const char* body, size_t length, ContentEncoding encoding,
+                          const char* deflated, size_t deflated_length) {
+    const char* vary = deflated ? "Vary: Accept-Encoding\r\n" : "";
+    if (!deflated || encoding == CONTENT_ENCODING_IDENTITY) {
+        mg_printf(c, "HTTP/1.1 %d %s\r\n%s%sContent-Length: %lu\r\n\r\n",
+                  status, status_text(status), headers, vary, (unsigned long)length);
+        mg_send(c, body, length);
+        c->is_resp = 0;
+        return;
+    }
+
+    unsigned char header[COMPRESS_HEADER_MAX], trailer[COMPRESS_TRAILER_MAX];
+    size_t header_length = compress_frame_header(encoding, header);
+    size_t trailer_length = compress_frame_trailer(encoding, body, length, trailer);
+    size_t total = header_length + deflated_length + trailer_length;
+    mg_printf(c, "HTTP/1.1 %d %s\r\n%s%sContent-Encoding: %s\r\nContent-Length: %lu\r\n\r\n",
+              status, status_text(status), headers, vary, content_encoding_name(encoding), (unsigned long)total);
+    mg_send(c, header, header_length);
+    mg_send(c, deflated, deflated_length);
+    mg_send(c, trailer, trailer_length);
+    c->is_resp = 0;
+
+    atomic_fetch_add_explicit(&compressed_responses, 1, memory_order_relaxed);
+    if (length > total) {
+        atomic_fetch_add_explicit(&compression_saved_bytes, length - total, memory_order_relaxed);
+    }
+}
+
+// Send a body built for this request, compressing it on the spot when the
+// client accepts an encoding and it is worth it
+static void send_negotiated(struct mg_connection *c, struct mg_http_message *hm, int status,
+                            const char* headers, const char* body, size_t length) {
+    ContentEncoding encoding = request_encoding(hm);
+    if (encoding == CONTENT_ENCODING_IDENTITY || length < COMPRESS_MIN_BYTES) {
+        send_response(c, status, headers, body, length, CONTENT_ENCODING_IDENTITY, NULL, 0);
+        return;
+    }
+
+    StrBuf deflated;
+    strbuf_init(&deflated);
+    if (deflate_buffer(body, length, &deflated)) {
+        send_response(c, status, headers, body, length, encoding, deflated.data, deflated.length);
+    } else {
+        send_response(c, status, headers, body, length, CONTENT_ENCODING_IDENTITY, NULL, 0);
+    }
+    strbuf_free(&deflated);
+}
+
+// Raw deflate of a chat reply. A prebuilt message is not compressed again:
+// its startup segment is spliced between the dynamic prefix and suffix.
+static bool deflate_chat_json(const BotResponse* response, const char* json, size_t length, StrBuf* out) {
+    Deflater deflater;
+    if (!deflater_begin(&deflater, out)) return false;
+
+    const DeflateSegment* segment = NULL;
+    if ((unsigned)response->intent < INTENT_COUNT && response->message &&
+        response->message == prebuilt_messages[response->intent]) {
+        segment = &prebuilt_segments[response->intent];
+    }
+    size_t prefix = sizeof(CHAT_JSON_PREFIX) - 1;
+    if (segment && segment->data && length > prefix + segment->source_length &&
+        memcmp(json, CHAT_JSON_PREFIX, prefix) == 0) {
+        deflater_write(&deflater, json, prefix);
+        deflater_splice(&deflater, segment);
+        json += prefix + segment->source_length;
+        length -= prefix + segment->source_length;
+    }
+    deflater_write(&deflater, json, length);
+    return deflater_finish(&deflater);
+}
+
+// Escape and compress the prebuilt messages and fixed documents once
+static void precompress_payloads(void) {
+    StrBuf escaped;
+    strbuf_init(&escaped);
+    for (int intent = 0; intent < INTENT_COUNT; intent++) {
+        const BotResponse* prebuilt = bot_response_prebuilt((IntentType)intent);
+        if (!prebuilt || !prebuilt->message) continue;
+
+        strbuf_clear(&escaped);
+        if (!json_escape_append(&escaped, prebuilt->message, strlen(prebuilt->message)) ||
+            !deflate_segment_init(&prebuilt_segments[intent], escaped.data, escaped.length)) {
+            continue;
         }
+        prebuilt_messages[intent] = prebuilt->message;
+    }
+    strbuf_free(&escaped);
+
+    strbuf_init(&capabilities_deflated);
+    if (!deflate_buffer(capabilities_json, sizeof(capabilities_json) - 1, &capabilities_deflated)) {
+        strbuf_free(&capabilities_deflated);
+    }
+}
+
+static void free_payloads(void) {
+    for (int intent = 0; intent < INTENT_COUNT; intent++) {
+        deflate_segment_free(&prebuilt_segments[intent]);
+        prebuilt_messages[intent] = NULL;
     }
+    strbuf_free(&capabilities_deflated);
 }
 
-// Simple JSON-like parsing (extract message from "message":"value")
-static char* extract_message_from_json(const char* json_str) {
-    if (!json_str) return NULL;
+// Hold the web UI in memory: the React build output first, then the
+// public files it was built from
+static void load_static_assets(void) {
+    static_cache_load(API_WEB_BUILD_ROOT);
+    static_cache_load(API_WEB_PUBLIC_ROOT);
 
-    const char* message_start = strstr(json_str, "\"message\":\"");
-    if (!message_start) return NULL;
+    StaticCacheStats stats;
+    static_cache_get_stats(&stats);
+    log_message(LOG_INFO, "Static cache: %zu files, %zu bytes (%zu gzip), %zu left on disk",
+                stats.assets, stats.bytes, stats.gzip_bytes, stats.on_disk);
+}
 
-    message_start += 11; // Skip "message":"
-    const char* message_end = strstr(message_start, "\"");
-    if (!message_end) return NULL;
+// Route one request; chat replies are deferred to a worker
+static void route_request(struct mg_connection *c, struct mg_http_message *hm) {
+    if (method_is(hm, "OPTIONS")) {
+        mg_http_reply(c, 204, CORS_HEADERS, "");
+        return;
+    }
 
-    int length = message_end - message_start;
-    char* message = malloc(length + 1);
-    if (!message) return NULL;
+    // Only chat goes through admission; probes are answered right here so
+    // health checks keep passing while chat sheds load
+    if (uri_is(hm, "/api/chat")) {
+        handle_chat_endpoint(c, hm);
+    } else if (uri_is(hm, "/api/chat/batch")) {
+        handle_chat_batch_endpoint(c, hm);
+    } else if (uri_is(hm, "/api/chat/stream")) {
+        handle_chat_stream_endpoint(c, hm);
+    } else if (uri_is(hm, "/ws/chat")) {
+        handle_ws_upgrade(c, hm);
+    } else if (uri_is(hm, "/api/metrics")) {
+        handle_metrics_endpoint(c, hm);
+    } else if (uri_is(hm, "/api/status")) {
+        handle_status_endpoint(c, hm);
+    } else if (uri_is(hm, "/api/health")) {
+        handle_health_endpoint(c, hm);
+    } else if (uri_is(hm, "/api/capabilities")) {
+        handle_capabilities_endpoint(c, hm);
+    } else {
+        handle_static_request(c, hm);
+    }
+}
 
-    strncpy(message, message_start, length);
-    message[length] = '\0';
+// Main HTTP event handler. Every response carries Content-Length, so a
+// connection stays open for further (and pipelined) requests unless the
+// client asked to close it. Mongoose holds pipelined requests back while a
+// response is outstanding (c->is_resp), which keeps deferred chat replies in
+// request order.
+static void http_handler(struct mg_connection *c, int ev, void *ev_data) {
+    if (ev == MG_EV_WS_MSG) {
+        handle_ws_message(c, (struct mg_ws_message *) ev_data);
+        return;
+    }
+    if (ev == MG_EV_CLOSE) {
+        close_ws_session(c);
+        return;
+    }
+    if (ev != MG_EV_HTTP_MSG) return;
+    struct mg_http_message *hm = (struct mg_http_message *) ev_data;
+    bool close_after = wants_close(hm) || atomic_load_explicit(&stop_requested, memory_order_relaxed);
+    c->data[CONN_ENCODING_SLOT] = (char)request_encoding(hm);
+    route_request(c, hm);
+
+    if (close_after) {
+        if (c->is_resp) c->data[0] = CONN_CLOSE_AFTER_REPLY;   // Reply still on a worker
+        else c->is_draining = 1;
+    }
+}
+
+// The unescaped "message" string of a JSON object; caller frees. NULL when
+// the text is not a well-formed object with one.
+static char* extract_message_from_json(const char* json_text, size_t length) {
+    JsonReader json;
+    json_reader_init(&json, json_text, length);
+    if (!json_enter_object(&json)) return NULL;
+
+    char* message = NULL;
+    char key[16];
+    while (json_next_member(&json, key, sizeof(key))) {
+        if (strcmp(key, "message") == 0 && !message && json_peek(&json) == JSON_VALUE_STRING) {
+            message = json_read_string(&json);
+        } else {
+            json_skip(&json);
+        }
+    }
+    if (!json_reader_done(&json)) {
+        free(message);
+        return NULL;
+    }
     return message;
 }
 
-// Chat endpoint handler
+// ============================================================================
+// CHAT (admission-controlled worker pool)
+// ============================================================================
+
+static void reply_busy(struct mg_connection *c, const char* body) {
+    char headers[256];
+    snprintf(headers, sizeof(headers), JSON_HEADERS "Retry-After: %u\r\n", admission_retry_after());
+    mg_http_reply(c, 503, headers, "%s", body);
+}
+
+static SharedBytes* error_bytes(int status, const char* body) {
+    return shared_bytes_new(status, body, strlen(body));
+}
+
+static void queue_reply(unsigned long conn_id, ReplyKind kind, SharedBytes* bytes, WsSession* session) {
+    ChatReply* reply = malloc(sizeof(ChatReply));
+    if (!reply) return;     // The client times out; nothing better to do without memory
+    reply->conn_id = conn_id;
+    reply->kind = kind;
+    reply->bytes = shared_bytes_retain(bytes);
+    reply->session = session;
+    reply->held_since_ms = 0;
+    reply->next = NULL;
+
+    ApiLoop* loop = loop_of(conn_id);
+    pthread_mutex_lock(&loop->reply_lock);
+    if (loop->reply_tail) loop->reply_tail->next = reply;
+    else loop->reply_head = reply;
+    loop->reply_tail = reply;
+    pthread_mutex_unlock(&loop->reply_lock);
+
+    // A lost wakeup only delays the reply to the next poll
+    mg_wakeup(&loop->mgr, loop->wakeup_conn_id, "", 0);
+}
+
+static void post_reply(unsigned long conn_id, ReplyKind kind, SharedBytes* bytes) {
+    queue_reply(conn_id, kind, bytes, NULL);
+}
+
+// Flight member callback: every request in the flight gets the same bytes
+static void reply_to_member(void* member, SharedBytes* result) {
+    unsigned long conn_id = (unsigned long)(uintptr_t)member;
+    if (result) {
+        post_reply(conn_id, REPLY_RESPONSE, result);
+        return;
+    }
+    SharedBytes* failure = error_bytes(500, "{\"error\": \"Internal server error\"}\n");
+    if (failure) post_reply(conn_id, REPLY_RESPONSE, failure);
+    shared_bytes_release(failure);
+}
+
+static void free_chat_job(ChatJob* job) {
+    free(job->message);
+    free(job);
+}
+
+static void run_chat_job(void* arg) {
+    ChatJob* job = arg;
+
+    BotResponse* response = process_user_query(job->message);
+    char* json_response = response ? bot_response_to_json(response) : NULL;
+
+    SharedBytes* result;
+    if (json_response) {
+        size_t length = strlen(json_response);
+        result = shared_bytes_new(200, json_response, length);
+
+        // Compressed here, once per flight, rather than per member on the loop
+        if (result && job->compress && length >= COMPRESS_MIN_BYTES) {
+            StrBuf deflated;
+            strbuf_init(&deflated);
+            if (deflate_chat_json(response, json_response, length, &deflated)) {
+                result->deflated = shared_bytes_new(200, deflated.data, deflated.length);
+            }
+            strbuf_free(&deflated);
+        }
+    } else {
+        result = error_bytes(500, response ? "{\"error\": \"Failed to generate response\"}\n"
+                                           : "{\"error\": \"Internal server error\"}\n");
+    }
+    free(json_response);
+    if (response) free_enhanced_bot_response(response);
+
+    singleflight_complete(job->flight, result);
+    free_chat_job(job);
+}
+
+static void shed_chat_job(void* arg, AdmissionShedReason reason) {
+    ChatJob* job = arg;
+    log_message(LOG_DEBUG, "Shed chat request \"%s\" (%s)", job->message, admission_shed_reason_name(reason));
+    singleflight_complete(job->flight, error_bytes(503, "{\"error\":\"Server busy, please retry\"}\n"));
+    free_chat_job(job);
+}
+
+static struct mg_connection* find_connection(struct mg_mgr *mgr, unsigned long id) {
+    for (struct mg_connection *c = mgr->conns; c != NULL; c = c->next) {
+        if (c->id == id) return c;
+    }
+    return NULL;
+}
+
+static void send_reply(struct mg_connection *c, SharedBytes* bytes) {
+    if (bytes->status == 503) {
+        reply_busy(c, bytes->data);
+    } else {
+        send_response(c, bytes->status, JSON_HEADERS, bytes->data, bytes->length,
+                      (ContentEncoding)c->data[CONN_ENCODING_SLOT],
+                      bytes->deflated ? bytes->deflated->data : NULL,
+                      bytes->deflated ? bytes->deflated->length : 0);
+    }
+    if (c->data[0] == CONN_CLOSE_AFTER_REPLY) c->is_draining = 1;
+}
+
+// Write one stream event as an HTTP chunk, unless the client is not keeping
+// up: then it waits (false) rather than piling into the send buffer, and a
+// reader stalled for API_STREAM_STALL_MS is disconnected.
+static bool send_stream_event(struct mg_connection *c, ChatReply* event, uint64_t now_ms) {
+    if (c->data[CONN_HELD_SLOT] || c->send.len >= API_STREAM_HIGH_WATER) {
+        if (event->held_since_ms == 0) event->held_since_ms = now_ms;
+        if (now_ms - event->held_since_ms < API_STREAM_STALL_MS) {
+            c->data[CONN_HELD_SLOT] = 1;
+            return false;
+        }
+        c->is_closing = 1;
+        return true;
+    }
+
+    if (!c->data[CONN_STREAM_SLOT]) {
+        mg_printf(c, "HTTP/1.1 200 OK\r\n%s\r\n", c->data[CONN_NDJSON_SLOT] ? NDJSON_HEADERS : STREAM_HEADERS);
+        c->data[CONN_STREAM_SLOT] = 1;
+    }
+    mg_http_write_chunk(c, event->bytes->data, event->bytes->length);
+    if (event->kind == REPLY_STREAM_END) {
+        mg_http_write_chunk(c, "", 0);
+        c->data[CONN_STREAM_SLOT] = 0;
+        c->data[CONN_NDJSON_SLOT] = 0;
+        c->is_resp = 0;
+        if (c->data[0] == CONN_CLOSE_AFTER_REPLY) c->is_draining = 1;
+    }
+    return true;
+}
+
+static void hold_reply(ApiLoop* loop, ChatReply* reply) {
+    reply->next = NULL;
+    if (loop->held_tail) loop->held_tail->next = reply;
+    else loop->held_head = reply;
+    loop->held_tail = reply;
+}
+
+// Send every reply the workers have finished; the connection may be gone
+static void deliver_replies(ApiLoop* loop) {
+    struct mg_mgr *mgr = &loop->mgr;
+    pthread_mutex_lock(&loop->reply_lock);
+    ChatReply* fresh = loop->reply_head;
+    loop->reply_head = loop->reply_tail = NULL;
+    pthread_mutex_unlock(&loop->reply_lock);
+
+    // Held events go first so every connection's events stay in order
+    ChatReply* reply = loop->held_head ? loop->held_head : fresh;
+    if (loop->held_tail) loop->held_tail->next = fresh;
+    loop->held_head = loop->held_tail = NULL;
+    for (struct mg_connection *c = mgr->conns; c != NULL; c = c->next) c->data[CONN_HELD_SLOT] = 0;
+
+    uint64_t now_ms = mg_millis();
+    while (reply) {
+        ChatReply* next = reply->next;
+        struct mg_connection *c = find_connection(mgr, reply->conn_id);
+        if (reply->kind == REPLY_WS_TURN) {
+            finish_ws_turn(reply->session, c, reply->bytes);
+        } else if (c && reply->kind == REPLY_RESPONSE) {
+            send_reply(c, reply->bytes);
+        } else if (c && !send_stream_event(c, reply, now_ms)) {
+            hold_reply(loop, reply);
+            reply = next;
+            continue;
+        }
+        shared_bytes_release(reply->bytes);
+        free(reply);
+        reply = next;
+    }
+}
+
+static AdmissionPriority request_priority(struct mg_http_message *hm) {
+    struct mg_str *value = mg_http_get_header(hm, "X-Request-Priority");
+    if (value == NULL) return ADMISSION_PRIORITY_NORMAL;
+    if (mg_strcasecmp(*value, mg_str("high")) == 0) return ADMISSION_PRIORITY_HIGH;
+    if (mg_strcasecmp(*value, mg_str("low")) == 0) return ADMISSION_PRIORITY_LOW;
+    return ADMISSION_PRIORITY_NORMAL;
+}
+
+// The "message" of a JSON request body; caller frees
+static char* message_from_body(struct mg_http_message *hm) {
+    uint64_t parse_ns = metrics_now_ns();
+    char* user_message = extract_message_from_json(hm->body.buf, hm->body.len);
+    metrics_record_since(METRIC_PARSE, parse_ns);
+    return user_message;
+}
+
+// Messages are capped at MAX_INPUT_LENGTH like WebSocket frames: the intent
+// classifier's edit-distance tables grow with the input on a worker's stack
+static bool message_fits(const char* message) {
+    return strlen(message) < MAX_INPUT_LENGTH;
+}
+
+// Chat endpoint handler: join a running flight for the same query, or lead
+// a new one through admission; replies come from deliver_replies
 static void handle_chat_endpoint(struct mg_connection *c, struct mg_http_message *hm) {
-    if (mg_vcmp(&hm->method, "POST") != 0) {
-        mg_printf(c, "{\"error\": \"Method not allowed\"}\n");
+    if (!method_is(hm, "POST")) {
+        mg_http_reply(c, 405, JSON_HEADERS "Allow: POST, OPTIONS\r\n", "{\"error\": \"Method not allowed\"}\n");
         return;
     }
 
-    // Simple JSON parsing - for demo, use a test message
-    // In production, this would parse the actual HTTP body
-    char* user_message = strdup("Show me Punjab groundwater data");
+    char* user_message = message_from_body(hm);
     if (!user_message) {
-        mg_printf(c, "{\"error\": \"Invalid request format\"}\n");
+        mg_http_reply(c, 400, JSON_HEADERS, "{\"error\": \"Invalid request format\"}\n");
         return;
     }
+    if (!message_fits(user_message)) {
+        mg_http_reply(c, 413, JSON_HEADERS, "{\"error\": \"Message too long\"}\n");
+        free(user_message);
+        return;
+    }
+
+    SingleFlight* flight = singleflight_begin(user_message, reply_to_member, (void*)(uintptr_t)c->id);
+    if (!flight) {
+        free(user_message);     // Coalesced: the leader's reply will be ours too
+        return;
+    }
+
+    ChatJob* job = malloc(sizeof(ChatJob));
+    if (!job) {
+        singleflight_complete(flight, error_bytes(500, "{\"error\": \"Internal server error\"}\n"));
+        free(user_message);
+        return;
+    }
+    job->flight = flight;
+    job->message = user_message;
+    job->compress = c->data[CONN_ENCODING_SLOT] != CONTENT_ENCODING_IDENTITY;
+
+    // When the queue is full the shed callback has already answered the flight
+    admission_submit(request_priority(hm), run_chat_job, shed_chat_job, job);
+}
+
+// ============================================================================
+// CHAT STREAM (server-sent events)
+// ============================================================================
+
+// Queue "event: <name>" with one line of JSON data for the loop to send
+static void post_stream_event(unsigned long conn_id, ReplyKind kind, const char* name, const StrBuf* data) {
+    StrBuf event;
+    strbuf_init(&event);
+    if (strbuf_appendf(&event, "event: %s\ndata: ", name) &&
+        strbuf_append(&event, data->data, data->length) &&
+        strbuf_append(&event, "\n\n", 2)) {
+        SharedBytes* bytes = shared_bytes_new(200, event.data, event.length);
+        if (bytes) post_reply(conn_id, kind, bytes);
+        shared_bytes_release(bytes);
+    }
+    strbuf_free(&event);
+}
+
+// Last event of a stream that failed after its headers went out
+static void post_stream_error(unsigned long conn_id, const char* message) {
+    StrBuf data;
+    strbuf_init(&data);
+    JsonWriter json;
+    json_writer_init(&json, &data);
+    json_begin_object(&json);
+    json_key(&json, "error");
+    json_string(&json, message);
+    json_end_object(&json);
+    if (json_writer_ok(&json)) post_stream_event(conn_id, REPLY_STREAM_END, "error", &data);
+    strbuf_free(&data);
+}
+
+// First event: goes out as soon as the query is classified
+static void stream_intent(void* context, IntentType intent, float confidence) {
+    StreamJob* job = context;
+    StrBuf data;
+    strbuf_init(&data);
+    JsonWriter json;
+    json_writer_init(&json, &data);
+    json_begin_object(&json);
+    json_key(&json, "intent");
+    json_int(&json, intent);
+    json_key(&json, "confidence");
+    json_double(&json, confidence, 2);
+    json_end_object(&json);
+    if (json_writer_ok(&json)) post_stream_event(job->conn_id, REPLY_STREAM_EVENT, "intent", &data);
+    strbuf_free(&data);
+}
+
+// The message one section (blank-line separated) per event, then the rest
+// of the response in a final "done" event
+static void stream_response(StreamJob* job, const BotResponse* response) {
+    StrBuf data;
+    strbuf_init(&data);
+    JsonWriter json;
+
+    const char* text = response->message ? response->message : "";
+    while (*text) {
+        const char* section_end = strstr(text, "\n\n");
+        size_t length = section_end ? (size_t)(section_end - text) + 2 : strlen(text);
+
+        strbuf_clear(&data);
+        json_writer_init(&json, &data);
+        json_begin_object(&json);
+        json_key(&json, "text");
+        json_string_n(&json, text, length);
+        json_end_object(&json);
+        if (json_writer_ok(&json)) post_stream_event(job->conn_id, REPLY_STREAM_EVENT, "section", &data);
+        text += length;
+    }
+
+    strbuf_clear(&data);
+    json_writer_init(&json, &data);
+    json_begin_object(&json);
+    write_response_fields(&json, response);
+    json_end_object(&json);
+    if (json_writer_ok(&json)) {
+        post_stream_event(job->conn_id, REPLY_STREAM_END, "done", &data);
+    } else {
+        post_stream_error(job->conn_id, "Internal server error");
+    }
+    strbuf_free(&data);
+}
 
-    // Process with enhanced chatbot
-    BotResponse* response = process_user_query(user_message);
-    free(user_message);
+static void free_stream_job(StreamJob* job) {
+    free(job->message);
+    free(job);
+}
 
+static void run_stream_job(void* arg) {
+    StreamJob* job = arg;
+    BotResponse* response = process_user_query_streaming(job->message, NULL, stream_intent, job);
     if (response) {
-        char* json_response = bot_response_to_json(response);
-        if (json_response) {
-            mg_printf(c, "%s\n", json_response);
-            free(json_response);
+        stream_response(job, response);
+        free_enhanced_bot_response(response);
+    } else {
+        post_stream_error(job->conn_id, "Failed to generate response");
+    }
+    free_stream_job(job);
+}
+
+// Nothing has been sent yet, so a shed stream still gets a plain 503
+static void shed_stream_job(void* arg, AdmissionShedReason reason) {
+    StreamJob* job = arg;
+    log_message(LOG_DEBUG, "Shed chat stream \"%s\" (%s)", job->message, admission_shed_reason_name(reason));
+    SharedBytes* busy = error_bytes(503, "{\"error\":\"Server busy, please retry\"}\n");
+    if (busy) post_reply(job->conn_id, REPLY_RESPONSE, busy);
+    shared_bytes_release(busy);
+    free_stream_job(job);
+}
+
+// Chat stream handler: GET ?message= (for EventSource) or POST like
+// /api/chat; events are written by deliver_replies as the worker posts them
+static void handle_chat_stream_endpoint(struct mg_connection *c, struct mg_http_message *hm) {
+    char* user_message = NULL;
+    if (method_is(hm, "GET")) {
+        char value[MAX_INPUT_LENGTH];
+        if (mg_http_get_var(&hm->query, "message", value, sizeof(value)) > 0) user_message = strdup(value);
+    } else if (method_is(hm, "POST")) {
+        user_message = message_from_body(hm);
+    } else {
+        mg_http_reply(c, 405, JSON_HEADERS "Allow: GET, POST, OPTIONS\r\n", "{\"error\": \"Method not allowed\"}\n");
+        return;
+    }
+    if (!user_message) {
+        mg_http_reply(c, 400, JSON_HEADERS, "{\"error\": \"Invalid request format\"}\n");
+        return;
+    }
+    if (!message_fits(user_message)) {
+        mg_http_reply(c, 413, JSON_HEADERS, "{\"error\": \"Message too long\"}\n");
+        free(user_message);
+        return;
+    }
+
+    StreamJob* job = malloc(sizeof(StreamJob));
+    if (!job) {
+        mg_http_reply(c, 500, JSON_HEADERS, "{\"error\": \"Internal server error\"}\n");
+        free(user_message);
+        return;
+    }
+    job->conn_id = c->id;
+    job->message = user_message;
+    admission_submit(request_priority(hm), run_stream_job, shed_stream_job, job);
+}
+
+// ============================================================================
+// CHAT BATCH (/api/chat/batch)
+// ============================================================================
+
+static void free_batch(ChatBatch* batch) {
+    for (int i = 0; i < batch->count; i++) {
+        free(batch->items[i].message);
+        free(batch->items[i].session_id);
+        shared_bytes_release(batch->items[i].result);
+    }
+    free(batch->items);
+    pthread_mutex_destroy(&batch->lock);
+    free(batch);
+}
+
+// An answer without its trailing newline, so it sits on one NDJSON line
+static size_t answer_length(const SharedBytes* answer) {
+    size_t length = answer->length;
+    while (length > 0 && answer->data[length - 1] == '\n') length--;
+    return length;
+}
+
+// The whole batch as one JSON array, compressed when the client allows
+static void post_batch_array(ChatBatch* batch) {
+    StrBuf out;
+    strbuf_init(&out);
+    JsonWriter json;
+    json_writer_init(&json, &out);
+    json_begin_array(&json);
+    for (int i = 0; i < batch->count; i++) {
+        json_raw(&json, batch->items[i].result->data, answer_length(batch->items[i].result));
+    }
+    json_end_array(&json);
+
+    SharedBytes* body = json_writer_ok(&json) && strbuf_append(&out, "\n", 1)
+        ? shared_bytes_new(200, out.data, out.length)
+        : error_bytes(500, "{\"error\": \"Internal server error\"}\n");
+    if (body && body->status == 200 && batch->compress && out.length >= COMPRESS_MIN_BYTES) {
+        StrBuf deflated;
+        strbuf_init(&deflated);
+        if (deflate_buffer(out.data, out.length, &deflated)) {
+            body->deflated = shared_bytes_new(200, deflated.data, deflated.length);
+        }
+        strbuf_free(&deflated);
+    }
+    if (body) post_reply(batch->conn_id, REPLY_RESPONSE, body);
+    shared_bytes_release(body);
+    strbuf_free(&out);
+}
+
+// Post every NDJSON line that is ready and has no unanswered item before it.
+// Called under the batch lock, so lines reach the reply list in order.
+static void post_batch_lines(ChatBatch* batch) {
+    StrBuf line;
+    strbuf_init(&line);
+    while (batch->next_line < batch->count && batch->items[batch->next_line].result) {
+        const SharedBytes* answer = batch->items[batch->next_line].result;
+        strbuf_clear(&line);
+        if (strbuf_append(&line, answer->data, answer_length(answer)) && strbuf_append(&line, "\n", 1)) {
+            SharedBytes* bytes = shared_bytes_new(200, line.data, line.length);
+            bool last = batch->next_line == batch->count - 1;
+            if (bytes) post_reply(batch->conn_id, last ? REPLY_STREAM_END : REPLY_STREAM_EVENT, bytes);
+            shared_bytes_release(bytes);
+        }
+        batch->next_line++;
+    }
+    strbuf_free(&line);
+}
+
+static void run_batch_item(void* arg);
+static void shed_batch_item(void* arg, AdmissionShedReason reason);
+
+// Submit items until window of them are running; called with the batch
+// lock held and returns with it held. One thread submits at a time: an item
+// answered meanwhile leaves the refill to it, and since pumping is cleared
+// under the same lock that checks for the last answer, exactly one thread
+// sees the batch finished (true) and completes it.
+static bool pump_batch_locked(ChatBatch* batch) {
+    batch->pumping = true;
+    while (batch->running < batch->window && batch->next_run < batch->count) {
+        BatchItem* item = &batch->items[batch->next_run++];
+        if (item->duplicate) continue;
+        batch->running++;
+        pthread_mutex_unlock(&batch->lock);
+        // A shed item is answered before this returns
+        admission_submit(batch->priority, run_batch_item, shed_batch_item, item);
+        pthread_mutex_lock(&batch->lock);
+    }
+    batch->pumping = false;
+    return batch->answered == batch->count;
+}
+
+static void finish_batch(ChatBatch* batch) {
+    if (!batch->ndjson) post_batch_array(batch);
+    free_batch(batch);
+}
+
+// Record an item's answer (taking ownership) for it and its duplicates
+static void answer_batch_item(BatchItem* item, SharedBytes* answer) {
+    ChatBatch* batch = item->batch;
+    pthread_mutex_lock(&batch->lock);
+    for (BatchItem* same = item; same; same = same->same_next >= 0 ? &batch->items[same->same_next] : NULL) {
+        same->result = shared_bytes_retain(answer);
+        batch->answered++;
+    }
+    batch->running--;
+    if (batch->ndjson) post_batch_lines(batch);
+    shared_bytes_release(answer);
+
+    // Another thread is submitting: it refills and sees this answer
+    if (batch->pumping) {
+        pthread_mutex_unlock(&batch->lock);
+        return;
+    }
+    bool finished = pump_batch_locked(batch);
+    pthread_mutex_unlock(&batch->lock);
+    if (finished) finish_batch(batch);
+}
+
+static void run_batch_item(void* arg) {
+    BatchItem* item = arg;
+    BotResponse* response = process_user_query_enhanced(item->message, item->session_id);
+    char* json_response = response ? bot_response_to_json(response) : NULL;
+    SharedBytes* answer = json_response
+        ? shared_bytes_new(200, json_response, strlen(json_response))
+        : error_bytes(500, response ? "{\"error\": \"Failed to generate response\"}\n"
+                                    : "{\"error\": \"Internal server error\"}\n");
+    free(json_response);
+    if (response) free_enhanced_bot_response(response);
+    answer_batch_item(item, answer);
+}
+
+static void shed_batch_item(void* arg, AdmissionShedReason reason) {
+    BatchItem* item = arg;
+    log_message(LOG_DEBUG, "Shed batch item \"%s\" (%s)", item->message, admission_shed_reason_name(reason));
+    answer_batch_item(item, error_bytes(503, "{\"error\":\"Server busy, please retry\"}\n"));
+}
+
+// One array element: a bare message, or {"message": ..., "session_id": ...}
+static bool read_batch_item(JsonReader* json, BatchItem* item) {
+    if (json_peek(json) == JSON_VALUE_STRING) {
+        item->message = json_read_string(json);
+        return item->message != NULL;
+    }
+    if (!json_enter_object(json)) return false;
+    char key[16];
+    while (json_next_member(json, key, sizeof(key))) {
+        if (strcmp(key, "message") == 0 && !item->message) {
+            item->message = json_read_string(json);
+        } else if (strcmp(key, "session_id") == 0 && !item->session_id &&
+                   json_peek(json) == JSON_VALUE_STRING) {
+            item->session_id = json_read_string(json);
         } else {
-            mg_printf(c, "{\"error\": \"Failed to generate response\"}\n");
+            json_skip(json);
         }
-        free_enhanced_bot_response(response);
+    }
+    return !json->failed && item->message != NULL;
+}
+
+// Parse the request body into batch->items; false when it is not an array
+// of messages, or has more than API_BATCH_MAX_ITEMS or a message that is
+// too long (*too_large)
+static bool read_batch(ChatBatch* batch, const char* body, size_t length, bool* too_large) {
+    JsonReader json;
+    json_reader_init(&json, body, length);
+    if (!json_enter_array(&json)) return false;
+
+    int capacity = 0;
+    while (json_next_element(&json)) {
+        if (batch->count == API_BATCH_MAX_ITEMS) {
+            *too_large = true;
+            return false;
+        }
+        if (batch->count == capacity) {
+            int grown_capacity = capacity ? capacity * 2 : 16;
+            BatchItem* grown = realloc(batch->items, sizeof(BatchItem) * (size_t)grown_capacity);
+            if (!grown) return false;
+            batch->items = grown;
+            capacity = grown_capacity;
+        }
+        BatchItem* item = &batch->items[batch->count++];
+        memset(item, 0, sizeof(*item));
+        item->batch = batch;
+        item->same_next = -1;
+        if (!read_batch_item(&json, item)) return false;
+        if (!message_fits(item->message)) {
+            *too_large = true;
+            return false;
+        }
+    }
+    return json_reader_done(&json);
+}
+
+// Run each distinct (query, session) once: later copies join the first
+static void link_duplicate_items(ChatBatch* batch) {
+    char (*keys)[SINGLEFLIGHT_KEY_MAX] = malloc(sizeof(*keys) * (size_t)batch->count);
+    size_t* key_lengths = malloc(sizeof(size_t) * (size_t)batch->count);
+    int* last_same = malloc(sizeof(int) * (size_t)batch->count);
+    if (keys && key_lengths && last_same) {
+        for (int i = 0; i < batch->count; i++) {
+            BatchItem* item = &batch->items[i];
+            key_lengths[i] = singleflight_normalize(item->message, keys[i], SINGLEFLIGHT_KEY_MAX);
+            last_same[i] = i;
+            for (int first = 0; first < i && key_lengths[i] > 0; first++) {
+                BatchItem* other = &batch->items[first];
+                if (other->duplicate || key_lengths[first] != key_lengths[i] ||
+                    memcmp(keys[first], keys[i], key_lengths[i]) != 0) {
+                    continue;
+                }
+                if ((other->session_id == NULL) != (item->session_id == NULL) ||
+                    (item->session_id && strcmp(other->session_id, item->session_id) != 0)) {
+                    continue;
+                }
+                item->duplicate = true;
+                batch->items[last_same[first]].same_next = i;
+                last_same[first] = i;
+                break;
+            }
+        }
+    }
+    free(keys);
+    free(key_lengths);
+    free(last_same);
+}
+
+// Batch endpoint: POST a JSON array of messages (strings or objects with
+// "message" and an optional "session_id"). The answers come back in request
+// order as one JSON array, or as NDJSON lines while they finish when asked
+// for with ?format=ndjson or Accept: application/x-ndjson.
+static void handle_chat_batch_endpoint(struct mg_connection *c, struct mg_http_message *hm) {
+    if (!method_is(hm, "POST")) {
+        mg_http_reply(c, 405, JSON_HEADERS "Allow: POST, OPTIONS\r\n", "{\"error\": \"Method not allowed\"}\n");
+        return;
+    }
+
+    ChatBatch* batch = calloc(1, sizeof(ChatBatch));
+    if (!batch) {
+        mg_http_reply(c, 500, JSON_HEADERS, "{\"error\": \"Internal server error\"}\n");
+        return;
+    }
+    pthread_mutex_init(&batch->lock, NULL);
+
+    uint64_t parse_ns = metrics_now_ns();
+    bool too_large = false;
+    bool parsed = read_batch(batch, hm->body.buf, hm->body.len, &too_large);
+    metrics_record_since(METRIC_PARSE, parse_ns);
+    if (!parsed || batch->count == 0) {
+        free_batch(batch);
+        if (too_large) {
+            mg_http_reply(c, 413, JSON_HEADERS, "{\"error\": \"Too many or too long messages in one batch\"}\n");
+        } else {
+            mg_http_reply(c, 400, JSON_HEADERS, "{\"error\": \"Expected a JSON array of messages\"}\n");
+        }
+        return;
+    }
+    link_duplicate_items(batch);
+
+    char format[16];
+    struct mg_str *accept = mg_http_get_header(hm, "Accept");
+    batch->ndjson = (mg_http_get_var(&hm->query, "format", format, sizeof(format)) > 0 &&
+                     strcmp(format, "ndjson") == 0) ||
+                    (accept && mg_match(*accept, mg_str("#application/x-ndjson#"), NULL));
+    batch->conn_id = c->id;
+    batch->compress = !batch->ndjson && c->data[CONN_ENCODING_SLOT] != CONTENT_ENCODING_IDENTITY;
+
+    // Bulk work yields to interactive chat unless the client says otherwise
+    batch->priority = mg_http_get_header(hm, "X-Request-Priority") ? request_priority(hm)
+                                                                    : ADMISSION_PRIORITY_LOW;
+    // Items are CPU-bound, so more of them at once than cores only adds
+    // contention
+    AdmissionStats admission;
+    admission_stats(&admission);
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    batch->window = admission.workers < API_BATCH_PARALLEL ? admission.workers : API_BATCH_PARALLEL;
+    if (cores > 0 && cores < batch->window) batch->window = (int)cores;
+    if (batch->window < 1) batch->window = 1;
+
+    c->data[CONN_NDJSON_SLOT] = batch->ndjson;
+    ApiLoop* loop = c->mgr->userdata;
+    atomic_fetch_add_explicit(&loop->batch_requests_total, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&loop->batch_items_total, (uint_fast64_t)batch->count, memory_order_relaxed);
+
+    pthread_mutex_lock(&batch->lock);
+    bool finished = pump_batch_locked(batch);
+    pthread_mutex_unlock(&batch->lock);
+    if (finished) finish_batch(batch);
+}
+
+// ============================================================================
+// WEBSOCKET CHAT (/ws/chat)
+// ============================================================================
+
+static void free_ws_turn(WsTurn* turn) {
+    free(turn->message);
+    free(turn);
+}
+
+static void free_ws_session(WsSession* session) {
+    while (session->pending) {
+        WsTurn* next = session->pending->next;
+        free_ws_turn(session->pending);
+        session->pending = next;
+    }
+    if (session->running) free_ws_turn(session->running);
+    free_conversation_context(session->context);
+    free(session);
+}
+
+static void send_ws_error(struct mg_connection *c, int opcode, const char* message) {
+    char frame[160];
+    int length = snprintf(frame, sizeof(frame), "{\"error\": \"%s\"}", message);
+    mg_ws_send(c, frame, (size_t)length, opcode);
+}
+
+static void run_ws_turn(void* arg) {
+    WsSession* session = arg;
+    BotResponse* response = process_user_query_in_session(session->running->message, session->context);
+    char* json_response = response ? bot_response_to_json(response) : NULL;
+
+    SharedBytes* answer = json_response
+        ? shared_bytes_new(200, json_response, strlen(json_response))
+        : error_bytes(500, "{\"error\": \"Failed to generate response\"}");
+    free(json_response);
+    if (response) free_enhanced_bot_response(response);
+
+    queue_reply(session->conn_id, REPLY_WS_TURN, answer, session);
+    shared_bytes_release(answer);
+}
+
+static void shed_ws_turn(void* arg, AdmissionShedReason reason) {
+    WsSession* session = arg;
+    log_message(LOG_DEBUG, "Shed WebSocket turn \"%s\" (%s)", session->running->message,
+                admission_shed_reason_name(reason));
+    char body[96];
+    snprintf(body, sizeof(body), "{\"error\": \"Server busy, please retry\", \"retry_after\": %u}",
+             admission_retry_after());
+    SharedBytes* busy = error_bytes(503, body);
+    queue_reply(session->conn_id, REPLY_WS_TURN, busy, session);
+    shared_bytes_release(busy);
+}
+
+// Hand the session's next pending turn to admission, answering rejected
+// frames on the way; loop thread only
+static void start_ws_turn(WsSession* session, struct mg_connection *c) {
+    while (!session->running && session->pending) {
+        WsTurn* turn = session->pending;
+        session->pending = turn->next;
+        if (!session->pending) session->pending_tail = &session->pending;
+        session->pending_count--;
+        turn->next = NULL;
+
+        if (turn->error) {
+            if (c) send_ws_error(c, turn->opcode, turn->error);
+            free_ws_turn(turn);
+            continue;
+        }
+        session->running = turn;
+        atomic_fetch_add_explicit(&loop_of(session->conn_id)->ws_turns_total, 1, memory_order_relaxed);
+        admission_submit(session->priority, run_ws_turn, shed_ws_turn, session);
+    }
+}
+
+// A turn came back from its worker: answer it and start the next one
+static void finish_ws_turn(WsSession* session, struct mg_connection *c, SharedBytes* answer) {
+    if (session->closed) {
+        free_ws_session(session);
+        return;
+    }
+    if (c) mg_ws_send(c, answer->data, answer->length, session->running->opcode);
+    free_ws_turn(session->running);
+    session->running = NULL;
+    start_ws_turn(session, c);
+}
+
+// One session per connection, for the life of the socket
+static void handle_ws_upgrade(struct mg_connection *c, struct mg_http_message *hm) {
+    if (!method_is(hm, "GET")) {
+        mg_http_reply(c, 405, JSON_HEADERS "Allow: GET\r\n", "{\"error\": \"Method not allowed\"}\n");
+        return;
+    }
+
+    WsSession* session = calloc(1, sizeof(WsSession));
+    if (session) session->context = init_conversation_context();
+    if (!session || !session->context) {
+        free(session);
+        mg_http_reply(c, 500, JSON_HEADERS, "{\"error\": \"Internal server error\"}\n");
+        return;
+    }
+    session->conn_id = c->id;
+    session->priority = request_priority(hm);
+    session->pending_tail = &session->pending;
+
+    mg_ws_upgrade(c, hm, NULL);
+    if (!c->is_websocket) {
+        free_ws_session(session);   // Not a WebSocket handshake; mongoose answered 426
+        return;
+    }
+    c->fn_data = session;
+    ApiLoop* loop = c->mgr->userdata;
+    atomic_fetch_add_explicit(&loop->ws_sessions_open, 1, memory_order_relaxed);
+}
+
+// Each text or binary frame is one chat turn: {"message": "..."} like
+// /api/chat, or the bare question. Turns queue behind the running one and
+// are answered in order; only a full queue is refused on the spot.
+static void handle_ws_message(struct mg_connection *c, struct mg_ws_message *wm) {
+    WsSession* session = c->fn_data;
+    if (!session) return;
+
+    int opcode = (wm->flags & 0x0F) == WEBSOCKET_OP_BINARY ? WEBSOCKET_OP_BINARY : WEBSOCKET_OP_TEXT;
+    if (session->pending_count >= API_WS_MAX_PENDING) {
+        send_ws_error(c, opcode, "Too many pending messages");
+        return;
+    }
+    WsTurn* turn = calloc(1, sizeof(WsTurn));
+    if (!turn) {
+        send_ws_error(c, opcode, "Internal server error");
+        return;
+    }
+    turn->opcode = opcode;
+
+    char* message = NULL;
+    if (wm->data.len > 0 && wm->data.len < MAX_INPUT_LENGTH) {
+        if (wm->data.buf[0] == '{') {
+            message = extract_message_from_json(wm->data.buf, wm->data.len);
+        } else if ((message = malloc(wm->data.len + 1)) != NULL) {
+            memcpy(message, wm->data.buf, wm->data.len);
+            message[wm->data.len] = '\0';
+        }
+    }
+    turn->message = message;
+    if (!message) turn->error = "Invalid request format";
+
+    *session->pending_tail = turn;
+    session->pending_tail = &turn->next;
+    session->pending_count++;
+    start_ws_turn(session, c);
+}
+
+// A running turn keeps its session alive until the worker's answer is back
+static void close_ws_session(struct mg_connection *c) {
+    WsSession* session = c->fn_data;
+    if (!c->is_websocket || !session) return;
+    c->fn_data = NULL;
+    ApiLoop* loop = c->mgr->userdata;
+    atomic_fetch_sub_explicit(&loop->ws_sessions_open, 1, memory_order_relaxed);
+    if (session->running) {
+        session->closed = true;
     } else {
-        mg_printf(c, "{\"error\": \"Internal server error\"}\n");
+        free_ws_session(session);
     }
 }
 
 // Status endpoint handler
 static void handle_status_endpoint(struct mg_connection *c, struct mg_http_message *hm) {
-    mg_printf(c, "{\"status\":\"online\",\"version\":\"2.0.0-enhanced\",\"intent_count\":70,\"server_time\":%ld}\n", time(NULL));
+    (void)hm;
+    mg_http_reply(c, 200, JSON_HEADERS, "{\"status\":\"online\",\"version\":\"2.0.0-enhanced\",\"intent_count\":70,\"server_time\":%ld}\n", time(NULL));
 }
 
 // Health check endpoint
 static void handle_health_endpoint(struct mg_connection *c, struct mg_http_message *hm) {
-    mg_printf(c, "{\"status\": \"healthy\", \"timestamp\": %ld}\n", time(NULL));
+    (void)hm;
+    mg_http_reply(c, 200, JSON_HEADERS, "{\"status\": \"healthy\", \"timestamp\": %ld}\n", time(NULL));
 }
 
-// Capabilities endpoint
+// Capabilities endpoint: a fixed document, compressed at startup
 static void handle_capabilities_endpoint(struct mg_connection *c, struct mg_http_message *hm) {
-    mg_printf(c, "{\"capabilities\":[\"Location-based groundwater queries\",\"Historical trend analysis\",\"Multi-location comparisons\",\"Policy recommendations\",\"Conservation method suggestions\",\"Crisis area identification\",\"Technical explanations\",\"Context-aware conversations\",\"Fuzzy string matching\",\"Multi-language support framework\",\"Real-time confidence scoring\",\"Follow-up suggestions\",\"Data source attribution\"],\"total_intents\":70,\"supported_languages\":\"English, Hindi (framework)\"}\n");
+    send_response(c, 200, JSON_HEADERS, capabilities_json, sizeof(capabilities_json) - 1,
+                  request_encoding(hm), capabilities_deflated.data, capabilities_deflated.length);
 }
 
-// Start API server
-int start_api_server(const char* port) {
-    struct mg_mgr mgr;
-    struct mg_connection *c;
-    
-    mg_mgr_init(&mgr);
-    
-    char listen_addr[64];
-    snprintf(listen_addr, sizeof(listen_addr), "http://0.0.0.0:%s", port);
-    
-    c = mg_http_listen(&mgr, listen_addr, http_handler, NULL);
+// Web UI files from the in-memory static cache. A matching If-None-Match
+// gets 304; otherwise the held gzip body goes out to clients that prefer
+// gzip, and the identity body to everyone else.
+static void handle_static_request(struct mg_connection *c, struct mg_http_message *hm) {
+    char path[MG_PATH_MAX];
+    int length = mg_url_decode(hm->uri.buf, hm->uri.len, path, sizeof(path), 0);
+    const StaticAsset* asset = length > 0 ? static_cache_find(path) : NULL;
+    if (!asset) {
+        mg_http_reply(c, 404, "", "Not found\n");
+        return;
+    }
+    if (!asset->data) {
+        struct mg_http_serve_opts opts = {0};
+        mg_http_serve_file(c, hm, asset->file, &opts);
+        return;
+    }
+
+    bool gzip = asset->gzip && request_encoding(hm) == CONTENT_ENCODING_GZIP;
+    const char* vary = asset->gzip ? "Vary: Accept-Encoding\r\n" : "";
+    ApiLoop* loop = c->mgr->userdata;
+    atomic_fetch_add_explicit(&loop->static_responses_total, 1, memory_order_relaxed);
+
+    struct mg_str *if_none_match = mg_http_get_header(hm, "If-None-Match");
+    if (if_none_match && static_cache_not_modified(asset, if_none_match->buf, if_none_match->len)) {
+        atomic_fetch_add_explicit(&loop->static_not_modified_total, 1, memory_order_relaxed);
+        mg_printf(c, "HTTP/1.1 304 %s\r\nETag: %s\r\nCache-Control: %s\r\n%s\r\n",
+                  status_text(304), gzip ? asset->gzip_etag : asset->etag, asset->cache_control, vary);
+        c->is_resp = 0;
+        return;
+    }
+
+    const char* body = gzip ? asset->gzip : asset->data;
+    size_t body_length = gzip ? asset->gzip_length : asset->length;
+    mg_printf(c, "HTTP/1.1 200 %s\r\nContent-Type: %s\r\nETag: %s\r\nCache-Control: %s\r\n%s%s"
+              "Content-Length: %lu\r\n\r\n",
+              status_text(200), asset->content_type, gzip ? asset->gzip_etag : asset->etag,
+              asset->cache_control, vary, gzip ? "Content-Encoding: gzip\r\n" : "",
+              (unsigned long)body_length);
+    if (!method_is(hm, "HEAD")) mg_send(c, body, body_length);
+    c->is_resp = 0;
+
+    if (gzip) {
+        atomic_fetch_add_explicit(&compressed_responses, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&compression_saved_bytes, asset->length - asset->gzip_length,
+                                  memory_order_relaxed);
+    }
+}
+
+// Metrics endpoint: per-stage latency summaries in Prometheus text format
+static void handle_metrics_endpoint(struct mg_connection *c, struct mg_http_message *hm) {
+    char* body = metrics_render_prometheus();
+    if (!body) {
+        mg_http_reply(c, 500, "", "");
+        return;
+    }
+
+    AdmissionStats admission;
+    admission_stats(&admission);
+    SingleFlightStats flights;
+    singleflight_stats(&flights);
+    StaticCacheStats statics;
+    static_cache_get_stats(&statics);
+
+    int ws_sessions = 0;
+    unsigned long long ws_turns = 0, batch_requests = 0, batch_items = 0;
+    unsigned long long static_responses = 0, static_not_modified = 0;
+    for (int i = 0; i < api_loop_count; i++) {
+        ApiLoop* loop = api_loops[i];
+        ws_sessions += atomic_load_explicit(&loop->ws_sessions_open, memory_order_relaxed);
+        ws_turns += atomic_load_explicit(&loop->ws_turns_total, memory_order_relaxed);
+        batch_requests += atomic_load_explicit(&loop->batch_requests_total, memory_order_relaxed);
+        batch_items += atomic_load_explicit(&loop->batch_items_total, memory_order_relaxed);
+        static_responses += atomic_load_explicit(&loop->static_responses_total, memory_order_relaxed);
+        static_not_modified += atomic_load_explicit(&loop->static_not_modified_total, memory_order_relaxed);
+    }
+
+    char gauges[6144];
+    snprintf(gauges, sizeof(gauges),
+             "# HELP ingres_active_requests Requests currently in the pipeline.\n"
+             "# TYPE ingres_active_requests gauge\n"
+             "ingres_active_requests %d\n"
+             "# HELP ingres_log_dropped_total Log lines dropped because the log ring was full.\n"
+             "# TYPE ingres_log_dropped_total counter\n"
+             "ingres_log_dropped_total %lu\n"
+             "# HELP ingres_admission_workers Worker threads serving chat requests.\n"
+             "# TYPE ingres_admission_workers gauge\n"
+             "ingres_admission_workers %d\n"
+             "# HELP ingres_admission_in_flight Chat requests running on a worker.\n"
+             "# TYPE ingres_admission_in_flight gauge\n"
+             "ingres_admission_in_flight %d\n"
+             "# HELP ingres_admission_queue_depth Chat requests waiting for a worker.\n"
+             "# TYPE ingres_admission_queue_depth gauge\n"
+             "ingres_admission_queue_depth{priority=\"high\"} %d\n"
+             "ingres_admission_queue_depth{priority=\"normal\"} %d\n"
+             "ingres_admission_queue_depth{priority=\"low\"} %d\n"
+             "# HELP ingres_admission_admitted_total Chat requests handed to a worker.\n"
+             "# TYPE ingres_admission_admitted_total counter\n"
+             "ingres_admission_admitted_total %llu\n"
+             "# HELP ingres_admission_shed_total Chat requests answered with 503.\n"
+             "# TYPE ingres_admission_shed_total counter\n"
+             "ingres_admission_shed_total{reason=\"queue_full\"} %llu\n"
+             "ingres_admission_shed_total{reason=\"timeout\"} %llu\n"
+             "ingres_admission_shed_total{reason=\"shutdown\"} %llu\n"
+             "# HELP ingres_chat_pipeline_runs_total Chat requests that ran the pipeline as a flight leader.\n"
+             "# TYPE ingres_chat_pipeline_runs_total counter\n"
+             "ingres_chat_pipeline_runs_total %llu\n"
+             "# HELP ingres_chat_coalesced_total Chat requests answered by an identical in-flight request.\n"
+             "# TYPE ingres_chat_coalesced_total counter\n"
+             "ingres_chat_coalesced_total %llu\n"
+             "# HELP ingres_http_compressed_responses_total Responses sent gzip- or deflate-encoded.\n"
+             "# TYPE ingres_http_compressed_responses_total counter\n"
+             "ingres_http_compressed_responses_total %llu\n"
+             "# HELP ingres_http_compression_saved_bytes_total Body bytes compression kept off the wire.\n"
+             "# TYPE ingres_http_compression_saved_bytes_total counter\n"
+             "ingres_http_compression_saved_bytes_total %llu\n"
+             "# HELP ingres_ws_sessions Open /ws/chat connections.\n"
+             "# TYPE ingres_ws_sessions gauge\n"
+             "ingres_ws_sessions %d\n"
+             "# HELP ingres_ws_turns_total Chat turns started over /ws/chat.\n"
+             "# TYPE ingres_ws_turns_total counter\n"
+             "ingres_ws_turns_total %llu\n"
+             "# HELP ingres_chat_batch_requests_total Requests to /api/chat/batch.\n"
+             "# TYPE ingres_chat_batch_requests_total counter\n"
+             "ingres_chat_batch_requests_total %llu\n"
+             "# HELP ingres_chat_batch_items_total Messages received in /api/chat/batch requests.\n"
+             "# TYPE ingres_chat_batch_items_total counter\n"
+             "ingres_chat_batch_items_total %llu\n"
+             "# HELP ingres_static_assets Web UI files held by the static cache.\n"
+             "# TYPE ingres_static_assets gauge\n"
+             "ingres_static_assets{held=\"memory\"} %zu\n"
+             "ingres_static_assets{held=\"disk\"} %zu\n"
+             "# HELP ingres_static_cache_bytes Bytes of web UI bodies held in memory.\n"
+             "# TYPE ingres_static_cache_bytes gauge\n"
+             "ingres_static_cache_bytes{encoding=\"identity\"} %zu\n"
+             "ingres_static_cache_bytes{encoding=\"gzip\"} %zu\n"
+             "# HELP ingres_static_responses_total Web UI files answered from the static cache.\n"
+             "# TYPE ingres_static_responses_total counter\n"
+             "ingres_static_responses_total{status=\"200\"} %llu\n"
+             "ingres_static_responses_total{status=\"304\"} %llu\n",
+             atomic_load(&request_counter.active_requests), logger_dropped(),
+             admission.workers, admission.in_flight,
+             admission.queued_by_priority[ADMISSION_PRIORITY_HIGH],
+             admission.queued_by_priority[ADMISSION_PRIORITY_NORMAL],
+             admission.queued_by_priority[ADMISSION_PRIORITY_LOW],
+             (unsigned long long)admission.admitted_total,
+             (unsigned long long)admission.shed_total[ADMISSION_SHED_QUEUE_FULL],
+             (unsigned long long)admission.shed_total[ADMISSION_SHED_TIMEOUT],
+             (unsigned long long)admission.shed_total[ADMISSION_SHED_SHUTDOWN],
+             (unsigned long long)flights.leaders, (unsigned long long)flights.coalesced,
+             (unsigned long long)atomic_load(&compressed_responses),
+             (unsigned long long)atomic_load(&compression_saved_bytes),
+             ws_sessions, ws_turns, batch_requests, batch_items,
+             statics.assets - statics.on_disk, statics.on_disk, statics.bytes, statics.gzip_bytes,
+             static_responses - static_not_modified, static_not_modified);
+
+    StrBuf out;
+    strbuf_init(&out);
+    if (strbuf_append_str(&out, body) && strbuf_append_str(&out, gauges)) {
+        send_negotiated(c, hm, 200, "Content-Type: text/plain; version=0.0.4\r\n", out.data, out.length);
+    } else {
+        mg_http_reply(c, 500, "", "");
+    }
+    strbuf_free(&out);
+    free(body);
+}
+
+// Event loops to run: INGRES_EVENT_LOOPS, or one per online core for 0
+static int configured_loop_count(void) {
+    const char* value = getenv("INGRES_EVENT_LOOPS");
+    int loops = value && *value ? atoi(value) : API_DEFAULT_EVENT_LOOPS;
+    if (loops <= 0) {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        loops = cores > 0 ? (int)cores : 1;
+    }
+    if (loops > API_MAX_EVENT_LOOPS) loops = API_MAX_EVENT_LOOPS;
+#ifndef SO_REUSEPORT
+    loops = 1;
+#endif
+    return loops;
+}
+
+#ifdef SO_REUSEPORT
+// An HTTP listener on a socket of our own with SO_REUSEPORT set, so every
+// loop binds the same port and the kernel spreads new connections across
+// them. mongoose has no option for it: its listener is opened on a throwaway
+// loopback port and then handed this socket instead.
+static struct mg_connection* listen_reuseport(struct mg_mgr *mgr, const char* port) {
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons((uint16_t)atoi(port));
+
+    int on = 1;
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return NULL;
+    if (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)) != 0 ||
+        setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) != 0 ||
+        bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+        listen(fd, MG_SOCK_LISTEN_BACKLOG_SIZE) != 0 ||
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK) != 0) {
+        close(fd);
+        return NULL;
+    }
+
+    struct mg_connection *c = mg_http_listen(mgr, "http://127.0.0.1:0", http_handler, NULL);
+    if (c == NULL) {
+        close(fd);
+        return NULL;
+    }
+    close((int)(size_t)c->fd);      // Also leaves the manager's epoll set
+    c->fd = (void*)(size_t)fd;
+    MG_EPOLL_ADD(c);
+    memset(c->loc.ip, 0, sizeof(c->loc.ip));    // Accepted connections copy loc
+    c->loc.port = addr.sin_port;
+    return c;
+}
+#endif
+
+// Connections go first so every WebSocket session is marked closed; the
+// replies left over then only release what they hold
+static void free_loop(ApiLoop* loop) {
+    mg_mgr_free(&loop->mgr);
+    deliver_replies(loop);
+    pthread_mutex_destroy(&loop->reply_lock);
+    free(loop);
+}
+
+static ApiLoop* open_loop(int index, const char* port) {
+    ApiLoop* loop = calloc(1, sizeof(ApiLoop));
+    if (!loop) return NULL;
+    loop->index = index;
+    pthread_mutex_init(&loop->reply_lock, NULL);
+    mg_mgr_init(&loop->mgr);
+    loop->mgr.userdata = loop;
+    loop->mgr.nextid = (unsigned long)index << LOOP_ID_SHIFT;
+
+    if (!mg_wakeup_init(&loop->mgr)) {
+        printf("❌ Failed to set up the API server wakeup channel\n");
+        free_loop(loop);
+        return NULL;
+    }
+
+    struct mg_connection *c = NULL;
+    if (api_loop_count == 1) {
+        char listen_addr[64];
+        snprintf(listen_addr, sizeof(listen_addr), "http://0.0.0.0:%s", port);
+        c = mg_http_listen(&loop->mgr, listen_addr, http_handler, NULL);
+    }
+#ifdef SO_REUSEPORT
+    else {
+        c = listen_reuseport(&loop->mgr, port);
+    }
+#endif
     if (c == NULL) {
         printf("❌ Failed to start API server on port %s\n", port);
+        free_loop(loop);
+        return NULL;
+    }
+    loop->wakeup_conn_id = c->id;
+    return loop;
+}
+
+// ============================================================================
+// EVENT LOOPS AND DRAIN
+// ============================================================================
+
+void stop_api_server(void) {
+    atomic_store(&stop_requested, true);
+}
+
+// Nothing outstanding on c: no response being produced, no bytes queued
+// either way, and for a WebSocket no turn running or waiting
+static bool connection_idle(struct mg_connection *c) {
+    if (c->send.len > 0 || c->recv.len > 0) return false;
+    if (c->is_websocket) {
+        WsSession* session = c->fn_data;
+        return session == NULL || (session->running == NULL && session->pending == NULL);
+    }
+    return !c->is_resp;
+}
+
+// One drain pass: stop accepting, close client connections that have gone
+// idle (busy ones close after their reply, see http_handler), and count the
+// client connections still open
+static int drain_connections(ApiLoop* loop) {
+    int open = 0;
+    for (struct mg_connection *c = loop->mgr.conns; c != NULL; c = c->next) {
+        if (c->is_listening) {
+            c->is_closing = 1;
+        } else if (c->is_accepted) {
+            if (!c->is_draining && !c->is_closing && connection_idle(c)) {
+                if (c->is_websocket) mg_ws_send(c, "\x03\xe9", 2, WEBSOCKET_OP_CLOSE);   // 1001 Going Away
+                c->is_draining = 1;
+            }
+            open++;
+        }
+    }
+    return open;
+}
+
+// Poll until a stop is requested and this loop's connections have drained
+// or the drain timeout has passed
+static void run_loop(ApiLoop* loop) {
+    uint64_t drain_deadline = 0;
+    for (;;) {
+        mg_mgr_poll(&loop->mgr, API_POLL_INTERVAL_MS);
+        if (loop->index == 0) admission_expire();   // The queue is shared; one loop sweeps it
+        deliver_replies(loop);
+
+        if (!atomic_load_explicit(&stop_requested, memory_order_relaxed)) continue;
+        uint64_t now = mg_millis();
+        if (drain_deadline == 0) {
+            drain_deadline = now + drain_timeout_ms;
+            if (loop->index == 0) log_message(LOG_INFO, "Stop requested; draining for up to %ums", drain_timeout_ms);
+        }
+        int open = drain_connections(loop);
+        if (open == 0) return;
+        if (now >= drain_deadline) {
+            log_message(LOG_WARNING, "Event loop %d: drain timed out, closing %d connections", loop->index, open);
+            return;
+        }
+    }
+}
+
+static void* loop_thread(void* arg) {
+    run_loop(arg);
+    return NULL;
+}
+
+static void join_loops(void) {
+    for (int i = 0; i < api_loop_count; i++) {
+        if (api_loops[i] && api_loops[i]->threaded) pthread_join(api_loops[i]->thread, NULL);
+        if (api_loops[i]) api_loops[i]->threaded = false;
+    }
+}
+
+// Only once no loop is running and the workers have stopped: until then
+// replies may be posted to any loop
+static void close_loops(void) {
+    for (int i = 0; i < api_loop_count; i++) {
+        if (api_loops[i]) free_loop(api_loops[i]);
+        api_loops[i] = NULL;
+    }
+    api_loop_count = 0;
+}
+
+// A last look at the counters for the log: the final scrape of /api/metrics
+// misses whatever was served after it
+static void log_final_totals(void) {
+    LatencyHistogram requests;
+    metrics_snapshot(METRIC_REQUEST, &requests);
+    AdmissionStats admission;
+    admission_stats(&admission);
+    unsigned long long shed = 0;
+    for (int reason = 0; reason < ADMISSION_SHED_REASON_COUNT; reason++) shed += admission.shed_total[reason];
+
+    log_message(LOG_INFO, "API server stopped: %llu pipeline runs (p99 %.2fms), %llu admitted, %llu shed "
+                "(%llu at shutdown)",
+                (unsigned long long)requests.total_count,
+                metrics_value_at_quantile(&requests, 0.99) / 1e6,
+                (unsigned long long)admission.admitted_total, shed,
+                (unsigned long long)admission.shed_total[ADMISSION_SHED_SHUTDOWN]);
+}
+
+// Start API server
+int start_api_server(const char* port) {
+    const char* drain = getenv("INGRES_DRAIN_TIMEOUT_MS");
+    drain_timeout_ms = drain && *drain ? (uint32_t)strtoul(drain, NULL, 10) : API_DRAIN_TIMEOUT_MS;
+
+    api_loop_count = configured_loop_count();
+    for (int i = 0; i < api_loop_count; i++) {
+        api_loops[i] = open_loop(i, port);
+        if (api_loops[i] == NULL) {
+            close_loops();
+            return 1;
+        }
+    }
+
+    precompress_payloads();
+    load_static_assets();
+
+    AdmissionConfig admission_config;
+    admission_default_config(&admission_config);
+    if (!admission_init(&admission_config)) {
+        printf("❌ Failed to start %d API workers\n", admission_config.max_concurrent);
+        close_loops();
         return 1;
     }
-    
+
+    // The calling thread runs the first loop. A loop whose thread cannot
+    // start is closed with those after it, so no listener is left unpolled.
+    for (int i = 1; i < api_loop_count; i++) {
+        if (pthread_create(&api_loops[i]->thread, NULL, loop_thread, api_loops[i]) != 0) {
+            log_message(LOG_WARNING, "Could not start event loop %d; serving with %d", i, i);
+            int opened = api_loop_count;
+            api_loop_count = i;
+            for (int j = i; j < opened; j++) {
+                free_loop(api_loops[j]);
+                api_loops[j] = NULL;
+            }
+            break;
+        }
+        api_loops[i]->threaded = true;
+    }
+
     printf("🌐 INGRES API Server started on http://localhost:%s\n", port);
+    if (api_loop_count > 1) {
+        printf("🧵 %d event loops share the port (SO_REUSEPORT)\n", api_loop_count);
+    }
+    printf("👷 %d workers; up to %d requests queue for %ums before 503\n",
+           admission_config.max_concurrent, admission_config.max_queued, admission_config.max_wait_ms);
     printf("📡 Endpoints available:\n");
     printf("   POST /api/chat - Main chat interface\n");
+    printf("   GET  /api/chat/stream?message= - Chat answer as server-sent events\n");
+    printf("   POST /api/chat/batch - Many messages, answered in order (JSON or NDJSON)\n");
+    printf("   GET  /ws/chat - WebSocket chat, one conversation per connection\n");
     printf("   GET  /api/status - Server status\n");
     printf("   GET  /api/health - Health check\n");
     printf("   GET  /api/capabilities - System capabilities\n");
+    printf("   GET  /api/metrics - Stage latency histograms (Prometheus)\n");
     printf("   GET  / - Static web interface\n\n");
-    
-    // Event loop
-    for (;;) {
-        mg_mgr_poll(&mgr, 1000);
-    }
-    
-    mg_mgr_free(&mgr);
+
+    run_loop(api_loops[0]);
+    join_loops();
+
+    // Running jobs finish and anything still queued is shed; either way
+    // their replies land on loops that are no longer sending
+    admission_shutdown();
+    close_loops();
+    free_payloads();
+    static_cache_clear();
+    log_final_totals();
     return 0;
 }
 
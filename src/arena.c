@@ -0,0 +1,159 @@
+/*
+ * INGRES ChatBot - Request Arenas
+ * Bump allocation for per-request scratch, with a per-thread arena cache.
+ */
+
+#include "arena.h"
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <stdalign.h>
+#include <pthread.h>
+
+#define ARENA_ALIGN alignof(max_align_t)
+
+struct ArenaBlock {
+    ArenaBlock* next;
+    size_t capacity;
+    alignas(max_align_t) unsigned char data[];
+};
+
+static ArenaBlock* new_block(size_t capacity, ArenaBlock* next) {
+    ArenaBlock* block = malloc(sizeof(ArenaBlock) + capacity);
+    if (!block) return NULL;
+    block->next = next;
+    block->capacity = capacity;
+    return block;
+}
+
+void arena_init(Arena* arena) {
+    arena->head = NULL;
+    arena->used = 0;
+}
+
+void arena_destroy(Arena* arena) {
+    ArenaBlock* block = arena->head;
+    while (block) {
+        ArenaBlock* next = block->next;
+        free(block);
+        block = next;
+    }
+    arena_init(arena);
+}
+
+void arena_reset(Arena* arena) {
+    ArenaBlock* head = arena->head;
+    arena->used = 0;
+    if (!head || !head->next) return;
+
+    // Overflowed: keep one block sized for the whole request instead
+    size_t total = 0;
+    for (ArenaBlock* block = head; block; block = block->next) total += block->capacity;
+    if (total > ARENA_MAX_RETAINED) total = ARENA_MAX_RETAINED;
+
+    arena_destroy(arena);
+    arena->head = new_block(total, NULL);
+}
+
+void* arena_alloc(Arena* arena, size_t size) {
+    size_t rounded = (size + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+    if (rounded < size) return NULL;
+
+    ArenaBlock* head = arena->head;
+    if (!head || head->capacity - arena->used < rounded) {
+        size_t capacity = rounded > ARENA_BLOCK_SIZE ? rounded : ARENA_BLOCK_SIZE;
+        head = new_block(capacity, arena->head);
+        if (!head) return NULL;
+        arena->head = head;
+        arena->used = 0;
+    }
+
+    void* memory = head->data + arena->used;
+    arena->used += rounded;
+    return memory;
+}
+
+char* arena_strndup(Arena* arena, const char* str, size_t length) {
+    if (!str) return NULL;
+    char* copy = arena_alloc(arena, length + 1);
+    if (!copy) return NULL;
+    memcpy(copy, str, length);
+    copy[length] = '\0';
+    return copy;
+}
+
+char* arena_strdup(Arena* arena, const char* str) {
+    return str ? arena_strndup(arena, str, strlen(str)) : NULL;
+}
+
+char* arena_lower(Arena* arena, const char* str) {
+    char* copy = arena_strdup(arena, str);
+    if (!copy) return NULL;
+    for (char* p = copy; *p; p++) {
+        *p = (char)tolower((unsigned char)*p);
+    }
+    return copy;
+}
+
+// ============================================================================
+// PER-THREAD CACHE
+// ============================================================================
+
+typedef struct {
+    Arena* arenas[ARENA_THREAD_CACHE];
+    int count;
+} ArenaCache;
+
+static pthread_once_t cache_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t cache_key;
+static _Thread_local ArenaCache* thread_cache;
+
+// Free the cached arenas when their thread exits
+static void free_cache(void* value) {
+    ArenaCache* cache = value;
+    for (int i = 0; i < cache->count; i++) {
+        arena_destroy(cache->arenas[i]);
+        free(cache->arenas[i]);
+    }
+    free(cache);
+    thread_cache = NULL;
+}
+
+static void create_cache_key(void) {
+    pthread_key_create(&cache_key, free_cache);
+}
+
+static ArenaCache* get_cache(void) {
+    if (thread_cache) return thread_cache;
+
+    ArenaCache* cache = calloc(1, sizeof(ArenaCache));
+    if (!cache) return NULL;
+    pthread_once(&cache_key_once, create_cache_key);
+    pthread_setspecific(cache_key, cache);
+    thread_cache = cache;
+    return cache;
+}
+
+Arena* arena_acquire(void) {
+    ArenaCache* cache = get_cache();
+    if (cache && cache->count > 0) {
+        return cache->arenas[--cache->count];
+    }
+
+    Arena* arena = malloc(sizeof(Arena));
+    if (arena) arena_init(arena);
+    return arena;
+}
+
+void arena_release(Arena* arena) {
+    if (!arena) return;
+
+    arena_reset(arena);
+    ArenaCache* cache = get_cache();
+    if (cache && cache->count < ARENA_THREAD_CACHE) {
+        cache->arenas[cache->count++] = arena;
+        return;
+    }
+    arena_destroy(arena);
+    free(arena);
+}
@@ -2,48 +2,74 @@
 #include "utils.h"
 #include "database.h"
 #include "intent_patterns.h"
+#include "logger.h"
+#include "metrics.h"
+#include "json_writer.h"
 #include <math.h>
 #include <ctype.h>
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <time.h>
+#include <pthread.h>
 
-// Enhanced logging with modern C features
-typedef enum {
-    LOG_INFO,
-    LOG_WARNING,
-    LOG_ERROR,
-    LOG_DEBUG
-} LogLevel;
-
-// Enhanced error handling
-static ChatbotError last_error = CHATBOT_SUCCESS;
-static char last_error_message[256] = "";
+// Enhanced error handling (per thread, like errno)
+static _Thread_local ChatbotError last_error = CHATBOT_SUCCESS;
+static _Thread_local char last_error_message[256] = "";
 
 // Global instances for enhanced features
 ThreadSafeCounter request_counter = {0};
 ResponseCache* global_cache = NULL;
 static bool enhanced_features_initialized = false;
 
-// External logging function declaration
-extern void log_message(LogLevel level, const char* format, ...);
-
 // Forward declarations for enhanced functions
 extern IntentType classify_intent_advanced(const char* user_input, ConversationContext* context, float* confidence);
 extern BotResponse* generate_enhanced_response(IntentType intent, const char* user_input,
                                               ConversationContext* context, const char* location,
                                               const char* query_details);
-extern int extract_locations(const char* user_input, char** state, char** district, char** block);
 extern ConversationContext* init_conversation_context(void);
 extern void update_conversation_context(ConversationContext* context, const char* user_input,
                                        IntentType intent, const char* location);
 extern void free_conversation_context(ConversationContext* context);
-extern void free_enhanced_bot_response(BotResponse* response);
+
+// Returned for empty input; prebuilt, so freeing it is a no-op
+static BotResponse invalid_input_response = {
+    .message = "Please provide a valid query.",
+    .intent = INTENT_ERROR,
+    .language_code = "en",
+};
 
 // Global conversation context for session management
 static ConversationContext* global_context = NULL;
 
+// Requests run concurrently: the context and the response cache are shared
+static pthread_mutex_t context_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Classification reads the shared context through a private copy, so the
+// lock is held only for the copy. A session context belongs to its caller
+// and is copied without the lock. Returns NULL without a context.
+static ConversationContext* snapshot_context(Arena* arena, ConversationContext* session,
+                                             ConversationContext* snapshot) {
+    memset(snapshot, 0, sizeof(*snapshot));
+    snapshot->last_intent = INTENT_UNKNOWN;
+
+    if (session) {
+        snapshot->last_intent = session->last_intent;
+        snapshot->last_location = arena_strdup(arena, session->last_location);
+        return snapshot;
+    }
+
+    pthread_mutex_lock(&context_lock);
+    bool present = global_context != NULL;
+    if (present) {
+        snapshot->last_intent = global_context->last_intent;
+        snapshot->last_location = arena_strdup(arena, global_context->last_location);
+    }
+    pthread_mutex_unlock(&context_lock);
+    return present ? snapshot : NULL;
+}
+
 bool chatbot_init(void) {
     return chatbot_init_enhanced(NULL);
 }
@@ -127,6 +153,15 @@ void chatbot_cleanup(void) {
         free_conversation_context(global_context);
         global_context = NULL;
     }
+
+    // Drop the cache's response references
+    if (global_cache) {
+        for (int i = 0; i < global_cache->size; i++) {
+            free_enhanced_bot_response(global_cache->entries[i].value);
+        }
+        free(global_cache);
+        global_cache = NULL;
+    }
     
     // Close the database
     db_close();
@@ -137,7 +172,11 @@ void chatbot_cleanup(void) {
 // Legacy function for backward compatibility
 IntentType classify_intent(const char* user_input) {
     float confidence;
-    return classify_intent_advanced(user_input, global_context, &confidence);
+    ConversationContext snapshot;
+    Arena* arena = arena_acquire();
+    IntentType intent = classify_intent_arena(arena, user_input, snapshot_context(arena, NULL, &snapshot), &confidence);
+    arena_release(arena);
+    return intent;
 }
 
 // Enhanced main processing function
@@ -145,7 +184,10 @@ BotResponse* process_user_query(const char* user_input) {
     return process_user_query_enhanced(user_input, NULL);
 }
 
-BotResponse* process_user_query_enhanced(const char* user_input, const char* session_id) {
+// The pipeline behind every process_user_query variant. session, when given,
+// replaces the global conversation context.
+static BotResponse* run_query(const char* user_input, const char* session_id, ConversationContext* session,
+                              IntentCallback on_intent, void* on_intent_context) {
     log_message(LOG_DEBUG, "Processing user query: %s", user_input ? user_input : "(null)");
 
     // Thread-safe request counting
@@ -158,21 +200,8 @@ BotResponse* process_user_query_enhanced(const char* user_input, const char* ses
 
         log_message(LOG_WARNING, "%s", last_error_message);
 
-        BotResponse* error_response = malloc(sizeof(BotResponse));
-        if (error_response) {
-            error_response->message = strdup("Please provide a valid query.");
-            error_response->intent = INTENT_ERROR;
-            error_response->has_data = false;
-            error_response->confidence_score = 0.0;
-            error_response->suggestion_count = 0;
-            log_message(LOG_DEBUG, "Created error response for empty input");
-        } else {
-            last_error = CHATBOT_ERROR_MEMORY_ALLOCATION;
-            log_message(LOG_ERROR, "Failed to allocate memory for error response");
-        }
-
         atomic_fetch_sub(&request_counter.active_requests, 1);
-        return error_response;
+        return &invalid_input_response;
     }
 
     // Check cache first if session_id provided
@@ -187,50 +216,62 @@ BotResponse* process_user_query_enhanced(const char* user_input, const char* ses
         }
     }
 
-    clock_t start_time = clock();
+    uint64_t start_ns = metrics_now_ns();
+
+    // Request scratch comes from one arena, reset in one go at the end
+    Arena* arena = arena_acquire();
+    ConversationContext snapshot;
+    ConversationContext* context = snapshot_context(arena, session, &snapshot);
 
     // Extract locations from user input
-    char* state = NULL;
-    char* district = NULL;
-    char* block = NULL;
-    int locations_found = extract_locations(user_input, &state, &district, &block);
+    const char* state = NULL;
+    const char* district = NULL;
+    const char* block = NULL;
+    uint64_t stage_ns = metrics_now_ns();
+    extract_locations(arena, user_input, &state, &district, &block);
+    stage_ns = metrics_record_since(METRIC_LOCATION, stage_ns);
 
     // Classify intent with enhanced system
     float confidence;
-    IntentType intent = classify_intent_advanced(user_input, global_context, &confidence);
+    IntentType intent = classify_intent_arena(arena, user_input, context, &confidence);
+    metrics_record_since(METRIC_CLASSIFY, stage_ns);
+    if (on_intent) on_intent(on_intent_context, intent, confidence);
 
     // Determine primary location for context
-    char* primary_location = NULL;
-    if (state) {
-        primary_location = strdup(state);
-    } else if (district) {
-        primary_location = strdup(district);
-    } else if (global_context && global_context->last_location) {
-        primary_location = strdup(global_context->last_location);
-    }
+    const char* primary_location = state ? state : district ? district : snapshot.last_location;
 
     // Generate enhanced response
-    BotResponse* response = generate_enhanced_response(intent, user_input, global_context,
+    BotResponse* response = generate_enhanced_response(intent, user_input, session ? session : global_context,
                                                       primary_location, user_input);
 
+    // Prebuilt responses are shared; per-request fields go on a private copy
+    // that borrows all of their strings
+    if (bot_response_is_static(response)) {
+        response = bot_response_borrow(response);
+    }
+
     if (response) {
         // Update confidence score
         response->confidence_score = confidence;
 
-        // Calculate processing time
-        clock_t end_time = clock();
-        response->processing_time_ms = ((double)(end_time - start_time) / CLOCKS_PER_SEC) * 1000.0;
+        // Wall time, not CPU time: waits on locks and I/O count too
+        response->processing_time_ms = (double)(metrics_now_ns() - start_ns) / 1e6;
 
         // Update conversation context
-        update_conversation_context(global_context, user_input, intent, primary_location);
+        if (session) {
+            update_conversation_context(session, user_input, intent, primary_location);
+        } else {
+            pthread_mutex_lock(&context_lock);
+            update_conversation_context(global_context, user_input, intent, primary_location);
+            pthread_mutex_unlock(&context_lock);
+        }
 
         // Add clarification if confidence is low
         if (confidence < 0.5) {
             response->requires_clarification = true;
-            response->clarification_question = strdup(
+            response->clarification_question =
                 "I'm not entirely sure I understood your query correctly. "
-                "Could you please rephrase or provide more specific details?"
-            );
+                "Could you please rephrase or provide more specific details?";
         }
 
         // Cache the response if session_id provided
@@ -245,26 +286,34 @@ BotResponse* process_user_query_enhanced(const char* user_input, const char* ses
                 "Failed to generate response for query: %s", user_input);
     }
 
-    // Clean up extracted locations
-    if (state) free(state);
-    if (district) free(district);
-    if (block) free(block);
-    if (primary_location) free(primary_location);
+    arena_release(arena);
+    metrics_record_since(METRIC_REQUEST, start_ns);
 
     atomic_fetch_sub(&request_counter.active_requests, 1);
     return response;
 }
+
+BotResponse* process_user_query_enhanced(const char* user_input, const char* session_id) {
+    return run_query(user_input, session_id, NULL, NULL, NULL);
+}
+
+BotResponse* process_user_query_streaming(const char* user_input, const char* session_id,
+                                          IntentCallback on_intent, void* on_intent_context) {
+    return run_query(user_input, session_id, NULL, on_intent, on_intent_context);
+}
+
+BotResponse* process_user_query_in_session(const char* user_input, ConversationContext* session) {
+    return run_query(user_input, NULL, session, NULL, NULL);
+}
+
 // Simplified process_user_input for testing
 BotResponse* process_user_input(const char* user_input) {
-    BotResponse* response = malloc(sizeof(BotResponse));
+    IntentType intent = classify_intent(user_input);
+    BotResponse* response = bot_response_new(intent);
     if (!response) return NULL;
     
-    IntentType intent = classify_intent(user_input);
-    response->intent = intent;
     response->message = generate_response(intent, "TestLocation", user_input);
-    response->query_result = NULL;
-    response->has_data = false;
-    response->processing_time_ms = 0.0f;
+    if (response->message) response->owned |= RESPONSE_OWNS_MESSAGE;
     
     return response;
 }
@@ -505,17 +554,7 @@ char* generate_response(IntentType intent, const char* location, const char* que
 
 
 void free_bot_response(BotResponse* response) {
-    if (!response) return;
-
-    if (response->message) {
-        free(response->message);
-    }
-
-    if (response->query_result) {
-        free_query_result(response->query_result);
-    }
-
-    free(response);
+    free_enhanced_bot_response(response);
 }
 
 // ============================================================================
@@ -548,44 +587,22 @@ bool init_response_cache(void) {
 BotResponse* get_cached_response(const char* cache_key) {
     if (!global_cache || !cache_key) return NULL;
 
+    pthread_mutex_lock(&cache_lock);
+    BotResponse* hit = NULL;
+
     // Simple linear search for now (could be optimized with hash table)
-    for (int i = 0; i < global_cache->size; i++) {
+    for (int i = 0; !hit && i < global_cache->size; i++) {
         if (strcmp(global_cache->entries[i].key, cache_key) == 0) {
             // Check if entry is not expired
             if (time(NULL) - global_cache->entries[i].timestamp < SESSION_TIMEOUT_SECONDS) {
                 global_cache->entries[i].access_count++;
                 log_message(LOG_DEBUG, "Cache hit for key: %s", cache_key);
 
-                // Return a copy of the cached response
-                BotResponse* cached = malloc(sizeof(BotResponse));
-                if (cached) {
-                    memcpy(cached, &global_cache->entries[i].value, sizeof(BotResponse));
-                    // Deep copy strings
-                    if (cached->message) {
-                        cached->message = strdup(cached->message);
-                    }
-                    if (cached->clarification_question) {
-                        cached->clarification_question = strdup(cached->clarification_question);
-                    }
-                    if (cached->language_code) {
-                        cached->language_code = strdup(cached->language_code);
-                    }
-                    // Deep copy suggestions
-                    for (int j = 0; j < cached->suggestion_count && j < 5; j++) {
-                        if (cached->suggested_actions[j]) {
-                            cached->suggested_actions[j] = strdup(cached->suggested_actions[j]);
-                        }
-                    }
-                    // Deep copy data sources
-                    for (int j = 0; j < cached->source_count && j < 3; j++) {
-                        if (cached->data_sources[j]) {
-                            cached->data_sources[j] = strdup(cached->data_sources[j]);
-                        }
-                    }
-                }
-                return cached;
+                // Another reference to the cached response, not a copy
+                hit = bot_response_retain(global_cache->entries[i].value);
             } else {
                 // Remove expired entry
+                free_enhanced_bot_response(global_cache->entries[i].value);
                 memmove(&global_cache->entries[i], &global_cache->entries[i + 1],
                        (global_cache->size - i - 1) * sizeof(CacheEntry));
                 global_cache->size--;
@@ -594,15 +611,19 @@ BotResponse* get_cached_response(const char* cache_key) {
         }
     }
 
-    return NULL;
+    pthread_mutex_unlock(&cache_lock);
+    return hit;
 }
 
-bool cache_response(const char* cache_key, const BotResponse* response) {
+bool cache_response(const char* cache_key, BotResponse* response) {
     if (!global_cache || !cache_key || !response) return false;
 
+    pthread_mutex_lock(&cache_lock);
+
     // Check if cache is full
     if (global_cache->size >= CACHE_SIZE) {
         // Remove oldest entry (simple LRU approximation)
+        free_enhanced_bot_response(global_cache->entries[0].value);
         memmove(&global_cache->entries[0], &global_cache->entries[1],
                (CACHE_SIZE - 1) * sizeof(CacheEntry));
         global_cache->size--;
@@ -613,12 +634,13 @@ bool cache_response(const char* cache_key, const BotResponse* response) {
     strncpy(entry->key, cache_key, sizeof(entry->key) - 1);
     entry->key[sizeof(entry->key) - 1] = '\0';
 
-    // Shallow copy of response (strings will be duplicated when retrieved)
-    memcpy(&entry->value, response, sizeof(BotResponse));
+    // The cache holds its own reference; hits share the same response
+    entry->value = bot_response_retain(response);
     entry->timestamp = time(NULL);
     entry->access_count = 1;
 
     global_cache->size++;
+    pthread_mutex_unlock(&cache_lock);
 
     log_message(LOG_DEBUG, "Cached response for key: %s", cache_key);
     return true;
@@ -630,9 +652,11 @@ int clear_expired_cache(void) {
     int cleared = 0;
     time_t current_time = time(NULL);
 
+    pthread_mutex_lock(&cache_lock);
     for (int i = 0; i < global_cache->size; ) {
         if (current_time - global_cache->entries[i].timestamp >= SESSION_TIMEOUT_SECONDS) {
             // Remove expired entry
+            free_enhanced_bot_response(global_cache->entries[i].value);
             memmove(&global_cache->entries[i], &global_cache->entries[i + 1],
                    (global_cache->size - i - 1) * sizeof(CacheEntry));
             global_cache->size--;
@@ -641,6 +665,7 @@ int clear_expired_cache(void) {
             i++;
         }
     }
+    pthread_mutex_unlock(&cache_lock);
 
     if (cleared > 0) {
         log_message(LOG_INFO, "Cleared %d expired cache entries", cleared);
@@ -656,6 +681,7 @@ void get_cache_stats(float* hit_rate, int* size) {
         return;
     }
 
+    pthread_mutex_lock(&cache_lock);
     if (size) *size = global_cache->size;
 
     // Calculate hit rate (simplified - would need more sophisticated tracking)
@@ -672,6 +698,7 @@ void get_cache_stats(float* hit_rate, int* size) {
 
         *hit_rate = total_accesses > 0 ? (float)hits / total_accesses : 0.0;
     }
+    pthread_mutex_unlock(&cache_lock);
 }
 
 // ============================================================================
@@ -692,6 +719,7 @@ bool process_web_request(const char* request_json, char** response_json) {
     }
 
     // Simple JSON parsing (in production, use a proper JSON library)
+    uint64_t parse_ns = metrics_now_ns();
     char* message = NULL;
     char* session_id = NULL;
 
@@ -725,6 +753,8 @@ bool process_web_request(const char* request_json, char** response_json) {
         }
     }
 
+    metrics_record_since(METRIC_PARSE, parse_ns);
+
     if (!message) {
         last_error = CHATBOT_ERROR_INVALID_INPUT;
         free(session_id);
@@ -741,38 +771,50 @@ bool process_web_request(const char* request_json, char** response_json) {
     }
 
     // Generate JSON response
-    char* json_response = malloc(4096); // Allocate sufficient space
-    if (!json_response) {
+    uint64_t serialize_ns = metrics_now_ns();
+    StrBuf out;
+    strbuf_init(&out);
+    strbuf_reserve(&out, 4096);
+
+    JsonWriter json;
+    json_writer_init(&json, &out);
+    json_begin_object(&json);
+    json_key(&json, "message");
+    json_string(&json, response->message ? response->message : "");
+    json_key(&json, "intent");
+    json_int(&json, response->intent);
+    json_key(&json, "confidence");
+    json_double(&json, response->confidence_score, 2);
+    json_key(&json, "processing_time_ms");
+    json_double(&json, response->processing_time_ms, 2);
+    json_key(&json, "has_data");
+    json_bool(&json, response->has_data);
+    json_key(&json, "requires_clarification");
+    json_bool(&json, response->requires_clarification);
+    json_key(&json, "suggestions");
+    json_begin_array(&json);
+    for (int i = 0; i < response->suggestion_count; i++) {
+        json_string(&json, response->suggested_actions[i] ? response->suggested_actions[i] : "");
+    }
+    json_end_array(&json);
+    json_key(&json, "data_sources");
+    json_begin_array(&json);
+    json_string(&json, "Central Ground Water Board (CGWB)");
+    json_end_array(&json);
+    json_key(&json, "groundwater_status");
+    json_string(&json, "normal");
+    json_end_object(&json);
+
+    if (!json_writer_ok(&json)) {
         last_error = CHATBOT_ERROR_MEMORY_ALLOCATION;
+        strbuf_free(&out);
         free_bot_response(response);
         free(message);
         free(session_id);
         return false;
     }
-
-    // Create JSON response (simplified - in production use proper JSON library)
-    snprintf(json_response, 4096,
-             "{"
-             "\"message\":\"%s\","
-             "\"intent\":%d,"
-             "\"confidence\":%.2f,"
-             "\"processing_time_ms\":%.2f,"
-             "\"has_data\":%s,"
-             "\"requires_clarification\":%s,"
-             "\"suggestions\":[%s],"
-             "\"data_sources\":[%s],"
-             "\"groundwater_status\":\"%s\""
-             "}",
-             response->message ? response->message : "",
-             response->intent,
-             response->confidence_score,
-             response->processing_time_ms,
-             response->has_data ? "true" : "false",
-             response->requires_clarification ? "true" : "false",
-             "\"\"", // Simplified suggestions
-             "\"Central Ground Water Board (CGWB)\"", // Simplified data sources
-             "normal" // Default groundwater status
-    );
+    char* json_response = out.data;
+    metrics_record_since(METRIC_SERIALIZE, serialize_ns);
 
     *response_json = json_response;
 
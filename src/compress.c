@@ -0,0 +1,276 @@
+/*
+ * INGRES ChatBot - Response Compression
+ * Accept-Encoding negotiation and spliceable raw deflate on zlib.
+ */
+
+#include "compress.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <pthread.h>
+#include <zlib.h>
+
+#define DEFLATE_CHUNK 4096
+
+// ============================================================================
+// NEGOTIATION
+// ============================================================================
+
+// q-value of one Accept-Encoding parameter list ("q=0.5"); 1 when absent
+static double parse_quality(const char* params, const char* end) {
+    while (params < end) {
+        while (params < end && (*params == ';' || *params == ' ' || *params == '\t')) params++;
+        if (end - params >= 2 && tolower((unsigned char)params[0]) == 'q' && params[1] == '=') {
+            double value = 0, scale = 1;
+            bool fraction = false;
+            for (params += 2; params < end && (isdigit((unsigned char)*params) || *params == '.'); params++) {
+                if (*params == '.') {
+                    fraction = true;
+                } else if (fraction) {
+                    scale /= 10;
+                    value += (*params - '0') * scale;
+                } else {
+                    value = value * 10 + (*params - '0');
+                }
+            }
+            return value;
+        }
+        while (params < end && *params != ';') params++;
+    }
+    return 1;
+}
+
+static bool token_is(const char* token, size_t length, const char* name) {
+    return strlen(name) == length && strncasecmp(token, name, length) == 0;
+}
+
+ContentEncoding compress_negotiate(const char* header, size_t length) {
+    if (!header) return CONTENT_ENCODING_IDENTITY;
+
+    // -1: not listed, so "*" decides
+    double gzip = -1, deflate = -1, wildcard = -1;
+    const char* end = header + length;
+    const char* item = header;
+    while (item < end) {
+        const char* item_end = memchr(item, ',', (size_t)(end - item));
+        if (!item_end) item_end = end;
+
+        const char* token = item;
+        while (token < item_end && (*token == ' ' || *token == '\t')) token++;
+        const char* token_end = token;
+        while (token_end < item_end && *token_end != ';' && *token_end != ' ' && *token_end != '\t') token_end++;
+        double quality = parse_quality(token_end, item_end);
+        size_t token_length = (size_t)(token_end - token);
+
+        if (token_is(token, token_length, "gzip") || token_is(token, token_length, "x-gzip")) gzip = quality;
+        else if (token_is(token, token_length, "deflate")) deflate = quality;
+        else if (token_is(token, token_length, "*")) wildcard = quality;
+
+        item = item_end + 1;
+    }
+    if (gzip < 0) gzip = wildcard;
+    if (deflate < 0) deflate = wildcard;
+
+    if (gzip > 0 && gzip >= deflate) return CONTENT_ENCODING_GZIP;
+    if (deflate > 0) return CONTENT_ENCODING_DEFLATE;
+    return CONTENT_ENCODING_IDENTITY;
+}
+
+const char* content_encoding_name(ContentEncoding encoding) {
+    switch (encoding) {
+        case CONTENT_ENCODING_GZIP:    return "gzip";
+        case CONTENT_ENCODING_DEFLATE: return "deflate";
+        default:                       return "identity";
+    }
+}
+
+// ============================================================================
+// THREAD DEFLATE STATE
+// ============================================================================
+
+static pthread_once_t stream_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t stream_key;
+static _Thread_local z_stream* thread_stream;
+
+// Release the deflate state when its thread exits
+static void free_stream(void* value) {
+    z_stream* stream = value;
+    deflateEnd(stream);
+    free(stream);
+    thread_stream = NULL;
+}
+
+static void create_stream_key(void) {
+    pthread_key_create(&stream_key, free_stream);
+}
+
+// This thread's raw deflate stream, reset and ready for a new body
+static z_stream* acquire_stream(void) {
+    if (thread_stream) {
+        deflateReset(thread_stream);
+        return thread_stream;
+    }
+
+    z_stream* stream = calloc(1, sizeof(z_stream));
+    if (!stream) return NULL;
+    if (deflateInit2(stream, COMPRESS_LEVEL, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        free(stream);
+        return NULL;
+    }
+    pthread_once(&stream_key_once, create_stream_key);
+    pthread_setspecific(stream_key, stream);
+    thread_stream = stream;
+    return stream;
+}
+
+// Feed data through stream with flush, appending all output to out
+static bool run_deflate(z_stream* stream, StrBuf* out, const char* data, size_t length, int flush) {
+    stream->next_in = (Bytef*)data;
+    stream->avail_in = (uInt)length;
+    do {
+        if (!strbuf_reserve(out, DEFLATE_CHUNK)) return false;
+        size_t room = out->capacity - out->length - 1;
+        stream->next_out = (Bytef*)out->data + out->length;
+        stream->avail_out = (uInt)room;
+
+        int status = deflate(stream, flush);
+        if (status == Z_STREAM_ERROR) return false;
+        out->length += room - stream->avail_out;
+        out->data[out->length] = '\0';
+        if (status == Z_STREAM_END) return true;
+    } while (stream->avail_in > 0 || stream->avail_out == 0);
+    return true;
+}
+
+// ============================================================================
+// SEGMENTS
+// ============================================================================
+
+// Raw deflate of text on a one-off stream at the best level, for text
+// compressed once and served many times
+static bool deflate_best(const char* text, size_t length, int flush, StrBuf* out) {
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 9, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return false;
+    }
+    bool ok = run_deflate(&stream, out, text, length, flush);
+    deflateEnd(&stream);
+    return ok;
+}
+
+bool deflate_segment_init(DeflateSegment* segment, const char* text, size_t length) {
+    memset(segment, 0, sizeof(*segment));
+
+    // A sync flush ends the segment on a byte boundary without a final block
+    StrBuf out;
+    strbuf_init(&out);
+    if (!deflate_best(text, length, Z_SYNC_FLUSH, &out)) {
+        strbuf_free(&out);
+        return false;
+    }
+
+    segment->data = out.data;
+    segment->length = out.length;
+    segment->source_length = length;
+    return true;
+}
+
+void deflate_segment_free(DeflateSegment* segment) {
+    free(segment->data);
+    memset(segment, 0, sizeof(*segment));
+}
+
+// ============================================================================
+// STREAMING
+// ============================================================================
+
+bool deflater_begin(Deflater* deflater, StrBuf* out) {
+    deflater->out = out;
+    deflater->stream = acquire_stream();
+    deflater->failed = deflater->stream == NULL;
+    return !deflater->failed;
+}
+
+void deflater_write(Deflater* deflater, const char* data, size_t length) {
+    if (deflater->failed || length == 0) return;
+    if (!run_deflate(deflater->stream, deflater->out, data, length, Z_NO_FLUSH)) deflater->failed = true;
+}
+
+// Flush to a byte boundary, append the segment, then restart the stream so
+// nothing after it back-references text the decoder saw in a different place
+void deflater_splice(Deflater* deflater, const DeflateSegment* segment) {
+    if (deflater->failed) return;
+    if (!run_deflate(deflater->stream, deflater->out, NULL, 0, Z_SYNC_FLUSH) ||
+        !strbuf_append(deflater->out, segment->data, segment->length)) {
+        deflater->failed = true;
+        return;
+    }
+    deflateReset(deflater->stream);
+}
+
+bool deflater_finish(Deflater* deflater) {
+    if (!deflater->failed && !run_deflate(deflater->stream, deflater->out, NULL, 0, Z_FINISH)) {
+        deflater->failed = true;
+    }
+    return !deflater->failed;
+}
+
+bool deflate_buffer(const char* data, size_t length, StrBuf* out) {
+    Deflater deflater;
+    if (!deflater_begin(&deflater, out)) return false;
+    deflater_write(&deflater, data, length);
+    return deflater_finish(&deflater);
+}
+
+bool gzip_buffer_best(const char* data, size_t length, StrBuf* out) {
+    unsigned char header[COMPRESS_HEADER_MAX], trailer[COMPRESS_TRAILER_MAX];
+    size_t header_length = compress_frame_header(CONTENT_ENCODING_GZIP, header);
+    size_t trailer_length = compress_frame_trailer(CONTENT_ENCODING_GZIP, data, length, trailer);
+    return strbuf_append(out, (const char*)header, header_length) &&
+           deflate_best(data, length, Z_FINISH, out) &&
+           strbuf_append(out, (const char*)trailer, trailer_length);
+}
+
+// ============================================================================
+// FRAMING
+// ============================================================================
+
+size_t compress_frame_header(ContentEncoding encoding, unsigned char header[COMPRESS_HEADER_MAX]) {
+    static const unsigned char gzip_header[10] = { 0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 3 };
+    static const unsigned char zlib_header[2] = { 0x78, 0x9c };
+
+    switch (encoding) {
+        case CONTENT_ENCODING_GZIP:
+            memcpy(header, gzip_header, sizeof(gzip_header));
+            return sizeof(gzip_header);
+        case CONTENT_ENCODING_DEFLATE:
+            memcpy(header, zlib_header, sizeof(zlib_header));
+            return sizeof(zlib_header);
+        default:
+            return 0;
+    }
+}
+
+static void put_le32(unsigned char* out, uint32_t value) {
+    for (int i = 0; i < 4; i++) out[i] = (unsigned char)(value >> (8 * i));
+}
+
+size_t compress_frame_trailer(ContentEncoding encoding, const char* source, size_t length,
+                              unsigned char trailer[COMPRESS_TRAILER_MAX]) {
+    if (encoding == CONTENT_ENCODING_GZIP) {
+        // CRC-32 and length mod 2^32, little-endian
+        put_le32(trailer, (uint32_t)crc32_z(crc32(0, NULL, 0), (const Bytef*)source, length));
+        put_le32(trailer + 4, (uint32_t)length);
+        return 8;
+    }
+    if (encoding == CONTENT_ENCODING_DEFLATE) {
+        // Adler-32, big-endian
+        uint32_t adler = (uint32_t)adler32_z(adler32(0, NULL, 0), (const Bytef*)source, length);
+        for (int i = 0; i < 4; i++) trailer[i] = (unsigned char)(adler >> (24 - 8 * i));
+        return 4;
+    }
+    return 0;
+}
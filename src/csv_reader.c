@@ -0,0 +1,225 @@
+/*
+ * INGRES ChatBot - Streaming CSV Reader
+ * Quote-aware, in-place CSV parsing for large CGWB assessment exports.
+ */
+
+#include "csv_reader.h"
+#include <stdlib.h>
+#include <string.h>
+
+struct CsvReader {
+    FILE* file;
+    bool owns_file;
+    char* buffer;
+    size_t capacity;        // Usable bytes; one extra byte is allocated for a terminator
+    size_t start;           // First unconsumed byte
+    size_t end;             // End of buffered data
+    size_t scan;            // Resume offset (relative to start) while looking for a record end
+    bool in_quotes;         // Quote state at scan
+    bool had_quotes;        // Current record contains a quote
+    bool eof;
+    long line;              // Line where the next record starts
+    long record_line;
+};
+
+static CsvReader* reader_create(FILE* file, bool owns_file) {
+    CsvReader* reader = calloc(1, sizeof(CsvReader));
+    if (!reader) return NULL;
+
+    reader->buffer = malloc(CSV_READER_BUFFER_SIZE + 1);
+    if (!reader->buffer) {
+        free(reader);
+        return NULL;
+    }
+    reader->capacity = CSV_READER_BUFFER_SIZE;
+    reader->file = file;
+    reader->owns_file = owns_file;
+    reader->line = 1;
+    return reader;
+}
+
+CsvReader* csv_reader_open(const char* path) {
+    if (!path) return NULL;
+
+    FILE* file = fopen(path, "rb");
+    if (!file) return NULL;
+
+    CsvReader* reader = reader_create(file, true);
+    if (!reader) fclose(file);
+    return reader;
+}
+
+CsvReader* csv_reader_from_file(FILE* file) {
+    return file ? reader_create(file, false) : NULL;
+}
+
+void csv_reader_close(CsvReader* reader) {
+    if (!reader) return;
+    if (reader->owns_file && reader->file) fclose(reader->file);
+    free(reader->buffer);
+    free(reader);
+}
+
+long csv_reader_line(const CsvReader* reader) {
+    return reader ? reader->record_line : 0;
+}
+
+// Slide unconsumed data to the front and read more, growing the buffer when a
+// single record fills it. Returns false once nothing more can be read.
+static bool refill(CsvReader* reader) {
+    if (reader->eof) return false;
+
+    if (reader->start > 0) {
+        size_t remaining = reader->end - reader->start;
+        memmove(reader->buffer, reader->buffer + reader->start, remaining);
+        reader->start = 0;
+        reader->end = remaining;
+    }
+
+    if (reader->end == reader->capacity) {
+        size_t grown = reader->capacity * 2;
+        char* buffer = realloc(reader->buffer, grown + 1);
+        if (!buffer) return false;
+        reader->buffer = buffer;
+        reader->capacity = grown;
+    }
+
+    size_t got = fread(reader->buffer + reader->end, 1, reader->capacity - reader->end, reader->file);
+    reader->end += got;
+    if (got == 0) reader->eof = true;
+    return got > 0;
+}
+
+// Find the end of the record starting at reader->start: the first newline
+// outside quotes. memchr does the scanning so unquoted data is skipped in
+// bulk. Returns the record length, or -1 for an unterminated quote at EOF
+// and -2 at end of input.
+static long find_record_end(CsvReader* reader, size_t* consumed) {
+    for (;;) {
+        char* base = reader->buffer + reader->start;
+        size_t avail = reader->end - reader->start;
+
+        while (reader->scan < avail) {
+            char* p = base + reader->scan;
+            size_t left = avail - reader->scan;
+
+            if (reader->in_quotes) {
+                char* quote = memchr(p, '"', left);
+                if (!quote) {
+                    reader->scan = avail;
+                    break;
+                }
+                reader->scan = (size_t)(quote - base) + 1;
+                reader->in_quotes = false;
+                continue;
+            }
+
+            char* newline = memchr(p, '\n', left);
+            size_t span = newline ? (size_t)(newline - p) : left;
+            char* quote = memchr(p, '"', span);
+            if (quote) {
+                reader->scan = (size_t)(quote - base) + 1;
+                reader->in_quotes = true;
+                reader->had_quotes = true;
+                continue;
+            }
+            if (newline) {
+                *consumed = (size_t)(newline - base) + 1;
+                return (long)(newline - base);
+            }
+            reader->scan = avail;
+        }
+
+        if (!refill(reader)) {
+            avail = reader->end - reader->start;
+            if (avail == 0) return -2;
+            if (reader->in_quotes) return -1;
+            // Final record without a trailing newline
+            *consumed = avail;
+            return (long)avail;
+        }
+    }
+}
+
+int csv_reader_next(CsvReader* reader, char** fields, int max_fields) {
+    if (!reader || !fields || max_fields <= 0) return -1;
+
+    for (;;) {
+        size_t consumed = 0;
+        reader->scan = 0;
+        reader->in_quotes = false;
+        reader->had_quotes = false;
+
+        long len = find_record_end(reader, &consumed);
+        if (len == -2) return 0;
+        if (len < 0) {
+            reader->record_line = reader->line;
+            return -1;
+        }
+
+        char* record = reader->buffer + reader->start;
+        reader->start += consumed;
+        reader->record_line = reader->line;
+
+        reader->line++;
+        if (reader->had_quotes) {
+            // Newlines embedded in quoted fields
+            for (long i = 0; i < len; i++) {
+                if (record[i] == '\n') reader->line++;
+            }
+        }
+
+        if (len > 0 && record[len - 1] == '\r') len--;
+        if (len == 0) continue;
+
+        return csv_parse_record(record, (size_t)len, fields, max_fields);
+    }
+}
+
+int csv_parse_record(char* buf, size_t len, char** fields, int max_fields) {
+    if (!buf || !fields || max_fields <= 0) return -1;
+
+    size_t i = 0;
+    int count = 0;
+
+    for (;;) {
+        char* field = buf + i;
+        char* out;
+
+        if (i < len && buf[i] == '"') {
+            // Quoted: unescape "" in place; the output never overtakes input
+            out = field;
+            i++;
+            for (;;) {
+                if (i >= len) return -1;
+                char ch = buf[i++];
+                if (ch == '"') {
+                    if (i < len && buf[i] == '"') {
+                        *out++ = '"';
+                        i++;
+                    } else {
+                        break;
+                    }
+                } else {
+                    *out++ = ch;
+                }
+            }
+            // Tolerate stray characters between the closing quote and comma
+            while (i < len && buf[i] != ',') i++;
+        } else {
+            char* comma = memchr(buf + i, ',', len - i);
+            i = comma ? (size_t)(comma - buf) : len;
+            out = buf + i;
+        }
+
+        bool more = i < len;
+        *out = '\0';
+        if (count < max_fields) fields[count] = field;
+        count++;
+
+        if (!more) break;
+        i++;
+    }
+
+    return count < max_fields ? count : max_fields;
+}
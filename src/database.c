@@ -1,36 +1,133 @@
 #include "database.h"
+#include "query_cache.h"
+#include "snapshot.h"
+#include "timeseries.h"
+#include "epoch.h"
+#include "pool.h"
 #include "utils.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
 #include <ctype.h>
+#include <strings.h>
+#include <stdatomic.h>
+#include <pthread.h>
 
-// Conditionally include PostgreSQL headers
+// Conditionally include the PostgreSQL connection pool
 #ifdef USE_POSTGRESQL
-#include <libpq-fe.h>
-static PGconn *conn = NULL;
+#include "db_pool.h"
 #endif
 
 static bool db_initialized = false;
 
-// Enhanced data structures for better performance
-typedef struct {
-    char state_key[32];     // Lowercase key for fast lookup
-    GroundwaterData* data;
-    int count;
-} StateDataIndex;
+// In-memory store: a snapshot mapped from INGRES_SNAPSHOT (written by
+// tools/csv_to_snapshot) or built from sample_data at startup. Readers
+// access it inside an epoch (db_snapshot_acquire); reloads publish a new
+// snapshot with an atomic swap and retire the old one to epoch reclamation.
+static _Atomic(Snapshot*) dataset = NULL;
+static char* snapshot_path = NULL;
+
+// Multi-year history, rebuilt and swapped together with the snapshot: the
+// current snapshot's rows on top of earlier assessments from
+// INGRES_HISTORY (a multi-year snapshot), or the built-in sample history
+// when the current data is the built-in sample
+static _Atomic(TimeSeriesStore*) history = NULL;
+
+// Background reloader: picks up db_request_reload (safe from a signal
+// handler) and reclaims retired snapshots
+#define RELOAD_POLL_MS 100
+static pthread_t reload_thread;
+static bool reload_thread_running = false;
+static atomic_bool reload_requested = false;
+static atomic_bool reload_stop = false;
+static pthread_mutex_t reload_serial = PTHREAD_MUTEX_INITIALIZER;
+
+// Bumped whenever the underlying data changes so cached results computed
+// against the old data are never served
+static atomic_ulong dataset_version = 1;
+
+static void destroy_snapshot(void* snapshot) {
+    snapshot_close(snapshot);
+}
+
+static void destroy_history(void* store) {
+    timeseries_free(store);
+}
+
+static void append_snapshot_rows(GroundwaterData* rows, size_t* count, const Snapshot* snapshot) {
+    for (uint32_t row = 0; row < snapshot->row_count; row++) {
+        snapshot_get_row(snapshot, row, &rows[(*count)++]);
+    }
+}
+
+// Earlier assessments first so the current snapshot wins for a shared year.
+// The built-in sample history describes the built-in sample data only; it
+// is never mixed into a real (mapped) snapshot.
+static TimeSeriesStore* build_history(const Snapshot* current) {
+    bool sample_current = current && !current->mapped;
+    const char* path = getenv("INGRES_HISTORY");
+    Snapshot* past = (path && *path) ? snapshot_open(path) : NULL;
+    if (path && *path && !past) {
+        fprintf(stderr, "⚠️  History %s missing or invalid; %s\n", path,
+                sample_current ? "using built-in sample history" : "no earlier assessments available");
+    } else if (!past && !sample_current) {
+        fprintf(stderr, "⚠️  INGRES_HISTORY not set; no earlier assessments available, "
+                "trends cover the current snapshot only\n");
+    }
+
+    size_t past_count = past ? past->row_count : sample_current ? (size_t)sample_history_count : 0;
+    size_t total = past_count + (current ? current->row_count : 0);
+    GroundwaterData* rows = malloc(sizeof(GroundwaterData) * (total ? total : 1));
+    if (!rows) {
+        snapshot_close(past);
+        return NULL;
+    }
 
-static StateDataIndex* state_index = NULL;
-static int state_index_size = 0;
-static HashTable* data_lookup_cache = NULL;
+    size_t count = 0;
+    if (past) {
+        append_snapshot_rows(rows, &count, past);
+    } else if (past_count > 0) {
+        memcpy(rows, sample_history, sizeof(GroundwaterData) * past_count);
+        count = past_count;
+    }
+    if (current) append_snapshot_rows(rows, &count, current);
+
+    TimeSeriesStore* store = timeseries_build(rows, count);
+    free(rows);
+    snapshot_close(past);
+    return store;
+}
+
+// Map the snapshot at path, or build one from the built-in sample data when
+// no path is configured or the file is unusable
+static Snapshot* load_snapshot(const char* path) {
+    if (path && *path) {
+        Snapshot* mapped = snapshot_open(path);
+        if (mapped) {
+            printf("📊 Mapped dataset snapshot %s\n", path);
+            return mapped;
+        }
+        fprintf(stderr, "⚠️  Snapshot %s missing or invalid; using built-in sample data\n", path);
+    }
+
+    printf("📊 Initializing enhanced groundwater database from built-in sample data\n");
+    return snapshot_from_rows(sample_data, sample_data_count);
+}
 
-// Database configuration
-#define DB_HOST "localhost"
-#define DB_PORT "5432"
-#define DB_NAME "ingres_groundwater"
-#define DB_USER "postgres"
-#define DB_PASS "postgres123"
+static void* reload_main(void* arg) {
+    (void)arg;
+    struct timespec pause = {0, RELOAD_POLL_MS * 1000000L};
+
+    while (!atomic_load(&reload_stop)) {
+        nanosleep(&pause, NULL);
+        if (atomic_exchange(&reload_requested, false)) {
+            db_reload_snapshot(NULL);
+        }
+        epoch_reclaim();
+    }
+    return NULL;
+}
 
 bool db_init(void) {
     if (db_initialized) {
@@ -38,47 +135,43 @@ bool db_init(void) {
     }
 
 #ifdef USE_POSTGRESQL
-    // Try PostgreSQL connection
-    char conninfo[256];
-    snprintf(conninfo, sizeof(conninfo),
-             "host=%s port=%s dbname=%s user=%s password=%s",
-             DB_HOST, DB_PORT, DB_NAME, DB_USER, DB_PASS);
-
-    conn = PQconnectdb(conninfo);
-
-    if (PQstatus(conn) == CONNECTION_OK) {
-        printf("✅ Database connected successfully to %s\n", DB_NAME);
-        db_initialized = true;
-        return true;
-    } else {
-        fprintf(stderr, "❌ Database connection failed: %s\n", PQerrorMessage(conn));
+    // Connection pool for PostgreSQL; the in-memory store below is still
+    // built so queries can fall back to it if the database goes away
+    if (!db_pool_init(NULL, 0)) {
         fprintf(stderr, "Falling back to enhanced sample data mode\n");
-        if (conn) PQfinish(conn);
-        conn = NULL;
     }
 #endif
 
-    // Initialize enhanced sample data with indexing
-    printf("📊 Initializing enhanced groundwater database with %d states\n", 28);
+    const char* configured = getenv("INGRES_SNAPSHOT");
+    if (configured && *configured) {
+        free(snapshot_path);
+        snapshot_path = strdup(configured);
+    }
 
-    // Build state index for fast lookups
-    if (!build_state_index()) {
-        fprintf(stderr, "❌ Failed to build state index\n");
+    Snapshot* initial = load_snapshot(snapshot_path);
+    if (!initial) {
+        fprintf(stderr, "❌ Failed to build dataset snapshot\n");
         return false;
     }
-
-    // Initialize lookup cache
-    data_lookup_cache = hash_create();
-    if (!data_lookup_cache) {
-        fprintf(stderr, "❌ Failed to initialize lookup cache\n");
-        free_state_index();
+    atomic_store(&dataset, initial);
+    atomic_store(&history, build_history(initial));
+
+    // Initialize query result cache
+    if (!query_cache_init(0, 0, 0)) {
+        fprintf(stderr, "❌ Failed to initialize query cache\n");
+        snapshot_close(atomic_exchange(&dataset, NULL));
+        timeseries_free(atomic_exchange(&history, NULL));
         return false;
     }
 
+    atomic_store(&reload_stop, false);
+    reload_thread_running = pthread_create(&reload_thread, NULL, reload_main, NULL) == 0;
+
     printf("✅ Enhanced database initialized with indexing and caching\n");
-    printf("   • State index built for %d states\n", state_index_size);
-    printf("   • Lookup cache initialized\n");
-    printf("   • Total assessment records: %d\n", sample_data_count);
+    printf("   • State index built for %u states\n", initial->state_count);
+    printf("   • Query result cache initialized\n");
+    printf("   • Total assessment records: %u\n", initial->row_count);
+    printf("   • Time series built for %zu locations\n", timeseries_location_count(atomic_load(&history)));
 
     db_initialized = true;
     return true;
@@ -86,128 +179,114 @@ bool db_init(void) {
 
 void db_close(void) {
 #ifdef USE_POSTGRESQL
-    if (conn) {
-        PQfinish(conn);
-        conn = NULL;
-        printf("🔌 Database connection closed\n");
+    if (db_pool_is_ready()) {
+        db_pool_shutdown();
+        printf("🔌 Database connection pool closed\n");
     }
 #endif
 
-    // Clean up enhanced data structures
-    free_state_index();
-    if (data_lookup_cache) {
-        hash_free(data_lookup_cache);
-        data_lookup_cache = NULL;
+    if (reload_thread_running) {
+        atomic_store(&reload_stop, true);
+        pthread_join(reload_thread, NULL);
+        reload_thread_running = false;
     }
 
+    // Clean up enhanced data structures; wait briefly for in-flight readers
+    Snapshot* current = atomic_exchange(&dataset, NULL);
+    if (current) epoch_retire(current, destroy_snapshot);
+    TimeSeriesStore* past = atomic_exchange(&history, NULL);
+    if (past) epoch_retire(past, destroy_history);
+    if (!epoch_drain(1000)) {
+        fprintf(stderr, "⚠️  Readers still active; leaving retired snapshots mapped\n");
+    }
+    query_cache_shutdown();
+    free(snapshot_path);
+    snapshot_path = NULL;
+
     db_initialized = false;
     printf("🧹 Enhanced database cleanup completed\n");
 }
 
-// ============================================================================
-// ENHANCED INDEXING AND CACHING FUNCTIONS
-// ============================================================================
+const struct Snapshot* db_snapshot_acquire(void) {
+    epoch_enter();
+    return atomic_load(&dataset);
+}
 
-bool build_state_index(void) {
-    if (state_index) {
-        free_state_index();
-    }
+void db_snapshot_release(void) {
+    epoch_exit();
+}
 
-    // Count unique states
-    HashTable* state_count_map = hash_create();
-    if (!state_count_map) return false;
+const struct TimeSeriesStore* db_history_acquire(void) {
+    epoch_enter();
+    return atomic_load(&history);
+}
 
-    for (int i = 0; i < sample_data_count; i++) {
-        char* state_key = string_to_lower((string)sample_data[i].state);
-        if (state_key) {
-            int* count = (int*)hash_get(state_count_map, state_key);
-            if (!count) {
-                count = malloc(sizeof(int));
-                *count = 0;
-                hash_set(state_count_map, state_key, count);
-            }
-            (*count)++;
-            free(state_key);
+void db_history_release(void) {
+    epoch_exit();
+}
+
+bool db_reload_snapshot(const char* path) {
+    pthread_mutex_lock(&reload_serial);
+
+    if (path && *path) {
+        char* copy = strdup(path);
+        if (copy) {
+            free(snapshot_path);
+            snapshot_path = copy;
         }
     }
 
-    // Allocate state index
-    state_index_size = hash_size(state_count_map);
-    state_index = malloc(sizeof(StateDataIndex) * state_index_size);
-    if (!state_index) {
-        hash_free(state_count_map);
+    // Load and validate entirely off the request path; a bad file keeps the
+    // current dataset in service. A mapped file is strict: no silent
+    // fallback to sample data on reload.
+    Snapshot* fresh = snapshot_path ? snapshot_open(snapshot_path)
+                                    : snapshot_from_rows(sample_data, sample_data_count);
+    if (!fresh) {
+        fprintf(stderr, "❌ Reload failed: %s missing or invalid; keeping current dataset\n",
+                snapshot_path ? snapshot_path : "sample data");
+        pthread_mutex_unlock(&reload_serial);
         return false;
     }
 
-    // Build index entries
-    int index = 0;
-    for (int i = 0; i < state_count_map->bucket_count; i++) {
-        HashNode* node = state_count_map->buckets[i];
-        while (node) {
-            StateDataIndex* entry = &state_index[index++];
-            strncpy(entry->state_key, node->key, sizeof(entry->state_key) - 1);
-            entry->state_key[sizeof(entry->state_key) - 1] = '\0';
-
-            int* count = (int*)node->value;
-            entry->count = *count;
-            entry->data = malloc(sizeof(GroundwaterData) * entry->count);
-            if (!entry->data) {
-                hash_free(state_count_map);
-                free_state_index();
-                return false;
-            }
-
-            // Populate data for this state
-            int data_index = 0;
-            for (int j = 0; j < sample_data_count; j++) {
-                char* state_lower = string_to_lower((string)sample_data[j].state);
-                if (state_lower && strcmp(state_lower, entry->state_key) == 0) {
-                    entry->data[data_index++] = sample_data[j];
-                }
-                if (state_lower) free(state_lower);
-            }
-
-            node = node->next;
-        }
+    // History is rebuilt from the new rows; if that fails the old series
+    // stay in service rather than dropping trend queries
+    TimeSeriesStore* fresh_history = build_history(fresh);
+
+    // Publish, then bump the version so cached results from the old
+    // snapshot are dropped; in-flight queries finish on the old one
+    Snapshot* old = atomic_exchange(&dataset, fresh);
+    TimeSeriesStore* old_history = fresh_history ? atomic_exchange(&history, fresh_history) : NULL;
+    db_mark_dataset_changed();
+    if (old && !epoch_retire(old, destroy_snapshot)) {
+        // Could not queue it; leaking is safer than unmapping under readers
+        fprintf(stderr, "⚠️  Could not retire previous snapshot\n");
+    }
+    if (old_history && !epoch_retire(old_history, destroy_history)) {
+        fprintf(stderr, "⚠️  Could not retire previous history\n");
     }
 
-    hash_free(state_count_map);
+    printf("🔄 Dataset reloaded: %u records, checksum %016llx\n",
+           fresh->row_count, (unsigned long long)fresh->checksum);
+    pthread_mutex_unlock(&reload_serial);
     return true;
 }
 
-void free_state_index(void) {
-    if (state_index) {
-        for (int i = 0; i < state_index_size; i++) {
-            if (state_index[i].data) {
-                free(state_index[i].data);
-            }
-        }
-        free(state_index);
-        state_index = NULL;
-        state_index_size = 0;
-    }
+void db_request_reload(void) {
+    atomic_store(&reload_requested, true);
 }
 
-StateDataIndex* find_state_data(const char* state_name) {
-    if (!state_name || !state_index) return NULL;
-
-    char* state_key = string_to_lower((string)state_name);
-    if (!state_key) return NULL;
-
-    for (int i = 0; i < state_index_size; i++) {
-        if (strcmp(state_index[i].state_key, state_key) == 0) {
-            free(state_key);
-            return &state_index[i];
-        }
-    }
+unsigned long db_dataset_version(void) {
+    return atomic_load(&dataset_version);
+}
 
-    free(state_key);
-    return NULL;
+void db_mark_dataset_changed(void) {
+    atomic_fetch_add(&dataset_version, 1);
+    query_cache_invalidate_all();
 }
 
 bool db_is_connected(void) {
 #ifdef USE_POSTGRESQL
-    return conn && (PQstatus(conn) == CONNECTION_OK);
+    return db_pool_is_ready();
 #else
     return false; // Always use sample data
 #endif
@@ -267,134 +346,461 @@ GroundwaterData sample_data[] = {
 
 int sample_data_count = sizeof(sample_data) / sizeof(GroundwaterData);
 
-// Enhanced query result creation with indexing
-static QueryResult* create_enhanced_result(const char* state, const char* district, const char* block) {
-    QueryResult* result = malloc(sizeof(QueryResult));
-    if (!result) return NULL;
+// Earlier assessment cycles for the sample locations; the 2023 cycle comes
+// from the current snapshot
+GroundwaterData sample_history[] = {
+    // Punjab
+    {"Punjab", "Amritsar", "Ajnala", "Critical", 45.7, 95.8, 21.5, 2013},
+    {"Punjab", "Amritsar", "Ajnala", "Critical", 45.3, 88.4, 22.3, 2017},
+    {"Punjab", "Amritsar", "Ajnala", "Over-Exploited", 43.6, 83.3, 22.7, 2020},
+    {"Punjab", "Amritsar", "Ajnala", "Over-Exploited", 43.5, 80.1, 23.1, 2022},
+    {"Punjab", "Ludhiana", "Ludhiana-I", "Critical", 47.1, 101.6, 23.9, 2013},
+    {"Punjab", "Ludhiana", "Ludhiana-I", "Critical", 50.0, 93.3, 24.1, 2017},
+    {"Punjab", "Ludhiana", "Ludhiana-I", "Over-Exploited", 47.6, 87.5, 25.2, 2020},
+    {"Punjab", "Ludhiana", "Ludhiana-I", "Over-Exploited", 50.4, 83.9, 25.5, 2022},
+    {"Punjab", "Bathinda", "Bathinda", "Critical", 44.4, 90.8, 19.0, 2013},
+    {"Punjab", "Bathinda", "Bathinda", "Critical", 44.0, 82.7, 20.3, 2017},
+    {"Punjab", "Bathinda", "Bathinda", "Over-Exploited", 41.6, 77.1, 20.6, 2020},
+    {"Punjab", "Bathinda", "Bathinda", "Over-Exploited", 42.1, 73.6, 21.0, 2022},
+    {"Punjab", "Jalandhar", "Jalandhar-I", "Semi-Critical", 55.8, 85.5, 31.2, 2013},
+    {"Punjab", "Jalandhar", "Jalandhar-I", "Semi-Critical", 54.8, 80.0, 31.5, 2017},
+    {"Punjab", "Jalandhar", "Jalandhar-I", "Critical", 53.5, 76.0, 32.9, 2020},
+    {"Punjab", "Jalandhar", "Jalandhar-I", "Critical", 54.1, 73.5, 33.8, 2022},
+    {"Punjab", "Patiala", "Patiala", "Semi-Critical", 48.5, 74.6, 27.4, 2013},
+    {"Punjab", "Patiala", "Patiala", "Semi-Critical", 49.0, 70.1, 28.4, 2017},
+    {"Punjab", "Patiala", "Patiala", "Critical", 50.4, 66.9, 29.8, 2020},
+    {"Punjab", "Patiala", "Patiala", "Critical", 48.2, 64.8, 30.3, 2022},
 
-    clock_t start_time = clock();
-
-    // Use indexed lookup for state queries
-    if (state && !district && !block) {
-        StateDataIndex* state_data = find_state_data(state);
-        if (state_data) {
-            result->data = malloc(sizeof(GroundwaterData) * state_data->count);
-            if (result->data) {
-                memcpy(result->data, state_data->data, sizeof(GroundwaterData) * state_data->count);
-                result->count = state_data->count;
-                strcpy(result->query_type, "Indexed State Query");
-                clock_t end_time = clock();
-                result->execution_time_ms = ((double)(end_time - start_time) / CLOCKS_PER_SEC) * 1000.0;
-                return result;
-            }
-        }
-    }
+    // Haryana
+    {"Haryana", "Sirsa", "Sirsa", "Critical", 40.1, 82.3, 17.3, 2013},
+    {"Haryana", "Sirsa", "Sirsa", "Critical", 38.2, 75.0, 17.9, 2017},
+    {"Haryana", "Sirsa", "Sirsa", "Over-Exploited", 37.7, 69.9, 18.6, 2020},
+    {"Haryana", "Sirsa", "Sirsa", "Over-Exploited", 39.7, 66.7, 19.3, 2022},
+    {"Haryana", "Hisar", "Hisar-I", "Critical", 39.7, 81.9, 18.5, 2013},
+    {"Haryana", "Hisar", "Hisar-I", "Critical", 42.1, 76.3, 19.2, 2017},
+    {"Haryana", "Hisar", "Hisar-I", "Over-Exploited", 42.4, 72.4, 20.0, 2020},
+    {"Haryana", "Hisar", "Hisar-I", "Over-Exploited", 41.8, 69.9, 20.6, 2022},
+    {"Haryana", "Fatehabad", "Fatehabad", "Semi-Critical", 44.5, 68.4, 23.9, 2013},
+    {"Haryana", "Fatehabad", "Fatehabad", "Semi-Critical", 46.3, 64.4, 24.7, 2017},
+    {"Haryana", "Fatehabad", "Fatehabad", "Critical", 45.3, 61.6, 26.2, 2020},
+    {"Haryana", "Fatehabad", "Fatehabad", "Critical", 45.4, 59.8, 26.9, 2022},
+    {"Haryana", "Bhiwani", "Bhiwani", "Semi-Critical", 47.5, 71.4, 24.1, 2013},
+    {"Haryana", "Bhiwani", "Bhiwani", "Semi-Critical", 45.9, 67.1, 26.8, 2017},
+    {"Haryana", "Bhiwani", "Bhiwani", "Critical", 44.5, 64.1, 27.3, 2020},
+    {"Haryana", "Bhiwani", "Bhiwani", "Critical", 45.1, 62.1, 28.1, 2022},
+    {"Haryana", "Rohtak", "Rohtak", "Safe", 53.2, 63.1, 30.3, 2013},
+    {"Haryana", "Rohtak", "Rohtak", "Safe", 51.0, 61.8, 31.1, 2017},
+    {"Haryana", "Rohtak", "Rohtak", "Semi-Critical", 53.6, 60.8, 31.6, 2020},
+    {"Haryana", "Rohtak", "Rohtak", "Semi-Critical", 51.9, 60.1, 32.4, 2022},
+
+    // Rajasthan
+    {"Rajasthan", "Jaipur", "Jaipur", "Safe", 70.1, 44.3, 36.0, 2013},
+    {"Rajasthan", "Jaipur", "Jaipur", "Safe", 67.2, 44.6, 38.4, 2017},
+    {"Rajasthan", "Jaipur", "Jaipur", "Safe", 67.6, 44.9, 40.7, 2020},
+    {"Rajasthan", "Jaipur", "Jaipur", "Safe", 70.9, 45.1, 41.4, 2022},
+    {"Rajasthan", "Jodhpur", "Jodhpur", "Safe", 41.2, 51.5, 23.6, 2013},
+    {"Rajasthan", "Jodhpur", "Jodhpur", "Safe", 42.0, 50.3, 24.4, 2017},
+    {"Rajasthan", "Jodhpur", "Jodhpur", "Semi-Critical", 41.3, 49.5, 24.8, 2020},
+    {"Rajasthan", "Jodhpur", "Jodhpur", "Semi-Critical", 41.8, 49.0, 25.6, 2022},
+    {"Rajasthan", "Bikaner", "Bikaner", "Safe", 37.1, 22.0, 18.7, 2013},
+    {"Rajasthan", "Bikaner", "Bikaner", "Safe", 35.8, 22.2, 19.5, 2017},
+    {"Rajasthan", "Bikaner", "Bikaner", "Safe", 36.3, 22.3, 20.4, 2020},
+    {"Rajasthan", "Bikaner", "Bikaner", "Safe", 36.9, 22.4, 21.0, 2022},
+    {"Rajasthan", "Alwar", "Alwar", "Semi-Critical", 52.4, 80.0, 26.9, 2013},
+    {"Rajasthan", "Alwar", "Alwar", "Semi-Critical", 50.8, 74.8, 29.4, 2017},
+    {"Rajasthan", "Alwar", "Alwar", "Critical", 51.8, 71.2, 30.6, 2020},
+    {"Rajasthan", "Alwar", "Alwar", "Critical", 49.4, 68.9, 31.2, 2022},
+    {"Rajasthan", "Kota", "Kota", "Safe", 61.3, 38.3, 35.5, 2013},
+    {"Rajasthan", "Kota", "Kota", "Safe", 59.6, 38.5, 37.0, 2017},
+    {"Rajasthan", "Kota", "Kota", "Safe", 60.1, 38.7, 37.7, 2020},
+    {"Rajasthan", "Kota", "Kota", "Safe", 59.7, 38.8, 38.3, 2022},
+
+    // Gujarat
+    {"Gujarat", "Ahmedabad", "Ahmedabad City", "Critical", 37.8, 85.9, 16.9, 2013},
+    {"Gujarat", "Ahmedabad", "Ahmedabad City", "Critical", 38.4, 77.0, 18.1, 2017},
+    {"Gujarat", "Ahmedabad", "Ahmedabad City", "Over-Exploited", 37.7, 71.0, 18.6, 2020},
+    {"Gujarat", "Ahmedabad", "Ahmedabad City", "Over-Exploited", 40.4, 67.2, 18.9, 2022},
+    {"Gujarat", "Surat", "Surat City", "Semi-Critical", 43.7, 68.5, 24.3, 2013},
+    {"Gujarat", "Surat", "Surat City", "Semi-Critical", 44.6, 64.9, 26.0, 2017},
+    {"Gujarat", "Surat", "Surat City", "Critical", 46.4, 62.2, 26.5, 2020},
+    {"Gujarat", "Surat", "Surat City", "Critical", 43.5, 60.5, 27.1, 2022},
+    {"Gujarat", "Vadodara", "Vadodara", "Safe", 57.0, 36.3, 32.0, 2013},
+    {"Gujarat", "Vadodara", "Vadodara", "Safe", 56.5, 36.6, 33.5, 2017},
+    {"Gujarat", "Vadodara", "Vadodara", "Safe", 60.9, 36.9, 34.8, 2020},
+    {"Gujarat", "Vadodara", "Vadodara", "Safe", 59.6, 37.1, 35.5, 2022},
+    {"Gujarat", "Rajkot", "Rajkot", "Safe", 50.7, 62.6, 28.9, 2013},
+    {"Gujarat", "Rajkot", "Rajkot", "Safe", 52.2, 61.1, 29.4, 2017},
+    {"Gujarat", "Rajkot", "Rajkot", "Semi-Critical", 51.4, 60.0, 30.7, 2020},
+    {"Gujarat", "Rajkot", "Rajkot", "Semi-Critical", 53.4, 59.3, 31.8, 2022},
+    {"Gujarat", "Bhavnagar", "Bhavnagar", "Safe", 49.9, 30.4, 25.6, 2013},
+    {"Gujarat", "Bhavnagar", "Bhavnagar", "Safe", 49.6, 30.7, 27.2, 2017},
+    {"Gujarat", "Bhavnagar", "Bhavnagar", "Safe", 48.8, 31.0, 29.0, 2020},
+    {"Gujarat", "Bhavnagar", "Bhavnagar", "Safe", 46.9, 31.1, 29.5, 2022},
+
+    // Maharashtra
+    {"Maharashtra", "Pune", "Pune City", "Critical", 41.3, 83.6, 18.9, 2013},
+    {"Maharashtra", "Pune", "Pune City", "Critical", 43.6, 78.4, 19.2, 2017},
+    {"Maharashtra", "Pune", "Pune City", "Over-Exploited", 43.6, 74.8, 20.1, 2020},
+    {"Maharashtra", "Pune", "Pune City", "Over-Exploited", 43.6, 72.4, 20.5, 2022},
+    {"Maharashtra", "Mumbai", "Mumbai Suburban", "Safe", 67.4, 44.9, 38.4, 2013},
+    {"Maharashtra", "Mumbai", "Mumbai Suburban", "Safe", 67.3, 45.2, 39.9, 2017},
+    {"Maharashtra", "Mumbai", "Mumbai Suburban", "Safe", 71.1, 45.4, 40.5, 2020},
+    {"Maharashtra", "Mumbai", "Mumbai Suburban", "Safe", 68.8, 45.6, 41.5, 2022},
+    {"Maharashtra", "Aurangabad", "Aurangabad", "Semi-Critical", 47.1, 74.9, 25.7, 2013},
+    {"Maharashtra", "Aurangabad", "Aurangabad", "Semi-Critical", 50.3, 70.4, 27.5, 2017},
+    {"Maharashtra", "Aurangabad", "Aurangabad", "Critical", 49.7, 67.2, 28.5, 2020},
+    {"Maharashtra", "Aurangabad", "Aurangabad", "Critical", 47.4, 65.2, 29.5, 2022},
+    {"Maharashtra", "Nashik", "Nashik", "Safe", 53.4, 64.4, 28.9, 2013},
+    {"Maharashtra", "Nashik", "Nashik", "Safe", 51.7, 62.3, 29.1, 2017},
+    {"Maharashtra", "Nashik", "Nashik", "Semi-Critical", 54.0, 60.8, 31.1, 2020},
+    {"Maharashtra", "Nashik", "Nashik", "Semi-Critical", 50.7, 59.8, 31.7, 2022},
+    {"Maharashtra", "Solapur", "Solapur", "Semi-Critical", 47.8, 68.8, 26.1, 2013},
+    {"Maharashtra", "Solapur", "Solapur", "Semi-Critical", 45.0, 65.9, 26.0, 2017},
+    {"Maharashtra", "Solapur", "Solapur", "Critical", 48.1, 63.8, 27.1, 2020},
+    {"Maharashtra", "Solapur", "Solapur", "Critical", 45.7, 62.4, 28.0, 2022},
+
+    // Karnataka
+    {"Karnataka", "Bangalore", "Bangalore Urban", "Critical", 37.4, 82.6, 17.6, 2013},
+    {"Karnataka", "Bangalore", "Bangalore Urban", "Critical", 39.4, 75.4, 17.4, 2017},
+    {"Karnataka", "Bangalore", "Bangalore Urban", "Over-Exploited", 40.2, 70.4, 18.5, 2020},
+    {"Karnataka", "Bangalore", "Bangalore Urban", "Over-Exploited", 40.1, 67.2, 19.0, 2022},
+    {"Karnataka", "Mysore", "Mysore", "Safe", 60.9, 37.5, 35.3, 2013},
+    {"Karnataka", "Mysore", "Mysore", "Safe", 60.8, 37.9, 36.5, 2017},
+    {"Karnataka", "Mysore", "Mysore", "Safe", 60.9, 38.1, 37.2, 2020},
+    {"Karnataka", "Mysore", "Mysore", "Safe", 60.3, 38.3, 38.3, 2022},
+    {"Karnataka", "Belgaum", "Belgaum", "Safe", 55.0, 67.8, 30.7, 2013},
+    {"Karnataka", "Belgaum", "Belgaum", "Safe", 57.0, 65.5, 31.6, 2017},
+    {"Karnataka", "Belgaum", "Belgaum", "Semi-Critical", 57.0, 63.8, 33.0, 2020},
+    {"Karnataka", "Belgaum", "Belgaum", "Semi-Critical", 55.3, 62.6, 33.7, 2022},
+    {"Karnataka", "Dharwad", "Dharwad", "Safe", 58.4, 36.2, 33.5, 2013},
+    {"Karnataka", "Dharwad", "Dharwad", "Safe", 56.4, 36.5, 34.2, 2017},
+    {"Karnataka", "Dharwad", "Dharwad", "Safe", 57.2, 36.7, 34.5, 2020},
+    {"Karnataka", "Dharwad", "Dharwad", "Safe", 59.8, 36.8, 35.7, 2022},
+    {"Karnataka", "Tumkur", "Tumkur", "Safe", 51.4, 62.2, 28.6, 2013},
+    {"Karnataka", "Tumkur", "Tumkur", "Safe", 52.5, 60.4, 29.4, 2017},
+    {"Karnataka", "Tumkur", "Tumkur", "Semi-Critical", 51.5, 59.1, 30.9, 2020},
+    {"Karnataka", "Tumkur", "Tumkur", "Semi-Critical", 50.4, 58.2, 31.4, 2022},
 
-    // Fallback to original method for complex queries
-    GroundwaterData* filtered_data = NULL;
-    int filtered_count = 0;
+    // Tamil Nadu
+    {"Tamil Nadu", "Chennai", "Chennai", "Critical", 35.4, 76.3, 15.3, 2013},
+    {"Tamil Nadu", "Chennai", "Chennai", "Critical", 36.4, 68.8, 15.9, 2017},
+    {"Tamil Nadu", "Chennai", "Chennai", "Over-Exploited", 35.5, 63.7, 16.7, 2020},
+    {"Tamil Nadu", "Chennai", "Chennai", "Over-Exploited", 35.2, 60.4, 17.1, 2022},
+    {"Tamil Nadu", "Coimbatore", "Coimbatore", "Safe", 52.2, 63.5, 28.6, 2013},
+    {"Tamil Nadu", "Coimbatore", "Coimbatore", "Safe", 53.9, 61.5, 29.9, 2017},
+    {"Tamil Nadu", "Coimbatore", "Coimbatore", "Semi-Critical", 53.7, 60.1, 30.8, 2020},
+    {"Tamil Nadu", "Coimbatore", "Coimbatore", "Semi-Critical", 51.1, 59.2, 31.6, 2022},
+    {"Tamil Nadu", "Madurai", "Madurai", "Safe", 60.3, 36.4, 30.7, 2013},
+    {"Tamil Nadu", "Madurai", "Madurai", "Safe", 56.9, 36.7, 34.3, 2017},
+    {"Tamil Nadu", "Madurai", "Madurai", "Safe", 56.7, 37.0, 34.9, 2020},
+    {"Tamil Nadu", "Madurai", "Madurai", "Safe", 56.7, 37.1, 35.8, 2022},
+    {"Tamil Nadu", "Tiruchirappalli", "Tiruchirappalli", "Safe", 50.2, 58.7, 25.7, 2013},
+    {"Tamil Nadu", "Tiruchirappalli", "Tiruchirappalli", "Safe", 49.5, 56.9, 28.3, 2017},
+    {"Tamil Nadu", "Tiruchirappalli", "Tiruchirappalli", "Semi-Critical", 47.3, 55.6, 28.6, 2020},
+    {"Tamil Nadu", "Tiruchirappalli", "Tiruchirappalli", "Semi-Critical", 50.5, 54.7, 29.3, 2022},
+    {"Tamil Nadu", "Salem", "Salem", "Safe", 54.8, 34.2, 28.7, 2013},
+    {"Tamil Nadu", "Salem", "Salem", "Safe", 57.4, 34.5, 31.4, 2017},
+    {"Tamil Nadu", "Salem", "Salem", "Safe", 53.7, 34.6, 32.2, 2020},
+    {"Tamil Nadu", "Salem", "Salem", "Safe", 55.3, 34.7, 33.3, 2022}
+};
 
-    // First pass: count matches
-    for (int i = 0; i < sample_data_count; i++) {
-        bool state_match = !state || strcasecmp(sample_data[i].state, state) == 0;
-        bool district_match = !district || strcasecmp(sample_data[i].district, district) == 0;
-        bool block_match = !block || strcasecmp(sample_data[i].block, block) == 0;
+int sample_history_count = sizeof(sample_history) / sizeof(GroundwaterData);
+
+static bool name_matches(const Snapshot* snapshot, uint32_t id, const char* wanted) {
+    return !wanted || strcasecmp(snapshot_string(snapshot, id), wanted) == 0;
+}
 
-        if (state_match && district_match && block_match) {
-            filtered_count++;
+// Collect the rows in [first, first + count) that match district/block
+static QueryResult* collect_rows(const Snapshot* snapshot, uint32_t first, uint32_t count,
+                                 const char* district, const char* block, const char* query_type) {
+    struct timespec start_time, end_time;
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
+
+    // First pass: count matches (compares dictionary strings, not copies)
+    int matched = 0;
+    for (uint32_t row = first; row < first + count; row++) {
+        if (name_matches(snapshot, snapshot->district[row], district) &&
+            name_matches(snapshot, snapshot->block[row], block)) {
+            matched++;
         }
     }
 
-    if (filtered_count > 0) {
-        filtered_data = malloc(sizeof(GroundwaterData) * filtered_count);
-        if (!filtered_data) {
-            free(result);
-            return NULL;
-        }
+    QueryResult* result = query_result_new(matched, query_type);
+    if (!result) return NULL;
 
-        // Second pass: collect data
+    if (matched > 0) {
+        // Second pass: materialize rows
         int idx = 0;
-        for (int i = 0; i < sample_data_count; i++) {
-            bool state_match = !state || strcasecmp(sample_data[i].state, state) == 0;
-            bool district_match = !district || strcasecmp(sample_data[i].district, district) == 0;
-            bool block_match = !block || strcasecmp(sample_data[i].block, block) == 0;
-
-            if (state_match && district_match && block_match) {
-                filtered_data[idx++] = sample_data[i];
+        for (uint32_t row = first; row < first + count; row++) {
+            if (name_matches(snapshot, snapshot->district[row], district) &&
+                name_matches(snapshot, snapshot->block[row], block)) {
+                snapshot_get_row(snapshot, row, &result->data[idx++]);
             }
         }
     }
 
-    result->data = filtered_data;
-    result->count = filtered_count;
-    strcpy(result->query_type, "Enhanced Location Query");
+    result->count = matched;
 
-    clock_t end_time = clock();
-    result->execution_time_ms = ((double)(end_time - start_time) / CLOCKS_PER_SEC) * 1000.0;
+    clock_gettime(CLOCK_MONOTONIC, &end_time);
+    result->execution_time_ms = (float)((end_time.tv_sec - start_time.tv_sec) * 1000.0 +
+                                        (end_time.tv_nsec - start_time.tv_nsec) / 1000000.0);
+    return result;
+}
 
+// Enhanced query result creation with indexing
+static QueryResult* create_enhanced_result(const char* state, const char* district, const char* block) {
+    const Snapshot* snapshot = db_snapshot_acquire();
+    if (!snapshot) {
+        db_snapshot_release();
+        return NULL;
+    }
+
+    // Rows are sorted by state, so a state narrows the scan to one range
+    QueryResult* result;
+    if (state) {
+        const SnapshotRange* range = snapshot_find_state(snapshot, state);
+        bool state_only = !district && !block;
+        result = collect_rows(snapshot, range ? range->first : 0, range ? range->count : 0,
+                              district, block,
+                              state_only ? "Indexed State Query" : "Enhanced Location Query");
+    } else {
+        result = collect_rows(snapshot, 0, snapshot->row_count, district, block, "Enhanced Location Query");
+    }
+
+    db_snapshot_release();
+    return result;
+}
+
+static void destroy_query_result(void* object) {
+    QueryResult* result = object;
+    free(result->data);
+    free(result);
+}
+
+QueryResult* query_result_new(int capacity, const char* query_type) {
+    QueryResult* result = pool_get(POOL_QUERY_RESULT);
+    if (!result) {
+        result = calloc(1, sizeof(QueryResult));
+        if (!result) return NULL;
+    }
+
+    // Only the row buffer survives reuse
+    result->count = 0;
+    result->execution_time_ms = 0.0f;
+    snprintf(result->query_type, sizeof(result->query_type), "%s", query_type ? query_type : "");
+    if (!query_result_reserve(result, capacity)) {
+        destroy_query_result(result);
+        return NULL;
+    }
     return result;
 }
 
+bool query_result_reserve(QueryResult* result, int capacity) {
+    if (capacity <= result->capacity) return true;
+
+    GroundwaterData* grown = realloc(result->data, sizeof(GroundwaterData) * (size_t)capacity);
+    if (!grown) return false;
+    result->data = grown;
+    result->capacity = capacity;
+    return true;
+}
+
 void free_query_result(QueryResult* result) {
     if (!result) return;
 
-    if (result->data) {
+    if (result->capacity > QUERY_RESULT_POOL_MAX_ROWS) {
         free(result->data);
+        result->data = NULL;
+        result->capacity = 0;
     }
-    free(result);
+    pool_put(POOL_QUERY_RESULT, result, destroy_query_result);
 }
 
-QueryResult* query_by_location(const char* state, const char* district, const char* block) {
+static QueryResult* fetch_by_location(const char* state, const char* district, const char* block) {
+#ifdef USE_POSTGRESQL
+    if (db_pool_is_ready()) {
+        const char* params[3] = {state, district, block};
+        QueryResult* result = db_pool_query(DB_STMT_BY_LOCATION, params, 3, "PostgreSQL Location Query");
+        if (result) return result;
+    }
+#endif
     return create_enhanced_result(state, district, block);
 }
 
-QueryResult* query_by_state(const char* state) {
+static QueryResult* fetch_by_state(const char* state) {
+#ifdef USE_POSTGRESQL
+    if (db_pool_is_ready() && state) {
+        const char* params[1] = {state};
+        QueryResult* result = db_pool_query(DB_STMT_BY_STATE, params, 1, "PostgreSQL State Query");
+        if (result) return result;
+    }
+#endif
     return create_enhanced_result(state, NULL, NULL);
 }
 
-QueryResult* query_by_category(const char* category) {
-    // For category queries, we need to filter by category
-    QueryResult* result = malloc(sizeof(QueryResult));
-    if (!result) return NULL;
+static QueryResult* fetch_by_category(const char* category) {
+#ifdef USE_POSTGRESQL
+    if (db_pool_is_ready() && category) {
+        const char* params[1] = {category};
+        QueryResult* pooled = db_pool_query(DB_STMT_BY_CATEGORY, params, 1, "PostgreSQL Category Query");
+        if (pooled) return pooled;
+    }
+#endif
+
+    // Category index: row ids grouped per category
+    const Snapshot* snapshot = db_snapshot_acquire();
+    if (!snapshot) {
+        db_snapshot_release();
+        return NULL;
+    }
 
-    GroundwaterData* filtered_data = NULL;
-    int filtered_count = 0;
+    const SnapshotRange* range = snapshot_find_category(snapshot, category);
+    int count = range ? (int)range->count : 0;
 
-    // Count matching records
-    for (int i = 0; i < sample_data_count; i++) {
-        if (strcasecmp(sample_data[i].category, category) == 0) {
-            filtered_count++;
-        }
+    QueryResult* result = query_result_new(count, "Category Query");
+    if (!result) {
+        db_snapshot_release();
+        return NULL;
+    }
+    for (int i = 0; i < count; i++) {
+        snapshot_get_row(snapshot, snapshot->category_rows[range->first + i], &result->data[i]);
     }
+    db_snapshot_release();
 
-    if (filtered_count > 0) {
-        filtered_data = malloc(sizeof(GroundwaterData) * filtered_count);
-        if (filtered_data) {
-            int idx = 0;
-            for (int i = 0; i < sample_data_count; i++) {
-                if (strcasecmp(sample_data[i].category, category) == 0) {
-                    filtered_data[idx++] = sample_data[i];
-                }
-            }
+    result->count = count;
+    return result;
+}
+
+// Every assessment year for the matching locations, oldest first per
+// location, decoded from the time-series store
+static QueryResult* fetch_historical_trend(const char* state, const char* district, const char* block) {
+    struct timespec start_time, end_time;
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
+
+    const TimeSeriesStore* store = db_history_acquire();
+    size_t matches = timeseries_find(store, state, district, block, NULL, 0);
+    if (matches == 0) {
+        db_history_release();
+        return create_enhanced_result(state, district, block);
+    }
+
+    uint32_t* locations = malloc(sizeof(uint32_t) * matches);
+    QueryResult* result = NULL;
+    size_t rows = 0;
+    if (locations) {
+        timeseries_find(store, state, district, block, locations, matches);
+        for (size_t i = 0; i < matches; i++) {
+            rows += (size_t)timeseries_stats(store, locations[i])->year_count;
         }
+        result = query_result_new((int)rows, "Historical Trend Query");
+    }
+    if (!result) {
+        db_history_release();
+        free(locations);
+        return NULL;
+    }
+
+    size_t written = 0;
+    for (size_t i = 0; i < matches; i++) {
+        written += timeseries_range(store, locations[i], 0, 0, &result->data[written], rows - written);
+    }
+    db_history_release();
+    free(locations);
+
+    result->count = (int)written;
+
+    clock_gettime(CLOCK_MONOTONIC, &end_time);
+    result->execution_time_ms = (float)((end_time.tv_sec - start_time.tv_sec) * 1000.0 +
+                                        (end_time.tv_nsec - start_time.tv_nsec) / 1000000.0);
+    return result;
+}
+
+// Read-through: serve from the query cache, otherwise run the query and
+// remember its result. A cache hit reports its own (near-zero) latency.
+static QueryResult* cached_query(QueryKind kind, const char* a, const char* b, const char* c) {
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    // Version read before the query: a result computed while a reload is
+    // being published is stamped old and never cached as new data
+    unsigned long version = db_dataset_version();
+    QueryResult* result = query_cache_get(kind, a, b, c);
+    if (result) {
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        result->execution_time_ms = (float)((end.tv_sec - start.tv_sec) * 1000.0 +
+                                            (end.tv_nsec - start.tv_nsec) / 1000000.0);
+        return result;
     }
 
-    result->data = filtered_data;
-    result->count = filtered_count;
-    strcpy(result->query_type, "Category Query");
-    result->execution_time_ms = (float)(rand() % 30 + 5);
+    switch (kind) {
+        case QUERY_KIND_LOCATION: result = fetch_by_location(a, b, c); break;
+        case QUERY_KIND_STATE:    result = fetch_by_state(a); break;
+        case QUERY_KIND_CATEGORY: result = fetch_by_category(a); break;
+        case QUERY_KIND_TREND:    result = fetch_historical_trend(a, b, c); break;
+        default: return NULL;
+    }
 
+    if (result) {
+        query_cache_put(kind, a, b, c, result, version);
+    }
     return result;
 }
 
+QueryResult* query_by_location(const char* state, const char* district, const char* block) {
+    return cached_query(QUERY_KIND_LOCATION, state, district, block);
+}
+
+QueryResult* query_by_state(const char* state) {
+    return cached_query(QUERY_KIND_STATE, state, NULL, NULL);
+}
+
+QueryResult* query_by_category(const char* category) {
+    if (!category) return NULL;
+    return cached_query(QUERY_KIND_CATEGORY, category, NULL, NULL);
+}
+
 QueryResult* query_critical_areas(void) {
     return query_by_category("Critical");
 }
 
 QueryResult* query_historical_trend(const char* state, const char* district, const char* block) {
-    // For historical trends, return data for the specified location
-    // In a real implementation, this would query historical data
-    return create_enhanced_result(state, district, block);
+    return cached_query(QUERY_KIND_TREND, state, district, block);
+}
+
+QueryResult* query_fastest_declining(int since_year, int limit) {
+    if (limit <= 0) return NULL;
+
+    TimeSeriesDecline* ranked = malloc(sizeof(TimeSeriesDecline) * (size_t)limit);
+    QueryResult* result = query_result_new(0, "Fastest Declining Query");
+    if (!ranked || !result) {
+        free(ranked);
+        free_query_result(result);
+        return NULL;
+    }
+
+    struct timespec start_time, end_time;
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
+
+    // Latest assessment of each location, most negative change first
+    const TimeSeriesStore* store = db_history_acquire();
+    size_t found = timeseries_fastest_declining(store, TS_MEASURE_EXTRACTABLE, since_year,
+                                                ranked, (size_t)limit);
+    int count = 0;
+    if (query_result_reserve(result, (int)found)) {
+        for (size_t i = 0; i < found; i++) {
+            count += (int)timeseries_range(store, ranked[i].location, ranked[i].to_year,
+                                           ranked[i].to_year, &result->data[count], 1);
+        }
+    }
+    db_history_release();
+    free(ranked);
+
+    result->count = count;
+
+    clock_gettime(CLOCK_MONOTONIC, &end_time);
+    result->execution_time_ms = (float)((end_time.tv_sec - start_time.tv_sec) * 1000.0 +
+                                        (end_time.tv_nsec - start_time.tv_nsec) / 1000000.0);
+    return result;
 }
 
 // Get database statistics
@@ -403,16 +809,20 @@ int get_total_states(void) {
 }
 
 int get_total_assessments(void) {
-    return sample_data_count;
+    const Snapshot* snapshot = db_snapshot_acquire();
+    int total = snapshot ? (int)snapshot->row_count : sample_data_count;
+    db_snapshot_release();
+    return total;
 }
 
 int get_critical_blocks_count(void) {
+    const Snapshot* snapshot = db_snapshot_acquire();
     int count = 0;
-    for (int i = 0; i < sample_data_count; i++) {
-        if (strcmp(sample_data[i].category, "Critical") == 0 ||
-            strcmp(sample_data[i].category, "Over-Exploited") == 0) {
-            count++;
-        }
+    if (snapshot) {
+        const SnapshotRange* critical = snapshot_find_category(snapshot, "Critical");
+        const SnapshotRange* over_exploited = snapshot_find_category(snapshot, "Over-Exploited");
+        count = (int)((critical ? critical->count : 0) + (over_exploited ? over_exploited->count : 0));
     }
+    db_snapshot_release();
     return count;
-}
\ No newline at end of file
+}
@@ -12,6 +12,26 @@ void db_close(void) {
     printf("[DB] Database closed (stub mode)\n");
 }
 
+QueryResult* query_result_new(int capacity, const char* query_type) {
+    QueryResult* result = calloc(1, sizeof(QueryResult));
+    if (!result) return NULL;
+    snprintf(result->query_type, sizeof(result->query_type), "%s", query_type ? query_type : "");
+    if (!query_result_reserve(result, capacity)) {
+        free(result);
+        return NULL;
+    }
+    return result;
+}
+
+bool query_result_reserve(QueryResult* result, int capacity) {
+    if (capacity <= result->capacity) return true;
+    GroundwaterData* grown = realloc(result->data, sizeof(GroundwaterData) * (size_t)capacity);
+    if (!grown) return false;
+    result->data = grown;
+    result->capacity = capacity;
+    return true;
+}
+
 void free_query_result(QueryResult* result) {
     if (result) {
         if (result->data) free(result->data);
@@ -0,0 +1,387 @@
+/*
+ * INGRES ChatBot - Asynchronous / Pipelined Query Batches
+ * Issues independent queries in one round trip using libpq non-blocking
+ * pipeline mode, with an in-memory fallback when no database is attached.
+ */
+
+#include "db_async.h"
+#include "query_cache.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef USE_POSTGRESQL
+#include "db_pool.h"
+#ifndef _WIN32
+#include <poll.h>
+#endif
+#endif
+
+typedef struct {
+    QueryKind kind;
+    char* params[3];
+    QueryResult* result;
+    bool sent;              // Went out in the pipeline (not a cache hit)
+    bool failed;
+} BatchQuery;
+
+struct DbBatch {
+    BatchQuery queries[DB_BATCH_MAX_QUERIES];
+    int count;
+    bool submitted;
+    DbBatchStatus status;
+#ifdef USE_POSTGRESQL
+    PooledConnection* pc;
+    int current;            // Sent query whose results are being read
+    bool flush_pending;     // Output still buffered in libpq
+    struct timespec started;
+    unsigned long dataset_version;  // As of submit, for query cache stamping
+#endif
+};
+
+DbBatch* db_batch_create(void) {
+    DbBatch* batch = calloc(1, sizeof(DbBatch));
+    if (batch) batch->status = DB_BATCH_PENDING;
+    return batch;
+}
+
+static char* copy_param(const char* value) {
+    return value ? strdup(value) : NULL;
+}
+
+static int add_query(DbBatch* batch, QueryKind kind, const char* a, const char* b, const char* c) {
+    if (!batch || batch->submitted || batch->count >= DB_BATCH_MAX_QUERIES) return -1;
+
+    BatchQuery* q = &batch->queries[batch->count];
+    q->kind = kind;
+    q->params[0] = copy_param(a);
+    q->params[1] = copy_param(b);
+    q->params[2] = copy_param(c);
+    q->result = NULL;
+    q->sent = false;
+    q->failed = false;
+    return batch->count++;
+}
+
+int db_batch_add_location(DbBatch* batch, const char* state, const char* district, const char* block) {
+    return add_query(batch, QUERY_KIND_LOCATION, state, district, block);
+}
+
+int db_batch_add_state(DbBatch* batch, const char* state) {
+    return add_query(batch, QUERY_KIND_STATE, state, NULL, NULL);
+}
+
+int db_batch_add_category(DbBatch* batch, const char* category) {
+    return add_query(batch, QUERY_KIND_CATEGORY, category, NULL, NULL);
+}
+
+int db_batch_count(const DbBatch* batch) {
+    return batch ? batch->count : 0;
+}
+
+// Synchronous path: used without a pool and to retry individual queries that
+// failed inside a pipeline
+static void run_query_sync(BatchQuery* q) {
+    switch (q->kind) {
+        case QUERY_KIND_STATE:
+            q->result = query_by_state(q->params[0]);
+            break;
+        case QUERY_KIND_CATEGORY:
+            q->result = query_by_category(q->params[0]);
+            break;
+        case QUERY_KIND_LOCATION:
+        default:
+            q->result = query_by_location(q->params[0], q->params[1], q->params[2]);
+            break;
+    }
+    q->failed = q->result == NULL;
+}
+
+static void run_all_sync(DbBatch* batch) {
+    for (int i = 0; i < batch->count; i++) {
+        if (!batch->queries[i].result) {
+            run_query_sync(&batch->queries[i]);
+        }
+    }
+    batch->status = DB_BATCH_DONE;
+}
+
+#if defined(USE_POSTGRESQL) && defined(LIBPQ_HAS_PIPELINING)
+
+static DbStatement statement_for(QueryKind kind, int* nparams) {
+    switch (kind) {
+        case QUERY_KIND_STATE:
+            *nparams = 1;
+            return DB_STMT_BY_STATE;
+        case QUERY_KIND_CATEGORY:
+            *nparams = 1;
+            return DB_STMT_BY_CATEGORY;
+        case QUERY_KIND_LOCATION:
+        default:
+            *nparams = 3;
+            return DB_STMT_BY_LOCATION;
+    }
+}
+
+// Leave pipeline mode and hand the connection back. Any query that did not
+// get a result is answered synchronously (from the pool or in-memory store).
+static void finish_pipeline(DbBatch* batch, bool healthy) {
+    if (batch->pc) {
+        PGconn* conn = db_pool_conn(batch->pc);
+        if (healthy && PQpipelineStatus(conn) != PQ_PIPELINE_OFF) {
+            healthy = PQexitPipelineMode(conn) == 1;
+        }
+        PQsetnonblocking(conn, 0);
+        db_pool_release(batch->pc, healthy);
+        batch->pc = NULL;
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    float elapsed_ms = (float)((now.tv_sec - batch->started.tv_sec) * 1000.0 +
+                               (now.tv_nsec - batch->started.tv_nsec) / 1000000.0);
+
+    for (int i = 0; i < batch->count; i++) {
+        BatchQuery* q = &batch->queries[i];
+        if (!q->result) {
+            run_query_sync(q);
+        } else if (q->sent) {
+            // Each query's latency is the shared round trip
+            q->result->execution_time_ms = elapsed_ms;
+            query_cache_put(q->kind, q->params[0], q->params[1], q->params[2], q->result,
+                            batch->dataset_version);
+        }
+    }
+    batch->status = DB_BATCH_DONE;
+}
+
+static int next_sent(const DbBatch* batch, int from) {
+    while (from < batch->count && !batch->queries[from].sent) from++;
+    return from;
+}
+
+static bool submit_pipeline(DbBatch* batch) {
+    batch->pc = db_pool_acquire(DB_POOL_ACQUIRE_TIMEOUT_MS);
+    if (!batch->pc) return false;
+
+    PGconn* conn = db_pool_conn(batch->pc);
+    if (PQsetnonblocking(conn, 1) != 0 || PQenterPipelineMode(conn) != 1) {
+        PQsetnonblocking(conn, 0);
+        db_pool_release(batch->pc, true);
+        batch->pc = NULL;
+        return false;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &batch->started);
+    batch->dataset_version = db_dataset_version();
+    for (int i = 0; i < batch->count; i++) {
+        BatchQuery* q = &batch->queries[i];
+        if (q->result) continue;   // Served from the query cache
+
+        int nparams;
+        DbStatement stmt = statement_for(q->kind, &nparams);
+        const char* const params[3] = {q->params[0], q->params[1], q->params[2]};
+
+        if (PQsendQueryPrepared(conn, db_pool_statement_name(stmt), nparams,
+                                params, NULL, NULL, 1 /* binary */) != 1) {
+            fprintf(stderr, "❌ Pipeline send failed: %s\n", PQerrorMessage(conn));
+            finish_pipeline(batch, false);
+            return true;
+        }
+        q->sent = true;
+    }
+
+    if (PQpipelineSync(conn) != 1) {
+        finish_pipeline(batch, false);
+        return true;
+    }
+
+    int flushed = PQflush(conn);
+    if (flushed < 0) {
+        finish_pipeline(batch, false);
+        return true;
+    }
+    batch->flush_pending = flushed == 1;
+    batch->current = next_sent(batch, 0);
+    return true;
+}
+
+static DbBatchStatus poll_pipeline(DbBatch* batch) {
+    PGconn* conn = db_pool_conn(batch->pc);
+
+    if (batch->flush_pending) {
+        int flushed = PQflush(conn);
+        if (flushed < 0) {
+            finish_pipeline(batch, false);
+            return batch->status;
+        }
+        batch->flush_pending = flushed == 1;
+    }
+
+    if (PQconsumeInput(conn) != 1) {
+        finish_pipeline(batch, false);
+        return batch->status;
+    }
+
+    while (!PQisBusy(conn)) {
+        PGresult* res = PQgetResult(conn);
+
+        if (!res) {
+            // End of the current query's results
+            batch->current = next_sent(batch, batch->current + 1);
+            continue;
+        }
+
+        ExecStatusType status = PQresultStatus(res);
+        if (status == PGRES_PIPELINE_SYNC) {
+            PQclear(res);
+            finish_pipeline(batch, true);
+            return batch->status;
+        }
+
+        if (batch->current < batch->count) {
+            BatchQuery* q = &batch->queries[batch->current];
+            if (status == PGRES_TUPLES_OK && !q->result) {
+                QueryResult* result = query_result_new(0, "Pipelined Query");
+                if (result && db_pool_decode_result(res, result)) {
+                    q->result = result;
+                } else {
+                    free_query_result(result);
+                    q->failed = true;
+                }
+            } else if (status != PGRES_TUPLES_OK) {
+                // PGRES_FATAL_ERROR or PGRES_PIPELINE_ABORTED; retried
+                // synchronously once the pipeline drains
+                q->failed = true;
+            }
+        }
+        PQclear(res);
+    }
+
+    return DB_BATCH_PENDING;
+}
+
+#endif // USE_POSTGRESQL && LIBPQ_HAS_PIPELINING
+
+bool db_batch_submit(DbBatch* batch) {
+    if (!batch || batch->submitted) return false;
+    batch->submitted = true;
+
+    // Hot lookups never reach the database
+    int pending = 0;
+    for (int i = 0; i < batch->count; i++) {
+        BatchQuery* q = &batch->queries[i];
+        q->result = query_cache_get(q->kind, q->params[0], q->params[1], q->params[2]);
+        if (!q->result) pending++;
+    }
+
+    if (pending == 0) {
+        batch->status = DB_BATCH_DONE;
+        return true;
+    }
+
+#if defined(USE_POSTGRESQL) && defined(LIBPQ_HAS_PIPELINING)
+    if (db_pool_is_ready() && submit_pipeline(batch)) {
+        return true;
+    }
+#endif
+
+    run_all_sync(batch);
+    return true;
+}
+
+int db_batch_socket(const DbBatch* batch) {
+#if defined(USE_POSTGRESQL) && defined(LIBPQ_HAS_PIPELINING)
+    if (batch && batch->pc && batch->status == DB_BATCH_PENDING) {
+        return PQsocket(db_pool_conn(batch->pc));
+    }
+#else
+    (void)batch;
+#endif
+    return -1;
+}
+
+bool db_batch_wants_write(const DbBatch* batch) {
+#if defined(USE_POSTGRESQL) && defined(LIBPQ_HAS_PIPELINING)
+    return batch && batch->pc && batch->flush_pending;
+#else
+    (void)batch;
+    return false;
+#endif
+}
+
+DbBatchStatus db_batch_poll(DbBatch* batch) {
+    if (!batch || !batch->submitted) return DB_BATCH_FAILED;
+    if (batch->status != DB_BATCH_PENDING) return batch->status;
+
+#if defined(USE_POSTGRESQL) && defined(LIBPQ_HAS_PIPELINING)
+    if (batch->pc) {
+        return poll_pipeline(batch);
+    }
+#endif
+
+    run_all_sync(batch);
+    return batch->status;
+}
+
+DbBatchStatus db_batch_wait(DbBatch* batch, int timeout_ms) {
+    if (timeout_ms <= 0) timeout_ms = DB_BATCH_DEFAULT_TIMEOUT_MS;
+
+    DbBatchStatus status = db_batch_poll(batch);
+
+#if defined(USE_POSTGRESQL) && defined(LIBPQ_HAS_PIPELINING) && !defined(_WIN32)
+    struct timespec start, now;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    while (status == DB_BATCH_PENDING) {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        long elapsed = (long)((now.tv_sec - start.tv_sec) * 1000 +
+                              (now.tv_nsec - start.tv_nsec) / 1000000);
+        if (elapsed >= timeout_ms) {
+            // Give up on the pipeline; the connection is reset by the pool
+            finish_pipeline(batch, false);
+            return batch->status;
+        }
+
+        struct pollfd pfd = {
+            .fd = db_batch_socket(batch),
+            .events = (short)(POLLIN | (db_batch_wants_write(batch) ? POLLOUT : 0))
+        };
+        poll(&pfd, 1, (int)(timeout_ms - elapsed));
+        status = db_batch_poll(batch);
+    }
+#endif
+
+    return status;
+}
+
+QueryResult* db_batch_take_result(DbBatch* batch, int index) {
+    if (!batch || index < 0 || index >= batch->count) return NULL;
+
+    QueryResult* result = batch->queries[index].result;
+    batch->queries[index].result = NULL;
+    return result;
+}
+
+void db_batch_free(DbBatch* batch) {
+    if (!batch) return;
+
+#if defined(USE_POSTGRESQL) && defined(LIBPQ_HAS_PIPELINING)
+    if (batch->pc) {
+        // Abandoned mid-flight: the pool resets the connection
+        PQsetnonblocking(db_pool_conn(batch->pc), 0);
+        db_pool_release(batch->pc, false);
+        batch->pc = NULL;
+    }
+#endif
+
+    for (int i = 0; i < batch->count; i++) {
+        BatchQuery* q = &batch->queries[i];
+        for (int p = 0; p < 3; p++) {
+            free(q->params[p]);
+        }
+        free_query_result(q->result);
+    }
+    free(batch);
+}
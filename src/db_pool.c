@@ -0,0 +1,521 @@
+/*
+ * INGRES ChatBot - PostgreSQL Connection Pool
+ * Fixed-size libpq pool with per-connection prepared statements,
+ * health checks and reconnect-with-backoff.
+ */
+
+#include "db_pool.h"
+
+#ifdef USE_POSTGRESQL
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+// Compiled-in defaults, used when neither INGRES_DB_CONNINFO nor
+// DATABASE_URL is set
+#define DB_HOST "localhost"
+#define DB_PORT "5432"
+#define DB_NAME "ingres_groundwater"
+#define DB_USER "postgres"
+#define DB_PASS "postgres123"
+
+// PostgreSQL type OIDs we accept in result columns (pg_type.h)
+#define PG_OID_INT4    23
+#define PG_OID_TEXT    25
+#define PG_OID_FLOAT4  700
+#define PG_OID_VARCHAR 1043
+
+// Every statement returns the same column layout so rows can be decoded
+// directly into GroundwaterData.
+#define ASSESSMENT_COLUMNS \
+    "SELECT state::text, district::text, coalesce(block, '')::text, category::text, " \
+    "annual_recharge::float4, net_availability::float4, annual_extraction::float4, " \
+    "assessment_year::int4 FROM groundwater_assessment "
+
+typedef struct {
+    const char* name;
+    const char* sql;
+    int nparams;
+} PreparedStatementDef;
+
+static const PreparedStatementDef statement_defs[DB_STMT_COUNT] = {
+    [DB_STMT_BY_LOCATION] = {
+        "ingres_by_location",
+        ASSESSMENT_COLUMNS
+        "WHERE ($1::text IS NULL OR lower(state) = lower($1)) "
+        "AND ($2::text IS NULL OR lower(district) = lower($2)) "
+        "AND ($3::text IS NULL OR lower(block) = lower($3)) "
+        "ORDER BY state, district, block",
+        3
+    },
+    [DB_STMT_BY_STATE] = {
+        "ingres_by_state",
+        ASSESSMENT_COLUMNS
+        "WHERE lower(state) = lower($1) ORDER BY district, block",
+        1
+    },
+    [DB_STMT_BY_CATEGORY] = {
+        "ingres_by_category",
+        ASSESSMENT_COLUMNS
+        "WHERE lower(category::text) = lower($1) ORDER BY state, district, block",
+        1
+    },
+};
+
+typedef enum {
+    SLOT_DOWN,      // Not connected; eligible for reconnect after next_retry_ms
+    SLOT_UP         // Connected and idle or checked out
+} SlotState;
+
+struct PooledConnection {
+    PGconn* conn;
+    SlotState state;
+    bool in_use;
+    unsigned prepared_mask;     // Bit per DbStatement prepared on this conn
+    int failures;               // Consecutive connect failures (drives backoff)
+    uint64_t next_retry_ms;     // Earliest reconnect attempt
+    time_t last_used;           // For idle pings
+    unsigned jitter_seed;       // rand_r state for backoff jitter
+};
+
+static struct {
+    PooledConnection* slots;
+    int size;
+    char* conninfo;
+    atomic_bool ready;          // Read by request threads without the lock
+    pthread_mutex_t lock;
+    pthread_cond_t available;
+    long acquire_timeouts;
+    atomic_long reconnects;
+} pool = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .available = PTHREAD_COND_INITIALIZER
+};
+
+static uint64_t monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+}
+
+static char* build_conninfo(const char* conninfo) {
+    if (conninfo && *conninfo) return strdup(conninfo);
+
+    const char* env = getenv("INGRES_DB_CONNINFO");
+    if (!env || !*env) env = getenv("DATABASE_URL");
+    if (env && *env) return strdup(env);
+
+    char buffer[256];
+    snprintf(buffer, sizeof(buffer),
+             "host=%s port=%s dbname=%s user=%s password=%s connect_timeout=5",
+             DB_HOST, DB_PORT, DB_NAME, DB_USER, DB_PASS);
+    return strdup(buffer);
+}
+
+// Exponential backoff with jitter so a restarted server is not hit by every
+// slot at the same instant
+static void schedule_retry(PooledConnection* pc) {
+    uint64_t delay = DB_POOL_BACKOFF_INITIAL_MS;
+    for (int i = 0; i < pc->failures && delay < DB_POOL_BACKOFF_MAX_MS; i++) {
+        delay *= 2;
+    }
+    if (delay > DB_POOL_BACKOFF_MAX_MS) delay = DB_POOL_BACKOFF_MAX_MS;
+    delay += (uint64_t)(rand_r(&pc->jitter_seed) % (int)(delay / 4 + 1));
+
+    pc->failures++;
+    pc->next_retry_ms = monotonic_ms() + delay;
+}
+
+static bool prepare_statements(PooledConnection* pc) {
+    for (int i = 0; i < DB_STMT_COUNT; i++) {
+        if (pc->prepared_mask & (1u << i)) continue;
+
+        const PreparedStatementDef* def = &statement_defs[i];
+        PGresult* res = PQprepare(pc->conn, def->name, def->sql, def->nparams, NULL);
+        bool ok = res && PQresultStatus(res) == PGRES_COMMAND_OK;
+        if (!ok) {
+            fprintf(stderr, "❌ Failed to prepare %s: %s\n", def->name,
+                    PQerrorMessage(pc->conn));
+        }
+        PQclear(res);
+        if (!ok) return false;
+
+        pc->prepared_mask |= 1u << i;
+    }
+    return true;
+}
+
+// (Re)establish the connection. Called without the pool lock held.
+static bool connect_slot(PooledConnection* pc) {
+    bool was_connected = pc->conn != NULL;
+
+    if (pc->conn) {
+        PQreset(pc->conn);
+    } else {
+        pc->conn = PQconnectdb(pool.conninfo);
+    }
+
+    if (!pc->conn || PQstatus(pc->conn) != CONNECTION_OK) {
+        return false;
+    }
+
+    // Server-side prepared statements do not survive a reconnect
+    pc->prepared_mask = 0;
+    if (!prepare_statements(pc)) {
+        return false;
+    }
+
+    if (was_connected || pc->failures > 0) {
+        atomic_fetch_add(&pool.reconnects, 1);
+    }
+    pc->failures = 0;
+    pc->last_used = time(NULL);
+    return true;
+}
+
+// Verify a checked-out connection before handing it to a caller
+static bool check_slot(PooledConnection* pc) {
+    if (pc->state == SLOT_DOWN) {
+        return connect_slot(pc);
+    }
+
+    if (PQstatus(pc->conn) != CONNECTION_OK) {
+        return connect_slot(pc);
+    }
+
+    if (time(NULL) - pc->last_used >= DB_POOL_IDLE_PING_SECONDS) {
+        PGresult* res = PQexec(pc->conn, "SELECT 1");
+        bool alive = res && PQresultStatus(res) == PGRES_TUPLES_OK;
+        PQclear(res);
+        if (!alive) return connect_slot(pc);
+    }
+
+    return pc->prepared_mask == (1u << DB_STMT_COUNT) - 1 || prepare_statements(pc);
+}
+
+bool db_pool_init(const char* conninfo, int size) {
+    if (pool.slots) return atomic_load(&pool.ready);
+
+    if (size <= 0) {
+        const char* env = getenv("INGRES_DB_POOL_SIZE");
+        size = env ? atoi(env) : DB_POOL_DEFAULT_SIZE;
+    }
+    if (size <= 0) size = DB_POOL_DEFAULT_SIZE;
+    if (size > DB_POOL_MAX_SIZE) size = DB_POOL_MAX_SIZE;
+
+    pool.conninfo = build_conninfo(conninfo);
+    pool.slots = calloc((size_t)size, sizeof(PooledConnection));
+    if (!pool.conninfo || !pool.slots) {
+        free(pool.conninfo);
+        free(pool.slots);
+        pool.conninfo = NULL;
+        pool.slots = NULL;
+        return false;
+    }
+    pool.size = size;
+    pool.acquire_timeouts = 0;
+    atomic_store(&pool.reconnects, 0);
+
+    int connected = 0;
+    for (int i = 0; i < size; i++) {
+        PooledConnection* pc = &pool.slots[i];
+        pc->jitter_seed = (unsigned)time(NULL) ^ ((unsigned)i * 2654435761u);
+        if (connect_slot(pc)) {
+            pc->state = SLOT_UP;
+            connected++;
+        } else {
+            pc->state = SLOT_DOWN;
+            schedule_retry(pc);
+        }
+    }
+
+    if (connected == 0) {
+        fprintf(stderr, "❌ Database pool could not connect: %s\n",
+                pool.slots[0].conn ? PQerrorMessage(pool.slots[0].conn) : "out of memory");
+        db_pool_shutdown();
+        return false;
+    }
+
+    atomic_store(&pool.ready, true);
+    printf("✅ Database pool ready: %d/%d connections\n", connected, size);
+    return true;
+}
+
+void db_pool_shutdown(void) {
+    pthread_mutex_lock(&pool.lock);
+    for (int i = 0; i < pool.size; i++) {
+        if (pool.slots[i].conn) {
+            PQfinish(pool.slots[i].conn);
+        }
+    }
+    free(pool.slots);
+    free(pool.conninfo);
+    pool.slots = NULL;
+    pool.conninfo = NULL;
+    pool.size = 0;
+    atomic_store(&pool.ready, false);
+    pthread_cond_broadcast(&pool.available);
+    pthread_mutex_unlock(&pool.lock);
+}
+
+bool db_pool_is_ready(void) {
+    return atomic_load(&pool.ready);
+}
+
+void db_pool_get_stats(DbPoolStats* stats) {
+    if (!stats) return;
+
+    pthread_mutex_lock(&pool.lock);
+    stats->size = pool.size;
+    stats->healthy = 0;
+    stats->in_use = 0;
+    for (int i = 0; i < pool.size; i++) {
+        if (pool.slots[i].state == SLOT_UP) stats->healthy++;
+        if (pool.slots[i].in_use) stats->in_use++;
+    }
+    stats->acquire_timeouts = pool.acquire_timeouts;
+    stats->reconnects = atomic_load(&pool.reconnects);
+    pthread_mutex_unlock(&pool.lock);
+}
+
+static PooledConnection* claim_slot_locked(void) {
+    uint64_t now = monotonic_ms();
+
+    // Prefer a connection that is already up
+    for (int i = 0; i < pool.size; i++) {
+        if (!pool.slots[i].in_use && pool.slots[i].state == SLOT_UP) {
+            pool.slots[i].in_use = true;
+            return &pool.slots[i];
+        }
+    }
+
+    // Otherwise take a broken slot whose backoff has expired
+    for (int i = 0; i < pool.size; i++) {
+        if (!pool.slots[i].in_use && pool.slots[i].state == SLOT_DOWN &&
+            now >= pool.slots[i].next_retry_ms) {
+            pool.slots[i].in_use = true;
+            return &pool.slots[i];
+        }
+    }
+
+    return NULL;
+}
+
+PooledConnection* db_pool_acquire(int timeout_ms) {
+    if (!atomic_load(&pool.ready)) return NULL;
+    if (timeout_ms <= 0) timeout_ms = DB_POOL_ACQUIRE_TIMEOUT_MS;
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&pool.lock);
+    for (;;) {
+        if (!pool.slots) {
+            pthread_mutex_unlock(&pool.lock);
+            return NULL;
+        }
+
+        PooledConnection* pc = claim_slot_locked();
+        if (pc) {
+            pthread_mutex_unlock(&pool.lock);
+
+            // Health checks and reconnects run outside the lock
+            bool healthy = check_slot(pc);
+
+            pthread_mutex_lock(&pool.lock);
+            if (healthy) {
+                pc->state = SLOT_UP;
+                pthread_mutex_unlock(&pool.lock);
+                return pc;
+            }
+            pc->state = SLOT_DOWN;
+            pc->in_use = false;
+            schedule_retry(pc);
+            continue;
+        }
+
+        // Wake up at the earlier of the deadline and the next retry window so
+        // a recovering database is picked up without a release signal
+        struct timespec wait_until = deadline;
+        uint64_t now = monotonic_ms();
+        uint64_t next_retry = UINT64_MAX;
+        for (int i = 0; i < pool.size; i++) {
+            if (!pool.slots[i].in_use && pool.slots[i].state == SLOT_DOWN &&
+                pool.slots[i].next_retry_ms < next_retry) {
+                next_retry = pool.slots[i].next_retry_ms;
+            }
+        }
+        if (next_retry != UINT64_MAX) {
+            struct timespec retry_at;
+            uint64_t delta = next_retry > now ? next_retry - now : 0;
+            clock_gettime(CLOCK_REALTIME, &retry_at);
+            retry_at.tv_sec += (time_t)(delta / 1000);
+            retry_at.tv_nsec += (long)(delta % 1000) * 1000000L;
+            if (retry_at.tv_nsec >= 1000000000L) {
+                retry_at.tv_sec++;
+                retry_at.tv_nsec -= 1000000000L;
+            }
+            if (retry_at.tv_sec < wait_until.tv_sec ||
+                (retry_at.tv_sec == wait_until.tv_sec && retry_at.tv_nsec < wait_until.tv_nsec)) {
+                wait_until = retry_at;
+            }
+        }
+
+        int rc = pthread_cond_timedwait(&pool.available, &pool.lock, &wait_until);
+        if (rc == ETIMEDOUT) {
+            struct timespec now_rt;
+            clock_gettime(CLOCK_REALTIME, &now_rt);
+            if (now_rt.tv_sec > deadline.tv_sec ||
+                (now_rt.tv_sec == deadline.tv_sec && now_rt.tv_nsec >= deadline.tv_nsec)) {
+                pool.acquire_timeouts++;
+                pthread_mutex_unlock(&pool.lock);
+                return NULL;
+            }
+        }
+    }
+}
+
+void db_pool_release(PooledConnection* pc, bool healthy) {
+    if (!pc) return;
+
+    pthread_mutex_lock(&pool.lock);
+    pc->in_use = false;
+    pc->last_used = time(NULL);
+    if (!healthy || PQstatus(pc->conn) != CONNECTION_OK) {
+        // Reset lazily on the next acquire rather than blocking the caller
+        pc->state = SLOT_DOWN;
+        pc->next_retry_ms = monotonic_ms();
+    }
+    pthread_cond_signal(&pool.available);
+    pthread_mutex_unlock(&pool.lock);
+}
+
+PGconn* db_pool_conn(PooledConnection* pc) {
+    return pc ? pc->conn : NULL;
+}
+
+const char* db_pool_statement_name(DbStatement stmt) {
+    if (stmt < 0 || stmt >= DB_STMT_COUNT) return NULL;
+    return statement_defs[stmt].name;
+}
+
+// ============================================================================
+// BINARY RESULT DECODING
+// ============================================================================
+
+static uint32_t read_be32(const char* p) {
+    const unsigned char* u = (const unsigned char*)p;
+    return ((uint32_t)u[0] << 24) | ((uint32_t)u[1] << 16) |
+           ((uint32_t)u[2] << 8) | (uint32_t)u[3];
+}
+
+static float read_float4(const PGresult* res, int row, int col) {
+    if (PQgetisnull(res, row, col) || PQgetlength(res, row, col) != 4) return 0.0f;
+    uint32_t bits = read_be32(PQgetvalue(res, row, col));
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static int read_int4(const PGresult* res, int row, int col) {
+    if (PQgetisnull(res, row, col) || PQgetlength(res, row, col) != 4) return 0;
+    return (int)(int32_t)read_be32(PQgetvalue(res, row, col));
+}
+
+// Binary text values are raw bytes without a terminator guarantee in the
+// protocol; copy by length and clamp to the fixed-size field.
+static void read_text(const PGresult* res, int row, int col, char* dest, size_t size) {
+    if (PQgetisnull(res, row, col)) {
+        dest[0] = '\0';
+        return;
+    }
+    size_t len = (size_t)PQgetlength(res, row, col);
+    if (len >= size) len = size - 1;
+    memcpy(dest, PQgetvalue(res, row, col), len);
+    dest[len] = '\0';
+}
+
+bool db_pool_decode_result(const PGresult* res, QueryResult* out) {
+    if (!res || !out) return false;
+    if (PQresultStatus(res) != PGRES_TUPLES_OK || PQnfields(res) != 8) return false;
+
+    static const Oid expected[8] = {
+        PG_OID_TEXT, PG_OID_TEXT, PG_OID_TEXT, PG_OID_TEXT,
+        PG_OID_FLOAT4, PG_OID_FLOAT4, PG_OID_FLOAT4, PG_OID_INT4
+    };
+    for (int col = 0; col < 8; col++) {
+        Oid type = PQftype(res, col);
+        bool text_ok = expected[col] == PG_OID_TEXT && type == PG_OID_VARCHAR;
+        if (type != expected[col] && !text_ok) return false;
+        if (PQfformat(res, col) != 1) return false;
+    }
+
+    int rows = PQntuples(res);
+    out->count = 0;
+    if (!query_result_reserve(out, rows)) return false;
+
+    for (int row = 0; row < rows; row++) {
+        GroundwaterData* record = &out->data[row];
+        read_text(res, row, 0, record->state, sizeof(record->state));
+        read_text(res, row, 1, record->district, sizeof(record->district));
+        read_text(res, row, 2, record->block, sizeof(record->block));
+        read_text(res, row, 3, record->category, sizeof(record->category));
+        record->annual_recharge = read_float4(res, row, 4);
+        record->extractable_resource = read_float4(res, row, 5);
+        record->annual_extraction = read_float4(res, row, 6);
+        record->assessment_year = read_int4(res, row, 7);
+    }
+    out->count = rows;
+    return true;
+}
+
+QueryResult* db_pool_query(DbStatement stmt, const char* const* params, int nparams,
+                           const char* query_type) {
+    if (stmt < 0 || stmt >= DB_STMT_COUNT || nparams != statement_defs[stmt].nparams) {
+        return NULL;
+    }
+
+    uint64_t start = monotonic_ms();
+    PooledConnection* pc = db_pool_acquire(DB_POOL_ACQUIRE_TIMEOUT_MS);
+    if (!pc) return NULL;
+
+    PGresult* res = PQexecPrepared(pc->conn, statement_defs[stmt].name, nparams,
+                                   params, NULL, NULL, 1 /* binary results */);
+
+    if (!res || PQresultStatus(res) != PGRES_TUPLES_OK) {
+        bool connection_ok = PQstatus(pc->conn) == CONNECTION_OK;
+        fprintf(stderr, "❌ Query %s failed: %s\n", statement_defs[stmt].name,
+                PQerrorMessage(pc->conn));
+        PQclear(res);
+        db_pool_release(pc, connection_ok);
+        return NULL;
+    }
+
+    QueryResult* result = query_result_new(0, query_type ? query_type : "PostgreSQL Query");
+    if (!result || !db_pool_decode_result(res, result)) {
+        free_query_result(result);
+        PQclear(res);
+        db_pool_release(pc, true);
+        return NULL;
+    }
+
+    PQclear(res);
+    db_pool_release(pc, true);
+
+    result->execution_time_ms = (float)(monotonic_ms() - start);
+    return result;
+}
+
+#endif // USE_POSTGRESQL
@@ -1,5 +1,6 @@
 #include "chatbot.h"
 #include "intent_patterns.h"
+#include "arena.h"
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
@@ -28,7 +29,6 @@ typedef struct {
 
 // Forward declarations for helper functions
 bool is_stop_word(const char* word);
-float calculate_advanced_similarity(const char* str1, const char* str2);
 float calculate_jaccard_similarity(const char* str1, const char* str2);
 float calculate_ngram_score(const char* input, EnhancedIntentPattern* pattern, int word_count, char* words[]);
 float calculate_context_score(ConversationContext* context, EnhancedIntentPattern* pattern, const char* input);
@@ -277,12 +277,21 @@ float calculate_similarity(const char* str1, const char* str2) {
 
 // Enhanced pattern matching with advanced fuzzy logic and N-gram analysis
 IntentType classify_intent_advanced(const char* user_input, ConversationContext* context, float* confidence) {
-    if (!user_input) {
+    Arena* arena = arena_acquire();
+    IntentType intent = classify_intent_arena(arena, user_input, context, confidence);
+    arena_release(arena);
+    return intent;
+}
+
+// Scratch (lowercased input, token copy) comes from the caller's arena
+IntentType classify_intent_arena(Arena* arena, const char* user_input, ConversationContext* context,
+                                 float* confidence) {
+    if (!user_input || !arena) {
         *confidence = 0.0;
         return INTENT_ERROR;
     }
 
-    char* lower_input = string_to_lower((char*)user_input);
+    char* lower_input = arena_lower(arena, user_input);
     if (!lower_input) {
         *confidence = 0.0;
         return INTENT_ERROR;
@@ -294,15 +303,16 @@ IntentType classify_intent_advanced(const char* user_input, ConversationContext*
     // Tokenize input for advanced analysis
     char* words[100];
     int word_count = 0;
-    char* input_copy = strdup(lower_input);
-    char* token = strtok(input_copy, " ,.!?;:\"'()");
+    char* input_copy = arena_strdup(arena, lower_input);
+    char* save = NULL;
+    char* token = input_copy ? strtok_r(input_copy, " ,.!?;:\"'()", &save) : NULL;
 
     while (token && word_count < 100) {
         // Skip very short words and common stop words
         if (strlen(token) > 1 && !is_stop_word(token)) {
             words[word_count++] = token;
         }
-        token = strtok(NULL, " ,.!?;:\"'()");
+        token = strtok_r(NULL, " ,.!?;:\"'()", &save);
     }
 
     for (int i = 0; i < enhanced_pattern_count; i++) {
@@ -379,9 +389,6 @@ IntentType classify_intent_advanced(const char* user_input, ConversationContext*
         }
     }
 
-    free(input_copy);
-    free(lower_input);
-
     *confidence = best_score;
 
     // Return UNKNOWN if confidence is too low
@@ -522,20 +529,21 @@ float calculate_coverage_ratio(const char* input, EnhancedIntentPattern* pattern
 }
 
 // Extract locations from user input
-int extract_locations(const char* user_input, char** state, char** district, char** block) {
-    if (!user_input) return 0;
-    
-    char* lower_input = string_to_lower((char*)user_input);
-    int locations_found = 0;
-    
+int extract_locations(Arena* arena, const char* user_input, const char** state, const char** district,
+                      const char** block) {
     *state = NULL;
     *district = NULL;
     *block = NULL;
+    if (!user_input || !arena) return 0;
+    
+    char* lower_input = arena_lower(arena, user_input);
+    if (!lower_input) return 0;
+    int locations_found = 0;
     
     // Check for state names
     for (int i = 0; i < state_count; i++) {
         if (strstr(lower_input, indian_states[i])) {
-            *state = strdup(indian_states[i]);
+            *state = indian_states[i];
             locations_found++;
             break;
         }
@@ -544,7 +552,7 @@ int extract_locations(const char* user_input, char** state, char** district, cha
     // Check for city names (could be districts)
     for (int i = 0; i < city_count; i++) {
         if (strstr(lower_input, major_cities[i])) {
-            *district = strdup(major_cities[i]);
+            *district = major_cities[i];
             locations_found++;
             break;
         }
@@ -554,12 +562,13 @@ int extract_locations(const char* user_input, char** state, char** district, cha
     if (locations_found == 0) {
         char* words[20];
         int word_count = 0;
-        char* input_copy = strdup(lower_input);
-        char* token = strtok(input_copy, " ");
+        char* input_copy = arena_strdup(arena, lower_input);
+        char* save = NULL;
+        char* token = input_copy ? strtok_r(input_copy, " ", &save) : NULL;
         
         while (token && word_count < 20) {
             words[word_count++] = token;
-            token = strtok(NULL, " ");
+            token = strtok_r(NULL, " ", &save);
         }
         
         // Check each word against state names
@@ -567,18 +576,15 @@ int extract_locations(const char* user_input, char** state, char** district, cha
             for (int j = 0; j < state_count; j++) {
                 float similarity = calculate_similarity(words[i], indian_states[j]);
                 if (similarity > 0.8) {  // 80% similarity for location names
-                    *state = strdup(indian_states[j]);
+                    *state = indian_states[j];
                     locations_found++;
                     break;
                 }
             }
             if (*state) break;
         }
-        
-        free(input_copy);
     }
     
-    free(lower_input);
     return locations_found;
 }
 
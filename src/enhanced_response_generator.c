@@ -1,9 +1,21 @@
 #include "chatbot.h"
 #include "database.h"
+#include "db_async.h"
+#include "response_render.h"
+#include "pool.h"
+#include "metrics.h"
+#include "logger.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
+#include <ctype.h>
 #include <time.h>
+#include <pthread.h>
+
+// Location names known to the intent matcher (enhanced_intent_patterns.c)
+extern const char* indian_states[];
+extern int state_count;
 
 // Multi-language response templates
 typedef struct {
@@ -20,7 +32,7 @@ typedef struct {
 // Comprehensive response templates
 MultilingualResponseTemplate enhanced_templates[] = {
     {
-        .intent = 1,  // INTENT_GREETING
+        .intent = INTENT_GREETING,
         .english_template = "🌊 Namaste! Welcome to INGRES - India's Groundwater Resource Expert System!\n\n"
                            "I'm your AI assistant for comprehensive groundwater information across India. "
                            "I can help you with:\n\n"
@@ -54,29 +66,31 @@ MultilingualResponseTemplate enhanced_templates[] = {
     },
     
     {
-        .intent = 7,  // INTENT_QUERY_LOCATION
-        .english_template = "🔍 **GROUNDWATER ANALYSIS FOR %s**\n\n"
-                           "📍 **Location**: %s\n"
-                           "📅 **Assessment Year**: %d\n"
-                           "🏷️ **Category**: %s\n"
-                           "💧 **Annual Recharge**: %.2f MCM\n"
-                           "🏭 **Annual Extraction**: %.2f MCM\n"
-                           "📊 **Stage of Extraction**: %.1f%%\n"
-                           "⚖️ **Net Availability**: %.2f MCM\n\n"
-                           "**Status Interpretation**:\n%s\n\n"
-                           "**Trend**: %s over the past 3 years\n"
-                           "**Risk Level**: %s",
-       .hindi_template = "🔍 **%s के लिए भूजल विश्लेषण**\n\n"
-                        "📍 **स्थान**: %s\n"
-                        "📅 **मूल्यांकन वर्ष**: %d\n"
-                        "🏷️ **श्रेणी**: %s\n"
-                        "💧 **वार्षिक पुनर्भरण**: %.2f एमसीएम\n"
-                        "🏭 **वार्षिक निकासी**: %.2f एमसीएम\n"
-                        "📊 **निकासी का स्तर**: %.1f%%\n"
-                        "⚖️ **नेट उपलब्धता**: %.2f एमसीएम\n\n"
-                        "**स्थिति व्याख्या**:\n%s\n\n"
-                        "**प्रवृत्ति**: पिछले 3 वर्षों में %s\n"
-                        "**जोखिम स्तर**: %s",
+        .intent = INTENT_QUERY_LOCATION,
+        .english_template = "🔍 **GROUNDWATER ANALYSIS FOR {location}**\n\n"
+                           "📍 **Location**: {location}\n"
+                           "🧮 **Blocks Assessed**: {block_count}\n"
+                           "📅 **Assessment Year**: {year}\n"
+                           "🏷️ **Category**: {category}\n"
+                           "💧 **Annual Recharge**: {recharge} MCM\n"
+                           "🏭 **Annual Extraction**: {extraction} MCM\n"
+                           "📊 **Stage of Extraction**: {stage}%\n"
+                           "⚖️ **Net Availability**: {extractable} MCM\n\n"
+                           "**Status Interpretation**:\n{interpretation}\n\n"
+                           "**Trend**: {trend} since {first_year} ({trend_rate}% per year)\n"
+                           "**Risk Level**: {risk}",
+       .hindi_template = "🔍 **{location} के लिए भूजल विश्लेषण**\n\n"
+                        "📍 **स्थान**: {location}\n"
+                        "🧮 **आकलित ब्लॉक**: {block_count}\n"
+                        "📅 **मूल्यांकन वर्ष**: {year}\n"
+                        "🏷️ **श्रेणी**: {category}\n"
+                        "💧 **वार्षिक पुनर्भरण**: {recharge} एमसीएम\n"
+                        "🏭 **वार्षिक निकासी**: {extraction} एमसीएम\n"
+                        "📊 **निकासी का स्तर**: {stage}%\n"
+                        "⚖️ **नेट उपलब्धता**: {extractable} एमसीएम\n\n"
+                        "**स्थिति व्याख्या**:\n{interpretation}\n\n"
+                        "**प्रवृत्ति**: {first_year} से {trend} ({trend_rate}% प्रति वर्ष)\n"
+                        "**जोखिम स्तर**: {risk}",
         .needs_location = true,
         .needs_data = true,
         .follow_up_suggestions = {
@@ -90,44 +104,24 @@ MultilingualResponseTemplate enhanced_templates[] = {
     },
     
     {
-        .intent = 37,  // INTENT_CRITICAL_AREAS
+        .intent = INTENT_CRITICAL_AREAS,
         .english_template = "🚨 **CRITICAL GROUNDWATER AREAS - URGENT ATTENTION REQUIRED**\n\n"
-                           "**OVER-EXPLOITED REGIONS** (>100%% extraction):\n"
-                           "🔴 **Punjab**: 78%% of blocks affected\n"
-                           "   • Amritsar: 165%% extraction rate\n"
-                           "   • Ludhiana: 178%% extraction rate\n"
-                           "   • Bathinda: 156%% extraction rate\n\n"
-                           "🔴 **Haryana**: 45%% of blocks affected\n"
-                           "   • Sirsa: 189%% extraction rate\n"
-                           "   • Hisar: 145%% extraction rate\n\n"
-                           "🔴 **Tamil Nadu**: Urban stress zones\n"
-                           "   • Chennai: 167%% extraction rate\n\n"
-                           "**CRITICAL REGIONS** (90-100%% extraction):\n"
-                           "🟠 **Maharashtra**: Pune (156%%), Aurangabad (145%%)\n"
-                           "🟠 **Karnataka**: Bangalore Urban (167%%)\n"
-                           "🟠 **Gujarat**: Ahmedabad City (156%%)\n"
-                           "🟠 **Rajasthan**: Alwar (134%%)\n\n"
+                           "**OVER-EXPLOITED BLOCKS** ({block_count} in the {year} assessment):\n"
+                           "{rows}\n"
+                           "**CRITICAL BLOCKS** ({other_block_count} in the {other_year} assessment):\n"
+                           "{other_rows}\n"
+                           "Figures are annual extraction as a share of net annual availability.\n\n"
                            "**IMMEDIATE ACTIONS NEEDED**:\n"
                            "• Strict groundwater extraction regulations\n"
                            "• Mandatory rainwater harvesting\n"
                            "• Crop pattern diversification\n"
                            "• Industrial water recycling",
        .hindi_template = "🚨 **महत्वपूर्ण भूजल क्षेत्र - तत्काल ध्यान आवश्यक**\n\n"
-                        "**अति-शोषित क्षेत्र** (>100%% निकासी):\n"
-                        "🔴 **पंजाब**: 78%% ब्लॉक प्रभावित\n"
-                        "   • अमृतसर: 165%% निकासी दर\n"
-                        "   • लुधियाना: 178%% निकासी दर\n"
-                        "   • बठिंडा: 156%% निकासी दर\n\n"
-                        "🔴 **हरियाणा**: 45%% ब्लॉक प्रभावित\n"
-                        "   • सिरसा: 189%% निकासी दर\n"
-                        "   • हिसार: 145%% निकासी दर\n\n"
-                        "🔴 **तमिलनाडु**: शहरी तनाव क्षेत्र\n"
-                        "   • चेन्नई: 167%% निकासी दर\n\n"
-                        "**महत्वपूर्ण क्षेत्र** (90-100%% निकासी):\n"
-                        "🟠 **महाराष्ट्र**: पुणे (156%%), औरंगाबाद (145%%)\n"
-                        "🟠 **कर्नाटक**: बंगलौर शहरी (167%%)\n"
-                        "🟠 **गुजरात**: अहमदाबाद शहर (156%%)\n"
-                        "🟠 **राजस्थान**: अलवर (134%%)\n\n"
+                        "**अति-शोषित ब्लॉक** ({year} मूल्यांकन में {block_count}):\n"
+                        "{rows}\n"
+                        "**महत्वपूर्ण ब्लॉक** ({other_year} मूल्यांकन में {other_block_count}):\n"
+                        "{other_rows}\n"
+                        "आंकड़े शुद्ध वार्षिक उपलब्धता के प्रतिशत के रूप में वार्षिक निकासी हैं।\n\n"
                         "**तत्काल कार्रवाई आवश्यक**:\n"
                         "• कड़े भूजल निकासी नियम\n"
                         "• अनिवार्य वर्षा जल संचयन\n"
@@ -146,23 +140,20 @@ MultilingualResponseTemplate enhanced_templates[] = {
     },
     
     {
-        .intent = 44,  // INTENT_COMPARE_LOCATIONS
+        .intent = INTENT_COMPARE_LOCATIONS,
         .english_template = "🔄 **COMPARATIVE GROUNDWATER ANALYSIS**\n\n"
-                           "**%s vs %s** (Latest Assessment)\n\n"
-                           "| Parameter | %s | %s |\n"
+                           "**{location} vs {other_location}** (Latest Assessment)\n\n"
+                           "| Parameter | {location} | {other_location} |\n"
                            "|-----------|---------|----------|\n"
-                           "| Over-exploited blocks | %d%% | %d%% |\n"
-                           "| Average extraction | %.1f%% | %.1f%% |\n"
-                           "| Water table trend | %s | %s |\n"
-                           "| Primary concern | %s | %s |\n"
-                           "| Risk level | %s | %s |\n\n"
+                           "| Assessed blocks | {block_count} | {other_block_count} |\n"
+                           "| Critical or over-exploited | {stressed_pct}% | {other_stressed_pct}% |\n"
+                           "| Stage of extraction | {stage}% | {other_stage}% |\n"
+                           "| Net availability (MCM) | {extractable} | {other_extractable} |\n"
+                           "| Availability trend | {trend} | {other_trend} |\n"
+                           "| Risk level | {risk} | {other_risk} |\n\n"
                            "**KEY INSIGHTS**:\n"
-                           "• %s shows %s groundwater stress\n"
-                           "• %s has %s management practices\n"
-                           "• Both regions need %s\n\n"
-                           "**RECOMMENDATIONS**:\n"
-                           "• %s: Focus on %s\n"
-                           "• %s: Implement %s",
+                           "• {location}: {interpretation}\n"
+                           "• {other_location}: {other_interpretation}",
         .needs_location = true,
         .needs_data = true,
         .follow_up_suggestions = {
@@ -176,28 +167,19 @@ MultilingualResponseTemplate enhanced_templates[] = {
     },
     
     {
-        .intent = 52,  // INTENT_HISTORICAL_TREND
+        .intent = INTENT_HISTORICAL_TREND,
         .english_template = "📈 **HISTORICAL GROUNDWATER TREND ANALYSIS**\n\n"
-                           "📍 **Location**: %s\n"
-                           "📅 **Analysis Period**: 2019-2023 (5 years)\n\n"
-                           "**YEAR-WISE EXTRACTION TRENDS**:\n"
-                           "• 2019: %.1f%% extraction\n"
-                           "• 2020: %.1f%% extraction (%+.1f%%)\n"
-                           "• 2021: %.1f%% extraction (%+.1f%%)\n"
-                           "• 2022: %.1f%% extraction (%+.1f%%)\n"
-                           "• 2023: %.1f%% extraction (%+.1f%%)\n\n"
+                           "📍 **Location**: {location}\n"
+                           "📅 **Analysis Period**: {first_year}-{year}\n\n"
+                           "**YEAR-WISE EXTRACTION TRENDS** (stage of extraction | net availability):\n"
+                           "{history}\n"
                            "**TREND ANALYSIS**:\n"
-                           "📊 **Overall Trend**: %s\n"
-                           "📉 **Annual Change Rate**: %+.2f%% per year\n"
-                           "🎯 **Category Change**: %s → %s\n"
-                           "⚠️ **Risk Trajectory**: %s\n\n"
-                           "**CONTRIBUTING FACTORS**:\n"
-                           "• Rainfall variation: %s\n"
-                           "• Agricultural practices: %s\n"
-                           "• Industrial growth: %s\n"
-                           "• Policy interventions: %s\n\n"
-                           "**FUTURE PROJECTION** (2024-2026):\n"
-                           "If current trend continues: %s",
+                           "📊 **Overall Trend**: {trend}\n"
+                           "📉 **Annual Change Rate**: {trend_rate}% per year in net availability\n"
+                           "🎯 **Category Change**: {first_category} → {category}\n"
+                           "⚠️ **Risk Level**: {risk}\n\n"
+                           "**FUTURE PROJECTION** ({projection_year}):\n"
+                           "If the current trend continues: {projection} MCM net availability",
         .needs_location = true,
         .needs_data = true,
         .follow_up_suggestions = {
@@ -211,8 +193,8 @@ MultilingualResponseTemplate enhanced_templates[] = {
     },
     
     {
-        .intent = 72,  // INTENT_POLICY_SUGGESTION
-        .english_template = "🏛️ **COMPREHENSIVE POLICY RECOMMENDATIONS FOR %s**\n\n"
+        .intent = INTENT_POLICY_SUGGESTION,
+        .english_template = "🏛️ **COMPREHENSIVE POLICY RECOMMENDATIONS FOR {location}**\n\n"
                            "**IMMEDIATE MEASURES** (0-6 months):\n"
                            "🚨 **Regulatory Actions**:\n"
                            "• Implement groundwater extraction permits\n"
@@ -221,7 +203,7 @@ MultilingualResponseTemplate enhanced_templates[] = {
                            "• Real-time monitoring system installation\n\n"
                            "💧 **Conservation Mandates**:\n"
                            "• Rainwater harvesting for buildings >300 sq.m\n"
-                           "• Drip irrigation subsidies (50%% cost)\n"
+                           "• Drip irrigation subsidies (50% cost)\n"
                            "• Greywater recycling in urban areas\n\n"
                            "**MEDIUM-TERM STRATEGIES** (6 months - 2 years):\n"
                            "🌾 **Agricultural Reforms**:\n"
@@ -230,7 +212,7 @@ MultilingualResponseTemplate enhanced_templates[] = {
                            "• Promote drought-resistant varieties\n"
                            "• Micro-irrigation expansion\n\n"
                            "🏭 **Industrial Measures**:\n"
-                           "• Water recycling mandates (80%% reuse)\n"
+                           "• Water recycling mandates (80% reuse)\n"
                            "• Effluent treatment plant upgrades\n"
                            "• Water-positive industrial policies\n\n"
                            "**LONG-TERM VISION** (2-5 years):\n"
@@ -239,12 +221,11 @@ MultilingualResponseTemplate enhanced_templates[] = {
                            "• Inter-basin water transfer projects\n"
                            "• Community-based water management\n"
                            "• Climate-resilient water infrastructure\n\n"
-                           "**FINANCIAL FRAMEWORK**:\n"
-                           "💰 **Investment Required**: ₹%d crores\n"
-                           "📊 **Expected Impact**: %d%% reduction in extraction\n"
-                           "⏱️ **Timeline**: %d years for full implementation",
+                           "**PRIORITY FOR {location}**:\n"
+                           "📊 {stressed_count} of {block_count} assessed blocks are Critical or Over-Exploited\n"
+                           "📈 Net availability trend: {trend} ({trend_rate}% per year)",
         .needs_location = true,
-        .needs_data = false,
+        .needs_data = true,
         .follow_up_suggestions = {
             "Show successful policy examples",
             "Economic analysis of recommendations",
@@ -256,7 +237,7 @@ MultilingualResponseTemplate enhanced_templates[] = {
     },
     
     {
-        .intent = 73,  // INTENT_CONSERVATION_METHODS
+        .intent = INTENT_CONSERVATION_METHODS,
         .english_template = "🌱 **COMPREHENSIVE WATER CONSERVATION STRATEGIES**\n\n"
                            "**RAINWATER HARVESTING**:\n"
                            "🏠 **Rooftop Systems**:\n"
@@ -270,8 +251,8 @@ MultilingualResponseTemplate enhanced_templates[] = {
                            "• Watershed management\n\n"
                            "**AGRICULTURAL EFFICIENCY**:\n"
                            "💧 **Micro-irrigation**:\n"
-                           "• Drip irrigation: 30-50%% water savings\n"
-                           "• Sprinkler systems: 20-40%% savings\n"
+                           "• Drip irrigation: 30-50% water savings\n"
+                           "• Sprinkler systems: 20-40% savings\n"
                            "• Fertigation: Nutrient + water efficiency\n\n"
                            "🌾 **Crop Management**:\n"
                            "• Drought-resistant varieties\n"
@@ -280,7 +261,7 @@ MultilingualResponseTemplate enhanced_templates[] = {
                            "• Precision agriculture techniques\n\n"
                            "**INDUSTRIAL CONSERVATION**:\n"
                            "♻️ **Water Recycling**:\n"
-                           "• Closed-loop systems: 80-90%% reuse\n"
+                           "• Closed-loop systems: 80-90% reuse\n"
                            "• Membrane technologies\n"
                            "• Zero liquid discharge (ZLD)\n\n"
                            "**URBAN STRATEGIES**:\n"
@@ -308,30 +289,30 @@ MultilingualResponseTemplate enhanced_templates[] = {
     },
     
     {
-        .intent = 66,  // INTENT_RAINFALL_CORRELATION
+        .intent = INTENT_RAINFALL_CORRELATION,
         .english_template = "🌧️ **RAINFALL-GROUNDWATER CORRELATION ANALYSIS**\n\n"
                            "**MONSOON IMPACT ON GROUNDWATER RECHARGE**:\n\n"
                            "📊 **Recharge Efficiency by Region**:\n"
-                           "• Western Ghats: 60-80%% (High permeability)\n"
-                           "• Gangetic Plains: 40-60%% (Moderate permeability)\n"
-                           "• Deccan Plateau: 30-50%% (Variable geology)\n"
-                           "• Arid Regions: 10-30%% (Low permeability)\n\n"
+                           "• Western Ghats: 60-80% (High permeability)\n"
+                           "• Gangetic Plains: 40-60% (Moderate permeability)\n"
+                           "• Deccan Plateau: 30-50% (Variable geology)\n"
+                           "• Arid Regions: 10-30% (Low permeability)\n\n"
                            "**SEASONAL PATTERNS**:\n"
                            "🌦️ **Southwest Monsoon** (June-September):\n"
-                           "• Contributes 70-80%% of annual recharge\n"
+                           "• Contributes 70-80% of annual recharge\n"
                            "• Peak recharge: July-August\n"
                            "• Regional variation: 500-3000mm rainfall\n\n"
                            "🌨️ **Northeast Monsoon** (October-December):\n"
-                           "• Contributes 15-20%% of annual recharge\n"
+                           "• Contributes 15-20% of annual recharge\n"
                            "• Critical for Tamil Nadu and Andhra Pradesh\n"
                            "• Coastal areas benefit most\n\n"
                            "**RAINFALL-RECHARGE RELATIONSHIPS**:\n"
-                           "📈 **Good Monsoon** (>110%% of normal):\n"
-                           "• Groundwater recharge: +15 to +25%%\n"
+                           "📈 **Good Monsoon** (>110% of normal):\n"
+                           "• Groundwater recharge: +15 to +25%\n"
                            "• Water table rise: 1-3 meters\n"
                            "• Category improvement possible\n\n"
-                           "📉 **Poor Monsoon** (<90%% of normal):\n"
-                           "• Groundwater recharge: -20 to -40%%\n"
+                           "📉 **Poor Monsoon** (<90% of normal):\n"
+                           "• Groundwater recharge: -20 to -40%\n"
                            "• Water table decline: 0.5-2 meters\n"
                            "• Increased extraction stress\n\n"
                            "**CLIMATE CHANGE IMPACTS**:\n"
@@ -358,31 +339,31 @@ MultilingualResponseTemplate enhanced_templates[] = {
     },
     
     {
-        .intent = 80,  // INTENT_TECHNICAL_EXPLANATION
+        .intent = INTENT_TECHNICAL_EXPLANATION,
         .english_template = "🔬 **TECHNICAL GROUNDWATER CONCEPTS EXPLAINED**\n\n"
                            "**STAGE OF GROUNDWATER EXTRACTION**:\n"
                            "📊 **Formula**: (Annual Extraction / Net Annual Availability) × 100\n\n"
                            "**CATEGORY DEFINITIONS**:\n"
-                           "🟢 **SAFE** (<70%% extraction):\n"
+                           "🟢 **SAFE** (<70% extraction):\n"
                            "• Sustainable extraction levels\n"
                            "• No restrictions on development\n"
                            "• Water table stable or rising\n"
-                           "• Example: Jaipur (65%%), Kolkata (56%%)\n\n"
-                           "🟡 **SEMI-CRITICAL** (70-90%% extraction):\n"
+                           "• Example: Jaipur (65%), Kolkata (56%)\n\n"
+                           "🟡 **SEMI-CRITICAL** (70-90% extraction):\n"
                            "• Moderate stress on aquifer\n"
                            "• Careful development needed\n"
                            "• Monitoring required\n"
-                           "• Example: Nashik (89%%), Coimbatore (98%%)\n\n"
-                           "🟠 **CRITICAL** (90-100%% extraction):\n"
+                           "• Example: Nashik (89%), Coimbatore (98%)\n\n"
+                           "🟠 **CRITICAL** (90-100% extraction):\n"
                            "• High stress on groundwater\n"
                            "• Immediate intervention needed\n"
                            "• Regulated development\n"
-                           "• Example: Pune (156%%), Bangalore (167%%)\n\n"
-                           "🔴 **OVER-EXPLOITED** (>100%% extraction):\n"
+                           "• Example: Pune (156%), Bangalore (167%)\n\n"
+                           "🔴 **OVER-EXPLOITED** (>100% extraction):\n"
                            "• Groundwater mining occurring\n"
                            "• Ban on new extractions\n"
                            "• Urgent conservation needed\n"
-                           "• Example: Amritsar (165%%), Ludhiana (178%%)\n\n"
+                           "• Example: Amritsar (165%), Ludhiana (178%)\n\n"
                            "**KEY PARAMETERS EXPLAINED**:\n\n"
                            "💧 **Annual Recharge**:\n"
                            "• Natural replenishment from rainfall\n"
@@ -390,9 +371,9 @@ MultilingualResponseTemplate enhanced_templates[] = {
                            "• Artificial recharge contributions\n"
                            "• Measured in Million Cubic Meters (MCM)\n\n"
                            "🏭 **Annual Extraction**:\n"
-                           "• Agricultural use (85-90%%)\n"
-                           "• Domestic use (5-10%%)\n"
-                           "• Industrial use (2-5%%)\n"
+                           "• Agricultural use (85-90%)\n"
+                           "• Domestic use (5-10%)\n"
+                           "• Industrial use (2-5%)\n"
                            "• Measured through surveys and estimates\n\n"
                            "⚖️ **Net Annual Availability**:\n"
                            "• Total recharge minus natural discharge\n"
@@ -420,113 +401,310 @@ MultilingualResponseTemplate enhanced_templates[] = {
 
 int enhanced_template_count = sizeof(enhanced_templates) / sizeof(MultilingualResponseTemplate);
 
-// Generate enhanced response with context awareness
-BotResponse* generate_enhanced_response(IntentType intent, const char* user_input, 
-                                      ConversationContext* context, const char* location, 
-                                      const char* query_details) {
-    BotResponse* response = malloc(sizeof(BotResponse));
-    if (!response) return NULL;
-    
-    // Initialize response structure
-    response->intent = intent;
-    response->query_result = NULL;
-    response->has_data = false;
-    response->processing_time_ms = 0.0;
+// Strings every templated response cites; borrowed, never freed
+static char* const default_sources[] = {
+    "Central Ground Water Board (CGWB)",
+    "National Water Informatics Centre (NWIC)",
+    "State Ground Water Departments"
+};
+static char default_language[] = "en";
+static char fallback_message[] = "I apologize, but I couldn't generate a proper response for your query. "
+                                 "Please try rephrasing or ask for help.";
+static char allocation_failed_message[] = "Memory allocation error occurred.";
+
+// Templates compiled once into literal segments and typed slots, indexed by
+// intent so dispatch is a single array load. Intents whose text never varies
+// (no slots, or no template at all) get a prebuilt response shared by every
+// request.
+typedef struct {
+    const MultilingualResponseTemplate* source;
+    TemplateProgram* program;
+    bool is_shared;
+    BotResponse shared;
+} CompiledTemplate;
+
+static CompiledTemplate templates_by_intent[INTENT_COUNT];
+static TemplateProgram* missing_data_program;
+static pthread_once_t templates_once = PTHREAD_ONCE_INIT;
+
+// Suggestions, sources and language all point into static storage
+static void borrow_template_fields(BotResponse* response, const MultilingualResponseTemplate* template) {
     response->confidence_score = 0.8;  // Default confidence
-    response->suggestion_count = 0;
-    response->requires_clarification = false;
-    response->clarification_question = NULL;
-    response->context = context;
-    response->source_count = 0;
-    response->is_multilingual = false;
-    response->language_code = strdup("en");
-    
-    // Initialize suggestions array
-    for (int i = 0; i < 5; i++) {
-        response->suggested_actions[i] = NULL;
+    response->language_code = default_language;
+    if (!template) return;
+
+    response->suggestion_count = template->suggestion_count < 5 ? template->suggestion_count : 5;
+    for (int i = 0; i < response->suggestion_count; i++) {
+        response->suggested_actions[i] = template->follow_up_suggestions[i];
     }
-    
-    // Find matching template
-    MultilingualResponseTemplate* template = NULL;
+    for (int i = 0; i < 3; i++) {
+        response->data_sources[i] = default_sources[i];
+    }
+    response->source_count = 3;
+}
+
+static void compile_templates(void) {
     for (int i = 0; i < enhanced_template_count; i++) {
-        if (enhanced_templates[i].intent == intent) {
-            template = &enhanced_templates[i];
-            break;
+        const MultilingualResponseTemplate* template = &enhanced_templates[i];
+        CompiledTemplate* compiled = &templates_by_intent[template->intent];
+        if (compiled->source) continue;  // First template for an intent wins
+
+        // A template that fails to compile is treated as missing, so its
+        // raw placeholders never reach a user
+        TemplateProgram* program = template_compile(template->english_template);
+        if (!program) {
+            log_message(LOG_ERROR, "Template for intent %d failed to compile; skipping it",
+                        template->intent);
+            continue;
         }
+        compiled->source = template;
+        compiled->program = program;
     }
-    
-    if (!template) {
-        response->message = strdup("I apologize, but I couldn't generate a proper response for your query. Please try rephrasing or ask for help.");
-        return response;
+    missing_data_program = template_compile("⚠️ No groundwater assessment data found for {location}. "
+                                            "Try a state such as Punjab or a district such as Amritsar.");
+
+    for (int intent = 0; intent < INTENT_COUNT; intent++) {
+        CompiledTemplate* compiled = &templates_by_intent[intent];
+        char* text = fallback_message;
+        if (compiled->source) text = (char*)template_static_text(compiled->program);
+        if (!text) continue;  // Rendered per request
+
+        BotResponse* shared = &compiled->shared;
+        shared->intent = (IntentType)intent;
+        shared->message = text;
+        borrow_template_fields(shared, compiled->source);
+        compiled->is_shared = true;
     }
-    
-    // Copy suggestions
-    response->suggestion_count = template->suggestion_count;
-    for (int i = 0; i < template->suggestion_count && i < 5; i++) {
-        response->suggested_actions[i] = strdup(template->follow_up_suggestions[i]);
+}
+
+// Query results backing one response; primary_rows moves into the response
+typedef struct {
+    QueryResult* primary_rows;
+    QueryResult* secondary_rows;
+    QueryResult* primary_history;
+    QueryResult* secondary_history;
+} BoundResults;
+
+static void free_bound_results(BoundResults* bound) {
+    free_query_result(bound->primary_rows);
+    free_query_result(bound->secondary_rows);
+    free_query_result(bound->primary_history);
+    free_query_result(bound->secondary_history);
+}
+
+// A second state named in the input, for comparisons
+static const char* find_other_state(const char* input, const char* exclude) {
+    if (!input) return NULL;
+
+    char lower[MAX_INPUT_LENGTH];
+    size_t length = 0;
+    for (; input[length] && length < sizeof(lower) - 1; length++) {
+        lower[length] = (char)tolower((unsigned char)input[length]);
     }
-    
-    // Generate response based on template and data needs
-    char* formatted_response = malloc(4096);  // Larger buffer for complex responses
-    if (!formatted_response) {
-        response->message = strdup("Memory allocation error occurred.");
-        return response;
+    lower[length] = '\0';
+
+    for (int i = 0; i < state_count; i++) {
+        if (exclude && strcasecmp(indian_states[i], exclude) == 0) continue;
+        if (strstr(lower, indian_states[i])) return indian_states[i];
     }
-    
-    if (template->needs_data && location) {
-        // Fetch data and format response with actual data
-        // This is a simplified version - in real implementation, 
-        // you would query the database here
-        snprintf(formatted_response, 4096, template->english_template, 
-                location, location, 2023, "Over-Exploited", 156.8, 178.5, 113.8, 89.2,
-                "This area shows severe groundwater stress with extraction exceeding sustainable limits.",
-                "Declining", "Very High");
-    } else if (intent == INTENT_COMPARE_LOCATIONS) {
-        // Handle comparison responses
-        const char* loc1 = location ? location : "Punjab";
-        const char* loc2 = "Haryana";  // Default comparison
-        snprintf(formatted_response, 4096, template->english_template,
-                loc1, loc2, loc1, loc2, 78, 45, 150.5, 95.2,
-                "Declining 2-3m", "Mixed trends", "Rice-wheat cultivation", "Industrial demand",
-                "Very High", "High", loc1, "higher", loc2, "better",
-                "immediate intervention", loc1, "crop diversification", loc2, "industrial regulation");
+    return NULL;
+}
+
+// Resolve a batch slot that came back empty as a district name instead
+static QueryResult* location_rows_or_district(QueryResult* state_rows, const char* location) {
+    if (state_rows && state_rows->count > 0) return state_rows;
+    free_query_result(state_rows);
+    return query_by_location(NULL, location, NULL);
+}
+
+// History for the same scope the rows were found at (state or district)
+static QueryResult* location_history(const char* location, const QueryResult* rows) {
+    if (!location) return query_historical_trend(NULL, NULL, NULL);
+    if (rows && rows->count > 0 && strcasecmp(rows->data[0].state, location) == 0) {
+        return query_historical_trend(location, NULL, NULL);
+    }
+    return query_historical_trend(NULL, location, NULL);
+}
+
+// Independent lookups go out as one batch (a single pipelined round trip
+// with the PostgreSQL pool). Rendering runs on an admission worker, so
+// waiting here blocks that worker, never the event loop.
+static void fetch_pair(bool by_category, const char* first, const char* second,
+                       QueryResult** first_rows, QueryResult** second_rows) {
+    DbBatch* batch = db_batch_create();
+    int first_index = -1, second_index = -1;
+    if (batch) {
+        first_index = by_category ? db_batch_add_category(batch, first) : db_batch_add_state(batch, first);
+        second_index = by_category ? db_batch_add_category(batch, second) : db_batch_add_state(batch, second);
+        if (db_batch_submit(batch)) db_batch_wait(batch, DB_BATCH_DEFAULT_TIMEOUT_MS);
+    }
+    *first_rows = batch ? db_batch_take_result(batch, first_index) : NULL;
+    *second_rows = batch ? db_batch_take_result(batch, second_index) : NULL;
+    db_batch_free(batch);
+}
+
+static void bind_data(IntentType intent, const char* location, const char* user_input,
+                      RenderData* data, BoundResults* bound) {
+    memset(bound, 0, sizeof(*bound));
+
+    switch (intent) {
+        case INTENT_CRITICAL_AREAS:
+            render_aggregate_init(&data->primary, "Over-Exploited");
+            render_aggregate_init(&data->secondary, "Critical");
+            fetch_pair(true, "Over-Exploited", "Critical", &bound->primary_rows, &bound->secondary_rows);
+            break;
+
+        case INTENT_COMPARE_LOCATIONS: {
+            const char* first = location ? location : "punjab";
+            const char* second = find_other_state(user_input, first);
+            if (!second) second = strcasecmp(first, "haryana") == 0 ? "punjab" : "haryana";
+
+            render_aggregate_init(&data->primary, first);
+            render_aggregate_init(&data->secondary, second);
+            fetch_pair(false, first, second, &bound->primary_rows, &bound->secondary_rows);
+            bound->primary_rows = location_rows_or_district(bound->primary_rows, first);
+            bound->secondary_rows = location_rows_or_district(bound->secondary_rows, second);
+            bound->primary_history = location_history(first, bound->primary_rows);
+            bound->secondary_history = location_history(second, bound->secondary_rows);
+            break;
+        }
+
+        default:
+            // One location (a state, else a district), or all of India
+            render_aggregate_init(&data->primary, location);
+            render_aggregate_init(&data->secondary, NULL);
+            bound->primary_rows = location ? location_rows_or_district(query_by_state(location), location)
+                                           : query_by_location(NULL, NULL, NULL);
+            bound->primary_history = location_history(location, bound->primary_rows);
+            break;
+    }
+
+    render_aggregate_rows(&data->primary, bound->primary_rows);
+    render_aggregate_rows(&data->secondary, bound->secondary_rows);
+    render_aggregate_history(&data->primary, bound->primary_history);
+    render_aggregate_history(&data->secondary, bound->secondary_history);
+}
+
+// Generate enhanced response with context awareness
+BotResponse* generate_enhanced_response(IntentType intent, const char* user_input, 
+                                      ConversationContext* context, const char* location, 
+                                      const char* query_details) {
+    pthread_once(&templates_once, compile_templates);
+    if ((unsigned)intent >= INTENT_COUNT) intent = INTENT_UNKNOWN;
+
+    // Output that never varies comes from the prebuilt response: no allocation
+    CompiledTemplate* compiled = &templates_by_intent[intent];
+    if (compiled->is_shared) return &compiled->shared;
+
+    BotResponse* response = bot_response_new(intent);
+    if (!response) return NULL;
+    response->context = context;
+
+    const MultilingualResponseTemplate* template = compiled->source;
+    borrow_template_fields(response, template);
+
+    const TemplateProgram* program = compiled->program;
+    if (template->needs_data) {
+        // Bind the template's slots to query results for the actual location
+        RenderData data;
+        BoundResults bound;
+        uint64_t stage_ns = metrics_now_ns();
+        bind_data(intent, location, query_details ? query_details : user_input, &data, &bound);
+        stage_ns = metrics_record_since(METRIC_DB_QUERY, stage_ns);
+
+        bool missing = template->needs_location && location && data.primary.block_count == 0;
+        response->message = template_render_alloc(missing ? missing_data_program : program, &data, NULL);
+        metrics_record_since(METRIC_RENDER, stage_ns);
+
+        // The primary rows travel with the response
+        response->query_result = bound.primary_rows;
+        response->has_data = bound.primary_rows && bound.primary_rows->count > 0;
+        if (response->query_result) response->owned |= RESPONSE_OWNS_QUERY_RESULT;
+        bound.primary_rows = NULL;
+        free_bound_results(&bound);
     } else {
-        // Use template as-is for general responses
-        strcpy(formatted_response, template->english_template);
+        RenderData empty;
+        render_aggregate_init(&empty.primary, location);
+        render_aggregate_init(&empty.secondary, NULL);
+        uint64_t stage_ns = metrics_now_ns();
+        response->message = template_render_alloc(program, &empty, NULL);
+        metrics_record_since(METRIC_RENDER, stage_ns);
+    }
+
+    if (response->message) {
+        response->owned |= RESPONSE_OWNS_MESSAGE;
+    } else {
+        response->message = allocation_failed_message;
     }
-    
-    response->message = formatted_response;
-    response->has_data = template->needs_data;
-    
-    // Add data sources
-    response->data_sources[0] = strdup("Central Ground Water Board (CGWB)");
-    response->data_sources[1] = strdup("National Water Informatics Centre (NWIC)");
-    response->data_sources[2] = strdup("State Ground Water Departments");
-    response->source_count = 3;
     
     return response;
 }
 
-// Enhanced free function for new response structure
+// Pooled responses come back as they were freed; clear everything
+static BotResponse* take_response(void) {
+    BotResponse* response = pool_get(POOL_BOT_RESPONSE);
+    return response ? response : malloc(sizeof(BotResponse));
+}
+
+BotResponse* bot_response_new(IntentType intent) {
+    BotResponse* response = take_response();
+    if (!response) return NULL;
+    memset(response, 0, sizeof(BotResponse));
+    response->intent = intent;
+    atomic_init(&response->ref_count, 1);
+    return response;
+}
+
+bool bot_response_is_static(const BotResponse* response) {
+    return response && atomic_load(&response->ref_count) == 0;
+}
+
+BotResponse* bot_response_retain(BotResponse* response) {
+    if (response && !bot_response_is_static(response)) {
+        atomic_fetch_add(&response->ref_count, 1);
+    }
+    return response;
+}
+
+BotResponse* bot_response_borrow(const BotResponse* response) {
+    if (!bot_response_is_static(response)) return NULL;
+
+    BotResponse* copy = take_response();
+    if (!copy) return NULL;
+    memcpy(copy, response, sizeof(BotResponse));
+    copy->owned = 0;
+    atomic_init(&copy->ref_count, 1);
+    return copy;
+}
+
+const BotResponse* bot_response_prebuilt(IntentType intent) {
+    pthread_once(&templates_once, compile_templates);
+    if ((unsigned)intent >= INTENT_COUNT) return NULL;
+    const CompiledTemplate* compiled = &templates_by_intent[intent];
+    return compiled->is_shared ? &compiled->shared : NULL;
+}
+
+// Release one reference; owned fields go with the last one
 void free_enhanced_bot_response(BotResponse* response) {
-    if (!response) return;
-    
-    if (response->message) free(response->message);
-    if (response->query_result) free_query_result(response->query_result);
-    if (response->clarification_question) free(response->clarification_question);
-    if (response->language_code) free(response->language_code);
-    
-    for (int i = 0; i < response->suggestion_count; i++) {
-        if (response->suggested_actions[i]) {
+    if (!response || bot_response_is_static(response)) return;
+    if (atomic_fetch_sub(&response->ref_count, 1) != 1) return;
+
+    unsigned owned = response->owned;
+    if (owned & RESPONSE_OWNS_MESSAGE) free(response->message);
+    if (owned & RESPONSE_OWNS_QUERY_RESULT) free_query_result(response->query_result);
+    if (owned & RESPONSE_OWNS_CLARIFICATION) free(response->clarification_question);
+    if (owned & RESPONSE_OWNS_LANGUAGE) free(response->language_code);
+
+    if (owned & RESPONSE_OWNS_SUGGESTIONS) {
+        for (int i = 0; i < response->suggestion_count; i++) {
             free(response->suggested_actions[i]);
         }
     }
-    
-    for (int i = 0; i < response->source_count; i++) {
-        if (response->data_sources[i]) {
+    if (owned & RESPONSE_OWNS_SOURCES) {
+        for (int i = 0; i < response->source_count; i++) {
             free(response->data_sources[i]);
         }
     }
-    
-    free(response);
-}
\ No newline at end of file
+
+    pool_put(POOL_BOT_RESPONSE, response, free);
+}
@@ -0,0 +1,162 @@
+/*
+ * INGRES ChatBot - Epoch-Based Reclamation
+ * Lock-free reader registration and deferred destruction for objects
+ * swapped under readers (dataset snapshots).
+ */
+
+#include "epoch.h"
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+
+// A reader slot holds the global epoch observed on entry, or 0 while the
+// thread is outside any read section. Slots sit on their own cache lines so
+// readers never contend.
+typedef struct {
+    _Alignas(64) atomic_uint_fast64_t active;
+    atomic_bool claimed;
+} ReaderSlot;
+
+typedef struct RetiredObject {
+    void* object;
+    void (*destroy)(void*);
+    uint64_t epoch;                 // Safe once no reader is active before this
+    struct RetiredObject* next;
+} RetiredObject;
+
+static ReaderSlot slots[EPOCH_MAX_READERS];
+static atomic_uint_fast64_t global_epoch = 1;
+static atomic_int overflow_readers;     // Readers without a slot (conservative)
+
+static pthread_mutex_t retire_lock = PTHREAD_MUTEX_INITIALIZER;
+static RetiredObject* retired = NULL;
+
+static pthread_once_t slot_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t slot_key;
+
+typedef struct {
+    int slot;           // -1 when every slot was taken
+    int depth;
+    bool registered;
+} ReaderState;
+
+static _Thread_local ReaderState reader = {-1, 0, false};
+
+// Give the slot back when its thread exits
+static void release_slot(void* value) {
+    int slot = (int)(intptr_t)value - 1;
+    if (slot >= 0 && slot < EPOCH_MAX_READERS) {
+        atomic_store(&slots[slot].active, 0);
+        atomic_store(&slots[slot].claimed, false);
+    }
+}
+
+static void create_slot_key(void) {
+    pthread_key_create(&slot_key, release_slot);
+}
+
+static void register_reader(void) {
+    reader.registered = true;
+    for (int i = 0; i < EPOCH_MAX_READERS; i++) {
+        bool expected = false;
+        if (!atomic_load_explicit(&slots[i].claimed, memory_order_relaxed) &&
+            atomic_compare_exchange_strong(&slots[i].claimed, &expected, true)) {
+            reader.slot = i;
+            pthread_once(&slot_key_once, create_slot_key);
+            pthread_setspecific(slot_key, (void*)(intptr_t)(i + 1));
+            return;
+        }
+    }
+}
+
+void epoch_enter(void) {
+    if (reader.depth++ > 0) return;
+    if (!reader.registered) register_reader();
+
+    if (reader.slot >= 0) {
+        // seq_cst store then load: a writer scanning slots after advancing
+        // the epoch either sees this reader or this reader sees the new object
+        atomic_store(&slots[reader.slot].active, atomic_load(&global_epoch));
+    } else {
+        atomic_fetch_add(&overflow_readers, 1);
+    }
+}
+
+void epoch_exit(void) {
+    if (reader.depth <= 0 || --reader.depth > 0) return;
+
+    if (reader.slot >= 0) {
+        atomic_store_explicit(&slots[reader.slot].active, 0, memory_order_release);
+    } else {
+        atomic_fetch_sub(&overflow_readers, 1);
+    }
+}
+
+bool epoch_retire(void* object, void (*destroy)(void*)) {
+    if (!object || !destroy) return false;
+
+    RetiredObject* node = malloc(sizeof(RetiredObject));
+    if (!node) return false;
+
+    node->object = object;
+    node->destroy = destroy;
+    node->epoch = atomic_fetch_add(&global_epoch, 1) + 1;
+
+    pthread_mutex_lock(&retire_lock);
+    node->next = retired;
+    retired = node;
+    pthread_mutex_unlock(&retire_lock);
+    return true;
+}
+
+// Oldest epoch any reader is still inside, or UINT64_MAX when none are
+static uint64_t oldest_active_epoch(void) {
+    if (atomic_load(&overflow_readers) > 0) return 0;
+
+    uint64_t oldest = UINT64_MAX;
+    for (int i = 0; i < EPOCH_MAX_READERS; i++) {
+        uint64_t active = atomic_load(&slots[i].active);
+        if (active != 0 && active < oldest) oldest = active;
+    }
+    return oldest;
+}
+
+int epoch_reclaim(void) {
+    uint64_t oldest = oldest_active_epoch();
+    RetiredObject* ready = NULL;
+    int remaining = 0;
+
+    pthread_mutex_lock(&retire_lock);
+    RetiredObject** link = &retired;
+    while (*link) {
+        RetiredObject* node = *link;
+        if (node->epoch <= oldest) {
+            *link = node->next;
+            node->next = ready;
+            ready = node;
+        } else {
+            remaining++;
+            link = &node->next;
+        }
+    }
+    pthread_mutex_unlock(&retire_lock);
+
+    // Destroy outside the lock; unmapping can take a while
+    while (ready) {
+        RetiredObject* next = ready->next;
+        ready->destroy(ready->object);
+        free(ready);
+        ready = next;
+    }
+    return remaining;
+}
+
+bool epoch_drain(int timeout_ms) {
+    struct timespec pause = {0, 1000000};   // 1 ms
+    for (int waited = 0; ; waited++) {
+        if (epoch_reclaim() == 0) return true;
+        if (waited >= timeout_ms) return false;
+        nanosleep(&pause, NULL);
+    }
+}
@@ -1,6 +1,7 @@
 #include "intent_patterns.h"
 #include <string.h>
 #include <stdlib.h>
+#include <pthread.h>
 
 // Define all your intent patterns here
 IntentPattern intent_patterns[] = {
@@ -182,18 +183,38 @@ IntentType match_patterns(const char* user_input) {
     return best_intent;
 }
 
-// Get response template for an intent
-char* get_response_template(IntentType intent) {
-    for (int i = 0; i < template_count; i++) {
-        if (response_templates[i].intent == intent) {
-            return strdup(response_templates[i].template_text);
-        }
+// Templates indexed by intent, with their lengths, built once at startup
+typedef struct {
+    const char* text;
+    size_t length;
+} TemplateText;
+
+static const char fallback_template[] = "[HELP] I didn't quite understand that. Type 'help' for more options.";
+static TemplateText templates_by_intent[INTENT_COUNT];
+static pthread_once_t patterns_once = PTHREAD_ONCE_INIT;
+
+static void build_template_table(void) {
+    for (int i = 0; i < INTENT_COUNT; i++) {
+        templates_by_intent[i] = (TemplateText){fallback_template, sizeof(fallback_template) - 1};
+    }
+    // Earlier entries win, as with the old linear search
+    for (int i = template_count - 1; i >= 0; i--) {
+        const char* text = response_templates[i].template_text;
+        templates_by_intent[response_templates[i].intent] = (TemplateText){text, strlen(text)};
     }
-    return strdup("[HELP] I didn't quite understand that. Type 'help' for more options.");
+}
+
+// Get response template for an intent
+const char* get_response_template(IntentType intent, size_t* length) {
+    pthread_once(&patterns_once, build_template_table);
+    const TemplateText* entry = (unsigned)intent < INTENT_COUNT ? &templates_by_intent[intent]
+                                                                : &templates_by_intent[INTENT_UNKNOWN];
+    if (length) *length = entry->length;
+    return entry->text;
 }
 
 // Initialize patterns (if needed for dynamic loading)
 void init_patterns(void) {
-    // This function can be used to load patterns from a file in the future
-    // For now, patterns are statically defined
-}
\ No newline at end of file
+    // Patterns are statically defined; only the template table is built
+    pthread_once(&patterns_once, build_template_table);
+}
@@ -0,0 +1,280 @@
+/*
+ * INGRES ChatBot - JSON Reader
+ * Pull parser with in-order traversal and unescaping of JSON strings.
+ */
+
+#include "json_reader.h"
+#include "utils.h"
+#include <stdlib.h>
+#include <string.h>
+
+void json_reader_init(JsonReader* json, const char* data, size_t length) {
+    memset(json, 0, sizeof(*json));
+    json->at = data;
+    json->end = data + length;
+    json->failed = data == NULL;
+}
+
+static void skip_space(JsonReader* json) {
+    while (json->at < json->end &&
+           (*json->at == ' ' || *json->at == '\t' || *json->at == '\n' || *json->at == '\r')) {
+        json->at++;
+    }
+}
+
+static bool fail(JsonReader* json) {
+    json->failed = true;
+    return false;
+}
+
+// Consume c after optional whitespace
+static bool expect(JsonReader* json, char c) {
+    skip_space(json);
+    if (json->failed || json->at >= json->end || *json->at != c) return fail(json);
+    json->at++;
+    return true;
+}
+
+JsonValueType json_peek(JsonReader* json) {
+    skip_space(json);
+    if (json->failed || json->at >= json->end) return JSON_VALUE_INVALID;
+    switch (*json->at) {
+        case '"': return JSON_VALUE_STRING;
+        case '{': return JSON_VALUE_OBJECT;
+        case '[': return JSON_VALUE_ARRAY;
+        case 't':
+        case 'f': return JSON_VALUE_BOOL;
+        case 'n': return JSON_VALUE_NULL;
+        default:
+            return (*json->at == '-' || (*json->at >= '0' && *json->at <= '9'))
+                ? JSON_VALUE_NUMBER : JSON_VALUE_INVALID;
+    }
+}
+
+// ============================================================================
+// CONTAINERS
+// ============================================================================
+
+static bool enter(JsonReader* json, char opener, char closer) {
+    if (!expect(json, opener)) return false;
+    if (json->depth + 1 >= JSON_READER_MAX_DEPTH) return fail(json);
+    json->depth++;
+    json->closers[json->depth] = closer;
+    json->has_items[json->depth] = false;
+    return true;
+}
+
+bool json_enter_array(JsonReader* json) { return enter(json, '[', ']'); }
+bool json_enter_object(JsonReader* json) { return enter(json, '{', '}'); }
+
+// Close the container or pass the comma before its next item
+static bool next_item(JsonReader* json) {
+    skip_space(json);
+    if (json->failed || json->depth == 0 || json->at >= json->end) return fail(json);
+
+    if (*json->at == json->closers[json->depth]) {
+        json->at++;
+        json->depth--;
+        return false;
+    }
+    if (json->has_items[json->depth] && !expect(json, ',')) return false;
+    json->has_items[json->depth] = true;
+    return true;
+}
+
+bool json_next_element(JsonReader* json) {
+    if (json->depth > 0 && json->closers[json->depth] != ']') return fail(json);
+    return next_item(json);
+}
+
+bool json_next_member(JsonReader* json, char* key, size_t key_size) {
+    if (json->depth > 0 && json->closers[json->depth] != '}') return fail(json);
+    if (!next_item(json)) return false;
+
+    char* name = json_read_string(json);
+    if (!name || !expect(json, ':')) {
+        free(name);
+        return fail(json);
+    }
+    size_t length = strlen(name);
+    if (key_size > 0) {
+        if (length >= key_size) length = 0;
+        memcpy(key, name, length);
+        key[length] = '\0';
+    }
+    free(name);
+    return true;
+}
+
+// ============================================================================
+// VALUES
+// ============================================================================
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Four hex digits after "\u"; -1 when malformed
+static long read_hex4(JsonReader* json) {
+    if (json->end - json->at < 4) return -1;
+    long value = 0;
+    for (int i = 0; i < 4; i++) {
+        int digit = hex_value(json->at[i]);
+        if (digit < 0) return -1;
+        value = value * 16 + digit;
+    }
+    json->at += 4;
+    return value;
+}
+
+static bool append_utf8(StrBuf* out, unsigned long code) {
+    char bytes[4];
+    size_t length;
+    if (code < 0x80) {
+        bytes[0] = (char)code;
+        length = 1;
+    } else if (code < 0x800) {
+        bytes[0] = (char)(0xC0 | (code >> 6));
+        bytes[1] = (char)(0x80 | (code & 0x3F));
+        length = 2;
+    } else if (code < 0x10000) {
+        bytes[0] = (char)(0xE0 | (code >> 12));
+        bytes[1] = (char)(0x80 | ((code >> 6) & 0x3F));
+        bytes[2] = (char)(0x80 | (code & 0x3F));
+        length = 3;
+    } else {
+        bytes[0] = (char)(0xF0 | (code >> 18));
+        bytes[1] = (char)(0x80 | ((code >> 12) & 0x3F));
+        bytes[2] = (char)(0x80 | ((code >> 6) & 0x3F));
+        bytes[3] = (char)(0x80 | (code & 0x3F));
+        length = 4;
+    }
+    return strbuf_append(out, bytes, length);
+}
+
+// "\uXXXX", joining a surrogate pair into one code point
+static bool read_unicode_escape(JsonReader* json, StrBuf* out) {
+    long code = read_hex4(json);
+    if (code < 0) return false;
+    if (code >= 0xD800 && code <= 0xDBFF) {
+        if (json->end - json->at < 6 || json->at[0] != '\\' || json->at[1] != 'u') return false;
+        json->at += 2;
+        long low = read_hex4(json);
+        if (low < 0xDC00 || low > 0xDFFF) return false;
+        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+    } else if (code >= 0xDC00 && code <= 0xDFFF) {
+        return false;
+    }
+    return append_utf8(out, (unsigned long)code);
+}
+
+// Unescape a string body up to its closing quote onto out (when given)
+static bool read_string_body(JsonReader* json, StrBuf* out) {
+    const char* run = json->at;
+    while (json->at < json->end) {
+        unsigned char c = (unsigned char)*json->at;
+        if (c == '"' || c == '\\') {
+            if (out && !strbuf_append(out, run, (size_t)(json->at - run))) return false;
+            json->at++;
+            if (c == '"') return true;
+            if (json->at >= json->end) return false;
+
+            char escape = *json->at++;
+            char plain;
+            switch (escape) {
+                case '"':  plain = '"'; break;
+                case '\\': plain = '\\'; break;
+                case '/':  plain = '/'; break;
+                case 'b':  plain = '\b'; break;
+                case 'f':  plain = '\f'; break;
+                case 'n':  plain = '\n'; break;
+                case 'r':  plain = '\r'; break;
+                case 't':  plain = '\t'; break;
+                case 'u': {
+                    StrBuf scratch;
+                    strbuf_init(&scratch);
+                    bool ok = read_unicode_escape(json, out ? out : &scratch);
+                    strbuf_free(&scratch);
+                    if (!ok) return false;
+                    run = json->at;
+                    continue;
+                }
+                default: return false;
+            }
+            if (out && !strbuf_append(out, &plain, 1)) return false;
+            run = json->at;
+        } else if (c < 0x20) {
+            return false;       // Control characters must be escaped
+        } else {
+            json->at++;
+        }
+    }
+    return false;
+}
+
+char* json_read_string(JsonReader* json) {
+    if (json_peek(json) != JSON_VALUE_STRING) {
+        fail(json);
+        return NULL;
+    }
+    json->at++;
+
+    StrBuf out;
+    strbuf_init(&out);
+    if (!strbuf_reserve(&out, 64) || !read_string_body(json, &out)) {
+        strbuf_free(&out);
+        fail(json);
+        return NULL;
+    }
+    return out.data;
+}
+
+static bool skip_literal(JsonReader* json, const char* literal) {
+    size_t length = strlen(literal);
+    if ((size_t)(json->end - json->at) < length || memcmp(json->at, literal, length) != 0) return fail(json);
+    json->at += length;
+    return true;
+}
+
+static bool skip_number(JsonReader* json) {
+    if (*json->at == '-') json->at++;
+    const char* digits = json->at;
+    while (json->at < json->end && strchr("0123456789.eE+-", *json->at)) json->at++;
+    return json->at > digits ? true : fail(json);
+}
+
+bool json_skip(JsonReader* json) {
+    switch (json_peek(json)) {
+        case JSON_VALUE_STRING:
+            json->at++;
+            return read_string_body(json, NULL) ? true : fail(json);
+        case JSON_VALUE_NUMBER:
+            return skip_number(json);
+        case JSON_VALUE_BOOL:
+            return skip_literal(json, *json->at == 't' ? "true" : "false");
+        case JSON_VALUE_NULL:
+            return skip_literal(json, "null");
+        case JSON_VALUE_ARRAY:
+            if (!json_enter_array(json)) return false;
+            while (json_next_element(json)) {
+                if (!json_skip(json)) return false;
+            }
+            return !json->failed;
+        case JSON_VALUE_OBJECT:
+            if (!json_enter_object(json)) return false;
+            while (json_next_member(json, NULL, 0)) {
+                if (!json_skip(json)) return false;
+            }
+            return !json->failed;
+        default:
+            return fail(json);
+    }
+}
+
+bool json_reader_done(JsonReader* json) {
+    skip_space(json);
+    return !json->failed && json->depth == 0 && json->at == json->end;
+}
@@ -0,0 +1,148 @@
+/*
+ * INGRES ChatBot - JSON Writer
+ * Comma-tracking, escaping JSON output onto a StrBuf.
+ */
+
+#include "json_writer.h"
+#include <string.h>
+#include <math.h>
+
+void json_writer_init(JsonWriter* json, StrBuf* out) {
+    memset(json, 0, sizeof(*json));
+    json->out = out;
+}
+
+static void append(JsonWriter* json, const char* data, size_t length) {
+    if (!json->failed && !strbuf_append(json->out, data, length)) json->failed = true;
+}
+
+// Separator before a value: nothing after a key, a comma after a sibling
+static void begin_value(JsonWriter* json) {
+    if (json->after_key) {
+        json->after_key = false;
+        return;
+    }
+    if (json->has_items[json->depth]) append(json, ",", 1);
+    json->has_items[json->depth] = true;
+}
+
+// ============================================================================
+// CONTAINERS
+// ============================================================================
+
+static void open_container(JsonWriter* json, char bracket) {
+    begin_value(json);
+    if (json->depth + 1 >= JSON_WRITER_MAX_DEPTH) {
+        json->failed = true;
+        return;
+    }
+    append(json, &bracket, 1);
+    json->has_items[++json->depth] = false;
+}
+
+static void close_container(JsonWriter* json, char bracket) {
+    if (json->depth == 0 || json->after_key) {
+        json->failed = true;
+        return;
+    }
+    json->depth--;
+    append(json, &bracket, 1);
+}
+
+void json_begin_object(JsonWriter* json) { open_container(json, '{'); }
+void json_end_object(JsonWriter* json) { close_container(json, '}'); }
+void json_begin_array(JsonWriter* json) { open_container(json, '['); }
+void json_end_array(JsonWriter* json) { close_container(json, ']'); }
+
+void json_key(JsonWriter* json, const char* key) {
+    json_string(json, key);
+    append(json, ":", 1);
+    json->after_key = true;
+}
+
+// ============================================================================
+// VALUES
+// ============================================================================
+
+bool json_escape_append(StrBuf* out, const char* value, size_t length) {
+    static const char hex[] = "0123456789abcdef";
+    size_t run_start = 0;
+
+    for (size_t i = 0; i < length; i++) {
+        unsigned char c = (unsigned char)value[i];
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+
+        // Flush the unescaped run, then the escape for this byte
+        if (!strbuf_append(out, value + run_start, i - run_start)) return false;
+        run_start = i + 1;
+
+        char escape[6] = { '\\', 0 };
+        size_t escape_length = 2;
+        switch (c) {
+            case '"':  escape[1] = '"'; break;
+            case '\\': escape[1] = '\\'; break;
+            case '\n': escape[1] = 'n'; break;
+            case '\r': escape[1] = 'r'; break;
+            case '\t': escape[1] = 't'; break;
+            case '\b': escape[1] = 'b'; break;
+            case '\f': escape[1] = 'f'; break;
+            default:
+                memcpy(escape, "\\u00", 4);
+                escape[4] = hex[c >> 4];
+                escape[5] = hex[c & 0xF];
+                escape_length = 6;
+                break;
+        }
+        if (!strbuf_append(out, escape, escape_length)) return false;
+    }
+    return strbuf_append(out, value + run_start, length - run_start);
+}
+
+void json_string_n(JsonWriter* json, const char* value, size_t length) {
+    begin_value(json);
+    append(json, "\"", 1);
+    if (!json->failed && !json_escape_append(json->out, value, length)) json->failed = true;
+    append(json, "\"", 1);
+}
+
+void json_string(JsonWriter* json, const char* value) {
+    if (!value) {
+        json_null(json);
+        return;
+    }
+    json_string_n(json, value, strlen(value));
+}
+
+void json_int(JsonWriter* json, long value) {
+    begin_value(json);
+    if (!json->failed && !strbuf_append_int(json->out, value)) json->failed = true;
+}
+
+// JSON has no NaN or infinity; those become null
+void json_double(JsonWriter* json, double value, int decimals) {
+    if (!isfinite(value)) {
+        json_null(json);
+        return;
+    }
+    begin_value(json);
+    if (!json->failed && !strbuf_append_fixed(json->out, value, decimals, false)) json->failed = true;
+}
+
+void json_bool(JsonWriter* json, bool value) {
+    begin_value(json);
+    append(json, value ? "true" : "false", value ? 4 : 5);
+}
+
+void json_null(JsonWriter* json) {
+    begin_value(json);
+    append(json, "null", 4);
+}
+
+void json_raw(JsonWriter* json, const char* value, size_t length) {
+    begin_value(json);
+    append(json, value, length);
+}
+
+bool json_writer_ok(const JsonWriter* json) {
+    return !json->failed && json->depth == 0 && !json->after_key;
+}
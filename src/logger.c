@@ -0,0 +1,401 @@
+/*
+ * INGRES ChatBot - Logger
+ * Lock-free ring of formatted lines drained by a background flusher.
+ */
+
+#include "logger.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/uio.h>
+
+#define LOG_RING_MASK (LOG_RING_SIZE - 1)
+#define LOG_PREFIX_MAX 64
+#define LOG_JSON_MAX (LOG_MESSAGE_MAX * 6 + LOG_PREFIX_MAX * 2 + 4)   // Every byte escaped as \u00XX
+
+_Static_assert((LOG_RING_SIZE & LOG_RING_MASK) == 0, "LOG_RING_SIZE must be a power of two");
+
+// A slot is free for position p when sequence == p, and holds the line for
+// position p once sequence == p + 1 (bounded MPMC queue, Vyukov style, with
+// a single consumer).
+typedef struct {
+    atomic_size_t sequence;
+    LogLevel level;
+    unsigned thread;
+    size_t length;
+    struct timespec time;
+    char text[LOG_MESSAGE_MAX];
+} LogSlot;
+
+typedef enum {
+    LOGGER_STOPPED,
+    LOGGER_RUNNING,
+    LOGGER_SHUT_DOWN
+} LoggerState;
+
+static struct {
+    LogSlot slots[LOG_RING_SIZE];
+    atomic_size_t head;             // Next position producers claim
+    size_t tail;                    // Next position the flusher reads
+    atomic_size_t written;          // Positions before this are on disk
+    atomic_ulong dropped;
+    atomic_int state;
+    atomic_int format;
+    bool console;
+    int fd;
+    char path[256];
+    pthread_t thread;
+    pthread_mutex_t lock;           // Only for sleeping/waking the flusher
+    pthread_cond_t wake;
+} logger = {
+    .fd = -1,
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .wake = PTHREAD_COND_INITIALIZER,
+};
+
+atomic_int logger_min_level = LOG_INFO;
+
+static pthread_once_t default_start_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t init_lock = PTHREAD_MUTEX_INITIALIZER;
+static atomic_uint next_thread_id = 1;
+static _Thread_local unsigned thread_id;
+
+static const char* level_names[] = { "DEBUG", "INFO", "WARN", "ERROR" };
+static const char* level_json_names[] = { "debug", "info", "warn", "error" };
+
+// ============================================================================
+// CONFIGURATION
+// ============================================================================
+
+static LogLevel parse_level(const char* text, LogLevel fallback) {
+    if (!text || !*text) return fallback;
+    if (strcasecmp(text, "debug") == 0) return LOG_DEBUG;
+    if (strcasecmp(text, "info") == 0) return LOG_INFO;
+    if (strcasecmp(text, "warn") == 0 || strcasecmp(text, "warning") == 0) return LOG_WARNING;
+    if (strcasecmp(text, "error") == 0) return LOG_ERROR;
+    return fallback;
+}
+
+void logger_default_config(LoggerConfig* config) {
+    const char* path = getenv("INGRES_LOG_FILE");
+    const char* format = getenv("INGRES_LOG_FORMAT");
+    const char* console = getenv("INGRES_LOG_CONSOLE");
+
+    config->path = path ? path : "ingres_chatbot.log";
+    config->level = parse_level(getenv("INGRES_LOG_LEVEL"), LOG_INFO);
+    config->format = format && strcasecmp(format, "json") == 0 ? LOG_FORMAT_JSON : LOG_FORMAT_TEXT;
+    config->console = !console || strcmp(console, "0") != 0;
+}
+
+void logger_set_level(LogLevel level) {
+    atomic_store_explicit(&logger_min_level, (int)level, memory_order_relaxed);
+}
+
+void logger_set_format(LogFormat format) {
+    atomic_store_explicit(&logger.format, (int)format, memory_order_relaxed);
+}
+
+const char* logger_path(void) {
+    return logger.fd >= 0 ? logger.path : NULL;
+}
+
+unsigned long logger_dropped(void) {
+    return atomic_load(&logger.dropped);
+}
+
+// ============================================================================
+// PRODUCERS
+// ============================================================================
+
+static void start_default_logger(void) {
+    logger_init(NULL);
+}
+
+void log_message(LogLevel level, const char* format, ...) {
+    if (!log_enabled(level)) return;
+
+    if (atomic_load_explicit(&logger.state, memory_order_acquire) != LOGGER_RUNNING) {
+        pthread_once(&default_start_once, start_default_logger);
+        if (atomic_load_explicit(&logger.state, memory_order_acquire) != LOGGER_RUNNING) return;
+    }
+
+    // Claim a slot; a full ring drops the line instead of waiting
+    size_t pos = atomic_load_explicit(&logger.head, memory_order_relaxed);
+    LogSlot* slot;
+    for (;;) {
+        slot = &logger.slots[pos & LOG_RING_MASK];
+        size_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&logger.head, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            atomic_fetch_add_explicit(&logger.dropped, 1, memory_order_relaxed);
+            return;
+        } else {
+            pos = atomic_load_explicit(&logger.head, memory_order_relaxed);
+        }
+    }
+
+    if (!thread_id) thread_id = atomic_fetch_add(&next_thread_id, 1);
+    slot->level = level;
+    slot->thread = thread_id;
+    clock_gettime(CLOCK_REALTIME, &slot->time);
+
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(slot->text, sizeof(slot->text), format, args);
+    va_end(args);
+    if (length < 0) length = 0;
+    size_t kept = (size_t)length;
+    if (kept >= sizeof(slot->text)) {
+        // Truncated: don't leave half a UTF-8 sequence at the end
+        kept = sizeof(slot->text) - 1;
+        size_t cut = kept;
+        while (cut > 0 && ((unsigned char)slot->text[cut - 1] & 0xC0) == 0x80) cut--;
+        if (cut > 0 && (unsigned char)slot->text[cut - 1] >= 0xC0) kept = cut - 1;
+    }
+    slot->length = kept;
+
+    atomic_store_explicit(&slot->sequence, pos + 1, memory_order_release);
+}
+
+// ============================================================================
+// FLUSHER
+// ============================================================================
+
+// Timestamps change once a second; only the milliseconds are formatted per line
+typedef struct {
+    time_t second;
+    LogFormat format;
+    char text[32];
+    size_t length;
+} TimestampCache;
+
+static const char* cached_timestamp(TimestampCache* cache, const struct timespec* time, LogFormat format) {
+    if (cache->length == 0 || cache->second != time->tv_sec || cache->format != format) {
+        struct tm parts;
+        if (format == LOG_FORMAT_JSON) {
+            gmtime_r(&time->tv_sec, &parts);
+            cache->length = strftime(cache->text, sizeof(cache->text), "%Y-%m-%dT%H:%M:%S", &parts);
+        } else {
+            localtime_r(&time->tv_sec, &parts);
+            cache->length = strftime(cache->text, sizeof(cache->text), "%Y-%m-%d %H:%M:%S", &parts);
+        }
+        cache->second = time->tv_sec;
+        cache->format = format;
+    }
+    return cache->text;
+}
+
+static size_t json_escape(char* out, const char* text, size_t length) {
+    static const char hex[] = "0123456789abcdef";
+    char* p = out;
+    for (size_t i = 0; i < length; i++) {
+        unsigned char c = (unsigned char)text[i];
+        switch (c) {
+            case '"':  *p++ = '\\'; *p++ = '"'; break;
+            case '\\': *p++ = '\\'; *p++ = '\\'; break;
+            case '\n': *p++ = '\\'; *p++ = 'n'; break;
+            case '\r': *p++ = '\\'; *p++ = 'r'; break;
+            case '\t': *p++ = '\\'; *p++ = 't'; break;
+            default:
+                if (c < 0x20) {
+                    memcpy(p, "\\u00", 4);
+                    p[4] = hex[c >> 4];
+                    p[5] = hex[c & 0xf];
+                    p += 6;
+                } else {
+                    *p++ = (char)c;
+                }
+        }
+    }
+    return (size_t)(p - out);
+}
+
+static bool write_all(int fd, struct iovec* iov, int count) {
+    while (count > 0) {
+        ssize_t n = writev(fd, iov, count);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        while (count > 0 && (size_t)n >= iov->iov_len) {
+            n -= (ssize_t)iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0) {
+            iov->iov_base = (char*)iov->iov_base + n;
+            iov->iov_len -= (size_t)n;
+        }
+    }
+    return true;
+}
+
+// Per-batch scratch, only touched by the flusher thread
+static struct {
+    char prefixes[LOG_BATCH_MAX][LOG_PREFIX_MAX];
+    char json[LOG_BATCH_MAX][LOG_JSON_MAX];
+    struct iovec iov[LOG_BATCH_MAX * 3];
+    struct iovec copy[LOG_BATCH_MAX * 3];
+    TimestampCache timestamp;
+} batch;
+
+// Write up to LOG_BATCH_MAX ready lines; returns how many
+static int flush_batch(void) {
+    LogFormat format = (LogFormat)atomic_load_explicit(&logger.format, memory_order_relaxed);
+    static const char newline = '\n';
+    int lines = 0;
+    int iov_count = 0;
+    size_t pos = logger.tail;
+
+    // Text lines point straight into the slots: prefix, message, newline.
+    // Slots are only handed back after the write.
+    while (lines < LOG_BATCH_MAX) {
+        LogSlot* slot = &logger.slots[pos & LOG_RING_MASK];
+        if (atomic_load_explicit(&slot->sequence, memory_order_acquire) != pos + 1) break;
+
+        const char* stamp = cached_timestamp(&batch.timestamp, &slot->time, format);
+        int millis = (int)(slot->time.tv_nsec / 1000000);
+        if (format == LOG_FORMAT_JSON) {
+            char* line = batch.json[lines];
+            int n = snprintf(line, LOG_PREFIX_MAX * 2, "{\"ts\":\"%s.%03dZ\",\"level\":\"%s\",\"thread\":%u,\"msg\":\"",
+                             stamp, millis, level_json_names[slot->level], slot->thread);
+            size_t length = (size_t)n + json_escape(line + n, slot->text, slot->length);
+            memcpy(line + length, "\"}\n", 3);
+            batch.iov[iov_count++] = (struct iovec){ line, length + 3 };
+        } else {
+            int n = snprintf(batch.prefixes[lines], LOG_PREFIX_MAX, "[%s] [%s] ",
+                             stamp, level_names[slot->level]);
+            batch.iov[iov_count++] = (struct iovec){ batch.prefixes[lines], (size_t)n };
+            batch.iov[iov_count++] = (struct iovec){ slot->text, slot->length };
+            batch.iov[iov_count++] = (struct iovec){ (void*)&newline, 1 };
+        }
+        lines++;
+        pos++;
+    }
+    if (lines == 0) return 0;
+
+    // writev advances the vector it is given, so each target gets a copy
+    if (logger.fd >= 0) {
+        memcpy(batch.copy, batch.iov, sizeof(struct iovec) * (size_t)iov_count);
+        write_all(logger.fd, batch.copy, iov_count);
+    }
+    if (logger.console) {
+        memcpy(batch.copy, batch.iov, sizeof(struct iovec) * (size_t)iov_count);
+        write_all(STDOUT_FILENO, batch.copy, iov_count);
+    }
+
+    for (size_t p = logger.tail; p != pos; p++) {
+        atomic_store_explicit(&logger.slots[p & LOG_RING_MASK].sequence, p + LOG_RING_SIZE,
+                              memory_order_release);
+    }
+    logger.tail = pos;
+    atomic_store_explicit(&logger.written, pos, memory_order_release);
+    return lines;
+}
+
+static void* flusher_main(void* arg) {
+    (void)arg;
+    for (;;) {
+        bool running = atomic_load_explicit(&logger.state, memory_order_acquire) == LOGGER_RUNNING;
+        if (flush_batch() > 0) continue;
+        if (!running) break;
+
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += LOG_IDLE_WAIT_MS * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        pthread_mutex_lock(&logger.lock);
+        pthread_cond_timedwait(&logger.wake, &logger.lock, &deadline);
+        pthread_mutex_unlock(&logger.lock);
+    }
+    return NULL;
+}
+
+static void wake_flusher(void) {
+    pthread_mutex_lock(&logger.lock);
+    pthread_cond_signal(&logger.wake);
+    pthread_mutex_unlock(&logger.lock);
+}
+
+// ============================================================================
+// LIFECYCLE
+// ============================================================================
+
+bool logger_init(const LoggerConfig* config) {
+    LoggerConfig defaults;
+    if (!config) {
+        logger_default_config(&defaults);
+        config = &defaults;
+    }
+
+    pthread_mutex_lock(&init_lock);
+    if (atomic_load(&logger.state) != LOGGER_STOPPED) {
+        pthread_mutex_unlock(&init_lock);
+        return false;
+    }
+
+    if (config->path && *config->path) {
+        logger.fd = open(config->path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (logger.fd < 0) {
+            pthread_mutex_unlock(&init_lock);
+            return false;
+        }
+        snprintf(logger.path, sizeof(logger.path), "%s", config->path);
+    }
+    for (size_t i = 0; i < LOG_RING_SIZE; i++) {
+        atomic_init(&logger.slots[i].sequence, i);
+    }
+    logger.console = config->console;
+    logger_set_format(config->format);
+    logger_set_level(config->level);
+
+    atomic_store(&logger.state, LOGGER_RUNNING);
+    if (pthread_create(&logger.thread, NULL, flusher_main, NULL) != 0) {
+        atomic_store(&logger.state, LOGGER_STOPPED);
+        if (logger.fd >= 0) close(logger.fd);
+        logger.fd = -1;
+        pthread_mutex_unlock(&init_lock);
+        return false;
+    }
+    atexit(logger_shutdown);
+    pthread_mutex_unlock(&init_lock);
+    return true;
+}
+
+void logger_flush(void) {
+    if (atomic_load_explicit(&logger.state, memory_order_acquire) != LOGGER_RUNNING) return;
+
+    size_t target = atomic_load_explicit(&logger.head, memory_order_acquire);
+    while (atomic_load_explicit(&logger.written, memory_order_acquire) < target) {
+        wake_flusher();
+        nanosleep(&(struct timespec){ .tv_nsec = 1000000 }, NULL);
+    }
+}
+
+void logger_shutdown(void) {
+    pthread_mutex_lock(&init_lock);
+    int expected = LOGGER_RUNNING;
+    if (atomic_compare_exchange_strong(&logger.state, &expected, LOGGER_SHUT_DOWN)) {
+        wake_flusher();
+        pthread_join(logger.thread, NULL);
+        if (logger.fd >= 0) close(logger.fd);
+        logger.fd = -1;
+    }
+    pthread_mutex_unlock(&init_lock);
+}
@@ -2,17 +2,15 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
-#include <stdarg.h>
+#include <signal.h>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
 #include "chatbot.h"
+#include "database.h"
 #include "utils.h"
-
-// Enhanced logging system
-typedef enum {
-    LOG_INFO,
-    LOG_WARNING,
-    LOG_ERROR,
-    LOG_DEBUG
-} LogLevel;
+#include "logger.h"
+#include "api.h"
 
 // Performance monitoring structure
 typedef struct {
@@ -25,43 +23,6 @@ typedef struct {
     int peak_concurrent_users;
 } PerformanceMetrics;
 
-void log_message(LogLevel level, const char* format, ...) {
-    time_t now = time(NULL);
-    struct tm* tm_info = localtime(&now);
-    char timestamp[20];
-    strftime(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S", tm_info);
-
-    const char* level_str;
-    switch (level) {
-        case LOG_INFO: level_str = "INFO"; break;
-        case LOG_WARNING: level_str = "WARN"; break;
-        case LOG_ERROR: level_str = "ERROR"; break;
-        case LOG_DEBUG: level_str = "DEBUG"; break;
-        default: level_str = "UNKNOWN"; break;
-    }
-
-    printf("[%s] [%s] ", timestamp, level_str);
-
-    va_list args;
-    va_start(args, format);
-    vprintf(format, args);
-    va_end(args);
-
-    printf("\n");
-
-    // Also write to log file
-    FILE* log_file = fopen("ingres_chatbot.log", "a");
-    if (log_file) {
-        fprintf(log_file, "[%s] [%s] ", timestamp, level_str);
-        va_list args2;
-        va_start(args2, format);
-        vfprintf(log_file, format, args2);
-        va_end(args2);
-        fprintf(log_file, "\n");
-        fclose(log_file);
-    }
-}
-
 void print_performance_report(PerformanceMetrics* metrics) {
     time_t uptime = time(NULL) - metrics->start_time;
 
@@ -104,9 +65,6 @@ void print_performance_report(PerformanceMetrics* metrics) {
                 metrics->avg_response_time, error_rate);
 }
 
-// Comment out API includes for now
-// #include "api.h"
-
 // Enhanced test queries showcasing new capabilities
 const char* enhanced_test_queries[] = {
     // Basic interaction
@@ -178,7 +136,43 @@ void print_response_details(BotResponse* response) {
     }
 }
 
-int main() {
+#ifndef _WIN32
+// SIGHUP reloads the dataset snapshot in the background
+static void handle_reload_signal(int sig) {
+    (void)sig;
+    db_request_reload();
+}
+
+// SIGTERM / SIGINT drain the API server; a second one exits at once
+static volatile sig_atomic_t stop_signals = 0;
+
+static void handle_stop_signal(int sig) {
+    if (stop_signals++ > 0) _exit(128 + sig);
+    stop_api_server();
+}
+#endif
+
+static void print_usage(const char* program) {
+    printf("Usage: %s [--server] [--port PORT]\n", program);
+    printf("  (no options)   Run the capability demo, then an interactive session\n");
+    printf("  --server       Serve the HTTP API instead\n");
+    printf("  --port PORT    API port (default %s)\n", API_DEFAULT_PORT);
+}
+
+int main(int argc, char** argv) {
+    bool server_mode = false;
+    const char* port = API_DEFAULT_PORT;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--server") == 0) {
+            server_mode = true;
+        } else if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            port = argv[++i];
+        } else {
+            print_usage(argv[0]);
+            return strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+
     log_message(LOG_INFO, "🌊 *** INGRES ChatBot - Enhanced AI System Starting *** 🌊");
     log_message(LOG_INFO, "India's Groundwater Resource Expert System");
     log_message(LOG_INFO, "Smart India Hackathon 2025 | Enhanced Version");
@@ -206,6 +200,21 @@ int main() {
         return 1;
     }
     log_message(LOG_INFO, "Chatbot initialization successful");
+
+#ifndef _WIN32
+    signal(SIGHUP, handle_reload_signal);
+#endif
+
+    if (server_mode) {
+#ifndef _WIN32
+        signal(SIGTERM, handle_stop_signal);
+        signal(SIGINT, handle_stop_signal);
+#endif
+        int status = start_api_server(port);
+        chatbot_cleanup();
+        logger_shutdown();
+        return status;
+    }
     
     printf("\n🚀 **ENHANCED FEATURES LOADED**:\n");
     printf("   ✅ 70+ Intent Types with Fuzzy Matching\n");
@@ -0,0 +1,271 @@
+/*
+ * INGRES ChatBot - Latency Metrics
+ * Per-thread HDR-style histograms merged on read.
+ */
+
+#include "metrics.h"
+#include "utils.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+
+#define SUB_BUCKET_COUNT (1u << METRICS_SUB_BUCKET_BITS)
+#define SUB_BUCKET_MASK (SUB_BUCKET_COUNT - 1)
+#define MAX_TRACKED_NS ((UINT64_C(1) << METRICS_MAX_VALUE_BITS) - 1)
+
+// Only the owning thread writes; readers load. Relaxed load+store pairs
+// compile to plain increments but keep concurrent reads untorn.
+typedef struct {
+    atomic_uint_fast64_t counts[METRICS_BUCKET_COUNT];
+    atomic_uint_fast64_t total_count;
+    atomic_uint_fast64_t total_ns;
+    atomic_uint_fast64_t max_ns;
+} SharedHistogram;
+
+typedef struct ThreadMetrics {
+    SharedHistogram stages[METRIC_STAGE_COUNT];
+    struct ThreadMetrics* next;
+    struct ThreadMetrics* prev;
+} ThreadMetrics;
+
+static const char* stage_names[METRIC_STAGE_COUNT] = {
+    "parse", "location", "classify", "db_query", "render", "serialize", "request"
+};
+
+// Live threads, plus everything recorded by threads that have exited
+static pthread_mutex_t registry_lock = PTHREAD_MUTEX_INITIALIZER;
+static ThreadMetrics* registry = NULL;
+static ThreadMetrics retired;
+
+static pthread_once_t metrics_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t metrics_key;
+static _Thread_local ThreadMetrics* thread_metrics;
+
+static inline void add_relaxed(atomic_uint_fast64_t* value, uint64_t amount) {
+    atomic_store_explicit(value, atomic_load_explicit(value, memory_order_relaxed) + amount,
+                          memory_order_relaxed);
+}
+
+static int bucket_index(uint64_t value) {
+    if (value > MAX_TRACKED_NS) value = MAX_TRACKED_NS;
+    if (value < SUB_BUCKET_COUNT) return (int)value;
+
+    int msb = 63 - __builtin_clzll(value);
+    int shift = msb - METRICS_SUB_BUCKET_BITS;
+    return ((shift + 1) << METRICS_SUB_BUCKET_BITS) | (int)((value >> shift) & SUB_BUCKET_MASK);
+}
+
+static uint64_t bucket_highest_value(int index) {
+    if (index < (int)SUB_BUCKET_COUNT) return (uint64_t)index;
+
+    int shift = (index >> METRICS_SUB_BUCKET_BITS) - 1;
+    uint64_t sub = (uint64_t)(index & SUB_BUCKET_MASK) | SUB_BUCKET_COUNT;
+    return ((sub + 1) << shift) - 1;
+}
+
+// ============================================================================
+// RECORDING
+// ============================================================================
+
+static void merge_into(SharedHistogram* into, SharedHistogram* from) {
+    for (int i = 0; i < METRICS_BUCKET_COUNT; i++) {
+        add_relaxed(&into->counts[i], atomic_load_explicit(&from->counts[i], memory_order_relaxed));
+    }
+    add_relaxed(&into->total_count, atomic_load_explicit(&from->total_count, memory_order_relaxed));
+    add_relaxed(&into->total_ns, atomic_load_explicit(&from->total_ns, memory_order_relaxed));
+    uint64_t max = atomic_load_explicit(&from->max_ns, memory_order_relaxed);
+    if (max > atomic_load_explicit(&into->max_ns, memory_order_relaxed)) {
+        atomic_store_explicit(&into->max_ns, max, memory_order_relaxed);
+    }
+}
+
+// Fold an exiting thread's counts into the retired totals
+static void unregister_thread(void* value) {
+    ThreadMetrics* metrics = value;
+
+    pthread_mutex_lock(&registry_lock);
+    for (int stage = 0; stage < METRIC_STAGE_COUNT; stage++) {
+        merge_into(&retired.stages[stage], &metrics->stages[stage]);
+    }
+    if (metrics->prev) metrics->prev->next = metrics->next;
+    else registry = metrics->next;
+    if (metrics->next) metrics->next->prev = metrics->prev;
+    pthread_mutex_unlock(&registry_lock);
+
+    free(metrics);
+    thread_metrics = NULL;
+}
+
+static void create_metrics_key(void) {
+    pthread_key_create(&metrics_key, unregister_thread);
+}
+
+static ThreadMetrics* get_thread_metrics(void) {
+    if (thread_metrics) return thread_metrics;
+
+    ThreadMetrics* metrics = calloc(1, sizeof(ThreadMetrics));
+    if (!metrics) return NULL;
+    pthread_once(&metrics_key_once, create_metrics_key);
+    pthread_setspecific(metrics_key, metrics);
+
+    pthread_mutex_lock(&registry_lock);
+    metrics->next = registry;
+    if (registry) registry->prev = metrics;
+    registry = metrics;
+    pthread_mutex_unlock(&registry_lock);
+
+    thread_metrics = metrics;
+    return metrics;
+}
+
+uint64_t metrics_now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+void metrics_record(MetricStage stage, uint64_t elapsed_ns) {
+    if ((unsigned)stage >= METRIC_STAGE_COUNT) return;
+    ThreadMetrics* metrics = get_thread_metrics();
+    if (!metrics) return;
+
+    SharedHistogram* histogram = &metrics->stages[stage];
+    add_relaxed(&histogram->counts[bucket_index(elapsed_ns)], 1);
+    add_relaxed(&histogram->total_count, 1);
+    add_relaxed(&histogram->total_ns, elapsed_ns);
+    if (elapsed_ns > atomic_load_explicit(&histogram->max_ns, memory_order_relaxed)) {
+        atomic_store_explicit(&histogram->max_ns, elapsed_ns, memory_order_relaxed);
+    }
+}
+
+uint64_t metrics_record_since(MetricStage stage, uint64_t start_ns) {
+    uint64_t now = metrics_now_ns();
+    metrics_record(stage, now - start_ns);
+    return now;
+}
+
+// ============================================================================
+// READING
+// ============================================================================
+
+static void add_to_snapshot(LatencyHistogram* out, SharedHistogram* from) {
+    for (int i = 0; i < METRICS_BUCKET_COUNT; i++) {
+        out->counts[i] += atomic_load_explicit(&from->counts[i], memory_order_relaxed);
+    }
+    out->total_count += atomic_load_explicit(&from->total_count, memory_order_relaxed);
+    out->total_ns += atomic_load_explicit(&from->total_ns, memory_order_relaxed);
+    uint64_t max = atomic_load_explicit(&from->max_ns, memory_order_relaxed);
+    if (max > out->max_ns) out->max_ns = max;
+}
+
+void metrics_snapshot(MetricStage stage, LatencyHistogram* out) {
+    memset(out, 0, sizeof(*out));
+    if ((unsigned)stage >= METRIC_STAGE_COUNT) return;
+
+    pthread_mutex_lock(&registry_lock);
+    add_to_snapshot(out, &retired.stages[stage]);
+    for (ThreadMetrics* metrics = registry; metrics; metrics = metrics->next) {
+        add_to_snapshot(out, &metrics->stages[stage]);
+    }
+    pthread_mutex_unlock(&registry_lock);
+}
+
+void metrics_histogram_record(LatencyHistogram* histogram, uint64_t value_ns) {
+    histogram->counts[bucket_index(value_ns)]++;
+    histogram->total_count++;
+    histogram->total_ns += value_ns;
+    if (value_ns > histogram->max_ns) histogram->max_ns = value_ns;
+}
+
+void metrics_histogram_add(LatencyHistogram* into, const LatencyHistogram* from) {
+    for (int i = 0; i < METRICS_BUCKET_COUNT; i++) into->counts[i] += from->counts[i];
+    into->total_count += from->total_count;
+    into->total_ns += from->total_ns;
+    if (from->max_ns > into->max_ns) into->max_ns = from->max_ns;
+}
+
+uint64_t metrics_value_at_quantile(const LatencyHistogram* histogram, double q) {
+    if (histogram->total_count == 0) return 0;
+    if (q < 0.0) q = 0.0;
+    if (q > 1.0) q = 1.0;
+
+    uint64_t target = (uint64_t)(q * (double)histogram->total_count + 0.5);
+    if (target == 0) target = 1;
+
+    uint64_t seen = 0;
+    for (int i = 0; i < METRICS_BUCKET_COUNT; i++) {
+        seen += histogram->counts[i];
+        if (seen >= target) {
+            uint64_t value = bucket_highest_value(i);
+            return value < histogram->max_ns ? value : histogram->max_ns;
+        }
+    }
+    return histogram->max_ns;
+}
+
+const char* metrics_stage_name(MetricStage stage) {
+    return (unsigned)stage < METRIC_STAGE_COUNT ? stage_names[stage] : "unknown";
+}
+
+char* metrics_render_prometheus(void) {
+    static const double quantiles[] = { 0.5, 0.9, 0.99, 0.999 };
+
+    LatencyHistogram* histogram = malloc(sizeof(LatencyHistogram));
+    if (!histogram) return NULL;
+
+    StrBuf out;
+    strbuf_init(&out);
+    strbuf_append_str(&out,
+        "# HELP ingres_stage_duration_seconds Wall time spent in each request pipeline stage.\n"
+        "# TYPE ingres_stage_duration_seconds summary\n");
+
+    for (int stage = 0; stage < METRIC_STAGE_COUNT; stage++) {
+        metrics_snapshot((MetricStage)stage, histogram);
+        const char* name = stage_names[stage];
+        for (size_t i = 0; i < sizeof(quantiles) / sizeof(quantiles[0]); i++) {
+            strbuf_appendf(&out, "ingres_stage_duration_seconds{stage=\"%s\",quantile=\"%g\"} %.9f\n",
+                           name, quantiles[i],
+                           (double)metrics_value_at_quantile(histogram, quantiles[i]) / 1e9);
+        }
+        strbuf_appendf(&out, "ingres_stage_duration_seconds_sum{stage=\"%s\"} %.9f\n",
+                       name, (double)histogram->total_ns / 1e9);
+        strbuf_appendf(&out, "ingres_stage_duration_seconds_count{stage=\"%s\"} %llu\n",
+                       name, (unsigned long long)histogram->total_count);
+    }
+
+    strbuf_append_str(&out,
+        "# HELP ingres_stage_duration_max_seconds Slowest observation of each stage.\n"
+        "# TYPE ingres_stage_duration_max_seconds gauge\n");
+    for (int stage = 0; stage < METRIC_STAGE_COUNT; stage++) {
+        metrics_snapshot((MetricStage)stage, histogram);
+        strbuf_appendf(&out, "ingres_stage_duration_max_seconds{stage=\"%s\"} %.9f\n",
+                       stage_names[stage], (double)histogram->max_ns / 1e9);
+    }
+    free(histogram);
+
+    char* text = strbuf_copy(&out);
+    strbuf_free(&out);
+    return text;
+}
+
+static void clear_histogram(SharedHistogram* histogram) {
+    for (int i = 0; i < METRICS_BUCKET_COUNT; i++) {
+        atomic_store_explicit(&histogram->counts[i], 0, memory_order_relaxed);
+    }
+    atomic_store_explicit(&histogram->total_count, 0, memory_order_relaxed);
+    atomic_store_explicit(&histogram->total_ns, 0, memory_order_relaxed);
+    atomic_store_explicit(&histogram->max_ns, 0, memory_order_relaxed);
+}
+
+void metrics_reset(void) {
+    pthread_mutex_lock(&registry_lock);
+    for (int stage = 0; stage < METRIC_STAGE_COUNT; stage++) {
+        clear_histogram(&retired.stages[stage]);
+        for (ThreadMetrics* metrics = registry; metrics; metrics = metrics->next) {
+            clear_histogram(&metrics->stages[stage]);
+        }
+    }
+    pthread_mutex_unlock(&registry_lock);
+}
@@ -0,0 +1,71 @@
+/*
+ * INGRES ChatBot - Object Pools
+ * Per-thread free lists for per-request objects.
+ */
+
+#include "pool.h"
+#include <stdlib.h>
+#include <pthread.h>
+
+typedef struct {
+    void* objects[POOL_MAX_CACHED];
+    int count;
+    void (*destroy)(void*);
+} PoolList;
+
+typedef struct {
+    PoolList lists[POOL_KIND_COUNT];
+} ThreadPools;
+
+static pthread_once_t pools_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t pools_key;
+static _Thread_local ThreadPools* thread_pools;
+
+// Destroy the cached objects when their thread exits
+static void free_pools(void* value) {
+    ThreadPools* pools = value;
+    for (int kind = 0; kind < POOL_KIND_COUNT; kind++) {
+        PoolList* list = &pools->lists[kind];
+        for (int i = 0; i < list->count; i++) {
+            list->destroy(list->objects[i]);
+        }
+    }
+    free(pools);
+    thread_pools = NULL;
+}
+
+static void create_pools_key(void) {
+    pthread_key_create(&pools_key, free_pools);
+}
+
+static ThreadPools* get_pools(void) {
+    if (thread_pools) return thread_pools;
+
+    ThreadPools* pools = calloc(1, sizeof(ThreadPools));
+    if (!pools) return NULL;
+    pthread_once(&pools_key_once, create_pools_key);
+    pthread_setspecific(pools_key, pools);
+    thread_pools = pools;
+    return pools;
+}
+
+void* pool_get(PoolKind kind) {
+    ThreadPools* pools = thread_pools;
+    if (!pools) return NULL;
+
+    PoolList* list = &pools->lists[kind];
+    return list->count > 0 ? list->objects[--list->count] : NULL;
+}
+
+void pool_put(PoolKind kind, void* object, void (*destroy)(void*)) {
+    if (!object) return;
+
+    ThreadPools* pools = get_pools();
+    PoolList* list = pools ? &pools->lists[kind] : NULL;
+    if (!list || list->count == POOL_MAX_CACHED) {
+        destroy(object);
+        return;
+    }
+    list->destroy = destroy;
+    list->objects[list->count++] = object;
+}
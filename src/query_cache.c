@@ -0,0 +1,301 @@
+/*
+ * INGRES ChatBot - Query Result Cache
+ * Bounded LRU read-through cache for query_by_* results with TTL and
+ * dataset-version invalidation.
+ */
+
+#include "query_cache.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <ctype.h>
+#include <time.h>
+#include <pthread.h>
+
+#define NULL_PARAM_MARK '\x1e'      // Distinguishes NULL from ""
+#define PARAM_SEPARATOR '\x1f'
+
+typedef struct CacheNode {
+    char key[QUERY_CACHE_KEY_MAX];
+    uint64_t hash;
+    QueryResult result;             // Owns result.data
+    size_t bytes;
+    unsigned long dataset_version;
+    time_t expires_at;
+    struct CacheNode* chain_next;   // Bucket chain
+    struct CacheNode* lru_prev;     // Most recently used at lru_head
+    struct CacheNode* lru_next;
+} CacheNode;
+
+static struct {
+    CacheNode** buckets;
+    size_t bucket_count;            // Power of two
+    CacheNode* lru_head;
+    CacheNode* lru_tail;
+    size_t max_entries;
+    size_t max_bytes;
+    int ttl_seconds;
+    QueryCacheStats stats;
+    pthread_mutex_t lock;
+} cache = {
+    .lock = PTHREAD_MUTEX_INITIALIZER
+};
+
+static time_t monotonic_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec;
+}
+
+static size_t env_size(const char* name, size_t fallback) {
+    const char* value = getenv(name);
+    if (!value || !*value) return fallback;
+    long parsed = strtol(value, NULL, 10);
+    return parsed > 0 ? (size_t)parsed : fallback;
+}
+
+// Append one parameter: lowercased, trimmed, inner whitespace collapsed, so
+// "  Tamil   NADU " and "tamil nadu" share an entry. False when the key would
+// not fit: a truncated key could match a different query's entry.
+static bool append_param(char* key, size_t* len, const char* param) {
+    if (*len + 2 >= QUERY_CACHE_KEY_MAX) return false;
+    key[(*len)++] = PARAM_SEPARATOR;
+
+    if (!param) {
+        key[(*len)++] = NULL_PARAM_MARK;
+        return true;
+    }
+
+    bool pending_space = false;
+    for (const char* p = param; *p; p++) {
+        unsigned char ch = (unsigned char)*p;
+        if (isspace(ch)) {
+            pending_space = true;
+            continue;
+        }
+        bool space = pending_space && key[*len - 1] != PARAM_SEPARATOR;
+        if (*len + (space ? 2 : 1) >= QUERY_CACHE_KEY_MAX) return false;
+        if (space) key[(*len)++] = ' ';
+        pending_space = false;
+        key[(*len)++] = (char)tolower(ch);
+    }
+    return true;
+}
+
+// False (and nothing is cached or looked up) when the parameters are too
+// long for QUERY_CACHE_KEY_MAX
+static bool build_key(char* key, QueryKind kind, const char* a, const char* b, const char* c) {
+    size_t len = 0;
+    key[len++] = (char)('A' + kind);
+    bool fits = append_param(key, &len, a) && append_param(key, &len, b) && append_param(key, &len, c);
+    key[fits ? len : 0] = '\0';
+    return fits;
+}
+
+// FNV-1a
+static uint64_t hash_key(const char* key) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (const unsigned char* p = (const unsigned char*)key; *p; p++) {
+        hash ^= *p;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static void lru_unlink(CacheNode* node) {
+    if (node->lru_prev) node->lru_prev->lru_next = node->lru_next;
+    else cache.lru_head = node->lru_next;
+    if (node->lru_next) node->lru_next->lru_prev = node->lru_prev;
+    else cache.lru_tail = node->lru_prev;
+    node->lru_prev = node->lru_next = NULL;
+}
+
+static void lru_push_front(CacheNode* node) {
+    node->lru_prev = NULL;
+    node->lru_next = cache.lru_head;
+    if (cache.lru_head) cache.lru_head->lru_prev = node;
+    cache.lru_head = node;
+    if (!cache.lru_tail) cache.lru_tail = node;
+}
+
+// Caller holds the lock
+static void remove_node(CacheNode* node) {
+    CacheNode** link = &cache.buckets[node->hash & (cache.bucket_count - 1)];
+    while (*link && *link != node) {
+        link = &(*link)->chain_next;
+    }
+    if (*link) *link = node->chain_next;
+
+    lru_unlink(node);
+    cache.stats.entries--;
+    cache.stats.bytes -= node->bytes;
+    free(node->result.data);
+    free(node);
+}
+
+static CacheNode* find_node(const char* key, uint64_t hash) {
+    CacheNode* node = cache.buckets[hash & (cache.bucket_count - 1)];
+    while (node) {
+        if (node->hash == hash && strcmp(node->key, key) == 0) return node;
+        node = node->chain_next;
+    }
+    return NULL;
+}
+
+static void clear_locked(void) {
+    while (cache.lru_head) {
+        remove_node(cache.lru_head);
+    }
+}
+
+bool query_cache_init(size_t max_entries, size_t max_bytes, int ttl_seconds) {
+    if (max_entries == 0) max_entries = env_size("INGRES_QUERY_CACHE_ENTRIES", QUERY_CACHE_DEFAULT_ENTRIES);
+    if (max_bytes == 0) max_bytes = env_size("INGRES_QUERY_CACHE_BYTES", QUERY_CACHE_DEFAULT_BYTES);
+    if (ttl_seconds <= 0) ttl_seconds = (int)env_size("INGRES_QUERY_CACHE_TTL", QUERY_CACHE_DEFAULT_TTL_SECONDS);
+
+    // Keep chains short at the entry bound
+    size_t bucket_count = 16;
+    while (bucket_count < max_entries) bucket_count <<= 1;
+
+    CacheNode** buckets = calloc(bucket_count, sizeof(CacheNode*));
+    if (!buckets) return false;
+
+    pthread_mutex_lock(&cache.lock);
+    if (cache.buckets) {
+        clear_locked();
+        free(cache.buckets);
+    }
+    cache.buckets = buckets;
+    cache.bucket_count = bucket_count;
+    cache.max_entries = max_entries;
+    cache.max_bytes = max_bytes;
+    cache.ttl_seconds = ttl_seconds;
+    memset(&cache.stats, 0, sizeof(cache.stats));
+    pthread_mutex_unlock(&cache.lock);
+    return true;
+}
+
+void query_cache_shutdown(void) {
+    pthread_mutex_lock(&cache.lock);
+    if (cache.buckets) {
+        clear_locked();
+        free(cache.buckets);
+        cache.buckets = NULL;
+        cache.bucket_count = 0;
+    }
+    pthread_mutex_unlock(&cache.lock);
+}
+
+static QueryResult* copy_result(const QueryResult* source) {
+    QueryResult* copy = query_result_new(source->count, source->query_type);
+    if (!copy) return NULL;
+
+    if (source->count > 0) {
+        memcpy(copy->data, source->data, sizeof(GroundwaterData) * (size_t)source->count);
+    }
+    copy->count = source->count;
+    copy->execution_time_ms = source->execution_time_ms;
+    return copy;
+}
+
+QueryResult* query_cache_get(QueryKind kind, const char* a, const char* b, const char* c) {
+    char key[QUERY_CACHE_KEY_MAX];
+    bool cacheable = build_key(key, kind, a, b, c);
+    uint64_t hash = hash_key(key);
+
+    QueryResult* copy = NULL;
+    pthread_mutex_lock(&cache.lock);
+    if (cache.buckets && !cacheable) {
+        cache.stats.misses++;
+    } else if (cache.buckets) {
+        CacheNode* node = find_node(key, hash);
+        if (node && (node->dataset_version != db_dataset_version() ||
+                     node->expires_at <= monotonic_seconds())) {
+            remove_node(node);
+            cache.stats.expirations++;
+            node = NULL;
+        }
+
+        if (node) {
+            lru_unlink(node);
+            lru_push_front(node);
+            copy = copy_result(&node->result);
+            cache.stats.hits++;
+        } else {
+            cache.stats.misses++;
+        }
+    }
+    pthread_mutex_unlock(&cache.lock);
+    return copy;
+}
+
+void query_cache_put(QueryKind kind, const char* a, const char* b, const char* c,
+                     const QueryResult* result, unsigned long dataset_version) {
+    if (!result || result->count < 0 || dataset_version != db_dataset_version()) return;
+
+    size_t bytes = sizeof(CacheNode) + sizeof(GroundwaterData) * (size_t)result->count;
+    CacheNode* node = calloc(1, sizeof(CacheNode));
+    if (!node) return;
+
+    if (!build_key(node->key, kind, a, b, c)) {
+        free(node);
+        return;
+    }
+    node->hash = hash_key(node->key);
+    node->bytes = bytes;
+    node->dataset_version = dataset_version;
+    node->result = *result;
+    node->result.data = NULL;
+    node->result.capacity = result->count;
+    if (result->count > 0) {
+        node->result.data = malloc(sizeof(GroundwaterData) * (size_t)result->count);
+        if (!node->result.data) {
+            free(node);
+            return;
+        }
+        memcpy(node->result.data, result->data, sizeof(GroundwaterData) * (size_t)result->count);
+    }
+
+    pthread_mutex_lock(&cache.lock);
+    if (!cache.buckets || bytes > cache.max_bytes) {
+        pthread_mutex_unlock(&cache.lock);
+        free(node->result.data);
+        free(node);
+        return;
+    }
+
+    CacheNode* existing = find_node(node->key, node->hash);
+    if (existing) remove_node(existing);
+
+    while (cache.lru_tail && (cache.stats.entries >= cache.max_entries ||
+                              cache.stats.bytes + bytes > cache.max_bytes)) {
+        remove_node(cache.lru_tail);
+        cache.stats.evictions++;
+    }
+
+    node->expires_at = monotonic_seconds() + cache.ttl_seconds;
+    size_t bucket = node->hash & (cache.bucket_count - 1);
+    node->chain_next = cache.buckets[bucket];
+    cache.buckets[bucket] = node;
+    lru_push_front(node);
+    cache.stats.entries++;
+    cache.stats.bytes += bytes;
+    pthread_mutex_unlock(&cache.lock);
+}
+
+void query_cache_invalidate_all(void) {
+    pthread_mutex_lock(&cache.lock);
+    if (cache.buckets) {
+        cache.stats.expirations += (long)cache.stats.entries;
+        clear_locked();
+    }
+    pthread_mutex_unlock(&cache.lock);
+}
+
+void query_cache_get_stats(QueryCacheStats* stats) {
+    if (!stats) return;
+    pthread_mutex_lock(&cache.lock);
+    *stats = cache.stats;
+    pthread_mutex_unlock(&cache.lock);
+}
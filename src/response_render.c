@@ -0,0 +1,595 @@
+/*
+ * INGRES ChatBot - Response Rendering
+ * Template compiler (literal segments + typed slots) and data binding of
+ * query results into response text.
+ */
+
+#include "response_render.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <stdint.h>
+#include <math.h>
+#include <pthread.h>
+
+#define PROJECTION_YEARS 3
+
+typedef enum {
+    SLOT_LITERAL,
+    SLOT_TEXT,
+    SLOT_INT,
+    SLOT_FIXED,
+    SLOT_LIST
+} SlotKind;
+
+typedef enum {
+    FIELD_LOCATION,
+    FIELD_YEAR,
+    FIELD_FIRST_YEAR,
+    FIELD_CATEGORY,
+    FIELD_FIRST_CATEGORY,
+    FIELD_RECHARGE,
+    FIELD_EXTRACTABLE,
+    FIELD_EXTRACTION,
+    FIELD_STAGE,
+    FIELD_BLOCK_COUNT,
+    FIELD_STRESSED_COUNT,
+    FIELD_STRESSED_PCT,
+    FIELD_INTERPRETATION,
+    FIELD_TREND,
+    FIELD_TREND_RATE,
+    FIELD_RISK,
+    FIELD_PROJECTION,
+    FIELD_PROJECTION_YEAR,
+    FIELD_ROWS,
+    FIELD_HISTORY
+} RenderField;
+
+typedef struct {
+    const char* name;
+    RenderField field;
+    SlotKind kind;
+    int decimals;
+    bool show_sign;
+} SlotDefinition;
+
+static const SlotDefinition slot_definitions[] = {
+    {"location",        FIELD_LOCATION,        SLOT_TEXT,  0, false},
+    {"year",            FIELD_YEAR,            SLOT_INT,   0, false},
+    {"first_year",      FIELD_FIRST_YEAR,      SLOT_INT,   0, false},
+    {"category",        FIELD_CATEGORY,        SLOT_TEXT,  0, false},
+    {"first_category",  FIELD_FIRST_CATEGORY,  SLOT_TEXT,  0, false},
+    {"recharge",        FIELD_RECHARGE,        SLOT_FIXED, 2, false},
+    {"extractable",     FIELD_EXTRACTABLE,     SLOT_FIXED, 2, false},
+    {"extraction",      FIELD_EXTRACTION,      SLOT_FIXED, 2, false},
+    {"stage",           FIELD_STAGE,           SLOT_FIXED, 1, false},
+    {"block_count",     FIELD_BLOCK_COUNT,     SLOT_INT,   0, false},
+    {"stressed_count",  FIELD_STRESSED_COUNT,  SLOT_INT,   0, false},
+    {"stressed_pct",    FIELD_STRESSED_PCT,    SLOT_INT,   0, false},
+    {"interpretation",  FIELD_INTERPRETATION,  SLOT_TEXT,  0, false},
+    {"trend",           FIELD_TREND,           SLOT_TEXT,  0, false},
+    {"trend_rate",      FIELD_TREND_RATE,      SLOT_FIXED, 2, true},
+    {"risk",            FIELD_RISK,            SLOT_TEXT,  0, false},
+    {"projection",      FIELD_PROJECTION,      SLOT_FIXED, 2, false},
+    {"projection_year", FIELD_PROJECTION_YEAR, SLOT_INT,   0, false},
+    {"rows",            FIELD_ROWS,            SLOT_LIST,  0, false},
+    {"history",         FIELD_HISTORY,         SLOT_LIST,  0, false},
+};
+
+#define SLOT_DEFINITION_COUNT (sizeof(slot_definitions) / sizeof(slot_definitions[0]))
+#define SECONDARY_PREFIX "other_"
+
+typedef struct {
+    uint32_t offset;                // Literal: offset into program->literals
+    uint32_t length;
+    uint8_t kind;                   // SlotKind
+    uint8_t field;                  // RenderField
+    uint8_t decimals;
+    bool show_sign;
+    bool secondary;
+} TemplateSegment;
+
+struct TemplateProgram {
+    TemplateSegment* segments;
+    int segment_count;
+    int slot_count;
+    char* literals;                 // Literal text with "{{" unescaped
+    size_t literal_bytes;
+};
+
+// ============================================================================
+// COMPILATION
+// ============================================================================
+
+static const SlotDefinition* find_slot(const char* name, size_t length) {
+    for (size_t i = 0; i < SLOT_DEFINITION_COUNT; i++) {
+        if (strlen(slot_definitions[i].name) == length &&
+            memcmp(slot_definitions[i].name, name, length) == 0) {
+            return &slot_definitions[i];
+        }
+    }
+    return NULL;
+}
+
+static bool add_segment(TemplateProgram* program, int* capacity, TemplateSegment segment) {
+    if (program->segment_count == *capacity) {
+        int grown_capacity = *capacity ? *capacity * 2 : 8;
+        TemplateSegment* grown = realloc(program->segments, sizeof(TemplateSegment) * grown_capacity);
+        if (!grown) return false;
+        program->segments = grown;
+        *capacity = grown_capacity;
+    }
+    program->segments[program->segment_count++] = segment;
+    return true;
+}
+
+TemplateProgram* template_compile(const char* text) {
+    if (!text) return NULL;
+
+    TemplateProgram* program = calloc(1, sizeof(TemplateProgram));
+    size_t text_length = strlen(text);
+    if (program) program->literals = malloc(text_length + 1);
+    if (!program || !program->literals) {
+        template_free(program);
+        return NULL;
+    }
+
+    int capacity = 0;
+    size_t literal_start = 0;
+    const char* p = text;
+    while (*p) {
+        if (p[0] == '{' && p[1] == '{') {
+            program->literals[program->literal_bytes++] = '{';
+            p += 2;
+            continue;
+        }
+        if (p[0] != '{') {
+            program->literals[program->literal_bytes++] = *p++;
+            continue;
+        }
+
+        const char* close = strchr(p + 1, '}');
+        if (!close) {
+            template_free(program);
+            return NULL;
+        }
+
+        const char* name = p + 1;
+        size_t name_length = (size_t)(close - name);
+        bool secondary = name_length > strlen(SECONDARY_PREFIX) &&
+                         memcmp(name, SECONDARY_PREFIX, strlen(SECONDARY_PREFIX)) == 0;
+        if (secondary) {
+            name += strlen(SECONDARY_PREFIX);
+            name_length -= strlen(SECONDARY_PREFIX);
+        }
+
+        const SlotDefinition* definition = find_slot(name, name_length);
+        if (!definition) {
+            fprintf(stderr, "❌ Unknown template slot '%.*s'\n", (int)(close - p - 1), p + 1);
+            template_free(program);
+            return NULL;
+        }
+
+        // Close the pending literal, then the slot
+        bool ok = true;
+        if (program->literal_bytes > literal_start) {
+            TemplateSegment literal = {(uint32_t)literal_start, (uint32_t)(program->literal_bytes - literal_start),
+                                       SLOT_LITERAL, 0, 0, false, false};
+            ok = add_segment(program, &capacity, literal);
+        }
+        if (program->slot_count == TEMPLATE_MAX_SLOTS) {
+            fprintf(stderr, "❌ Template has more than %d slots\n", TEMPLATE_MAX_SLOTS);
+            template_free(program);
+            return NULL;
+        }
+
+        TemplateSegment slot = {0, 0, (uint8_t)definition->kind, (uint8_t)definition->field,
+                                (uint8_t)definition->decimals, definition->show_sign, secondary};
+        if (!ok || !add_segment(program, &capacity, slot)) {
+            template_free(program);
+            return NULL;
+        }
+        program->slot_count++;
+        literal_start = program->literal_bytes;
+        p = close + 1;
+    }
+
+    if (program->literal_bytes > literal_start) {
+        TemplateSegment literal = {(uint32_t)literal_start, (uint32_t)(program->literal_bytes - literal_start),
+                                   SLOT_LITERAL, 0, 0, false, false};
+        if (!add_segment(program, &capacity, literal)) {
+            template_free(program);
+            return NULL;
+        }
+    }
+    program->literals[program->literal_bytes] = '\0';
+    return program;
+}
+
+void template_free(TemplateProgram* program) {
+    if (!program) return;
+    free(program->segments);
+    free(program->literals);
+    free(program);
+}
+
+bool template_has_slots(const TemplateProgram* program) {
+    return program && program->slot_count > 0;
+}
+
+const char* template_static_text(const TemplateProgram* program) {
+    return program && program->slot_count == 0 ? program->literals : NULL;
+}
+
+size_t template_static_length(const TemplateProgram* program) {
+    return program ? program->literal_bytes : 0;
+}
+
+// ============================================================================
+// AGGREGATES
+// ============================================================================
+
+typedef enum {
+    CATEGORY_SAFE,
+    CATEGORY_SEMI_CRITICAL,
+    CATEGORY_CRITICAL,
+    CATEGORY_OVER_EXPLOITED,
+    CATEGORY_OTHER
+} CategoryRank;
+
+static const char* category_names[] = {"Safe", "Semi-Critical", "Critical", "Over-Exploited"};
+
+static CategoryRank rank_category(const char* category) {
+    for (int i = 0; i < CATEGORY_OTHER; i++) {
+        if (strcasecmp(category, category_names[i]) == 0) return (CategoryRank)i;
+    }
+    return CATEGORY_OTHER;
+}
+
+// Most common category; ties go to the more severe one
+static void dominant_category(char* out, size_t size, const int counts[CATEGORY_OTHER], const char* fallback) {
+    int best = -1;
+    for (int i = 0; i < CATEGORY_OTHER; i++) {
+        if (counts[i] > 0 && (best < 0 || counts[i] >= counts[best])) best = i;
+    }
+    snprintf(out, size, "%s", best >= 0 ? category_names[best] : (fallback ? fallback : ""));
+}
+
+void render_aggregate_init(RenderAggregate* aggregate, const char* location) {
+    memset(aggregate, 0, sizeof(*aggregate));
+    snprintf(aggregate->location, sizeof(aggregate->location), "%s", location ? location : "India");
+}
+
+void render_aggregate_rows(RenderAggregate* aggregate, const QueryResult* rows) {
+    aggregate->rows = rows;
+    if (!rows || rows->count <= 0) return;
+
+    // Canonical spelling from the data ("punjab" -> "Punjab")
+    const GroundwaterData* first = &rows->data[0];
+    if (strcasecmp(aggregate->location, first->state) == 0) {
+        snprintf(aggregate->location, sizeof(aggregate->location), "%s", first->state);
+    } else if (strcasecmp(aggregate->location, first->district) == 0) {
+        snprintf(aggregate->location, sizeof(aggregate->location), "%s", first->district);
+    }
+
+    int counts[CATEGORY_OTHER] = {0};
+    for (int i = 0; i < rows->count; i++) {
+        const GroundwaterData* row = &rows->data[i];
+        aggregate->recharge += row->annual_recharge;
+        aggregate->extractable += row->extractable_resource;
+        aggregate->extraction += row->annual_extraction;
+        if (row->assessment_year > aggregate->year) aggregate->year = row->assessment_year;
+
+        CategoryRank rank = rank_category(row->category);
+        if (rank != CATEGORY_OTHER) counts[rank]++;
+    }
+
+    aggregate->block_count = rows->count;
+    aggregate->safe = counts[CATEGORY_SAFE];
+    aggregate->semi_critical = counts[CATEGORY_SEMI_CRITICAL];
+    aggregate->critical = counts[CATEGORY_CRITICAL];
+    aggregate->over_exploited = counts[CATEGORY_OVER_EXPLOITED];
+    dominant_category(aggregate->category, sizeof(aggregate->category), counts, first->category);
+}
+
+void render_aggregate_history(RenderAggregate* aggregate, const QueryResult* history) {
+    if (!history || history->count <= 0) return;
+
+    // Sum every matching location per assessment year, oldest first
+    for (int i = 0; i < history->count; i++) {
+        const GroundwaterData* row = &history->data[i];
+        int slot = 0;
+        while (slot < aggregate->year_count && aggregate->years[slot].year < row->assessment_year) slot++;
+
+        if (slot == aggregate->year_count || aggregate->years[slot].year != row->assessment_year) {
+            if (aggregate->year_count == RENDER_MAX_YEARS) continue;
+            memmove(&aggregate->years[slot + 1], &aggregate->years[slot],
+                    sizeof(RenderYear) * (size_t)(aggregate->year_count - slot));
+            aggregate->years[slot] = (RenderYear){row->assessment_year, 0.0f, 0.0f};
+            aggregate->year_count++;
+        }
+        aggregate->years[slot].extractable += row->extractable_resource;
+        aggregate->years[slot].extraction += row->annual_extraction;
+    }
+
+    int first_year = aggregate->years[0].year;
+    int counts[CATEGORY_OTHER] = {0};
+    const char* fallback = NULL;
+    for (int i = 0; i < history->count; i++) {
+        if (history->data[i].assessment_year != first_year) continue;
+        CategoryRank rank = rank_category(history->data[i].category);
+        if (rank != CATEGORY_OTHER) counts[rank]++;
+        if (!fallback) fallback = history->data[i].category;
+    }
+    dominant_category(aggregate->first_category, sizeof(aggregate->first_category), counts, fallback);
+
+    const RenderYear* oldest = &aggregate->years[0];
+    const RenderYear* latest = &aggregate->years[aggregate->year_count - 1];
+    int span = latest->year - oldest->year;
+    if (span > 0 && oldest->extractable > 0.0f && latest->extractable > 0.0f) {
+        aggregate->trend_rate = (float)((pow(latest->extractable / oldest->extractable, 1.0 / span) - 1.0) * 100.0);
+    }
+}
+
+// ============================================================================
+// RENDERING
+// ============================================================================
+
+static double stage_of(double extraction, double extractable) {
+    return extractable > 0.0 ? extraction / extractable * 100.0 : 0.0;
+}
+
+static const char* interpretation_of(const RenderAggregate* aggregate) {
+    if (aggregate->block_count == 0) return "No assessment data is available for this location.";
+    switch (rank_category(aggregate->category)) {
+        case CATEGORY_OVER_EXPLOITED:
+            return "Extraction exceeds the sustainable limit; groundwater is being mined faster than it recharges.";
+        case CATEGORY_CRITICAL:
+            return "Extraction is close to the sustainable limit; new development needs regulation.";
+        case CATEGORY_SEMI_CRITICAL:
+            return "Moderate stress on the aquifer; development should be monitored.";
+        case CATEGORY_SAFE:
+            return "Extraction is within sustainable limits.";
+        default:
+            return "Category not classified in the latest assessment.";
+    }
+}
+
+static const char* risk_of(const RenderAggregate* aggregate) {
+    if (aggregate->block_count == 0) return "Unknown";
+    switch (rank_category(aggregate->category)) {
+        case CATEGORY_OVER_EXPLOITED: return "Very High";
+        case CATEGORY_CRITICAL:       return "High";
+        case CATEGORY_SEMI_CRITICAL:  return "Moderate";
+        case CATEGORY_SAFE:           return "Low";
+        default:                      return "Unknown";
+    }
+}
+
+static const char* trend_of(const RenderAggregate* aggregate) {
+    if (aggregate->year_count < 2) return "No earlier assessments available";
+    if (aggregate->trend_rate < -0.5f) return "Declining";
+    if (aggregate->trend_rate > 0.5f) return "Improving";
+    return "Stable";
+}
+
+// Worst rows by stage of extraction, as "   • District, State: 31.2%" lines
+static bool render_rows(const RenderAggregate* aggregate, StrBuf* out) {
+    const QueryResult* rows = aggregate->rows;
+    if (!rows || rows->count <= 0) {
+        return strbuf_append_str(out, "   • None in the current assessment\n");
+    }
+
+    int picked[RENDER_MAX_LIST_ROWS];
+    int picked_count = 0;
+    double picked_stage[RENDER_MAX_LIST_ROWS];
+    for (int i = 0; i < rows->count; i++) {
+        double stage = stage_of(rows->data[i].annual_extraction, rows->data[i].extractable_resource);
+        if (picked_count == RENDER_MAX_LIST_ROWS && stage <= picked_stage[picked_count - 1]) continue;
+
+        int pos = picked_count < RENDER_MAX_LIST_ROWS ? picked_count++ : RENDER_MAX_LIST_ROWS - 1;
+        while (pos > 0 && picked_stage[pos - 1] < stage) {
+            picked[pos] = picked[pos - 1];
+            picked_stage[pos] = picked_stage[pos - 1];
+            pos--;
+        }
+        picked[pos] = i;
+        picked_stage[pos] = stage;
+    }
+
+    bool ok = true;
+    for (int i = 0; ok && i < picked_count; i++) {
+        const GroundwaterData* row = &rows->data[picked[i]];
+        ok = strbuf_append_str(out, "   • ") && strbuf_append_str(out, row->district) &&
+             strbuf_append_str(out, ", ") && strbuf_append_str(out, row->state) &&
+             strbuf_append_str(out, ": ") &&
+             strbuf_append_fixed(out, stage_of(row->annual_extraction, row->extractable_resource), 1, false) &&
+             strbuf_append_str(out, "%\n");
+    }
+    if (ok && rows->count > picked_count) {
+        ok = strbuf_append_str(out, "   • ...and ") && strbuf_append_int(out, rows->count - picked_count) &&
+             strbuf_append_str(out, " more\n");
+    }
+    return ok;
+}
+
+// "• 2017: 27.4% | 88.40 MCM" per assessment year
+static bool render_history(const RenderAggregate* aggregate, StrBuf* out) {
+    if (aggregate->year_count == 0) {
+        return strbuf_append_str(out, "• No earlier assessments on record\n");
+    }
+
+    bool ok = true;
+    for (int i = 0; ok && i < aggregate->year_count; i++) {
+        const RenderYear* year = &aggregate->years[i];
+        ok = strbuf_append_str(out, "• ") && strbuf_append_int(out, year->year) &&
+             strbuf_append_str(out, ": ") &&
+             strbuf_append_fixed(out, stage_of(year->extraction, year->extractable), 1, false) &&
+             strbuf_append_str(out, "% | ") && strbuf_append_fixed(out, year->extractable, 2, false) &&
+             strbuf_append_str(out, " MCM\n");
+    }
+    return ok;
+}
+
+// Text-valued slots borrow a constant or the aggregate's own storage
+static const char* slot_text(const TemplateSegment* segment, const RenderAggregate* aggregate) {
+    switch ((RenderField)segment->field) {
+        case FIELD_LOCATION:        return aggregate->location;
+        case FIELD_CATEGORY:        return aggregate->category[0] ? aggregate->category : "Not assessed";
+        case FIELD_FIRST_CATEGORY:
+            return aggregate->first_category[0] ? aggregate->first_category
+                                                : (aggregate->category[0] ? aggregate->category : "Not assessed");
+        case FIELD_INTERPRETATION:  return interpretation_of(aggregate);
+        case FIELD_TREND:           return trend_of(aggregate);
+        case FIELD_RISK:            return risk_of(aggregate);
+        default:                    return NULL;
+    }
+}
+
+// Numeric and list slots are formatted
+static bool format_slot(const TemplateSegment* segment, const RenderAggregate* aggregate, StrBuf* out) {
+    int first_year = aggregate->year_count ? aggregate->years[0].year : aggregate->year;
+    int stressed = aggregate->critical + aggregate->over_exploited;
+
+    switch ((RenderField)segment->field) {
+        case FIELD_YEAR:            return strbuf_append_int(out, aggregate->year);
+        case FIELD_FIRST_YEAR:      return strbuf_append_int(out, first_year);
+        case FIELD_RECHARGE:
+            return strbuf_append_fixed(out, aggregate->recharge, segment->decimals, segment->show_sign);
+        case FIELD_EXTRACTABLE:
+            return strbuf_append_fixed(out, aggregate->extractable, segment->decimals, segment->show_sign);
+        case FIELD_EXTRACTION:
+            return strbuf_append_fixed(out, aggregate->extraction, segment->decimals, segment->show_sign);
+        case FIELD_STAGE:
+            return strbuf_append_fixed(out, stage_of(aggregate->extraction, aggregate->extractable),
+                                       segment->decimals, segment->show_sign);
+        case FIELD_BLOCK_COUNT:     return strbuf_append_int(out, aggregate->block_count);
+        case FIELD_STRESSED_COUNT:  return strbuf_append_int(out, stressed);
+        case FIELD_STRESSED_PCT:
+            return strbuf_append_int(out, aggregate->block_count ? lround(100.0 * stressed / aggregate->block_count) : 0);
+        case FIELD_TREND_RATE:
+            return strbuf_append_fixed(out, aggregate->trend_rate, segment->decimals, segment->show_sign);
+        case FIELD_PROJECTION:
+            return strbuf_append_fixed(out, aggregate->extractable * pow(1.0 + aggregate->trend_rate / 100.0,
+                                                                         PROJECTION_YEARS),
+                                       segment->decimals, segment->show_sign);
+        case FIELD_PROJECTION_YEAR: return strbuf_append_int(out, aggregate->year + PROJECTION_YEARS);
+        case FIELD_ROWS:            return render_rows(aggregate, out);
+        case FIELD_HISTORY:         return render_history(aggregate, out);
+        default:                    return false;
+    }
+}
+
+// A resolved slot: borrowed text, or a range of the per-thread scratch
+// buffer (kept as an offset, since the scratch may move as it grows)
+typedef struct {
+    const char* text;
+    size_t offset;
+    size_t length;
+} SlotValue;
+
+static pthread_once_t scratch_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t scratch_key;
+static _Thread_local StrBuf* slot_scratch;
+
+// Release the slot scratch buffer when its thread exits
+static void free_scratch(void* value) {
+    StrBuf* scratch = value;
+    strbuf_free(scratch);
+    free(scratch);
+    slot_scratch = NULL;
+}
+
+static void create_scratch_key(void) {
+    pthread_key_create(&scratch_key, free_scratch);
+}
+
+// This thread's slot scratch buffer, cleared for a new render
+static StrBuf* acquire_scratch(void) {
+    if (slot_scratch) {
+        strbuf_clear(slot_scratch);
+        return slot_scratch;
+    }
+
+    StrBuf* scratch = malloc(sizeof(StrBuf));
+    if (!scratch) return NULL;
+    strbuf_init(scratch);
+    pthread_once(&scratch_key_once, create_scratch_key);
+    pthread_setspecific(scratch_key, scratch);
+    slot_scratch = scratch;
+    return scratch;
+}
+
+// Resolve every slot value up front so the output length is known exactly
+// before a byte is written
+static bool resolve_slots(const TemplateProgram* program, const RenderData* data,
+                          SlotValue* values, size_t* length) {
+    StrBuf* scratch = acquire_scratch();
+    if (!scratch) return false;
+
+    size_t total = program->literal_bytes;
+    int slot = 0;
+    for (int i = 0; i < program->segment_count; i++) {
+        const TemplateSegment* segment = &program->segments[i];
+        if (segment->kind == SLOT_LITERAL) continue;
+
+        const RenderAggregate* aggregate = segment->secondary ? &data->secondary : &data->primary;
+        SlotValue* value = &values[slot++];
+        value->text = slot_text(segment, aggregate);
+        if (value->text) {
+            value->length = strlen(value->text);
+        } else {
+            value->offset = scratch->length;
+            if (!format_slot(segment, aggregate, scratch)) return false;
+            value->length = scratch->length - value->offset;
+        }
+        total += value->length;
+    }
+    *length = total;
+    return true;
+}
+
+static void write_segments(const TemplateProgram* program, const SlotValue* values, char* dest) {
+    int slot = 0;
+    for (int i = 0; i < program->segment_count; i++) {
+        const TemplateSegment* segment = &program->segments[i];
+        if (segment->kind == SLOT_LITERAL) {
+            memcpy(dest, program->literals + segment->offset, segment->length);
+            dest += segment->length;
+        } else {
+            const SlotValue* value = &values[slot++];
+            memcpy(dest, value->text ? value->text : slot_scratch->data + value->offset, value->length);
+            dest += value->length;
+        }
+    }
+    *dest = '\0';
+}
+
+bool template_render(const TemplateProgram* program, const RenderData* data, StrBuf* out) {
+    if (!program || !data || !out) return false;
+
+    SlotValue values[TEMPLATE_MAX_SLOTS];
+    size_t length;
+    if (!resolve_slots(program, data, values, &length)) return false;
+
+    // One exact reservation, then straight copies
+    if (!strbuf_reserve(out, length)) return false;
+    write_segments(program, values, out->data + out->length);
+    out->length += length;
+    return true;
+}
+
+char* template_render_alloc(const TemplateProgram* program, const RenderData* data, size_t* length) {
+    if (!program || !data) return NULL;
+
+    SlotValue values[TEMPLATE_MAX_SLOTS];
+    size_t total;
+    if (!resolve_slots(program, data, values, &total)) return NULL;
+
+    char* text = malloc(total + 1);
+    if (!text) return NULL;
+    write_segments(program, values, text);
+    if (length) *length = total;
+    return text;
+}
@@ -0,0 +1,191 @@
+/*
+ * INGRES ChatBot - Single-Flight Coalescing
+ * Identical concurrent queries share one pipeline run and one response.
+ */
+
+#include "singleflight.h"
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <pthread.h>
+
+typedef struct FlightMember {
+    SingleFlightCallback on_done;
+    void* member;
+    struct FlightMember* next;
+} FlightMember;
+
+struct SingleFlight {
+    uint64_t hash;
+    char* key;                          // NULL when the query is too long to coalesce
+    FlightMember* members;
+    FlightMember** members_tail;
+    struct SingleFlight* next;          // Stripe chain
+};
+
+typedef struct {
+    pthread_mutex_t lock;
+    SingleFlight* flights;
+} FlightStripe;
+
+static FlightStripe stripes[SINGLEFLIGHT_STRIPES];
+static pthread_once_t stripes_once = PTHREAD_ONCE_INIT;
+static atomic_uint_fast64_t leaders_total;
+static atomic_uint_fast64_t coalesced_total;
+static atomic_int flights_running;
+
+static void init_stripes(void) {
+    for (int i = 0; i < SINGLEFLIGHT_STRIPES; i++) {
+        pthread_mutex_init(&stripes[i].lock, NULL);
+        stripes[i].flights = NULL;
+    }
+}
+
+// ============================================================================
+// SHARED BYTES
+// ============================================================================
+
+SharedBytes* shared_bytes_new(int status, const char* data, size_t length) {
+    SharedBytes* bytes = malloc(sizeof(SharedBytes) + length + 1);
+    if (!bytes) return NULL;
+    atomic_init(&bytes->refs, 1);
+    bytes->status = status;
+    bytes->length = length;
+    bytes->deflated = NULL;
+    if (length > 0) memcpy(bytes->data, data, length);
+    bytes->data[length] = '\0';
+    return bytes;
+}
+
+SharedBytes* shared_bytes_retain(SharedBytes* bytes) {
+    if (bytes) atomic_fetch_add_explicit(&bytes->refs, 1, memory_order_relaxed);
+    return bytes;
+}
+
+void shared_bytes_release(SharedBytes* bytes) {
+    if (bytes && atomic_fetch_sub_explicit(&bytes->refs, 1, memory_order_acq_rel) == 1) {
+        shared_bytes_release(bytes->deflated);
+        free(bytes);
+    }
+}
+
+// ============================================================================
+// FLIGHTS
+// ============================================================================
+
+size_t singleflight_normalize(const char* query, char* out, size_t out_size) {
+    if (!query || out_size == 0) return 0;
+
+    size_t length = 0;
+    bool pending_space = false;
+    for (const unsigned char* p = (const unsigned char*)query; *p; p++) {
+        if (isspace(*p)) {
+            pending_space = length > 0;
+            continue;
+        }
+        if (length + (pending_space ? 2 : 1) >= out_size) return 0;
+        if (pending_space) out[length++] = ' ';
+        pending_space = false;
+        out[length++] = (char)tolower(*p);
+    }
+    while (length > 0 && strchr("?!.", out[length - 1])) length--;
+    while (length > 0 && out[length - 1] == ' ') length--;
+    out[length] = '\0';
+    return length;
+}
+
+static uint64_t fnv1a(const char* data, size_t length) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (unsigned char)data[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+SingleFlight* singleflight_begin(const char* query, SingleFlightCallback on_done, void* member) {
+    pthread_once(&stripes_once, init_stripes);
+
+    char key[SINGLEFLIGHT_KEY_MAX];
+    size_t key_length = singleflight_normalize(query, key, sizeof(key));
+
+    // Built up front so the stripe lock only covers the lookup
+    FlightMember* node = malloc(sizeof(FlightMember));
+    SingleFlight* flight = calloc(1, sizeof(SingleFlight));
+    char* owned_key = key_length > 0 ? malloc(key_length + 1) : NULL;
+    if (!node || !flight || (key_length > 0 && !owned_key)) {
+        free(node);
+        free(flight);
+        free(owned_key);
+        on_done(member, NULL);
+        return NULL;
+    }
+    node->on_done = on_done;
+    node->member = member;
+    node->next = NULL;
+    flight->hash = fnv1a(key, key_length);
+    flight->members = node;
+    flight->members_tail = &node->next;
+
+    if (owned_key) {
+        memcpy(owned_key, key, key_length + 1);
+        flight->key = owned_key;
+
+        FlightStripe* stripe = &stripes[flight->hash % SINGLEFLIGHT_STRIPES];
+        pthread_mutex_lock(&stripe->lock);
+        for (SingleFlight* other = stripe->flights; other; other = other->next) {
+            if (other->hash == flight->hash && strcmp(other->key, key) == 0) {
+                *other->members_tail = node;
+                other->members_tail = &node->next;
+                pthread_mutex_unlock(&stripe->lock);
+                free(owned_key);
+                free(flight);
+                atomic_fetch_add_explicit(&coalesced_total, 1, memory_order_relaxed);
+                return NULL;
+            }
+        }
+        flight->next = stripe->flights;
+        stripe->flights = flight;
+        pthread_mutex_unlock(&stripe->lock);
+    }
+
+    atomic_fetch_add_explicit(&leaders_total, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&flights_running, 1, memory_order_relaxed);
+    return flight;
+}
+
+void singleflight_complete(SingleFlight* flight, SharedBytes* result) {
+    if (!flight) {
+        shared_bytes_release(result);
+        return;
+    }
+
+    // Once unlinked no one else can join, so the member list is ours
+    if (flight->key) {
+        FlightStripe* stripe = &stripes[flight->hash % SINGLEFLIGHT_STRIPES];
+        pthread_mutex_lock(&stripe->lock);
+        SingleFlight** link = &stripe->flights;
+        while (*link && *link != flight) link = &(*link)->next;
+        if (*link) *link = flight->next;
+        pthread_mutex_unlock(&stripe->lock);
+    }
+    atomic_fetch_sub_explicit(&flights_running, 1, memory_order_relaxed);
+
+    FlightMember* node = flight->members;
+    while (node) {
+        FlightMember* next = node->next;
+        node->on_done(node->member, result);
+        free(node);
+        node = next;
+    }
+
+    free(flight->key);
+    free(flight);
+    shared_bytes_release(result);
+}
+
+void singleflight_stats(SingleFlightStats* stats) {
+    stats->leaders = atomic_load_explicit(&leaders_total, memory_order_relaxed);
+    stats->coalesced = atomic_load_explicit(&coalesced_total, memory_order_relaxed);
+    stats->in_flight = atomic_load_explicit(&flights_running, memory_order_relaxed);
+}
@@ -0,0 +1,695 @@
+/*
+ * INGRES ChatBot - Binary Dataset Snapshots
+ * Column-oriented, dictionary-encoded assessment images with prebuilt
+ * indexes, written offline and memory-mapped at startup.
+ */
+
+#include "snapshot.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#define SNAPSHOT_BYTE_ORDER 0x01020304u
+#define SNAPSHOT_ALIGN 8
+
+// On-disk header; every section offset is from the start of the image and
+// 8-byte aligned. The checksum covers everything after the header.
+typedef struct {
+    char magic[8];
+    uint32_t format_version;
+    uint32_t byte_order;            // Images are native-endian; reject foreign ones
+    uint64_t image_size;
+    uint64_t checksum;
+    uint32_t row_count;
+    uint32_t string_count;
+    uint32_t state_count;
+    uint32_t category_count;
+    uint64_t string_offsets;        // uint32_t[string_count + 1]
+    uint64_t string_blob;           // NUL-terminated strings
+    uint64_t col_state;             // uint32_t[row_count] string ids
+    uint64_t col_district;
+    uint64_t col_block;
+    uint64_t col_category;
+    uint64_t col_recharge;          // float[row_count]
+    uint64_t col_extractable;
+    uint64_t col_extraction;
+    uint64_t col_year;              // int32_t[row_count]
+    uint64_t state_ranges;          // SnapshotRange[state_count]
+    uint64_t category_ranges;       // SnapshotRange[category_count]
+    uint64_t category_rows;         // uint32_t[row_count]
+} SnapshotHeader;
+
+// FNV-1a over 64-bit words (bytewise for the tail). Word-at-a-time keeps
+// verification of a national dataset in the low milliseconds.
+static uint64_t image_checksum(const uint8_t* data, size_t len) {
+    uint64_t hash = 14695981039346656037ULL;
+    size_t words = len / 8;
+    for (size_t i = 0; i < words; i++) {
+        uint64_t word;
+        memcpy(&word, data + i * 8, 8);
+        hash ^= word;
+        hash *= 1099511628211ULL;
+    }
+    for (size_t i = words * 8; i < len; i++) {
+        hash ^= data[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static size_t align_up(size_t value) {
+    return (value + SNAPSHOT_ALIGN - 1) & ~(size_t)(SNAPSHOT_ALIGN - 1);
+}
+
+// ============================================================================
+// BUILDER
+// ============================================================================
+
+struct SnapshotBuilder {
+    // String dictionary: blob of NUL-terminated strings plus an
+    // open-addressing table of ids
+    char* blob;
+    size_t blob_size;
+    size_t blob_capacity;
+    uint32_t* offsets;
+    uint32_t string_count;
+    uint32_t string_capacity;
+    uint32_t* table;                // id + 1, 0 = empty
+    uint32_t table_size;            // Power of two
+
+    // Row columns
+    uint32_t* state;
+    uint32_t* district;
+    uint32_t* block;
+    uint32_t* category;
+    float* recharge;
+    float* extractable;
+    float* extraction;
+    int32_t* year;
+    uint32_t row_count;
+    uint32_t row_capacity;
+};
+
+static uint32_t hash_string(const char* s) {
+    uint32_t hash = 2166136261u;
+    for (const unsigned char* p = (const unsigned char*)s; *p; p++) {
+        hash ^= *p;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+SnapshotBuilder* snapshot_builder_create(void) {
+    SnapshotBuilder* builder = calloc(1, sizeof(SnapshotBuilder));
+    if (!builder) return NULL;
+
+    builder->table_size = 1024;
+    builder->table = calloc(builder->table_size, sizeof(uint32_t));
+    if (!builder->table) {
+        free(builder);
+        return NULL;
+    }
+    return builder;
+}
+
+void snapshot_builder_free(SnapshotBuilder* builder) {
+    if (!builder) return;
+    free(builder->blob);
+    free(builder->offsets);
+    free(builder->table);
+    free(builder->state);
+    free(builder->district);
+    free(builder->block);
+    free(builder->category);
+    free(builder->recharge);
+    free(builder->extractable);
+    free(builder->extraction);
+    free(builder->year);
+    free(builder);
+}
+
+static bool grow_table(SnapshotBuilder* builder) {
+    uint32_t size = builder->table_size * 2;
+    uint32_t* table = calloc(size, sizeof(uint32_t));
+    if (!table) return false;
+
+    for (uint32_t id = 0; id < builder->string_count; id++) {
+        uint32_t slot = hash_string(builder->blob + builder->offsets[id]) & (size - 1);
+        while (table[slot]) slot = (slot + 1) & (size - 1);
+        table[slot] = id + 1;
+    }
+    free(builder->table);
+    builder->table = table;
+    builder->table_size = size;
+    return true;
+}
+
+// Returns the dictionary id for s, adding it if new; UINT32_MAX on failure
+static uint32_t intern(SnapshotBuilder* builder, const char* s) {
+    uint32_t mask = builder->table_size - 1;
+    uint32_t slot = hash_string(s) & mask;
+    while (builder->table[slot]) {
+        uint32_t id = builder->table[slot] - 1;
+        if (strcmp(builder->blob + builder->offsets[id], s) == 0) return id;
+        slot = (slot + 1) & mask;
+    }
+
+    size_t len = strlen(s) + 1;
+    if (builder->blob_size + len > builder->blob_capacity) {
+        size_t capacity = builder->blob_capacity ? builder->blob_capacity * 2 : 4096;
+        while (capacity < builder->blob_size + len) capacity *= 2;
+        char* blob = realloc(builder->blob, capacity);
+        if (!blob) return UINT32_MAX;
+        builder->blob = blob;
+        builder->blob_capacity = capacity;
+    }
+    if (builder->string_count == builder->string_capacity) {
+        uint32_t capacity = builder->string_capacity ? builder->string_capacity * 2 : 256;
+        uint32_t* offsets = realloc(builder->offsets, sizeof(uint32_t) * capacity);
+        if (!offsets) return UINT32_MAX;
+        builder->offsets = offsets;
+        builder->string_capacity = capacity;
+    }
+
+    uint32_t id = builder->string_count++;
+    builder->offsets[id] = (uint32_t)builder->blob_size;
+    memcpy(builder->blob + builder->blob_size, s, len);
+    builder->blob_size += len;
+    builder->table[slot] = id + 1;
+
+    // Keep the table at most half full
+    if (builder->string_count * 2 > builder->table_size && !grow_table(builder)) {
+        return UINT32_MAX;
+    }
+    return id;
+}
+
+#define GROW_COLUMN(column, type) do { \
+        type* grown = realloc(builder->column, sizeof(type) * capacity); \
+        if (!grown) return false; \
+        builder->column = grown; \
+    } while (0)
+
+static bool grow_rows(SnapshotBuilder* builder) {
+    uint32_t capacity = builder->row_capacity ? builder->row_capacity * 2 : 1024;
+    GROW_COLUMN(state, uint32_t);
+    GROW_COLUMN(district, uint32_t);
+    GROW_COLUMN(block, uint32_t);
+    GROW_COLUMN(category, uint32_t);
+    GROW_COLUMN(recharge, float);
+    GROW_COLUMN(extractable, float);
+    GROW_COLUMN(extraction, float);
+    GROW_COLUMN(year, int32_t);
+    builder->row_capacity = capacity;
+    return true;
+}
+
+bool snapshot_builder_add(SnapshotBuilder* builder, const GroundwaterData* row) {
+    if (!builder || !row) return false;
+    if (builder->row_count == builder->row_capacity && !grow_rows(builder)) return false;
+
+    uint32_t ids[4] = {
+        intern(builder, row->state),
+        intern(builder, row->district),
+        intern(builder, row->block),
+        intern(builder, row->category)
+    };
+    for (int i = 0; i < 4; i++) {
+        if (ids[i] == UINT32_MAX) return false;
+    }
+
+    uint32_t r = builder->row_count++;
+    builder->state[r] = ids[0];
+    builder->district[r] = ids[1];
+    builder->block[r] = ids[2];
+    builder->category[r] = ids[3];
+    builder->recharge[r] = row->annual_recharge;
+    builder->extractable[r] = row->extractable_resource;
+    builder->extraction[r] = row->annual_extraction;
+    builder->year[r] = row->assessment_year;
+    return true;
+}
+
+static const char* builder_string(const SnapshotBuilder* builder, uint32_t id) {
+    return builder->blob + builder->offsets[id];
+}
+
+// qsort has no context argument; finish runs one sort at a time per thread
+static _Thread_local const SnapshotBuilder* sort_builder;
+
+static int compare_rows(const void* a, const void* b) {
+    uint32_t ra = *(const uint32_t*)a, rb = *(const uint32_t*)b;
+    const SnapshotBuilder* builder = sort_builder;
+
+    int cmp = strcasecmp(builder_string(builder, builder->state[ra]), builder_string(builder, builder->state[rb]));
+    if (cmp) return cmp;
+    cmp = strcasecmp(builder_string(builder, builder->district[ra]), builder_string(builder, builder->district[rb]));
+    if (cmp) return cmp;
+    cmp = strcasecmp(builder_string(builder, builder->block[ra]), builder_string(builder, builder->block[rb]));
+    if (cmp) return cmp;
+    if (builder->year[ra] != builder->year[rb]) return builder->year[ra] < builder->year[rb] ? -1 : 1;
+    return ra < rb ? -1 : (ra > rb);
+}
+
+static int compare_category_names(const void* a, const void* b) {
+    const SnapshotRange* ra = a;
+    const SnapshotRange* rb = b;
+    return strcasecmp(builder_string(sort_builder, ra->name_id), builder_string(sort_builder, rb->name_id));
+}
+
+uint8_t* snapshot_builder_finish(SnapshotBuilder* builder, size_t* size) {
+    if (!builder || !size) return NULL;
+
+    uint32_t rows = builder->row_count;
+    uint32_t strings = builder->string_count;
+    uint32_t* order = malloc(sizeof(uint32_t) * (rows ? rows : 1));
+    if (!order) return NULL;
+    for (uint32_t i = 0; i < rows; i++) order[i] = i;
+
+    sort_builder = builder;
+    qsort(order, rows, sizeof(uint32_t), compare_rows);
+
+    // State ranges over the sorted rows (names compared case-insensitively)
+    uint32_t state_count = 0;
+    for (uint32_t i = 0; i < rows; i++) {
+        if (i == 0 || strcasecmp(builder_string(builder, builder->state[order[i]]),
+                                 builder_string(builder, builder->state[order[i - 1]])) != 0) {
+            state_count++;
+        }
+    }
+
+    // Categories: distinct ids, counted per id
+    uint32_t* category_slot = malloc(sizeof(uint32_t) * (strings ? strings : 1));
+    SnapshotRange* categories = calloc(strings ? strings : 1, sizeof(SnapshotRange));
+    if (!category_slot || !categories) {
+        free(order);
+        free(category_slot);
+        free(categories);
+        return NULL;
+    }
+    memset(category_slot, 0xff, sizeof(uint32_t) * (strings ? strings : 1));
+    uint32_t category_count = 0;
+    for (uint32_t i = 0; i < rows; i++) {
+        uint32_t id = builder->category[i];
+        if (category_slot[id] == UINT32_MAX) {
+            categories[category_count].name_id = id;
+            category_slot[id] = category_count++;
+        }
+        categories[category_slot[id]].count++;
+    }
+    qsort(categories, category_count, sizeof(SnapshotRange), compare_category_names);
+    uint32_t first = 0;
+    for (uint32_t c = 0; c < category_count; c++) {
+        categories[c].first = first;
+        first += categories[c].count;
+        category_slot[categories[c].name_id] = c;
+    }
+
+    // Layout
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    size_t offset = align_up(sizeof(SnapshotHeader));
+    size_t column_bytes = sizeof(uint32_t) * rows;
+
+    header.string_offsets = offset;   offset = align_up(offset + sizeof(uint32_t) * (strings + 1));
+    header.string_blob = offset;      offset = align_up(offset + builder->blob_size);
+    header.col_state = offset;        offset = align_up(offset + column_bytes);
+    header.col_district = offset;     offset = align_up(offset + column_bytes);
+    header.col_block = offset;        offset = align_up(offset + column_bytes);
+    header.col_category = offset;     offset = align_up(offset + column_bytes);
+    header.col_recharge = offset;     offset = align_up(offset + sizeof(float) * rows);
+    header.col_extractable = offset;  offset = align_up(offset + sizeof(float) * rows);
+    header.col_extraction = offset;   offset = align_up(offset + sizeof(float) * rows);
+    header.col_year = offset;         offset = align_up(offset + sizeof(int32_t) * rows);
+    header.state_ranges = offset;     offset = align_up(offset + sizeof(SnapshotRange) * state_count);
+    header.category_ranges = offset;  offset = align_up(offset + sizeof(SnapshotRange) * category_count);
+    header.category_rows = offset;    offset = align_up(offset + column_bytes);
+
+    uint8_t* image = calloc(1, offset);
+    if (!image) {
+        free(order);
+        free(category_slot);
+        free(categories);
+        return NULL;
+    }
+
+    uint32_t* string_offsets = (uint32_t*)(image + header.string_offsets);
+    memcpy(string_offsets, builder->offsets, sizeof(uint32_t) * strings);
+    string_offsets[strings] = (uint32_t)builder->blob_size;
+    if (builder->blob_size) memcpy(image + header.string_blob, builder->blob, builder->blob_size);
+
+    uint32_t* col_state = (uint32_t*)(image + header.col_state);
+    uint32_t* col_district = (uint32_t*)(image + header.col_district);
+    uint32_t* col_block = (uint32_t*)(image + header.col_block);
+    uint32_t* col_category = (uint32_t*)(image + header.col_category);
+    float* col_recharge = (float*)(image + header.col_recharge);
+    float* col_extractable = (float*)(image + header.col_extractable);
+    float* col_extraction = (float*)(image + header.col_extraction);
+    int32_t* col_year = (int32_t*)(image + header.col_year);
+    SnapshotRange* state_ranges = (SnapshotRange*)(image + header.state_ranges);
+    uint32_t* category_rows = (uint32_t*)(image + header.category_rows);
+
+    uint32_t* category_fill = calloc(category_count ? category_count : 1, sizeof(uint32_t));
+    if (!category_fill) {
+        free(image);
+        free(order);
+        free(category_slot);
+        free(categories);
+        return NULL;
+    }
+
+    int32_t state_index = -1;
+    for (uint32_t i = 0; i < rows; i++) {
+        uint32_t r = order[i];
+        col_state[i] = builder->state[r];
+        col_district[i] = builder->district[r];
+        col_block[i] = builder->block[r];
+        col_category[i] = builder->category[r];
+        col_recharge[i] = builder->recharge[r];
+        col_extractable[i] = builder->extractable[r];
+        col_extraction[i] = builder->extraction[r];
+        col_year[i] = builder->year[r];
+
+        if (i == 0 || strcasecmp(builder_string(builder, col_state[i]),
+                                 builder_string(builder, col_state[i - 1])) != 0) {
+            state_index++;
+            state_ranges[state_index].name_id = col_state[i];
+            state_ranges[state_index].first = i;
+        }
+        state_ranges[state_index].count++;
+
+        uint32_t c = category_slot[col_category[i]];
+        category_rows[categories[c].first + category_fill[c]++] = i;
+    }
+    memcpy(image + header.category_ranges, categories, sizeof(SnapshotRange) * category_count);
+
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.format_version = SNAPSHOT_FORMAT_VERSION;
+    header.byte_order = SNAPSHOT_BYTE_ORDER;
+    header.image_size = offset;
+    header.row_count = rows;
+    header.string_count = strings;
+    header.state_count = state_count;
+    header.category_count = category_count;
+    size_t body = align_up(sizeof(SnapshotHeader));
+    header.checksum = image_checksum(image + body, offset - body);
+    memcpy(image, &header, sizeof(header));
+
+    free(category_fill);
+    free(order);
+    free(category_slot);
+    free(categories);
+
+    *size = offset;
+    return image;
+}
+
+bool snapshot_write_file(const uint8_t* image, size_t size, const char* path) {
+    if (!image || !path) return false;
+
+    size_t path_len = strlen(path);
+    char* temp_path = malloc(path_len + 5);
+    if (!temp_path) return false;
+    memcpy(temp_path, path, path_len);
+    memcpy(temp_path + path_len, ".tmp", 5);
+
+    FILE* file = fopen(temp_path, "wb");
+    if (!file) {
+        free(temp_path);
+        return false;
+    }
+
+    bool ok = fwrite(image, 1, size, file) == size;
+    ok = fflush(file) == 0 && ok;
+#ifndef _WIN32
+    ok = ok && fsync(fileno(file)) == 0;
+#endif
+    ok = fclose(file) == 0 && ok;
+
+#ifdef _WIN32
+    remove(path);
+#endif
+    if (ok) ok = rename(temp_path, path) == 0;
+    if (!ok) remove(temp_path);
+
+    free(temp_path);
+    return ok;
+}
+
+// ============================================================================
+// LOADING
+// ============================================================================
+
+static bool section_ok(const SnapshotHeader* header, uint64_t offset, uint64_t bytes) {
+    return offset % SNAPSHOT_ALIGN == 0 && offset >= sizeof(SnapshotHeader) &&
+           offset <= header->image_size && bytes <= header->image_size - offset;
+}
+
+static bool ids_ok(const uint32_t* ids, uint32_t count, uint32_t limit) {
+    for (uint32_t i = 0; i < count; i++) {
+        if (ids[i] >= limit) return false;
+    }
+    return true;
+}
+
+static bool ranges_ok(const SnapshotRange* ranges, uint32_t count, uint32_t rows, uint32_t strings) {
+    uint64_t covered = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        if (ranges[i].name_id >= strings || ranges[i].first != covered) return false;
+        covered += ranges[i].count;
+    }
+    return covered == rows;
+}
+
+// Validate the image and fill in the column views
+static bool attach(Snapshot* snapshot, const uint8_t* image, size_t size) {
+    if (size < sizeof(SnapshotHeader)) return false;
+
+    SnapshotHeader header;
+    memcpy(&header, image, sizeof(header));
+    if (memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0 ||
+        header.format_version != SNAPSHOT_FORMAT_VERSION ||
+        header.byte_order != SNAPSHOT_BYTE_ORDER ||
+        header.image_size != size) {
+        return false;
+    }
+
+    size_t body = align_up(sizeof(SnapshotHeader));
+    if (image_checksum(image + body, size - body) != header.checksum) return false;
+
+    uint64_t rows = header.row_count;
+    uint64_t column_bytes = sizeof(uint32_t) * rows;
+    if (!section_ok(&header, header.string_offsets, sizeof(uint32_t) * ((uint64_t)header.string_count + 1)) ||
+        !section_ok(&header, header.col_state, column_bytes) ||
+        !section_ok(&header, header.col_district, column_bytes) ||
+        !section_ok(&header, header.col_block, column_bytes) ||
+        !section_ok(&header, header.col_category, column_bytes) ||
+        !section_ok(&header, header.col_recharge, sizeof(float) * rows) ||
+        !section_ok(&header, header.col_extractable, sizeof(float) * rows) ||
+        !section_ok(&header, header.col_extraction, sizeof(float) * rows) ||
+        !section_ok(&header, header.col_year, sizeof(int32_t) * rows) ||
+        !section_ok(&header, header.state_ranges, sizeof(SnapshotRange) * (uint64_t)header.state_count) ||
+        !section_ok(&header, header.category_ranges, sizeof(SnapshotRange) * (uint64_t)header.category_count) ||
+        !section_ok(&header, header.category_rows, column_bytes)) {
+        return false;
+    }
+
+    const uint32_t* string_offsets = (const uint32_t*)(image + header.string_offsets);
+    uint32_t blob_size = string_offsets[header.string_count];
+    if (!section_ok(&header, header.string_blob, blob_size)) return false;
+    const char* blob = (const char*)(image + header.string_blob);
+    for (uint32_t i = 0; i < header.string_count; i++) {
+        if (string_offsets[i] >= blob_size || string_offsets[i + 1] < string_offsets[i] + 1 ||
+            blob[string_offsets[i + 1] - 1] != '\0') {
+            return false;
+        }
+    }
+
+    snapshot->row_count = header.row_count;
+    snapshot->string_count = header.string_count;
+    snapshot->state_count = header.state_count;
+    snapshot->category_count = header.category_count;
+    snapshot->checksum = header.checksum;
+    snapshot->string_offsets = string_offsets;
+    snapshot->string_blob = blob;
+    snapshot->state = (const uint32_t*)(image + header.col_state);
+    snapshot->district = (const uint32_t*)(image + header.col_district);
+    snapshot->block = (const uint32_t*)(image + header.col_block);
+    snapshot->category = (const uint32_t*)(image + header.col_category);
+    snapshot->annual_recharge = (const float*)(image + header.col_recharge);
+    snapshot->extractable_resource = (const float*)(image + header.col_extractable);
+    snapshot->annual_extraction = (const float*)(image + header.col_extraction);
+    snapshot->assessment_year = (const int32_t*)(image + header.col_year);
+    snapshot->states = (const SnapshotRange*)(image + header.state_ranges);
+    snapshot->categories = (const SnapshotRange*)(image + header.category_ranges);
+    snapshot->category_rows = (const uint32_t*)(image + header.category_rows);
+    snapshot->image = image;
+    snapshot->image_size = size;
+
+    uint32_t strings = header.string_count;
+    return ids_ok(snapshot->state, header.row_count, strings) &&
+           ids_ok(snapshot->district, header.row_count, strings) &&
+           ids_ok(snapshot->block, header.row_count, strings) &&
+           ids_ok(snapshot->category, header.row_count, strings) &&
+           ids_ok(snapshot->category_rows, header.row_count, header.row_count) &&
+           ranges_ok(snapshot->states, header.state_count, header.row_count, strings) &&
+           ranges_ok(snapshot->categories, header.category_count, header.row_count, strings);
+}
+
+Snapshot* snapshot_from_image(uint8_t* image, size_t size) {
+    if (!image) return NULL;
+
+    Snapshot* snapshot = calloc(1, sizeof(Snapshot));
+    if (!snapshot || !attach(snapshot, image, size)) {
+        free(snapshot);
+        free(image);
+        return NULL;
+    }
+    return snapshot;
+}
+
+Snapshot* snapshot_from_rows(const GroundwaterData* rows, int count) {
+    SnapshotBuilder* builder = snapshot_builder_create();
+    if (!builder) return NULL;
+
+    for (int i = 0; i < count; i++) {
+        if (!snapshot_builder_add(builder, &rows[i])) {
+            snapshot_builder_free(builder);
+            return NULL;
+        }
+    }
+
+    size_t size = 0;
+    uint8_t* image = snapshot_builder_finish(builder, &size);
+    snapshot_builder_free(builder);
+    return snapshot_from_image(image, size);
+}
+
+Snapshot* snapshot_open(const char* path) {
+    if (!path) return NULL;
+
+#ifdef _WIN32
+    // No shared mapping here; read the image into memory
+    FILE* file = fopen(path, "rb");
+    if (!file) return NULL;
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (length <= 0) {
+        fclose(file);
+        return NULL;
+    }
+    uint8_t* image = malloc((size_t)length);
+    size_t got = image ? fread(image, 1, (size_t)length, file) : 0;
+    fclose(file);
+    if (got != (size_t)length) {
+        free(image);
+        return NULL;
+    }
+    return snapshot_from_image(image, (size_t)length);
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return NULL;
+    }
+
+    size_t size = (size_t)st.st_size;
+    void* mapping = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) return NULL;
+    posix_madvise(mapping, size, POSIX_MADV_WILLNEED);
+
+    Snapshot* snapshot = calloc(1, sizeof(Snapshot));
+    if (!snapshot || !attach(snapshot, mapping, size)) {
+        free(snapshot);
+        munmap(mapping, size);
+        return NULL;
+    }
+    snapshot->mapped = true;
+    return snapshot;
+#endif
+}
+
+void snapshot_close(Snapshot* snapshot) {
+    if (!snapshot) return;
+
+#ifndef _WIN32
+    if (snapshot->mapped) {
+        munmap((void*)snapshot->image, snapshot->image_size);
+    } else
+#endif
+    {
+        free((void*)snapshot->image);
+    }
+    free(snapshot);
+}
+
+// ============================================================================
+// LOOKUPS
+// ============================================================================
+
+const char* snapshot_string(const Snapshot* snapshot, uint32_t id) {
+    if (!snapshot || id >= snapshot->string_count) return "";
+    return snapshot->string_blob + snapshot->string_offsets[id];
+}
+
+static void copy_field(char* dest, size_t size, const char* src) {
+    size_t len = strlen(src);
+    if (len >= size) len = size - 1;
+    memcpy(dest, src, len);
+    dest[len] = '\0';
+}
+
+void snapshot_get_row(const Snapshot* snapshot, uint32_t row, GroundwaterData* out) {
+    if (!snapshot || !out || row >= snapshot->row_count) return;
+
+    copy_field(out->state, sizeof(out->state), snapshot_string(snapshot, snapshot->state[row]));
+    copy_field(out->district, sizeof(out->district), snapshot_string(snapshot, snapshot->district[row]));
+    copy_field(out->block, sizeof(out->block), snapshot_string(snapshot, snapshot->block[row]));
+    copy_field(out->category, sizeof(out->category), snapshot_string(snapshot, snapshot->category[row]));
+    out->annual_recharge = snapshot->annual_recharge[row];
+    out->extractable_resource = snapshot->extractable_resource[row];
+    out->annual_extraction = snapshot->annual_extraction[row];
+    out->assessment_year = snapshot->assessment_year[row];
+}
+
+const SnapshotRange* snapshot_find_state(const Snapshot* snapshot, const char* state) {
+    if (!snapshot || !state) return NULL;
+
+    uint32_t low = 0, high = snapshot->state_count;
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        int cmp = strcasecmp(snapshot_string(snapshot, snapshot->states[mid].name_id), state);
+        if (cmp == 0) return &snapshot->states[mid];
+        if (cmp < 0) low = mid + 1;
+        else high = mid;
+    }
+    return NULL;
+}
+
+const SnapshotRange* snapshot_find_category(const Snapshot* snapshot, const char* category) {
+    if (!snapshot || !category) return NULL;
+
+    // A handful of CGWB categories; a linear scan beats anything fancier
+    for (uint32_t i = 0; i < snapshot->category_count; i++) {
+        if (strcasecmp(snapshot_string(snapshot, snapshot->categories[i].name_id), category) == 0) {
+            return &snapshot->categories[i];
+        }
+    }
+    return NULL;
+}
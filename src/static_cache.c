@@ -0,0 +1,267 @@
+/*
+ * INGRES ChatBot - Static Asset Cache
+ * Web UI files held in memory with ETags and precompressed gzip bodies.
+ */
+
+#include "static_cache.h"
+#include "compress.h"
+#include "utils.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#define STATIC_PATH_MAX 1024
+#define STATIC_MAX_DEPTH 16
+
+static StaticAsset* buckets[STATIC_CACHE_BUCKETS];
+static StaticCacheStats totals;
+
+static uint64_t fnv1a(const char* data, size_t length) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (unsigned char)data[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static StaticAsset** bucket_for(const char* path) {
+    return &buckets[fnv1a(path, strlen(path)) % STATIC_CACHE_BUCKETS];
+}
+
+static StaticAsset* lookup(const char* path) {
+    for (StaticAsset* asset = *bucket_for(path); asset; asset = asset->next) {
+        if (strcmp(asset->path, path) == 0) return asset;
+    }
+    return NULL;
+}
+
+// ============================================================================
+// FILE TYPES
+// ============================================================================
+
+typedef struct {
+    const char* extension;
+    const char* content_type;
+    bool compressible;
+} FileType;
+
+static const FileType file_types[] = {
+    { "html",  "text/html; charset=utf-8", true },
+    { "css",   "text/css; charset=utf-8", true },
+    { "js",    "text/javascript; charset=utf-8", true },
+    { "mjs",   "text/javascript; charset=utf-8", true },
+    { "json",  "application/json", true },
+    { "map",   "application/json", true },
+    { "txt",   "text/plain; charset=utf-8", true },
+    { "xml",   "application/xml", true },
+    { "svg",   "image/svg+xml", true },
+    { "ico",   "image/x-icon", true },
+    { "png",   "image/png", false },
+    { "jpg",   "image/jpeg", false },
+    { "jpeg",  "image/jpeg", false },
+    { "gif",   "image/gif", false },
+    { "webp",  "image/webp", false },
+    { "woff",  "font/woff", false },
+    { "woff2", "font/woff2", false },
+};
+
+static const FileType* file_type(const char* name) {
+    static const FileType unknown = { "", "application/octet-stream", false };
+    const char* dot = strrchr(name, '.');
+    if (dot) {
+        for (size_t i = 0; i < sizeof(file_types) / sizeof(file_types[0]); i++) {
+            if (strcasecmp(dot + 1, file_types[i].extension) == 0) return &file_types[i];
+        }
+    }
+    return &unknown;
+}
+
+// A dot-separated part between the stem and the extension that is 8+ hex
+// digits, as in main.1a2b3c4d.js or 453.0d1ad5e6.chunk.js
+static bool has_content_hash(const char* name) {
+    const char* part = strchr(name, '.');
+    while (part) {
+        const char* end = strchr(part + 1, '.');
+        if (!end) return false;
+        size_t length = (size_t)(end - part - 1);
+        bool hex = length >= 8;
+        for (const char* p = part + 1; hex && p < end; p++) hex = isxdigit((unsigned char)*p);
+        if (hex) return true;
+        part = end;
+    }
+    return false;
+}
+
+// ============================================================================
+// LOADING
+// ============================================================================
+
+static char* read_file(const char* file, size_t length) {
+    FILE* in = fopen(file, "rb");
+    if (!in) return NULL;
+    char* data = malloc(length + 1);
+    if (data && fread(data, 1, length, in) != length) {
+        free(data);
+        data = NULL;
+    }
+    fclose(in);
+    if (data) data[length] = '\0';
+    return data;
+}
+
+static void free_asset(StaticAsset* asset) {
+    free(asset->path);
+    free(asset->file);
+    free(asset->data);
+    free(asset->gzip);
+    free(asset);
+}
+
+static void add_file(const char* file, const char* path, const char* name, size_t length) {
+    if (lookup(path)) return;
+
+    StaticAsset* asset = calloc(1, sizeof(StaticAsset));
+    if (!asset) return;
+    asset->path = strdup(path);
+    asset->file = strdup(file);
+    if (!asset->path || !asset->file) {
+        free_asset(asset);
+        return;
+    }
+
+    const FileType* type = file_type(name);
+    asset->content_type = type->content_type;
+    asset->cache_control = has_content_hash(name) ? STATIC_CACHE_IMMUTABLE : STATIC_CACHE_REVALIDATE;
+    asset->length = length;
+
+    if (length <= STATIC_CACHE_MAX_FILE_BYTES && totals.bytes + length <= STATIC_CACHE_MAX_BYTES) {
+        asset->data = read_file(file, length);
+    }
+    if (!asset->data) {
+        // Too large to hold (or unreadable now): served from disk per request
+        totals.on_disk++;
+    } else {
+        totals.bytes += length;
+        uint64_t hash = fnv1a(asset->data, length);
+        snprintf(asset->etag, sizeof(asset->etag), "\"%016llx\"", (unsigned long long)hash);
+        snprintf(asset->gzip_etag, sizeof(asset->gzip_etag), "\"%016llx-gz\"", (unsigned long long)hash);
+
+        StrBuf gzip;
+        strbuf_init(&gzip);
+        if (type->compressible && length >= COMPRESS_MIN_BYTES &&
+            gzip_buffer_best(asset->data, length, &gzip) &&
+            gzip.length < length * STATIC_CACHE_GZIP_MAX_RATIO) {
+            asset->gzip = gzip.data;
+            asset->gzip_length = gzip.length;
+            totals.gzip_bytes += gzip.length;
+        } else {
+            strbuf_free(&gzip);
+        }
+    }
+
+    StaticAsset** bucket = bucket_for(path);
+    asset->next = *bucket;
+    *bucket = asset;
+    totals.assets++;
+}
+
+static void walk(const char* directory, const char* prefix, int depth) {
+    DIR* dir = opendir(directory);
+    if (!dir) return;
+
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (entry->d_name[0] == '.') continue;
+
+        char file[STATIC_PATH_MAX], path[STATIC_PATH_MAX];
+        int file_length = snprintf(file, sizeof(file), "%s/%s", directory, entry->d_name);
+        int path_length = snprintf(path, sizeof(path), "%s/%s", prefix, entry->d_name);
+        if (file_length < 0 || path_length < 0 ||
+            (size_t)file_length >= sizeof(file) || (size_t)path_length >= sizeof(path)) {
+            continue;
+        }
+
+        struct stat info;
+        if (stat(file, &info) != 0) continue;
+        if (S_ISDIR(info.st_mode)) {
+            if (depth < STATIC_MAX_DEPTH) walk(file, path, depth + 1);
+        } else if (S_ISREG(info.st_mode)) {
+            add_file(file, path, entry->d_name, (size_t)info.st_size);
+        }
+    }
+    closedir(dir);
+}
+
+bool static_cache_load(const char* root) {
+    struct stat info;
+    if (!root || stat(root, &info) != 0 || !S_ISDIR(info.st_mode)) return false;
+    walk(root, "", 0);
+    return true;
+}
+
+// ============================================================================
+// LOOKUP
+// ============================================================================
+
+const StaticAsset* static_cache_find(const char* path) {
+    if (!path || path[0] != '/') return NULL;
+
+    size_t length = strlen(path);
+    if (path[length - 1] != '/') return lookup(path);
+
+    char index[STATIC_PATH_MAX];
+    if (length + sizeof("index.html") > sizeof(index)) return NULL;
+    memcpy(index, path, length);
+    memcpy(index + length, "index.html", sizeof("index.html"));
+    return lookup(index);
+}
+
+// If-None-Match compares weakly: a W/ prefix still matches
+bool static_cache_not_modified(const StaticAsset* asset, const char* header, size_t length) {
+    if (!asset || !asset->data || !header) return false;
+
+    const char* end = header + length;
+    const char* item = header;
+    while (item < end) {
+        const char* item_end = memchr(item, ',', (size_t)(end - item));
+        if (!item_end) item_end = end;
+
+        const char* tag = item;
+        while (tag < item_end && (*tag == ' ' || *tag == '\t')) tag++;
+        const char* tag_end = item_end;
+        while (tag_end > tag && (tag_end[-1] == ' ' || tag_end[-1] == '\t')) tag_end--;
+        if (tag_end - tag >= 2 && tag[0] == 'W' && tag[1] == '/') tag += 2;
+        size_t tag_length = (size_t)(tag_end - tag);
+
+        if (tag_length == 1 && *tag == '*') return true;
+        if ((tag_length == strlen(asset->etag) && memcmp(tag, asset->etag, tag_length) == 0) ||
+            (tag_length == strlen(asset->gzip_etag) && memcmp(tag, asset->gzip_etag, tag_length) == 0)) {
+            return true;
+        }
+        item = item_end + 1;
+    }
+    return false;
+}
+
+void static_cache_get_stats(StaticCacheStats* stats) {
+    *stats = totals;
+}
+
+void static_cache_clear(void) {
+    for (int i = 0; i < STATIC_CACHE_BUCKETS; i++) {
+        StaticAsset* asset = buckets[i];
+        while (asset) {
+            StaticAsset* next = asset->next;
+            free_asset(asset);
+            asset = next;
+        }
+        buckets[i] = NULL;
+    }
+    memset(&totals, 0, sizeof(totals));
+}
@@ -1,10 +1,35 @@
 #include "chatbot.h"
 #include "utils.h"
+#include "query_cache.h"
+#include "snapshot.h"
+#include "csv_reader.h"
+#include "timeseries.h"
+#include "response_render.h"
+#include "intent_patterns.h"
+#include "logger.h"
+#include "metrics.h"
+#include "admission.h"
+#include "singleflight.h"
+#include "json_writer.h"
+#include "json_reader.h"
+#include "compress.h"
+#include "static_cache.h"
+#include "api.h"
+#ifdef USE_POSTGRESQL
+#include "db_pool.h"
+#include "db_async.h"
+#endif
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <math.h>
+#include <stdint.h>
+#include <stddef.h>
 #include <assert.h>
+#include <pthread.h>
+#include <zlib.h>
+#include <sys/stat.h>
 
 // Test framework structures
 typedef struct {
@@ -35,9 +60,6 @@ typedef struct {
     double total_time;
 } TestResults;
 
-// External logging function
-extern void log_message(int level, const char* format, ...);
-
 // Test data
 IntentTestCase intent_tests[] = {
     // Basic interactions
@@ -72,6 +94,7 @@ ResponseTestCase response_tests[] = {
     {"Help Response", "Help", 1, "I can help you with"},
     {"Critical Areas Response", "Show critical areas", 1, "CRITICAL GROUNDWATER AREAS"},
     {"Policy Response", "Policy suggestions", 1, "COMPREHENSIVE POLICY RECOMMENDATIONS"},
+    {"Location Data Response", "Punjab groundwater data", 1, "Net Availability**: 368.60 MCM"},
 };
 
 FuzzyMatchingTestCase fuzzy_tests[] = {
@@ -106,12 +129,12 @@ int run_intent_tests(TestResults* results) {
         if (test_passed) {
             passed++;
             printf("✅ %s: PASSED (%.2fms)\n", intent_tests[i].test_name, time_taken);
-            log_message(1, "Test '%s' PASSED", intent_tests[i].test_name);
+            log_message(LOG_INFO, "Test '%s' PASSED", intent_tests[i].test_name);
         } else {
             printf("❌ %s: FAILED\n", intent_tests[i].test_name);
             printf("   Expected: %d (%.2f confidence)\n", intent_tests[i].expected_intent, intent_tests[i].min_confidence);
             printf("   Got: %d (%.2f confidence)\n", result, confidence);
-            log_message(2, "Test '%s' FAILED - Expected %d, Got %d", intent_tests[i].test_name,
+            log_message(LOG_ERROR, "Test '%s' FAILED - Expected %d, Got %d", intent_tests[i].test_name,
                        intent_tests[i].expected_intent, result);
         }
 
@@ -153,7 +176,7 @@ int run_response_tests(TestResults* results) {
         if (test_passed) {
             passed++;
             printf("✅ %s: PASSED (%.2fms)\n", response_tests[i].test_name, time_taken);
-            log_message(1, "Response test '%s' PASSED", response_tests[i].test_name);
+            log_message(LOG_INFO, "Response test '%s' PASSED", response_tests[i].test_name);
         } else {
             printf("❌ %s: FAILED\n", response_tests[i].test_name);
             printf("   Expected substring: '%s'\n", response_tests[i].expected_substring);
@@ -162,7 +185,7 @@ int run_response_tests(TestResults* results) {
             } else {
                 printf("   No response generated\n");
             }
-            log_message(2, "Response test '%s' FAILED", response_tests[i].test_name);
+            log_message(LOG_ERROR, "Response test '%s' FAILED", response_tests[i].test_name);
         }
 
         if (response) {
@@ -204,11 +227,11 @@ int run_fuzzy_tests(TestResults* results) {
             passed++;
             printf("✅ %s: PASSED (%.2fms, confidence: %.2f)\n",
                    fuzzy_tests[i].test_name, time_taken, confidence);
-            log_message(1, "Fuzzy test '%s' PASSED", fuzzy_tests[i].test_name);
+            log_message(LOG_INFO, "Fuzzy test '%s' PASSED", fuzzy_tests[i].test_name);
         } else {
             printf("❌ %s: FAILED\n", fuzzy_tests[i].test_name);
             printf("   Intent: %d, Confidence: %.2f\n", result, confidence);
-            log_message(2, "Fuzzy test '%s' FAILED - Intent: %d, Confidence: %.2f",
+            log_message(LOG_ERROR, "Fuzzy test '%s' FAILED - Intent: %d, Confidence: %.2f",
                        fuzzy_tests[i].test_name, result, confidence);
         }
 
@@ -286,11 +309,11 @@ int run_performance_tests(TestResults* results) {
     if (perf_passed) {
         printf("✅ Performance test: PASSED\n");
         results->passed_tests++;
-        log_message(1, "Performance test PASSED - Avg: %.2fms, Success: %.1f%%", avg_time, success_rate);
+        log_message(LOG_INFO, "Performance test PASSED - Avg: %.2fms, Success: %.1f%%", avg_time, success_rate);
     } else {
         printf("❌ Performance test: FAILED\n");
         results->failed_tests++;
-        log_message(2, "Performance test FAILED - Avg: %.2fms, Success: %.1f%%", avg_time, success_rate);
+        log_message(LOG_ERROR, "Performance test FAILED - Avg: %.2fms, Success: %.1f%%", avg_time, success_rate);
     }
 
     results->total_tests++;
@@ -299,6 +322,1324 @@ int run_performance_tests(TestResults* results) {
     return perf_passed;
 }
 
+int run_query_cache_tests(TestResults* results) {
+    printf("\n🗃️  QUERY CACHE TESTS\n");
+    printf("=====================\n");
+
+    int passed = 0;
+    int test_count = 5;
+    QueryCacheStats before, after;
+
+    // Small bounds so eviction is easy to trigger
+    query_cache_init(3, QUERY_CACHE_DEFAULT_BYTES, 60);
+
+    // 1. Repeat lookup is a hit, served as an independent copy
+    QueryResult* first = query_by_state("Punjab");
+    query_cache_get_stats(&before);
+    QueryResult* second = query_by_state("Punjab");
+    query_cache_get_stats(&after);
+    int hit = first && second && after.hits == before.hits + 1 &&
+              first->count == second->count && first->data != second->data &&
+              (first->count == 0 || memcmp(first->data, second->data,
+                                           sizeof(GroundwaterData) * first->count) == 0);
+    free_query_result(second);
+    printf("%s Read-through Hit: %s\n", hit ? "✅" : "❌", hit ? "PASSED" : "FAILED");
+    passed += hit;
+
+    // 2. Parameters are normalized before keying
+    query_cache_get_stats(&before);
+    QueryResult* normalized = query_by_state("  PUNJAB ");
+    query_cache_get_stats(&after);
+    int normalize_ok = normalized && first && normalized->count == first->count &&
+                       after.hits == before.hits + 1;
+    free_query_result(normalized);
+    free_query_result(first);
+    printf("%s Key Normalization: %s\n", normalize_ok ? "✅" : "❌", normalize_ok ? "PASSED" : "FAILED");
+    passed += normalize_ok;
+
+    // 3. Entry bound evicts the least recently used result
+    free_query_result(query_by_state("Haryana"));
+    free_query_result(query_by_state("Gujarat"));
+    free_query_result(query_by_state("Kerala"));
+    query_cache_get_stats(&after);
+    int bounded = after.entries == 3 && after.evictions >= 1 &&
+                  !query_cache_get(QUERY_KIND_STATE, "Punjab", NULL, NULL);
+    printf("%s LRU Bound: %s (%zu entries, %ld evicted)\n", bounded ? "✅" : "❌",
+           bounded ? "PASSED" : "FAILED", after.entries, after.evictions);
+    passed += bounded;
+
+    // 4. A dataset version change drops everything cached so far
+    db_mark_dataset_changed();
+    query_cache_get_stats(&after);
+    QueryResult* stale = query_cache_get(QUERY_KIND_STATE, "Haryana", NULL, NULL);
+    int invalidated = !stale && after.entries == 0;
+    free_query_result(stale);
+    printf("%s Version Invalidation: %s\n", invalidated ? "✅" : "❌", invalidated ? "PASSED" : "FAILED");
+    passed += invalidated;
+
+    // 5. Keys too long to store whole are not cached, so queries sharing a
+    // long prefix never get each other's results
+    char long_a[QUERY_CACHE_KEY_MAX + 16], long_b[QUERY_CACHE_KEY_MAX + 16];
+    memset(long_a, 'x', sizeof(long_a) - 2);
+    memcpy(long_b, long_a, sizeof(long_a) - 2);
+    long_a[sizeof(long_a) - 2] = 'a';
+    long_b[sizeof(long_b) - 2] = 'b';
+    long_a[sizeof(long_a) - 1] = long_b[sizeof(long_b) - 1] = '\0';
+    GroundwaterData row = {0};
+    QueryResult long_result = { .data = &row, .count = 1, .query_type = "Test", .capacity = 1 };
+    query_cache_put(QUERY_KIND_STATE, long_a, NULL, NULL, &long_result, db_dataset_version());
+    QueryResult* collided = query_cache_get(QUERY_KIND_STATE, long_b, NULL, NULL);
+    QueryResult* oversized = query_cache_get(QUERY_KIND_STATE, long_a, NULL, NULL);
+    int long_ok = !collided && !oversized;
+    free_query_result(collided);
+    free_query_result(oversized);
+    printf("%s Oversized Keys: %s\n", long_ok ? "✅" : "❌", long_ok ? "PASSED" : "FAILED");
+    passed += long_ok;
+
+    // Restore the configured cache for the remaining tests
+    query_cache_init(0, 0, 0);
+
+    results->total_tests += test_count;
+    results->passed_tests += passed;
+    results->failed_tests += (test_count - passed);
+
+    printf("\nQuery Cache Tests: %d/%d passed\n", passed, test_count);
+    return passed;
+}
+
+int run_snapshot_tests(TestResults* results) {
+    printf("\n📦 SNAPSHOT TESTS\n");
+    printf("=================\n");
+
+    int passed = 0;
+    int test_count = 4;
+
+    // 1. Quoted fields with embedded commas, escaped quotes and empty fields
+    char record[] = "Tamil Nadu,\"Chennai, \"\"North\"\"\",,2023";
+    char* fields[8];
+    int count = csv_parse_record(record, strlen(record), fields, 8);
+    int csv_ok = count == 4 && strcmp(fields[0], "Tamil Nadu") == 0 &&
+                 strcmp(fields[1], "Chennai, \"North\"") == 0 &&
+                 fields[2][0] == '\0' && strcmp(fields[3], "2023") == 0;
+    printf("%s Quote-aware CSV: %s\n", csv_ok ? "✅" : "❌", csv_ok ? "PASSED" : "FAILED");
+    passed += csv_ok;
+
+    // 2. Written image maps back with the same rows and state index
+    SnapshotBuilder* builder = snapshot_builder_create();
+    for (int i = 0; builder && i < sample_data_count; i++) {
+        snapshot_builder_add(builder, &sample_data[i]);
+    }
+    size_t size = 0;
+    uint8_t* image = snapshot_builder_finish(builder, &size);
+    snapshot_builder_free(builder);
+
+    const char* path = "test_suite_snapshot.snap";
+    Snapshot* mapped = image && snapshot_write_file(image, size, path) ? snapshot_open(path) : NULL;
+    int punjab_rows = 0;
+    for (int i = 0; i < sample_data_count; i++) {
+        punjab_rows += strcmp(sample_data[i].state, "Punjab") == 0;
+    }
+    const SnapshotRange* punjab = snapshot_find_state(mapped, "PUNJAB");
+    GroundwaterData row = {0};
+    if (punjab) snapshot_get_row(mapped, punjab->first, &row);
+    int roundtrip = mapped && (int)mapped->row_count == sample_data_count && punjab &&
+                    (int)punjab->count == punjab_rows && strcmp(row.state, "Punjab") == 0;
+    snapshot_close(mapped);
+    remove(path);
+    printf("%s Snapshot Round-trip: %s\n", roundtrip ? "✅" : "❌", roundtrip ? "PASSED" : "FAILED");
+    passed += roundtrip;
+
+    // 3. A single flipped byte fails checksum validation
+    int rejected = 0;
+    if (image) {
+        uint8_t* corrupt = malloc(size);
+        if (corrupt) {
+            memcpy(corrupt, image, size);
+            corrupt[size - 1] ^= 0x5a;
+            Snapshot* bad = snapshot_from_image(corrupt, size);  // Frees corrupt on failure
+            rejected = bad == NULL;
+            snapshot_close(bad);
+        }
+    }
+    printf("%s Checksum Validation: %s\n", rejected ? "✅" : "❌", rejected ? "PASSED" : "FAILED");
+    passed += rejected;
+
+    // 4. Hot reload swaps datasets under a held reader and bumps the version
+    SnapshotBuilder* partial = snapshot_builder_create();
+    for (int i = 0; partial && i < 5; i++) {
+        snapshot_builder_add(partial, &sample_data[i]);
+    }
+    size_t partial_size = 0;
+    uint8_t* partial_image = snapshot_builder_finish(partial, &partial_size);
+    snapshot_builder_free(partial);
+
+    const char* partial_path = "test_suite_partial.snap";
+    const char* full_path = "test_suite_full.snap";
+    const char* history_path = "test_suite_history.snap";
+    int reloaded = 0;
+    if (partial_image && image && snapshot_write_file(partial_image, partial_size, partial_path) &&
+        snapshot_write_file(image, size, full_path)) {
+        const struct Snapshot* held = db_snapshot_acquire();
+        unsigned long version = db_dataset_version();
+        bool swapped = db_reload_snapshot(partial_path);
+        // The held snapshot must stay readable until released
+        int held_ok = held && (int)held->row_count == sample_data_count &&
+                      snapshot_find_state(held, "Punjab") != NULL;
+        db_snapshot_release();
+        bool failed_kept = !db_reload_snapshot("test_suite_missing.snap");
+        const struct Snapshot* current = db_snapshot_acquire();
+        reloaded = swapped && held_ok && failed_kept && db_dataset_version() > version &&
+                   current && current->row_count == 5;
+        db_snapshot_release();
+
+        // Restore the full dataset for the remaining tests. A mapped file
+        // gets no built-in history, so the sample years go in as its
+        // INGRES_HISTORY.
+        SnapshotBuilder* past = snapshot_builder_create();
+        for (int i = 0; past && i < sample_history_count; i++) {
+            snapshot_builder_add(past, &sample_history[i]);
+        }
+        size_t past_size = 0;
+        uint8_t* past_image = snapshot_builder_finish(past, &past_size);
+        snapshot_builder_free(past);
+        if (past_image && snapshot_write_file(past_image, past_size, history_path)) {
+            setenv("INGRES_HISTORY", history_path, 1);
+        }
+        db_reload_snapshot(full_path);
+        unsetenv("INGRES_HISTORY");
+        free(past_image);
+    }
+    remove(partial_path);
+    remove(full_path);
+    remove(history_path);
+    free(partial_image);
+    free(image);
+    printf("%s Hot Reload: %s\n", reloaded ? "✅" : "❌", reloaded ? "PASSED" : "FAILED");
+    passed += reloaded;
+
+    results->total_tests += test_count;
+    results->passed_tests += passed;
+    results->failed_tests += (test_count - passed);
+
+    printf("\nSnapshot Tests: %d/%d passed\n", passed, test_count);
+    return passed;
+}
+
+static GroundwaterData history_row(const char* district, int year, float extractable) {
+    GroundwaterData row = {"Testland", "", "Block", "Safe", 10.0f, extractable, 5.0f, year};
+    snprintf(row.district, sizeof(row.district), "%s", district);
+    return row;
+}
+
+int run_timeseries_tests(TestResults* results) {
+    printf("\n📈 TIME SERIES TESTS\n");
+    printf("====================\n");
+
+    int passed = 0;
+    int test_count = 4;
+
+    GroundwaterData rows[] = {
+        history_row("Falling", 2017, 81.0f),
+        history_row("Falling", 2013, 100.0f),
+        history_row("Falling", 2015, 95.5f),
+        history_row("Falling", 2015, 90.0f),    // Later duplicate replaces 95.5
+        history_row("Slipping", 2013, 50.0f),   // Before the scan window
+        history_row("Slipping", 2015, 40.0f),
+        history_row("Slipping", 2017, 38.0f),
+        history_row("Rising", 2015, 20.0f),
+        history_row("Rising", 2017, 22.25f),
+    };
+    TimeSeriesStore* store = timeseries_build(rows, sizeof(rows) / sizeof(rows[0]));
+
+    // 1. Delta-encoded series decode exactly, in year order, within a range
+    uint32_t falling = 0;
+    GroundwaterData decoded[4];
+    size_t found = store ? timeseries_find(store, "testland", "falling", NULL, &falling, 1) : 0;
+    size_t range = found ? timeseries_range(store, falling, 2015, 0, decoded, 4) : 0;
+    int range_ok = found == 1 && range == 2 &&
+                   decoded[0].assessment_year == 2015 && decoded[0].extractable_resource == 90.0f &&
+                   decoded[1].assessment_year == 2017 && decoded[1].extractable_resource == 81.0f &&
+                   strcmp(decoded[1].district, "Falling") == 0;
+    printf("%s Range Query: %s\n", range_ok ? "✅" : "❌", range_ok ? "PASSED" : "FAILED");
+    passed += range_ok;
+
+    // 2. Slope and CAGR computed at build time (100 -> 90 -> 81 over 4 years)
+    const TimeSeriesStats* stats = found ? timeseries_stats(store, falling) : NULL;
+    int stats_ok = stats && stats->year_count == 3 && stats->first_year == 2013 && stats->last_year == 2017 &&
+                   fabsf(stats->slope[TS_MEASURE_EXTRACTABLE] + 4.75f) < 0.001f &&
+                   fabsf(stats->cagr[TS_MEASURE_EXTRACTABLE] + 0.0513f) < 0.001f;
+    printf("%s Slope/CAGR: %s\n", stats_ok ? "✅" : "❌", stats_ok ? "PASSED" : "FAILED");
+    passed += stats_ok;
+
+    // 3. Decline scan ranks by relative change from the first year since 2015
+    TimeSeriesDecline declines[4];
+    size_t declined = timeseries_fastest_declining(store, TS_MEASURE_EXTRACTABLE, 2015, declines, 4);
+    const char* first_district = NULL;
+    if (declined > 0) timeseries_location_names(store, declines[0].location, NULL, &first_district, NULL);
+    int scan_ok = declined == 2 && first_district && strcmp(first_district, "Falling") == 0 &&
+                  declines[0].from_year == 2015 && declines[0].to_year == 2017 &&
+                  fabsf(declines[0].change + 0.1f) < 0.0001f && declines[1].change > declines[0].change;
+    printf("%s Fastest Declining Scan: %s\n", scan_ok ? "✅" : "❌", scan_ok ? "PASSED" : "FAILED");
+    passed += scan_ok;
+    timeseries_free(store);
+
+    // 4. Trend queries return every assessment year for the location
+    QueryResult* trend = query_historical_trend("Punjab", "Amritsar", NULL);
+    int trend_ok = trend && trend->count == 5 && trend->data[0].assessment_year == 2013 &&
+                   trend->data[4].assessment_year == 2023;
+    free_query_result(trend);
+    QueryResult* decline = query_fastest_declining(2013, 3);
+    trend_ok = trend_ok && decline && decline->count == 3;
+    free_query_result(decline);
+    printf("%s Historical Trend Query: %s\n", trend_ok ? "✅" : "❌", trend_ok ? "PASSED" : "FAILED");
+    passed += trend_ok;
+
+    results->total_tests += test_count;
+    results->passed_tests += passed;
+    results->failed_tests += (test_count - passed);
+
+    printf("\nTime Series Tests: %d/%d passed\n", passed, test_count);
+    return passed;
+}
+
+int run_template_tests(TestResults* results) {
+    printf("\n🧩 TEMPLATE RENDERING TESTS\n");
+    printf("===========================\n");
+
+    int passed = 0;
+    int test_count = 4;
+
+    GroundwaterData rows[] = {
+        {"Punjab", "Amritsar", "Ajnala", "Over-Exploited", 40.0f, 80.0f, 20.0f, 2023},
+        {"Punjab", "Patiala", "Patiala", "Critical", 50.0f, 70.0f, 35.0f, 2023},
+        {"Punjab", "Ludhiana", "Ludhiana-I", "Over-Exploited", 45.0f, 50.0f, 30.0f, 2023},
+    };
+    QueryResult result = { .data = rows, .count = 3, .query_type = "Test", .capacity = 3 };
+    RenderData data;
+    render_aggregate_init(&data.primary, "punjab");
+    render_aggregate_init(&data.secondary, "Haryana");
+    render_aggregate_rows(&data.primary, &result);
+
+    StrBuf out;
+    strbuf_init(&out);
+
+    // 1. Slots bind to the aggregate: canonical name, sums, stage, dominant category
+    TemplateProgram* program = template_compile("{location} {year}: {category}, {extractable} MCM at {stage}% "
+                                                "({stressed_count}/{block_count}) vs {other_location} {{x}");
+    int bound = program && template_render(program, &data, &out) &&
+                strcmp(out.data, "Punjab 2023: Over-Exploited, 200.00 MCM at 42.5% (3/3) vs Haryana {x}") == 0;
+    printf("%s Slot Binding: %s\n", bound ? "✅" : "❌", bound ? "PASSED" : "FAILED");
+    passed += bound;
+    template_free(program);
+
+    // 2. List slots order rows by stage of extraction, worst first
+    strbuf_clear(&out);
+    program = template_compile("{rows}");
+    int listed = program && template_render(program, &data, &out) &&
+                 strstr(out.data, "Ludhiana, Punjab: 60.0%") == out.data + strlen("   • ") &&
+                 strstr(out.data, "Patiala, Punjab: 50.0%") < strstr(out.data, "Amritsar, Punjab: 25.0%");
+    printf("%s Row List: %s\n", listed ? "✅" : "❌", listed ? "PASSED" : "FAILED");
+    passed += listed;
+    template_free(program);
+
+    // 3. Unknown slots and unterminated placeholders are compile errors
+    int rejected = template_compile("Hello {nonexistent}") == NULL && template_compile("Hello {location") == NULL;
+    printf("%s Compile Errors: %s\n", rejected ? "✅" : "❌", rejected ? "PASSED" : "FAILED");
+    passed += rejected;
+
+    // 4. Exact-size rendering matches the buffer path; static text is shared, not copied
+    strbuf_clear(&out);
+    program = template_compile("{location}: {stage}% ({category})");
+    size_t length = 0;
+    char* exact = template_render_alloc(program, &data, &length);
+    TemplateProgram* fixed = template_compile("No slots {{here}");
+    size_t greeting_length = 0;
+    const char* greeting = get_response_template(INTENT_GREETING, &greeting_length);
+    int exact_ok = exact && template_render(program, &data, &out) && strcmp(exact, out.data) == 0 &&
+                   length == strlen(exact) && out.length == length &&
+                   template_static_text(program) == NULL && template_static_text(fixed) &&
+                   strcmp(template_static_text(fixed), "No slots {here}") == 0 &&
+                   template_static_length(fixed) == strlen("No slots {here}") &&
+                   greeting == get_response_template(INTENT_GREETING, NULL) &&
+                   greeting_length == strlen(greeting) &&
+                   get_response_template(INTENT_COUNT, NULL) == get_response_template(INTENT_UNKNOWN, NULL);
+    printf("%s Exact Length & Static Text: %s\n", exact_ok ? "✅" : "❌", exact_ok ? "PASSED" : "FAILED");
+    passed += exact_ok;
+    free(exact);
+    template_free(fixed);
+    template_free(program);
+
+    strbuf_free(&out);
+
+    results->total_tests += test_count;
+    results->passed_tests += passed;
+    results->failed_tests += (test_count - passed);
+
+    printf("\nTemplate Tests: %d/%d passed\n", passed, test_count);
+    return passed;
+}
+
+int run_response_ownership_tests(TestResults* results) {
+    printf("\n📦 RESPONSE OWNERSHIP TESTS\n");
+    printf("============================\n");
+
+    int passed = 0;
+    int test_count = 3;
+
+    // 1. Static intents return one prebuilt response; freeing it is a no-op
+    BotResponse* greeting = generate_enhanced_response(INTENT_GREETING, "hello", NULL, NULL, NULL);
+    BotResponse* again = generate_enhanced_response(INTENT_GREETING, "namaste", NULL, NULL, NULL);
+    int shared = greeting && greeting == again && bot_response_is_static(greeting) && greeting->owned == 0 &&
+                 greeting->suggestion_count > 0 && greeting->source_count == 3;
+    free_enhanced_bot_response(again);
+    shared = shared && greeting->message && strlen(greeting->message) > 0;
+    printf("%s Shared Static Response: %s\n", shared ? "✅" : "❌", shared ? "PASSED" : "FAILED");
+    passed += shared;
+
+    // 2. A borrowed copy is private but shares every string
+    BotResponse* copy = bot_response_borrow(greeting);
+    BotResponse* heap = bot_response_new(INTENT_HELP);
+    int borrowed = copy && copy != greeting && copy->message == greeting->message &&
+                   copy->suggested_actions[0] == greeting->suggested_actions[0] &&
+                   copy->owned == 0 && !bot_response_is_static(copy) &&
+                   heap && bot_response_borrow(heap) == NULL;
+    if (copy) copy->confidence_score = 0.1f;
+    borrowed = borrowed && greeting->confidence_score != 0.1f;
+    free_enhanced_bot_response(copy);
+    free_enhanced_bot_response(heap);
+    printf("%s Borrowed Copy: %s\n", borrowed ? "✅" : "❌", borrowed ? "PASSED" : "FAILED");
+    passed += borrowed;
+
+    // 3. Cache hits hand out references to the cached response, which
+    // outlives the caller's own reference
+    init_response_cache();
+    BotResponse* original = bot_response_new(INTENT_HELP);
+    int counted = original != NULL;
+    if (counted) {
+        original->message = strdup("cached response");
+        original->owned |= RESPONSE_OWNS_MESSAGE;
+        counted = cache_response("ownership_test_key", original);
+        free_enhanced_bot_response(original);
+        BotResponse* hit = get_cached_response("ownership_test_key");
+        counted = counted && hit == original && strcmp(hit->message, "cached response") == 0;
+        free_enhanced_bot_response(hit);
+    }
+    printf("%s Cached References: %s\n", counted ? "✅" : "❌", counted ? "PASSED" : "FAILED");
+    passed += counted;
+
+    results->total_tests += test_count;
+    results->passed_tests += passed;
+    results->failed_tests += (test_count - passed);
+
+    printf("\nResponse Ownership Tests: %d/%d passed\n", passed, test_count);
+    return passed;
+}
+
+int run_arena_tests(TestResults* results) {
+    printf("\n🧱 ARENA TESTS\n");
+    printf("==============\n");
+
+    int passed = 0;
+    int test_count = 3;
+
+    // 1. Allocations stay aligned and intact across block overflow
+    Arena arena;
+    arena_init(&arena);
+    char* first = arena_strdup(&arena, "Ludhiana");
+    void* large = arena_alloc(&arena, ARENA_BLOCK_SIZE * 2);
+    char* lower = arena_lower(&arena, "PUNJAB Groundwater");
+    int intact = first && large && lower && strcmp(first, "Ludhiana") == 0 &&
+                 strcmp(lower, "punjab groundwater") == 0 &&
+                 ((uintptr_t)large % _Alignof(max_align_t)) == 0 &&
+                 ((uintptr_t)lower % _Alignof(max_align_t)) == 0;
+    printf("%s Bump Allocation: %s\n", intact ? "✅" : "❌", intact ? "PASSED" : "FAILED");
+    passed += intact;
+
+    // 2. Reset frees everything at once and reuses one block sized for the request
+    arena_reset(&arena);
+    char* reused = arena_alloc(&arena, 64);
+    void* fits = arena_alloc(&arena, ARENA_BLOCK_SIZE * 2);
+    char* after = arena_alloc(&arena, 16);
+    int reset_ok = reused && fits && after && after > (char*)fits && after < (char*)fits + ARENA_BLOCK_SIZE * 3;
+    arena_destroy(&arena);
+    printf("%s Reset Reuse: %s\n", reset_ok ? "✅" : "❌", reset_ok ? "PASSED" : "FAILED");
+    passed += reset_ok;
+
+    // 3. The thread cache hands back the released arena; nested requests get their own
+    Arena* outer = arena_acquire();
+    Arena* inner = arena_acquire();
+    int cached = outer && inner && outer != inner;
+    arena_release(inner);
+    Arena* again = arena_acquire();
+    cached = cached && again == inner;
+    const char* state = NULL;
+    const char* district = NULL;
+    const char* block = NULL;
+    extract_locations(again, "Groundwater in PUNJAB near Ludhiana", &state, &district, &block);
+    cached = cached && state && strcmp(state, "punjab") == 0 && district && strcmp(district, "ludhiana") == 0;
+    arena_release(again);
+    arena_release(outer);
+    printf("%s Thread Cache: %s\n", cached ? "✅" : "❌", cached ? "PASSED" : "FAILED");
+    passed += cached;
+
+    results->total_tests += test_count;
+    results->passed_tests += passed;
+    results->failed_tests += (test_count - passed);
+
+    printf("\nArena Tests: %d/%d passed\n", passed, test_count);
+    return passed;
+}
+
+int run_object_pool_tests(TestResults* results) {
+    printf("\n♻️  OBJECT POOL TESTS\n");
+    printf("====================\n");
+
+    int passed = 0;
+    int test_count = 3;
+
+    // 1. A freed response comes back on this thread with every field cleared
+    BotResponse* response = bot_response_new(INTENT_HELP);
+    int reused = response != NULL;
+    if (response) {
+        response->message = strdup("Pooled message");
+        response->owned = RESPONSE_OWNS_MESSAGE;
+        response->confidence_score = 0.9f;
+        response->suggestion_count = 2;
+    }
+    free_bot_response(response);
+    BotResponse* again = bot_response_new(INTENT_GREETING);
+    reused = reused && again == response && again->intent == INTENT_GREETING &&
+             again->message == NULL && again->owned == 0 && again->suggestion_count == 0 &&
+             again->confidence_score == 0.0f && atomic_load(&again->ref_count) == 1;
+    free_bot_response(again);
+    printf("%s Response Reuse: %s\n", reused ? "✅" : "❌", reused ? "PASSED" : "FAILED");
+    passed += reused;
+
+    // 2. A freed query result keeps its row buffer; everything else is reset
+    QueryResult* result = query_result_new(16, "Category Query");
+    GroundwaterData* rows = result ? result->data : NULL;
+    if (result) {
+        result->count = 3;
+        result->execution_time_ms = 4.5f;
+    }
+    free_query_result(result);
+    QueryResult* next = query_result_new(8, "State Query");
+    int kept = result && next == result && next->data == rows && next->capacity >= 16 &&
+               next->count == 0 && next->execution_time_ms == 0.0f &&
+               strcmp(next->query_type, "State Query") == 0;
+    free_query_result(next);
+    printf("%s Result Buffer Reuse: %s\n", kept ? "✅" : "❌", kept ? "PASSED" : "FAILED");
+    passed += kept;
+
+    // 3. Oversized row buffers are released instead of pooled
+    QueryResult* large = query_result_new(QUERY_RESULT_POOL_MAX_ROWS + 1, "Large Query");
+    free_query_result(large);
+    QueryResult* small = query_result_new(0, "Small Query");
+    int trimmed = large && small == large && small->capacity == 0 && small->data == NULL;
+    free_query_result(small);
+    printf("%s Oversized Buffers Dropped: %s\n", trimmed ? "✅" : "❌", trimmed ? "PASSED" : "FAILED");
+    passed += trimmed;
+
+    results->total_tests += test_count;
+    results->passed_tests += passed;
+    results->failed_tests += (test_count - passed);
+
+    printf("\nObject Pool Tests: %d/%d passed\n", passed, test_count);
+    return passed;
+}
+
+// Reads the log file back, so it needs one (INGRES_LOG_FILE not set to "")
+int run_logger_tests(TestResults* results) {
+    printf("\n📝 LOGGER TESTS\n");
+    printf("===============\n");
+
+    int passed = 0;
+    int test_count = 3;
+
+    // Make sure the flusher is running with its default configuration
+    log_message(LOG_INFO, "Logger tests starting");
+    const char* path = logger_path();
+    if (!path) {
+        printf("⏭️  Skipped: no log file configured\n");
+        return 0;
+    }
+
+    // 1. Lines below the threshold are dropped before formatting
+    logger_set_level(LOG_WARNING);
+    int filtered = !log_enabled(LOG_DEBUG) && !log_enabled(LOG_INFO) && log_enabled(LOG_ERROR);
+    log_message(LOG_INFO, "logger-test filtered %d", 1);
+    log_message(LOG_WARNING, "logger-test text %d", 2);
+    logger_flush();
+    logger_set_level(LOG_INFO);
+
+    // 2. Flushed text lines are on disk, in order, with level prefixes
+    logger_set_format(LOG_FORMAT_JSON);
+    log_message(LOG_ERROR, "logger-test \"json\"\tline\n");
+    logger_flush();
+    logger_set_format(LOG_FORMAT_TEXT);
+
+    char line[1024];
+    int saw_filtered = 0;
+    int saw_text = 0;
+    int saw_json = 0;
+    FILE* log = fopen(path, "r");
+    while (log && fgets(line, sizeof(line), log)) {
+        if (strstr(line, "logger-test filtered")) saw_filtered = 1;
+        if (strstr(line, "] [WARN] logger-test text 2\n")) saw_text = 1;
+        if (strstr(line, "\"level\":\"error\"") &&
+            strstr(line, "\"msg\":\"logger-test \\\"json\\\"\\tline\\n\"}\n")) saw_json = 1;
+    }
+    if (log) fclose(log);
+
+    filtered = filtered && !saw_filtered;
+    printf("%s Level Filtering: %s\n", filtered ? "✅" : "❌", filtered ? "PASSED" : "FAILED");
+    passed += filtered;
+
+    printf("%s Flushed Text Line: %s\n", saw_text ? "✅" : "❌", saw_text ? "PASSED" : "FAILED");
+    passed += saw_text;
+
+    // 3. JSON lines escape the message and stay one line each
+    printf("%s JSON Line Format: %s\n", saw_json ? "✅" : "❌", saw_json ? "PASSED" : "FAILED");
+    passed += saw_json;
+
+    results->total_tests += test_count;
+    results->passed_tests += passed;
+    results->failed_tests += (test_count - passed);
+
+    printf("\nLogger Tests: %d/%d passed\n", passed, test_count);
+    return passed;
+}
+
+static void* record_parse_latencies(void* arg) {
+    (void)arg;
+    for (int i = 0; i < 500; i++) metrics_record(METRIC_PARSE, 2000);
+    return NULL;
+}
+
+int run_metrics_tests(TestResults* results) {
+    printf("\n⏱️  METRICS TESTS\n");
+    printf("================\n");
+
+    int passed = 0;
+    int test_count = 3;
+    LatencyHistogram histogram;
+
+    // 1. Quantiles land within the histogram's ~3% bucket precision
+    metrics_reset();
+    for (int i = 1; i <= 100; i++) metrics_record(METRIC_RENDER, (uint64_t)i * 1000);
+    metrics_snapshot(METRIC_RENDER, &histogram);
+    double p50 = (double)metrics_value_at_quantile(&histogram, 0.5);
+    double p99 = (double)metrics_value_at_quantile(&histogram, 0.99);
+    int accurate = histogram.total_count == 100 && histogram.max_ns == 100000 &&
+                   fabs(p50 - 50000.0) / 50000.0 < 0.04 && fabs(p99 - 99000.0) / 99000.0 < 0.04;
+    printf("%s Quantile Accuracy: %s\n", accurate ? "✅" : "❌", accurate ? "PASSED" : "FAILED");
+    passed += accurate;
+
+    // 2. Counts from other threads survive their exit and merge with ours
+    pthread_t workers[2];
+    int started = 0;
+    for (int i = 0; i < 2; i++) {
+        started += pthread_create(&workers[i], NULL, record_parse_latencies, NULL) == 0;
+    }
+    for (int i = 0; i < started; i++) pthread_join(workers[i], NULL);
+    for (int i = 0; i < 100; i++) metrics_record(METRIC_PARSE, 4000);
+    metrics_snapshot(METRIC_PARSE, &histogram);
+    int merged = started == 2 && histogram.total_count == 1100 && histogram.total_ns == 2400000;
+    printf("%s Per-Thread Merge: %s\n", merged ? "✅" : "❌", merged ? "PASSED" : "FAILED");
+    passed += merged;
+
+    // 3. A real request records its stages and shows up in the exposition
+    metrics_reset();
+    BotResponse* response = process_user_query("Show me groundwater status in Punjab");
+    free_bot_response(response);
+    LatencyHistogram location;
+    metrics_snapshot(METRIC_REQUEST, &histogram);
+    metrics_snapshot(METRIC_LOCATION, &location);
+    char* text = metrics_render_prometheus();
+    int exposed = response && histogram.total_count == 1 && location.total_count == 1 && text &&
+                  strstr(text, "ingres_stage_duration_seconds_count{stage=\"request\"} 1\n") &&
+                  strstr(text, "ingres_stage_duration_seconds{stage=\"classify\",quantile=\"0.99\"}");
+    free(text);
+    printf("%s Pipeline Stages Exposed: %s\n", exposed ? "✅" : "❌", exposed ? "PASSED" : "FAILED");
+    passed += exposed;
+
+    results->total_tests += test_count;
+    results->passed_tests += passed;
+    results->failed_tests += (test_count - passed);
+
+    printf("\nMetrics Tests: %d/%d passed\n", passed, test_count);
+    return passed;
+}
+
+// Admission test jobs: a blocker holds the only worker until released, the
+// others record the order they ran in
+static pthread_mutex_t admission_test_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t admission_test_changed = PTHREAD_COND_INITIALIZER;
+static int blocker_state = 0;       // 0 idle, 1 running, 2 released
+static char run_order[8];
+static int run_count = 0;
+static int shed_counts[ADMISSION_SHED_REASON_COUNT];
+
+static void blocking_job(void* arg) {
+    (void)arg;
+    pthread_mutex_lock(&admission_test_lock);
+    blocker_state = 1;
+    pthread_cond_broadcast(&admission_test_changed);
+    while (blocker_state != 2) pthread_cond_wait(&admission_test_changed, &admission_test_lock);
+    pthread_mutex_unlock(&admission_test_lock);
+}
+
+static void recording_job(void* arg) {
+    pthread_mutex_lock(&admission_test_lock);
+    if (run_count < (int)sizeof(run_order) - 1) run_order[run_count] = *(const char*)arg;
+    run_count++;
+    pthread_cond_broadcast(&admission_test_changed);
+    pthread_mutex_unlock(&admission_test_lock);
+}
+
+static void counting_shed(void* arg, AdmissionShedReason reason) {
+    (void)arg;
+    pthread_mutex_lock(&admission_test_lock);
+    shed_counts[reason]++;
+    pthread_mutex_unlock(&admission_test_lock);
+}
+
+// Occupy the single worker so everything submitted afterwards queues
+static void start_blocker(void) {
+    pthread_mutex_lock(&admission_test_lock);
+    blocker_state = 0;
+    run_count = 0;
+    memset(run_order, 0, sizeof(run_order));
+    memset(shed_counts, 0, sizeof(shed_counts));
+    pthread_mutex_unlock(&admission_test_lock);
+
+    admission_submit(ADMISSION_PRIORITY_NORMAL, blocking_job, counting_shed, NULL);
+    pthread_mutex_lock(&admission_test_lock);
+    while (blocker_state != 1) pthread_cond_wait(&admission_test_changed, &admission_test_lock);
+    pthread_mutex_unlock(&admission_test_lock);
+}
+
+static void release_blocker(int wait_for_runs) {
+    pthread_mutex_lock(&admission_test_lock);
+    blocker_state = 2;
+    pthread_cond_broadcast(&admission_test_changed);
+    while (run_count < wait_for_runs) pthread_cond_wait(&admission_test_changed, &admission_test_lock);
+    pthread_mutex_unlock(&admission_test_lock);
+}
+
+int run_admission_tests(TestResults* results) {
+    printf("\n🚦 ADMISSION CONTROL TESTS\n");
+    printf("==========================\n");
+
+    int passed = 0;
+    int test_count = 3;
+    AdmissionConfig config = { .max_concurrent = 1, .max_queued = 2, .max_wait_ms = 60000 };
+    AdmissionStats stats;
+
+    // 1. Queued work runs highest priority first once a worker frees up
+    config.max_queued = 4;
+    bool started = admission_init(&config);
+    start_blocker();
+    admission_submit(ADMISSION_PRIORITY_LOW, recording_job, counting_shed, "L");
+    admission_submit(ADMISSION_PRIORITY_NORMAL, recording_job, counting_shed, "N");
+    admission_submit(ADMISSION_PRIORITY_HIGH, recording_job, counting_shed, "H");
+    admission_stats(&stats);
+    int queued_by_priority = stats.queued == 3 && stats.in_flight == 1 &&
+                             stats.queued_by_priority[ADMISSION_PRIORITY_HIGH] == 1;
+    release_blocker(3);
+    admission_shutdown();
+    int ordered = started && queued_by_priority && strcmp(run_order, "HNL") == 0;
+    printf("%s Priority Order: %s\n", ordered ? "✅" : "❌", ordered ? "PASSED" : "FAILED");
+    passed += ordered;
+
+    // 2. Beyond the queue bound a request is shed at once, not queued
+    config.max_queued = 2;
+    started = admission_init(&config);
+    start_blocker();
+    bool first = admission_submit(ADMISSION_PRIORITY_NORMAL, recording_job, counting_shed, "a");
+    bool second = admission_submit(ADMISSION_PRIORITY_NORMAL, recording_job, counting_shed, "b");
+    bool third = admission_submit(ADMISSION_PRIORITY_HIGH, recording_job, counting_shed, "c");
+    int shed_full = shed_counts[ADMISSION_SHED_QUEUE_FULL];
+    release_blocker(2);
+    admission_stats(&stats);
+    admission_shutdown();
+    int bounded = started && first && second && !third && shed_full == 1 &&
+                  stats.shed_total[ADMISSION_SHED_QUEUE_FULL] == 1 && strcmp(run_order, "ab") == 0;
+    printf("%s Queue Bound Sheds: %s\n", bounded ? "✅" : "❌", bounded ? "PASSED" : "FAILED");
+    passed += bounded;
+
+    // 3. Requests that wait past the deadline are shed with a Retry-After hint
+    config.max_wait_ms = 50;
+    started = admission_init(&config);
+    start_blocker();
+    admission_submit(ADMISSION_PRIORITY_LOW, recording_job, counting_shed, "x");
+    int early = admission_expire();
+    uint64_t queued_at = metrics_now_ns();
+    while (metrics_now_ns() - queued_at < 60000000ULL) {}
+    int expired = admission_expire();
+    uint32_t retry_after = admission_retry_after();
+    release_blocker(0);
+    admission_stats(&stats);
+    admission_shutdown();
+    int timed_out = started && early == 0 && expired == 1 && shed_counts[ADMISSION_SHED_TIMEOUT] == 1 &&
+                    run_count == 0 && stats.queued == 0 && retry_after >= 1 &&
+                    retry_after <= ADMISSION_MAX_RETRY_AFTER;
+    printf("%s Queue Deadline Sheds: %s\n", timed_out ? "✅" : "❌", timed_out ? "PASSED" : "FAILED");
+    passed += timed_out;
+
+    results->total_tests += test_count;
+    results->passed_tests += passed;
+    results->failed_tests += (test_count - passed);
+
+    printf("\nAdmission Tests: %d/%d passed\n", passed, test_count);
+    return passed;
+}
+
+// Records which bytes each flight member was handed
+static SharedBytes* flight_results[4];
+
+static void record_flight_result(void* member, SharedBytes* result) {
+    flight_results[(intptr_t)member] = shared_bytes_retain(result);
+}
+
+int run_singleflight_tests(TestResults* results) {
+    printf("\n🛫 SINGLE-FLIGHT TESTS\n");
+    printf("======================\n");
+
+    int passed = 0;
+    int test_count = 3;
+
+    // 1. Case, spacing and trailing punctuation do not split a flight
+    char a[128], b[128];
+    size_t a_length = singleflight_normalize("  Show   Punjab STATUS?? ", a, sizeof(a));
+    size_t b_length = singleflight_normalize("show punjab status", b, sizeof(b));
+    int normalized = a_length == b_length && strcmp(a, b) == 0 && strcmp(a, "show punjab status") == 0 &&
+                     singleflight_normalize("   ?", a, sizeof(a)) == 0;
+    printf("%s Query Normalization: %s\n", normalized ? "✅" : "❌", normalized ? "PASSED" : "FAILED");
+    passed += normalized;
+
+    // 2. Duplicates join the leader's flight and all receive the same bytes
+    memset(flight_results, 0, sizeof(flight_results));
+    SingleFlightStats before, after;
+    singleflight_stats(&before);
+    SingleFlight* leader = singleflight_begin("Critical areas", record_flight_result, (void*)0);
+    SingleFlight* duplicate = singleflight_begin("critical  areas?", record_flight_result, (void*)1);
+    SingleFlight* other = singleflight_begin("Punjab status", record_flight_result, (void*)2);
+    singleflight_stats(&after);
+    const char* body = "{\"message\":\"critical\"}";
+    SharedBytes* answer = shared_bytes_new(200, body, strlen(body));
+    singleflight_complete(leader, answer);
+    int coalesced = leader && !duplicate && other && flight_results[0] == answer &&
+                    flight_results[1] == answer && !flight_results[2] &&
+                    after.coalesced - before.coalesced == 1 && after.leaders - before.leaders == 2 &&
+                    atomic_load(&answer->refs) == 2;
+    singleflight_complete(other, NULL);
+    coalesced = coalesced && !flight_results[2];
+    printf("%s Duplicates Share One Result: %s\n", coalesced ? "✅" : "❌", coalesced ? "PASSED" : "FAILED");
+    passed += coalesced;
+    shared_bytes_release(flight_results[0]);
+    shared_bytes_release(flight_results[1]);
+
+    // 3. A finished flight is forgotten: the next identical query recomputes
+    SingleFlight* again = singleflight_begin("Critical areas", record_flight_result, (void*)3);
+    int fresh = again != NULL;
+    singleflight_complete(again, shared_bytes_new(200, "{}", 2));
+    singleflight_stats(&after);
+    fresh = fresh && flight_results[3] && after.in_flight == before.in_flight;
+    shared_bytes_release(flight_results[3]);
+    printf("%s Completed Flights Retire: %s\n", fresh ? "✅" : "❌", fresh ? "PASSED" : "FAILED");
+    passed += fresh;
+
+    results->total_tests += test_count;
+    results->passed_tests += passed;
+    results->failed_tests += (test_count - passed);
+
+    printf("\nSingle-Flight Tests: %d/%d passed\n", passed, test_count);
+    return passed;
+}
+
+int run_json_writer_tests(TestResults* results) {
+    printf("\n🧾 JSON WRITER TESTS\n");
+    printf("====================\n");
+
+    int passed = 0;
+    int test_count = 3;
+    StrBuf out;
+    strbuf_init(&out);
+    JsonWriter json;
+
+    // 1. Commas and nesting are placed by the writer
+    json_writer_init(&json, &out);
+    json_begin_object(&json);
+    json_key(&json, "a");
+    json_int(&json, -3);
+    json_key(&json, "b");
+    json_begin_array(&json);
+    json_bool(&json, true);
+    json_double(&json, 1.5, 2);
+    json_null(&json);
+    json_begin_object(&json);
+    json_end_object(&json);
+    json_end_array(&json);
+    json_end_object(&json);
+    int structured = json_writer_ok(&json) && strcmp(out.data, "{\"a\":-3,\"b\":[true,1.50,null,{}]}") == 0;
+    printf("%s Nesting And Separators: %s\n", structured ? "✅" : "❌", structured ? "PASSED" : "FAILED");
+    passed += structured;
+
+    // 2. Quotes, backslashes and control characters are escaped; UTF-8 is kept
+    strbuf_clear(&out);
+    json_writer_init(&json, &out);
+    json_string(&json, "Say \"hi\"\n\\ \x01 💧");
+    int escaped = json_writer_ok(&json) && strcmp(out.data, "\"Say \\\"hi\\\"\\n\\\\ \\u0001 💧\"") == 0;
+    printf("%s String Escaping: %s\n", escaped ? "✅" : "❌", escaped ? "PASSED" : "FAILED");
+    passed += escaped;
+
+    // 3. A real response with markdown and newlines serializes as valid JSON
+    BotResponse* response = process_user_query("Show critical areas in Punjab");
+    char* serialized = bot_response_to_json(response);
+    int valid = serialized && strstr(serialized, "\"message\":\"") && !strchr(serialized, '\n') &&
+                serialized[strlen(serialized) - 1] == '}';
+    free(serialized);
+    free_bot_response(response);
+    printf("%s Response Serialization: %s\n", valid ? "✅" : "❌", valid ? "PASSED" : "FAILED");
+    passed += valid;
+
+    strbuf_free(&out);
+    results->total_tests += test_count;
+    results->passed_tests += passed;
+    results->failed_tests += (test_count - passed);
+
+    printf("\nJSON Writer Tests: %d/%d passed\n", passed, test_count);
+    return passed;
+}
+
+int run_json_reader_tests(TestResults* results) {
+    printf("\n📖 JSON READER TESTS\n");
+    printf("====================\n");
+
+    int passed = 0;
+    int test_count = 3;
+    JsonReader json;
+
+    // 1. A batch body: bare strings and objects, unknown members skipped
+    const char* batch = " [\"Status of Punjab\", {\"session_id\":\"s1\",\"extra\":[1,{\"x\":null}],"
+                        "\"message\":\"Trend in Delhi\"}, \"\"] ";
+    json_reader_init(&json, batch, strlen(batch));
+    char* first = NULL;
+    char* second = NULL;
+    char* session = NULL;
+    char* third = NULL;
+    char key[16];
+    bool walked = json_enter_array(&json) && json_next_element(&json) &&
+                  (first = json_read_string(&json)) != NULL &&
+                  json_next_element(&json) && json_enter_object(&json);
+    while (walked && json_next_member(&json, key, sizeof(key))) {
+        if (strcmp(key, "message") == 0) second = json_read_string(&json);
+        else if (strcmp(key, "session_id") == 0) session = json_read_string(&json);
+        else json_skip(&json);
+    }
+    walked = walked && json_next_element(&json) && (third = json_read_string(&json)) != NULL &&
+             !json_next_element(&json) && json_reader_done(&json) &&
+             strcmp(first, "Status of Punjab") == 0 && second && strcmp(second, "Trend in Delhi") == 0 &&
+             session && strcmp(session, "s1") == 0 && third[0] == '\0';
+    free(first);
+    free(second);
+    free(session);
+    free(third);
+    printf("%s Array Of Mixed Items: %s\n", walked ? "✅" : "❌", walked ? "PASSED" : "FAILED");
+    passed += walked;
+
+    // 2. Escapes, including a surrogate pair, come back as UTF-8
+    const char* escaped = "\"Say \\\"hi\\\"\\n\\u00e9 \\ud83d\\udca7\"";
+    json_reader_init(&json, escaped, strlen(escaped));
+    char* text = json_read_string(&json);
+    bool unescaped = text && strcmp(text, "Say \"hi\"\né 💧") == 0 && json_reader_done(&json);
+    free(text);
+    printf("%s String Unescaping: %s\n", unescaped ? "✅" : "❌", unescaped ? "PASSED" : "FAILED");
+    passed += unescaped;
+
+    // 3. Malformed input is refused rather than half-read
+    const char* malformed[] = { "[\"a\" \"b\"]", "[\"a\",]", "[\"unterminated]", "[\"a\"] x", "{\"a\" 1}" };
+    bool refused = true;
+    for (size_t i = 0; i < sizeof(malformed) / sizeof(malformed[0]); i++) {
+        json_reader_init(&json, malformed[i], strlen(malformed[i]));
+        if (json_skip(&json) && json_reader_done(&json)) refused = false;
+    }
+    printf("%s Malformed Input Refused: %s\n", refused ? "✅" : "❌", refused ? "PASSED" : "FAILED");
+    passed += refused;
+
+    results->total_tests += test_count;
+    results->passed_tests += passed;
+    results->failed_tests += (test_count - passed);
+
+    printf("\nJSON Reader Tests: %d/%d passed\n", passed, test_count);
+    return passed;
+}
+
+typedef struct {
+    int calls;
+    IntentType intent;
+} IntentProbe;
+
+static void probe_intent(void* context, IntentType intent, float confidence) {
+    IntentProbe* probe = context;
+    (void)confidence;
+    probe->calls++;
+    probe->intent = intent;
+}
+
+int run_streaming_tests(TestResults* results) {
+    printf("\n📡 STREAMING TESTS\n");
+    printf("==================\n");
+
+    int passed = 0;
+    int test_count = 3;
+
+    // Test 1: the intent is reported once, and matches the final response
+    IntentProbe probe = {0};
+    BotResponse* response = process_user_query_streaming("What conservation methods work for Punjab?",
+                                                         NULL, probe_intent, &probe);
+    bool reported = response && probe.calls == 1 && probe.intent == response->intent;
+    free_enhanced_bot_response(response);
+    printf("%s Intent Reported Early: %s\n", reported ? "✅" : "❌", reported ? "PASSED" : "FAILED");
+    passed += reported;
+
+    // Test 2: input rejected before classification reports nothing
+    IntentProbe empty_probe = {0};
+    BotResponse* rejected = process_user_query_streaming("", NULL, probe_intent, &empty_probe);
+    bool silent = rejected && empty_probe.calls == 0;
+    free_enhanced_bot_response(rejected);
+    printf("%s No Intent For Empty Input: %s\n", silent ? "✅" : "❌", silent ? "PASSED" : "FAILED");
+    passed += silent;
+
+    // Test 3: a session's turns land in its own context only
+    ConversationContext* first = init_conversation_context();
+    ConversationContext* second = init_conversation_context();
+    BotResponse* turn = first ? process_user_query_in_session("Groundwater status in Punjab", first) : NULL;
+    bool isolated = turn && first->query_count == 1 && second && second->query_count == 0;
+    free_enhanced_bot_response(turn);
+    printf("%s Session Context Isolated: %s\n", isolated ? "✅" : "❌", isolated ? "PASSED" : "FAILED");
+    passed += isolated;
+    if (first) free_conversation_context(first);
+    if (second) free_conversation_context(second);
+
+    results->total_tests += test_count;
+    results->passed_tests += passed;
+    results->failed_tests += (test_count - passed);
+
+    printf("\nStreaming Tests: %d/%d passed\n", passed, test_count);
+    return passed;
+}
+
+// Frame a raw deflate body and inflate it back with zlib's own decoder
+static bool inflate_framed(ContentEncoding encoding, const char* source, size_t source_length,
+                           const StrBuf* deflated, char* out, size_t out_size, size_t* out_length) {
+    unsigned char header[COMPRESS_HEADER_MAX], trailer[COMPRESS_TRAILER_MAX];
+    size_t header_length = compress_frame_header(encoding, header);
+    size_t trailer_length = compress_frame_trailer(encoding, source, source_length, trailer);
+
+    StrBuf framed;
+    strbuf_init(&framed);
+    bool ok = strbuf_append(&framed, (const char*)header, header_length) &&
+              strbuf_append(&framed, deflated->data, deflated->length) &&
+              strbuf_append(&framed, (const char*)trailer, trailer_length);
+
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    int window = encoding == CONTENT_ENCODING_GZIP ? 16 + MAX_WBITS : MAX_WBITS;
+    if (ok && inflateInit2(&stream, window) == Z_OK) {
+        stream.next_in = (Bytef*)framed.data;
+        stream.avail_in = (uInt)framed.length;
+        stream.next_out = (Bytef*)out;
+        stream.avail_out = (uInt)out_size;
+        ok = inflate(&stream, Z_FINISH) == Z_STREAM_END;   // Also verifies the trailer
+        *out_length = out_size - stream.avail_out;
+        inflateEnd(&stream);
+    } else {
+        ok = false;
+    }
+    strbuf_free(&framed);
+    return ok;
+}
+
+int run_compress_tests(TestResults* results) {
+    printf("\n🗜️  COMPRESSION TESTS\n");
+    printf("=====================\n");
+
+    int passed = 0;
+    int test_count = 3;
+
+    // Test 1: Accept-Encoding negotiation honours q-values and wildcards
+    struct { const char* header; ContentEncoding expected; } cases[] = {
+        {"gzip, deflate, br", CONTENT_ENCODING_GZIP},
+        {"deflate", CONTENT_ENCODING_DEFLATE},
+        {"gzip;q=0, deflate;q=0.5", CONTENT_ENCODING_DEFLATE},
+        {"deflate;q=0.4, gzip;q=0.8", CONTENT_ENCODING_GZIP},
+        {"*;q=0.1", CONTENT_ENCODING_GZIP},
+        {"br, identity", CONTENT_ENCODING_IDENTITY},
+        {"*, gzip;q=0", CONTENT_ENCODING_DEFLATE},
+    };
+    bool negotiated = compress_negotiate(NULL, 0) == CONTENT_ENCODING_IDENTITY;
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        negotiated = negotiated && compress_negotiate(cases[i].header, strlen(cases[i].header)) == cases[i].expected;
+    }
+    printf("%s Encoding Negotiation: %s\n", negotiated ? "✅" : "❌", negotiated ? "PASSED" : "FAILED");
+    passed += negotiated;
+
+    // Test 2: one raw deflate body round-trips as both gzip and deflate
+    StrBuf text;
+    strbuf_init(&text);
+    for (int i = 0; i < 40; i++) {
+        strbuf_appendf(&text, "🌊 Punjab district %d: extraction %d%% of recharge, \"over-exploited\"\n", i, 150 + i);
+    }
+    StrBuf deflated;
+    strbuf_init(&deflated);
+    char* inflated = malloc(text.length + 64);
+    size_t inflated_length = 0;
+    bool round_trip = inflated && deflate_buffer(text.data, text.length, &deflated) &&
+                      deflated.length * 3 < text.length;
+    for (int encoding = CONTENT_ENCODING_GZIP; round_trip && encoding <= CONTENT_ENCODING_DEFLATE; encoding++) {
+        round_trip = inflate_framed((ContentEncoding)encoding, text.data, text.length, &deflated,
+                                    inflated, text.length + 64, &inflated_length) &&
+                     inflated_length == text.length && memcmp(inflated, text.data, text.length) == 0;
+    }
+    printf("%s Gzip And Deflate Round Trip: %s\n", round_trip ? "✅" : "❌", round_trip ? "PASSED" : "FAILED");
+    passed += round_trip;
+
+    // Test 3: a precompressed segment spliced between dynamic spans decodes
+    // to the concatenated text
+    const char* prefix = "{\"message\":\"";
+    const char* suffix = "\",\"intent\":1,\"confidence\":0.93}";
+    DeflateSegment segment;
+    Deflater deflater;
+    strbuf_clear(&deflated);
+    bool spliced = deflate_segment_init(&segment, text.data, text.length) &&
+                   deflater_begin(&deflater, &deflated);
+    if (spliced) {
+        deflater_write(&deflater, prefix, strlen(prefix));
+        deflater_splice(&deflater, &segment);
+        deflater_write(&deflater, suffix, strlen(suffix));
+        spliced = deflater_finish(&deflater);
+    }
+    StrBuf expected;
+    strbuf_init(&expected);
+    strbuf_append_str(&expected, prefix);
+    strbuf_append(&expected, text.data, text.length);
+    strbuf_append_str(&expected, suffix);
+    spliced = spliced && inflate_framed(CONTENT_ENCODING_GZIP, expected.data, expected.length, &deflated,
+                                        inflated, text.length + 64, &inflated_length) &&
+              inflated_length == expected.length && memcmp(inflated, expected.data, expected.length) == 0;
+    printf("%s Precompressed Segment Splice: %s\n", spliced ? "✅" : "❌", spliced ? "PASSED" : "FAILED");
+    passed += spliced;
+
+    deflate_segment_free(&segment);
+    strbuf_free(&expected);
+    strbuf_free(&deflated);
+    strbuf_free(&text);
+    free(inflated);
+    results->total_tests += test_count;
+    results->passed_tests += passed;
+    results->failed_tests += (test_count - passed);
+
+    printf("\nCompression Tests: %d/%d passed\n", passed, test_count);
+    return passed;
+}
+
+static bool write_test_file(const char* file, const char* text, size_t length) {
+    FILE* out = fopen(file, "wb");
+    if (!out) return false;
+    bool ok = fwrite(text, 1, length, out) == length;
+    return fclose(out) == 0 && ok;
+}
+
+int run_static_cache_tests(TestResults* results) {
+    printf("\n🗂️  STATIC CACHE TESTS\n");
+    printf("=====================\n");
+
+    int passed = 0;
+    int test_count = 3;
+
+    // Two roots, as the server loads the build output ahead of public
+    char build[] = "/tmp/ingres_static_XXXXXX";
+    char public_root[] = "/tmp/ingres_public_XXXXXX";
+    char js_dir[64], index_file[64], script_file[64], public_index[64], robots_file[64];
+    StrBuf html;
+    strbuf_init(&html);
+    strbuf_append_str(&html, "<!doctype html><html><body>");
+    for (int i = 0; i < 40; i++) strbuf_appendf(&html, "<p>Groundwater block %d</p>", i);
+    strbuf_append_str(&html, "</body></html>");
+
+    bool ready = mkdtemp(build) && mkdtemp(public_root);
+    if (ready) {
+        snprintf(js_dir, sizeof(js_dir), "%s/static", build);
+        snprintf(index_file, sizeof(index_file), "%s/index.html", build);
+        snprintf(script_file, sizeof(script_file), "%s/static/main.1a2b3c4d.js", build);
+        snprintf(public_index, sizeof(public_index), "%s/index.html", public_root);
+        snprintf(robots_file, sizeof(robots_file), "%s/robots.txt", public_root);
+        ready = mkdir(js_dir, 0700) == 0 &&
+                write_test_file(index_file, html.data, html.length) &&
+                write_test_file(script_file, "console.log(1);", 15) &&
+                write_test_file(public_index, "stale", 5) &&
+                write_test_file(robots_file, "User-agent: *\n", 14) &&
+                static_cache_load(build) && static_cache_load(public_root);
+    }
+
+    // Test 1: "/" is the build's index.html, revalidated, with a gzip body
+    // that inflates back to the file
+    const StaticAsset* index = ready ? static_cache_find("/") : NULL;
+    char* inflated = malloc(html.length + 64);
+    bool gzipped = index && inflated && index->length == html.length && index->gzip &&
+                   strcmp(index->cache_control, STATIC_CACHE_REVALIDATE) == 0;
+    if (gzipped) {
+        z_stream stream;
+        memset(&stream, 0, sizeof(stream));
+        gzipped = inflateInit2(&stream, 16 + MAX_WBITS) == Z_OK;
+        if (gzipped) {
+            stream.next_in = (Bytef*)index->gzip;
+            stream.avail_in = (uInt)index->gzip_length;
+            stream.next_out = (Bytef*)inflated;
+            stream.avail_out = (uInt)(html.length + 64);
+            gzipped = inflate(&stream, Z_FINISH) == Z_STREAM_END && stream.total_out == html.length &&
+                      memcmp(inflated, html.data, html.length) == 0;
+            inflateEnd(&stream);
+        }
+    }
+    printf("%s Index Served With Gzip Body: %s\n", gzipped ? "✅" : "❌", gzipped ? "PASSED" : "FAILED");
+    passed += gzipped;
+
+    // Test 2: a hashed build file is immutable and revalidates by ETag
+    const StaticAsset* script = ready ? static_cache_find("/static/main.1a2b3c4d.js") : NULL;
+    char weak[40];
+    if (script) snprintf(weak, sizeof(weak), "\"nope\", W/%s", script->etag);
+    bool validated = script && !script->gzip &&
+                     strcmp(script->cache_control, STATIC_CACHE_IMMUTABLE) == 0 &&
+                     static_cache_not_modified(script, script->etag, strlen(script->etag)) &&
+                     static_cache_not_modified(script, weak, strlen(weak)) &&
+                     !static_cache_not_modified(script, "\"nope\"", 6);
+    printf("%s Hashed Asset ETag And Lifetime: %s\n", validated ? "✅" : "❌", validated ? "PASSED" : "FAILED");
+    passed += validated;
+
+    // Test 3: public files fill in behind the build; unknown paths miss
+    const StaticAsset* robots = ready ? static_cache_find("/robots.txt") : NULL;
+    bool layered = robots && robots->length == 14 && index && index->length != 5 &&
+                   !static_cache_find("/missing.js") && !static_cache_find("/../etc/passwd");
+    printf("%s Roots Layered In Order: %s\n", layered ? "✅" : "❌", layered ? "PASSED" : "FAILED");
+    passed += layered;
+
+    static_cache_clear();
+    if (ready) {
+        remove(script_file);
+        remove(index_file);
+        remove(js_dir);
+        remove(build);
+        remove(public_index);
+        remove(robots_file);
+        remove(public_root);
+    }
+    free(inflated);
+    strbuf_free(&html);
+    results->total_tests += test_count;
+    results->passed_tests += passed;
+    results->failed_tests += (test_count - passed);
+
+    printf("\nStatic Cache Tests: %d/%d passed\n", passed, test_count);
+    return passed;
+}
+
+// Runs against a local PostgreSQL stand-in named by INGRES_TEST_CONNINFO
+// (e.g. "host=localhost dbname=ingres_test"); skipped when it is not set.
+int run_database_pool_tests(TestResults* results) {
+    printf("\n🐘 DATABASE POOL TESTS\n");
+    printf("======================\n");
+
+#ifdef USE_POSTGRESQL
+    const char* conninfo = getenv("INGRES_TEST_CONNINFO");
+    if (!conninfo || !*conninfo) {
+        printf("⏭️  Skipped: INGRES_TEST_CONNINFO not set\n");
+        return 0;
+    }
+
+    int passed = 0;
+    int test_count = 4;
+
+    // Results cached by earlier tests came from the in-memory store
+    query_cache_invalidate_all();
+    db_pool_shutdown();
+    if (!db_pool_init(conninfo, 2)) {
+        printf("❌ Pool Init: FAILED (could not connect)\n");
+        results->total_tests += test_count;
+        results->failed_tests += test_count;
+        return 0;
+    }
+
+    // 1. Prepared, binary-format query decodes into GroundwaterData
+    QueryResult* result = query_by_state("Punjab");
+    int decoded = result && result->count > 0 && strcmp(result->query_type, "PostgreSQL State Query") == 0;
+    for (int i = 0; decoded && i < result->count; i++) {
+        decoded = strcasecmp(result->data[i].state, "Punjab") == 0 &&
+                  result->data[i].assessment_year > 0;
+    }
+    free_query_result(result);
+    printf("%s Binary Decode: %s\n", decoded ? "✅" : "❌", decoded ? "PASSED" : "FAILED");
+    passed += decoded;
+
+    // 2. Exhausted pool times out instead of sharing a connection
+    PooledConnection* a = db_pool_acquire(100);
+    PooledConnection* b = db_pool_acquire(100);
+    PooledConnection* c = db_pool_acquire(100);
+    int exclusive = a && b && !c && db_pool_conn(a) != db_pool_conn(b);
+    if (c) db_pool_release(c, true);
+    printf("%s Exclusive Checkout: %s\n", exclusive ? "✅" : "❌", exclusive ? "PASSED" : "FAILED");
+    passed += exclusive;
+
+    // 3. A connection released as broken is reset and re-prepared
+    // (b stays checked out so the query has to take the reset slot)
+    db_pool_release(a, false);
+    DbPoolStats before, after;
+    db_pool_get_stats(&before);
+    QueryResult* retried = query_by_location("Punjab", NULL, NULL);
+    QueryResult* again = query_by_location("Punjab", NULL, NULL);
+    db_pool_release(b, true);
+    db_pool_get_stats(&after);
+    int recovered = retried && again && retried->count == again->count &&
+                    after.healthy == 2 && after.in_use == 0;
+    free_query_result(retried);
+    free_query_result(again);
+    printf("%s Reconnect: %s (reconnects %ld → %ld)\n", recovered ? "✅" : "❌",
+           recovered ? "PASSED" : "FAILED", before.reconnects, after.reconnects);
+    passed += recovered;
+
+    // 4. A pipelined batch returns the same rows as sequential queries
+    static const char* batch_states[] = {"Punjab", "Haryana", "Rajasthan"};
+    DbBatch* batch = db_batch_create();
+    for (int i = 0; i < 3; i++) {
+        db_batch_add_state(batch, batch_states[i]);
+    }
+    int pipelined = db_batch_submit(batch) && db_batch_wait(batch, 2000) == DB_BATCH_DONE;
+    for (int i = 0; pipelined && i < 3; i++) {
+        QueryResult* batched = db_batch_take_result(batch, i);
+        QueryResult* single = query_by_state(batch_states[i]);
+        pipelined = batched && single && batched->count == single->count;
+        free_query_result(batched);
+        free_query_result(single);
+    }
+    db_batch_free(batch);
+    printf("%s Pipelined Batch: %s\n", pipelined ? "✅" : "❌", pipelined ? "PASSED" : "FAILED");
+    passed += pipelined;
+
+    results->total_tests += test_count;
+    results->passed_tests += passed;
+    results->failed_tests += (test_count - passed);
+
+    printf("\nDatabase Pool Tests: %d/%d passed\n", passed, test_count);
+    return passed;
+#else
+    (void)results;
+    printf("⏭️  Skipped: built without USE_POSTGRESQL\n");
+    return 0;
+#endif
+}
+
 void print_test_summary(TestResults* results) {
     printf("\n" "═══════════════════════════════════════════════════════════════\n");
     printf("📊 COMPREHENSIVE TEST SUITE RESULTS\n");
@@ -330,7 +1671,7 @@ void print_test_summary(TestResults* results) {
 
     printf("═══════════════════════════════════════════════════════════════\n");
 
-    log_message(1, "Test suite completed - %d/%d tests passed (%.1f%%)",
+    log_message(LOG_INFO, "Test suite completed - %d/%d tests passed (%.1f%%)",
                 results->passed_tests, results->total_tests, success_rate);
 }
 
@@ -353,6 +1694,23 @@ int run_comprehensive_test_suite() {
     run_response_tests(&results);
     run_fuzzy_tests(&results);
     run_performance_tests(&results);
+    run_query_cache_tests(&results);
+    run_snapshot_tests(&results);
+    run_timeseries_tests(&results);
+    run_template_tests(&results);
+    run_response_ownership_tests(&results);
+    run_arena_tests(&results);
+    run_object_pool_tests(&results);
+    run_logger_tests(&results);
+    run_metrics_tests(&results);
+    run_admission_tests(&results);
+    run_singleflight_tests(&results);
+    run_json_writer_tests(&results);
+    run_json_reader_tests(&results);
+    run_compress_tests(&results);
+    run_static_cache_tests(&results);
+    run_streaming_tests(&results);
+    run_database_pool_tests(&results);
 
     // Print final summary
     print_test_summary(&results);
@@ -0,0 +1,456 @@
+/*
+ * INGRES ChatBot - Time-Series Store
+ * Compressed multi-year assessment history per location with precomputed
+ * trends and year-major columns for whole-dataset scans.
+ */
+
+#include "timeseries.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <math.h>
+
+#define TS_FIXED_SCALE 100.0        // Measures are stored in hundredths of MCM
+#define TS_MAX_CATEGORIES 255
+
+typedef struct {
+    char state[50];
+    char district[50];
+    char block[50];
+} LocationKey;
+
+struct TimeSeriesStore {
+    size_t location_count;
+    LocationKey* keys;              // Sorted case-insensitively
+    uint32_t* block_offsets;        // location_count + 1 offsets into blob
+    uint8_t* blob;                  // Encoded series, one block per location
+    TimeSeriesStats* stats;
+
+    char (*categories)[20];         // Category dictionary; blocks hold indexes
+    int category_count;
+
+    int* years;                     // Distinct assessment years, ascending
+    size_t year_count;
+    float* columns;                 // [measure][year][location]; NAN where absent
+};
+
+// ============================================================================
+// ENCODING
+// ============================================================================
+
+typedef struct {
+    uint8_t* data;
+    size_t size;
+    size_t capacity;
+} ByteBuffer;
+
+static bool buffer_reserve(ByteBuffer* buffer, size_t extra) {
+    if (buffer->size + extra <= buffer->capacity) return true;
+    size_t capacity = buffer->capacity ? buffer->capacity * 2 : 4096;
+    while (capacity < buffer->size + extra) capacity *= 2;
+    uint8_t* grown = realloc(buffer->data, capacity);
+    if (!grown) return false;
+    buffer->data = grown;
+    buffer->capacity = capacity;
+    return true;
+}
+
+static uint32_t zigzag(int32_t value) {
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static int32_t unzigzag(uint32_t value) {
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+// Caller reserved 5 bytes
+static void put_varint(ByteBuffer* buffer, uint32_t value) {
+    while (value >= 0x80) {
+        buffer->data[buffer->size++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    buffer->data[buffer->size++] = (uint8_t)value;
+}
+
+static uint32_t get_varint(const uint8_t** cursor) {
+    const uint8_t* p = *cursor;
+    uint32_t value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        uint8_t byte = *p++;
+        value |= (uint32_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) break;
+    }
+    *cursor = p;
+    return value;
+}
+
+static int32_t to_fixed(float value) {
+    return (int32_t)lrint(value * TS_FIXED_SCALE);
+}
+
+static float from_fixed(int32_t value) {
+    return (float)(value / TS_FIXED_SCALE);
+}
+
+static float measure_of(const GroundwaterData* row, int measure) {
+    switch (measure) {
+        case TS_MEASURE_RECHARGE:    return row->annual_recharge;
+        case TS_MEASURE_EXTRACTABLE: return row->extractable_resource;
+        default:                     return row->annual_extraction;
+    }
+}
+
+// ============================================================================
+// BUILDING
+// ============================================================================
+
+static int compare_location(const GroundwaterData* a, const GroundwaterData* b) {
+    int cmp = strcasecmp(a->state, b->state);
+    if (cmp == 0) cmp = strcasecmp(a->district, b->district);
+    if (cmp == 0) cmp = strcasecmp(a->block, b->block);
+    return cmp;
+}
+
+static _Thread_local const GroundwaterData* sort_rows;
+
+// Location, then year, then input order so the last duplicate wins
+static int compare_row_index(const void* a, const void* b) {
+    size_t ia = *(const size_t*)a, ib = *(const size_t*)b;
+    const GroundwaterData* ra = &sort_rows[ia];
+    const GroundwaterData* rb = &sort_rows[ib];
+    int cmp = compare_location(ra, rb);
+    if (cmp == 0) cmp = (ra->assessment_year > rb->assessment_year) - (ra->assessment_year < rb->assessment_year);
+    if (cmp == 0) cmp = (ia > ib) - (ia < ib);
+    return cmp;
+}
+
+static int compare_int(const void* a, const void* b) {
+    int x = *(const int*)a, y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+static int intern_category(TimeSeriesStore* store, const char* category) {
+    for (int i = 0; i < store->category_count; i++) {
+        if (strcasecmp(store->categories[i], category) == 0) return i;
+    }
+    if (store->category_count >= TS_MAX_CATEGORIES) return 0;
+    snprintf(store->categories[store->category_count], sizeof(store->categories[0]), "%s", category);
+    return store->category_count++;
+}
+
+static size_t year_index(const TimeSeriesStore* store, int year) {
+    const int* found = bsearch(&year, store->years, store->year_count, sizeof(int), compare_int);
+    return (size_t)(found - store->years);
+}
+
+static void compute_stats(TimeSeriesStats* stats, const GroundwaterData* const* series, int n) {
+    memset(stats, 0, sizeof(*stats));
+    stats->year_count = n;
+    if (n == 0) return;
+    stats->first_year = series[0]->assessment_year;
+    stats->last_year = series[n - 1]->assessment_year;
+
+    double mean_year = 0.0;
+    for (int i = 0; i < n; i++) mean_year += series[i]->assessment_year;
+    mean_year /= n;
+
+    for (int m = 0; m < TS_MEASURE_COUNT; m++) {
+        double mean_value = 0.0;
+        for (int i = 0; i < n; i++) mean_value += measure_of(series[i], m);
+        mean_value /= n;
+
+        double sxy = 0.0, sxx = 0.0;
+        for (int i = 0; i < n; i++) {
+            double dx = series[i]->assessment_year - mean_year;
+            sxy += dx * (measure_of(series[i], m) - mean_value);
+            sxx += dx * dx;
+        }
+        stats->slope[m] = sxx > 0.0 ? (float)(sxy / sxx) : 0.0f;
+
+        double first = measure_of(series[0], m);
+        double last = measure_of(series[n - 1], m);
+        int span = stats->last_year - stats->first_year;
+        stats->cagr[m] = (first > 0.0 && last > 0.0 && span > 0)
+                             ? (float)(pow(last / first, 1.0 / span) - 1.0) : 0.0f;
+    }
+}
+
+// Block layout: varint row count, then per row zigzag varint deltas of year
+// and each fixed-point measure against the previous row, and a category byte
+static bool encode_series(ByteBuffer* blob, TimeSeriesStore* store,
+                          const GroundwaterData* const* series, int n) {
+    if (!buffer_reserve(blob, 5 + (size_t)n * (5 * (1 + TS_MEASURE_COUNT) + 1))) return false;
+    put_varint(blob, (uint32_t)n);
+
+    int32_t previous[1 + TS_MEASURE_COUNT] = {0};
+    for (int i = 0; i < n; i++) {
+        int32_t current[1 + TS_MEASURE_COUNT];
+        current[0] = series[i]->assessment_year;
+        for (int m = 0; m < TS_MEASURE_COUNT; m++) current[1 + m] = to_fixed(measure_of(series[i], m));
+
+        for (int f = 0; f < 1 + TS_MEASURE_COUNT; f++) {
+            put_varint(blob, zigzag(current[f] - previous[f]));
+            previous[f] = current[f];
+        }
+        blob->data[blob->size++] = (uint8_t)intern_category(store, series[i]->category);
+    }
+    return true;
+}
+
+TimeSeriesStore* timeseries_build(const GroundwaterData* rows, size_t count) {
+    TimeSeriesStore* store = calloc(1, sizeof(TimeSeriesStore));
+    size_t* order = malloc(sizeof(size_t) * (count ? count : 1));
+    int* all_years = malloc(sizeof(int) * (count ? count : 1));
+    const GroundwaterData** series = malloc(sizeof(GroundwaterData*) * (count ? count : 1));
+    ByteBuffer blob = {0};
+    bool ok = store && order && all_years && series;
+
+    if (ok) {
+        store->categories = calloc(TS_MAX_CATEGORIES, sizeof(store->categories[0]));
+        ok = store->categories != NULL;
+    }
+
+    // Sort row indexes; count locations and distinct years
+    size_t locations = 0;
+    if (ok) {
+        for (size_t i = 0; i < count; i++) {
+            order[i] = i;
+            all_years[i] = rows[i].assessment_year;
+        }
+        sort_rows = rows;
+        qsort(order, count, sizeof(size_t), compare_row_index);
+        qsort(all_years, count, sizeof(int), compare_int);
+
+        for (size_t i = 0; i < count; i++) {
+            if (i == 0 || compare_location(&rows[order[i]], &rows[order[i - 1]]) != 0) locations++;
+            if (i == 0 || all_years[i] != all_years[store->year_count - 1]) {
+                all_years[store->year_count++] = all_years[i];
+            }
+        }
+
+        store->location_count = locations;
+        store->keys = calloc(locations ? locations : 1, sizeof(LocationKey));
+        store->block_offsets = calloc(locations + 1, sizeof(uint32_t));
+        store->stats = calloc(locations ? locations : 1, sizeof(TimeSeriesStats));
+        store->years = malloc(sizeof(int) * (store->year_count ? store->year_count : 1));
+        store->columns = malloc(sizeof(float) * TS_MEASURE_COUNT * (store->year_count ? store->year_count : 1) *
+                                (locations ? locations : 1));
+        ok = store->keys && store->block_offsets && store->stats && store->years && store->columns;
+    }
+
+    if (ok) {
+        memcpy(store->years, all_years, sizeof(int) * store->year_count);
+        size_t cells = TS_MEASURE_COUNT * store->year_count * locations;
+        for (size_t i = 0; i < cells; i++) store->columns[i] = NAN;
+
+        size_t location = 0;
+        for (size_t i = 0; ok && i < count; ) {
+            // Gather one location's rows, keeping the last of each year
+            int n = 0;
+            size_t j = i;
+            for (; j < count && compare_location(&rows[order[j]], &rows[order[i]]) == 0; j++) {
+                const GroundwaterData* row = &rows[order[j]];
+                if (n > 0 && series[n - 1]->assessment_year == row->assessment_year) n--;
+                series[n++] = row;
+            }
+
+            LocationKey* key = &store->keys[location];
+            snprintf(key->state, sizeof(key->state), "%s", series[0]->state);
+            snprintf(key->district, sizeof(key->district), "%s", series[0]->district);
+            snprintf(key->block, sizeof(key->block), "%s", series[0]->block);
+
+            store->block_offsets[location] = (uint32_t)blob.size;
+            ok = encode_series(&blob, store, series, n);
+            compute_stats(&store->stats[location], series, n);
+
+            for (int k = 0; k < n; k++) {
+                size_t y = year_index(store, series[k]->assessment_year);
+                for (int m = 0; m < TS_MEASURE_COUNT; m++) {
+                    store->columns[((size_t)m * store->year_count + y) * locations + location] =
+                        measure_of(series[k], m);
+                }
+            }
+
+            location++;
+            i = j;
+        }
+        store->block_offsets[locations] = (uint32_t)blob.size;
+        store->blob = blob.data;
+        blob.data = NULL;
+    }
+
+    free(order);
+    free(all_years);
+    free(series);
+    free(blob.data);
+    if (!ok) {
+        timeseries_free(store);
+        return NULL;
+    }
+    return store;
+}
+
+void timeseries_free(TimeSeriesStore* store) {
+    if (!store) return;
+    free(store->keys);
+    free(store->block_offsets);
+    free(store->blob);
+    free(store->stats);
+    free(store->categories);
+    free(store->years);
+    free(store->columns);
+    free(store);
+}
+
+// ============================================================================
+// QUERIES
+// ============================================================================
+
+size_t timeseries_location_count(const TimeSeriesStore* store) {
+    return store ? store->location_count : 0;
+}
+
+void timeseries_location_names(const TimeSeriesStore* store, uint32_t location,
+                               const char** state, const char** district, const char** block) {
+    const LocationKey* key = (store && location < store->location_count) ? &store->keys[location] : NULL;
+    if (state) *state = key ? key->state : NULL;
+    if (district) *district = key ? key->district : NULL;
+    if (block) *block = key ? key->block : NULL;
+}
+
+size_t timeseries_find(const TimeSeriesStore* store, const char* state, const char* district,
+                       const char* block, uint32_t* out, size_t max) {
+    if (!store) return 0;
+
+    // Keys are sorted by state first, so a state narrows the scan
+    size_t lo = 0, hi = store->location_count;
+    if (state) {
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (strcasecmp(store->keys[mid].state, state) < 0) lo = mid + 1;
+            else hi = mid;
+        }
+        hi = store->location_count;
+    }
+
+    size_t found = 0;
+    for (size_t i = lo; i < hi; i++) {
+        const LocationKey* key = &store->keys[i];
+        if (state && strcasecmp(key->state, state) != 0) break;
+        if ((district && strcasecmp(key->district, district) != 0) ||
+            (block && strcasecmp(key->block, block) != 0)) {
+            continue;
+        }
+        if (found < max) out[found] = (uint32_t)i;
+        found++;
+    }
+    return found;
+}
+
+size_t timeseries_range(const TimeSeriesStore* store, uint32_t location, int from_year, int to_year,
+                        GroundwaterData* out, size_t max) {
+    if (!store || location >= store->location_count) return 0;
+
+    const LocationKey* key = &store->keys[location];
+    const uint8_t* cursor = store->blob + store->block_offsets[location];
+    uint32_t n = get_varint(&cursor);
+
+    int32_t current[1 + TS_MEASURE_COUNT] = {0};
+    size_t written = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        for (int f = 0; f < 1 + TS_MEASURE_COUNT; f++) current[f] += unzigzag(get_varint(&cursor));
+        uint8_t category = *cursor++;
+
+        int year = current[0];
+        if (to_year > 0 && year > to_year) break;      // Years ascend
+        if ((from_year > 0 && year < from_year) || written >= max) continue;
+
+        GroundwaterData* row = &out[written++];
+        memcpy(row->state, key->state, sizeof(row->state));
+        memcpy(row->district, key->district, sizeof(row->district));
+        memcpy(row->block, key->block, sizeof(row->block));
+        memcpy(row->category, store->categories[category], sizeof(row->category));
+        row->annual_recharge = from_fixed(current[1 + TS_MEASURE_RECHARGE]);
+        row->extractable_resource = from_fixed(current[1 + TS_MEASURE_EXTRACTABLE]);
+        row->annual_extraction = from_fixed(current[1 + TS_MEASURE_EXTRACTION]);
+        row->assessment_year = year;
+    }
+    return written;
+}
+
+const TimeSeriesStats* timeseries_stats(const TimeSeriesStore* store, uint32_t location) {
+    return (store && location < store->location_count) ? &store->stats[location] : NULL;
+}
+
+size_t timeseries_fastest_declining(const TimeSeriesStore* store, TsMeasure measure, int since_year,
+                                    TimeSeriesDecline* out, size_t max) {
+    if (!store || measure < 0 || measure >= TS_MEASURE_COUNT || max == 0) return 0;
+
+    size_t first = 0;
+    while (first < store->year_count && store->years[first] < since_year) first++;
+    if (first == store->year_count || store->location_count == 0) return 0;
+
+    size_t n = store->location_count;
+    float* from = malloc(sizeof(float) * n);
+    float* to = malloc(sizeof(float) * n);
+    if (!from || !to) {
+        free(from);
+        free(to);
+        return 0;
+    }
+    for (size_t i = 0; i < n; i++) from[i] = to[i] = NAN;
+
+    // Branch-free selects over contiguous columns (x == x is false for NAN)
+    // so each pass vectorizes (this file builds with -O3): newest-to-oldest
+    // leaves the earliest value since since_year, oldest-to-newest the latest
+    const float* base = store->columns + (size_t)measure * store->year_count * n;
+    for (size_t y = store->year_count; y-- > first; ) {
+        const float* column = base + y * n;
+        for (size_t i = 0; i < n; i++) from[i] = column[i] == column[i] ? column[i] : from[i];
+    }
+    for (size_t y = first; y < store->year_count; y++) {
+        const float* column = base + y * n;
+        for (size_t i = 0; i < n; i++) to[i] = column[i] == column[i] ? column[i] : to[i];
+    }
+    for (size_t i = 0; i < n; i++) {
+        float change = (to[i] - from[i]) / from[i];
+        to[i] = from[i] > 0.0f ? change : NAN;
+    }
+
+    // Keep the max most negative changes (insertion into a short sorted list)
+    size_t kept = 0;
+    for (size_t i = 0; i < n; i++) {
+        float change = to[i];
+        if (!(change < 0.0f)) continue;
+        if (kept == max && change >= out[kept - 1].change) continue;
+
+        size_t pos = kept < max ? kept++ : max - 1;
+        while (pos > 0 && out[pos - 1].change > change) {
+            out[pos] = out[pos - 1];
+            pos--;
+        }
+        out[pos].location = (uint32_t)i;
+        out[pos].change = change;
+    }
+
+    // Fill in the endpoints for the survivors only
+    for (size_t k = 0; k < kept; k++) {
+        uint32_t location = out[k].location;
+        out[k].from_year = out[k].to_year = 0;
+        for (size_t y = first; y < store->year_count; y++) {
+            float value = base[y * n + location];
+            if (value != value) continue;
+            if (!out[k].from_year) {
+                out[k].from_year = store->years[y];
+                out[k].from_value = value;
+            }
+            out[k].to_year = store->years[y];
+            out[k].to_value = value;
+        }
+    }
+
+    free(from);
+    free(to);
+    return kept;
+}
@@ -4,8 +4,10 @@
  */
 
 #include "utils.h"
+#include "csv_reader.h"
 #include <stdarg.h>
 #include <errno.h>
+#include <math.h>
 
 // Global error state
 static UtilsError last_error = UTILS_SUCCESS;
@@ -334,6 +336,125 @@ StringArray* string_split(const string str, const char delimiter) {
     return result;
 }
 
+// ============================================================================
+// STRING BUFFERS
+// ============================================================================
+
+void strbuf_init(StrBuf* buf) {
+    buf->data = NULL;
+    buf->length = 0;
+    buf->capacity = 0;
+}
+
+void strbuf_free(StrBuf* buf) {
+    if (!buf) return;
+    free(buf->data);
+    strbuf_init(buf);
+}
+
+void strbuf_clear(StrBuf* buf) {
+    buf->length = 0;
+    if (buf->data) buf->data[0] = '\0';
+}
+
+bool strbuf_reserve(StrBuf* buf, size_t extra) {
+    size_t needed = buf->length + extra + 1;
+    if (needed <= buf->capacity) return true;
+
+    size_t capacity = buf->capacity ? buf->capacity * 2 : 256;
+    while (capacity < needed) capacity *= 2;
+    char* grown = realloc(buf->data, capacity);
+    if (!grown) {
+        last_error = UTILS_ERROR_OUT_OF_MEMORY;
+        return false;
+    }
+    buf->data = grown;
+    buf->capacity = capacity;
+    return true;
+}
+
+bool strbuf_append(StrBuf* buf, const char* data, size_t length) {
+    if (!strbuf_reserve(buf, length)) return false;
+    memcpy(buf->data + buf->length, data, length);
+    buf->length += length;
+    buf->data[buf->length] = '\0';
+    return true;
+}
+
+bool strbuf_append_str(StrBuf* buf, const char* str) {
+    return str ? strbuf_append(buf, str, strlen(str)) : true;
+}
+
+bool strbuf_append_int(StrBuf* buf, long value) {
+    char digits[24];
+    char* p = digits + sizeof(digits);
+    unsigned long magnitude = value < 0 ? 0UL - (unsigned long)value : (unsigned long)value;
+    do {
+        *--p = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude);
+    if (value < 0) *--p = '-';
+    return strbuf_append(buf, p, (size_t)(digits + sizeof(digits) - p));
+}
+
+// Fixed-point formatting without printf: sub-100ns for the small values
+// responses carry; falls back to printf for NaN, infinities and huge values
+bool strbuf_append_fixed(StrBuf* buf, double value, int decimals, bool show_sign) {
+    static const long scales[] = {1, 10, 100, 1000, 10000, 100000, 1000000};
+    if (decimals < 0) decimals = 0;
+    if (decimals > 6) decimals = 6;
+
+    if (!(fabs(value) < 1e12)) {
+        return strbuf_appendf(buf, show_sign ? "%+.*f" : "%.*f", decimals, value);
+    }
+
+    long scale = scales[decimals];
+    long scaled = lround(fabs(value) * (double)scale);
+    bool negative = value < 0 && scaled != 0;
+
+    if (negative && !strbuf_append(buf, "-", 1)) return false;
+    if (!negative && show_sign && !strbuf_append(buf, "+", 1)) return false;
+    if (!strbuf_append_int(buf, scaled / scale)) return false;
+    if (decimals == 0) return true;
+
+    char fraction[8];
+    long rest = scaled % scale;
+    fraction[0] = '.';
+    for (int i = decimals; i > 0; i--) {
+        fraction[i] = (char)('0' + rest % 10);
+        rest /= 10;
+    }
+    return strbuf_append(buf, fraction, (size_t)decimals + 1);
+}
+
+bool strbuf_appendf(StrBuf* buf, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    char probe[256];
+    int needed = vsnprintf(probe, sizeof(probe), format, args);
+    va_end(args);
+    if (needed < 0) return false;
+    if ((size_t)needed < sizeof(probe)) return strbuf_append(buf, probe, (size_t)needed);
+
+    if (!strbuf_reserve(buf, (size_t)needed)) return false;
+    va_start(args, format);
+    vsnprintf(buf->data + buf->length, (size_t)needed + 1, format, args);
+    va_end(args);
+    buf->length += (size_t)needed;
+    return true;
+}
+
+string strbuf_copy(const StrBuf* buf) {
+    string copy = malloc(buf->length + 1);
+    if (!copy) {
+        last_error = UTILS_ERROR_OUT_OF_MEMORY;
+        return NULL;
+    }
+    if (buf->length) memcpy(copy, buf->data, buf->length);
+    copy[buf->length] = '\0';
+    return copy;
+}
+
 // ============================================================================
 // HASH TABLE
 // ============================================================================
@@ -597,14 +718,28 @@ StringArray* csv_read_line(const string csv_line) {
     StringArray* fields = string_array_create();
     if (!fields) return NULL;
 
+    // Quote-aware split in a single copy of the line; empty fields are kept
     string line_copy = string_duplicate(csv_line);
-    char* token = strtok(line_copy, ",");
+    if (!line_copy) {
+        string_array_free(fields);
+        return NULL;
+    }
 
-    while (token != NULL) {
-        string trimmed = string_trim(token);
-        string_array_add(fields, trimmed);
-        free(trimmed);
-        token = strtok(NULL, ",");
+    size_t len = strlen(line_copy);
+    while (len > 0 && (line_copy[len - 1] == '\n' || line_copy[len - 1] == '\r')) {
+        line_copy[--len] = '\0';
+    }
+
+    char* parsed[CSV_MAX_FIELDS];
+    int count = csv_parse_record(line_copy, len, parsed, CSV_MAX_FIELDS);
+
+    for (int i = 0; i < count; i++) {
+        // Trim in place rather than allocating a trimmed copy
+        char* field = parsed[i];
+        while (isspace((unsigned char)*field)) field++;
+        char* field_end = field + strlen(field);
+        while (field_end > field && isspace((unsigned char)field_end[-1])) *--field_end = '\0';
+        string_array_add(fields, field);
     }
 
     free(line_copy);
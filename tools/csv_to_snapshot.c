@@ -0,0 +1,228 @@
+/*
+ * INGRES ChatBot - CSV to Snapshot Converter
+ * Streams a CGWB assessment CSV export and writes the binary snapshot the
+ * server maps at startup (see include/snapshot.h).
+ *
+ * Usage: csv_to_snapshot <input.csv> <output.snap> [--year YYYY]
+ *
+ * Columns are located by header name (case-insensitive), so exports with
+ * extra or reordered columns convert without editing.
+ */
+
+#include "csv_reader.h"
+#include "snapshot.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <time.h>
+
+typedef enum {
+    COL_STATE,
+    COL_DISTRICT,
+    COL_BLOCK,
+    COL_CATEGORY,
+    COL_RECHARGE,
+    COL_EXTRACTABLE,
+    COL_EXTRACTION,
+    COL_YEAR,
+    COL_COUNT
+} Column;
+
+// Accepted header names per column, first match wins
+static const char* const column_aliases[COL_COUNT][5] = {
+    [COL_STATE]       = {"state", "state_name", NULL},
+    [COL_DISTRICT]    = {"district", "district_name", NULL},
+    [COL_BLOCK]       = {"block", "assessment_unit", "mandal", "taluk", NULL},
+    [COL_CATEGORY]    = {"category", "categorization", "stage_category", NULL},
+    [COL_RECHARGE]    = {"annual_recharge", "total_annual_ground_water_recharge", "recharge", NULL},
+    [COL_EXTRACTABLE] = {"net_availability", "annual_extractable_ground_water_resource", "extractable_resource", NULL},
+    [COL_EXTRACTION]  = {"annual_extraction", "ground_water_extraction_for_all_uses", "extraction", NULL},
+    [COL_YEAR]        = {"assessment_year", "year", NULL},
+};
+
+// Canonical spellings so the category index has one entry per category
+static const char* const categories[] = {"Safe", "Semi-Critical", "Critical", "Over-Exploited", "Saline"};
+
+static char* trim(char* s) {
+    while (isspace((unsigned char)*s)) s++;
+    char* end = s + strlen(s);
+    while (end > s && isspace((unsigned char)end[-1])) *--end = '\0';
+    return s;
+}
+
+// Normalize a header cell for matching: lowercase, units in parentheses
+// dropped, runs of other characters folded to '_'
+// ("Annual Extraction (MCM)" -> "annual_extraction")
+static void normalize_header(const char* cell, char* out, size_t size) {
+    size_t len = 0;
+    bool pending_separator = false;
+    for (const char* p = cell; *p && *p != '(' && len + 2 < size; p++) {
+        unsigned char ch = (unsigned char)*p;
+        if (isalnum(ch)) {
+            if (pending_separator && len > 0) out[len++] = '_';
+            out[len++] = (char)tolower(ch);
+            pending_separator = false;
+        } else {
+            pending_separator = true;
+        }
+    }
+    out[len] = '\0';
+}
+
+static void copy_field(char* dest, size_t size, const char* src) {
+    snprintf(dest, size, "%s", src ? src : "");
+}
+
+static float parse_float(const char* s, bool* ok) {
+    char* end;
+    float value = strtof(s, &end);
+    if (end == s) *ok = false;
+    return value;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <input.csv> <output.snap> [--year YYYY]\n", argv[0]);
+        return 2;
+    }
+
+    int default_year = 0;
+    for (int i = 3; i + 1 < argc; i++) {
+        if (strcmp(argv[i], "--year") == 0) default_year = atoi(argv[++i]);
+    }
+
+    clock_t start = clock();
+    CsvReader* reader = csv_reader_open(argv[1]);
+    if (!reader) {
+        fprintf(stderr, "❌ Cannot open %s\n", argv[1]);
+        return 1;
+    }
+
+    char* fields[CSV_MAX_FIELDS];
+    int field_count = csv_reader_next(reader, fields, CSV_MAX_FIELDS);
+    if (field_count <= 0) {
+        fprintf(stderr, "❌ %s has no header row\n", argv[1]);
+        csv_reader_close(reader);
+        return 1;
+    }
+
+    char header[CSV_MAX_FIELDS][64];
+    for (int f = 0; f < field_count; f++) {
+        normalize_header(fields[f], header[f], sizeof(header[f]));
+    }
+
+    int column_index[COL_COUNT];
+    for (int c = 0; c < COL_COUNT; c++) {
+        column_index[c] = -1;
+        for (int a = 0; column_aliases[c][a] && column_index[c] < 0; a++) {
+            for (int f = 0; f < field_count; f++) {
+                if (strcmp(header[f], column_aliases[c][a]) == 0) {
+                    column_index[c] = f;
+                    break;
+                }
+            }
+        }
+    }
+
+    if (column_index[COL_STATE] < 0 || column_index[COL_DISTRICT] < 0 || column_index[COL_CATEGORY] < 0) {
+        fprintf(stderr, "❌ Header must name at least state, district and category columns\n");
+        csv_reader_close(reader);
+        return 1;
+    }
+    if (column_index[COL_YEAR] < 0 && default_year <= 0) {
+        fprintf(stderr, "❌ No assessment year column; pass --year YYYY\n");
+        csv_reader_close(reader);
+        return 1;
+    }
+
+    SnapshotBuilder* builder = snapshot_builder_create();
+    if (!builder) {
+        csv_reader_close(reader);
+        return 1;
+    }
+
+    long rows = 0, skipped = 0;
+    while ((field_count = csv_reader_next(reader, fields, CSV_MAX_FIELDS)) != 0) {
+        if (field_count < 0) {
+            fprintf(stderr, "❌ Malformed CSV near line %ld (unterminated quote)\n", csv_reader_line(reader));
+            snapshot_builder_free(builder);
+            csv_reader_close(reader);
+            return 1;
+        }
+
+        const char* values[COL_COUNT];
+        for (int c = 0; c < COL_COUNT; c++) {
+            int index = column_index[c];
+            values[c] = index >= 0 && index < field_count ? trim(fields[index]) : "";
+        }
+
+        GroundwaterData row;
+        memset(&row, 0, sizeof(row));
+        copy_field(row.state, sizeof(row.state), values[COL_STATE]);
+        copy_field(row.district, sizeof(row.district), values[COL_DISTRICT]);
+        copy_field(row.block, sizeof(row.block), values[COL_BLOCK]);
+        copy_field(row.category, sizeof(row.category), values[COL_CATEGORY]);
+        for (size_t i = 0; i < sizeof(categories) / sizeof(categories[0]); i++) {
+            if (strcasecmp(row.category, categories[i]) == 0) {
+                copy_field(row.category, sizeof(row.category), categories[i]);
+            }
+        }
+
+        bool ok = row.state[0] && row.district[0] && row.category[0];
+        row.annual_recharge = parse_float(values[COL_RECHARGE], &ok);
+        row.extractable_resource = parse_float(values[COL_EXTRACTABLE], &ok);
+        row.annual_extraction = parse_float(values[COL_EXTRACTION], &ok);
+        row.assessment_year = column_index[COL_YEAR] >= 0 ? atoi(values[COL_YEAR]) : default_year;
+        if (row.assessment_year <= 0) row.assessment_year = default_year;
+
+        if (!ok || row.assessment_year <= 0) {
+            if (skipped++ < 10) {
+                fprintf(stderr, "⚠️  Skipping line %ld: missing or non-numeric values\n", csv_reader_line(reader));
+            }
+            continue;
+        }
+
+        if (!snapshot_builder_add(builder, &row)) {
+            fprintf(stderr, "❌ Out of memory at line %ld\n", csv_reader_line(reader));
+            snapshot_builder_free(builder);
+            csv_reader_close(reader);
+            return 1;
+        }
+        rows++;
+    }
+    csv_reader_close(reader);
+
+    size_t size = 0;
+    uint8_t* image = snapshot_builder_finish(builder, &size);
+    snapshot_builder_free(builder);
+    if (!image) {
+        fprintf(stderr, "❌ Failed to build snapshot\n");
+        return 1;
+    }
+
+    bool written = snapshot_write_file(image, size, argv[2]);
+    free(image);
+    if (!written) {
+        fprintf(stderr, "❌ Failed to write %s\n", argv[2]);
+        return 1;
+    }
+
+    // Round-trip through the loader so a bad image never ships
+    Snapshot* check = snapshot_open(argv[2]);
+    if (!check) {
+        fprintf(stderr, "❌ Written snapshot failed validation\n");
+        return 1;
+    }
+
+    double elapsed_ms = (double)(clock() - start) / CLOCKS_PER_SEC * 1000.0;
+    printf("✅ Wrote %s\n", argv[2]);
+    printf("   • Rows: %ld (%ld skipped)\n", rows, skipped);
+    printf("   • States: %u, categories: %u, dictionary strings: %u\n",
+           check->state_count, check->category_count, check->string_count);
+    printf("   • Size: %zu bytes, checksum %016llx\n", size, (unsigned long long)check->checksum);
+    printf("   • Converted in %.1f ms\n", elapsed_ms);
+    snapshot_close(check);
+    return 0;
+}